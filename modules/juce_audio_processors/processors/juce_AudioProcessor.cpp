@@ -338,14 +338,12 @@ void AudioProcessor::setRandomAudioReader (AudioFormatReader* const newAudioForm
 
 void AudioProcessor::addListener (AudioProcessorListener* newListener)
 {
-    const ScopedLock sl (listenerLock);
-    listeners.addIfNotAlreadyThere (newListener);
+    listeners.add (newListener);
 }
 
 void AudioProcessor::removeListener (AudioProcessorListener* listenerToRemove)
 {
-    const ScopedLock sl (listenerLock);
-    listeners.removeFirstMatchingValue (listenerToRemove);
+    listeners.remove (listenerToRemove);
 }
 
 void AudioProcessor::setPlayConfigDetails (int newNumIns, int newNumOuts, double newSampleRate, int newBlockSize)
@@ -430,17 +428,9 @@ bool AudioProcessor::isHighResolutionParameters(bool initialValue)
 }
 
 //==============================================================================
-AudioProcessorListener* AudioProcessor::getListenerLocked (int index) const noexcept
-{
-    const ScopedLock sl (listenerLock);
-    return listeners[index];
-}
-
 void AudioProcessor::updateHostDisplay (const AudioProcessorListener::ChangeDetails& details)
 {
-    for (int i = listeners.size(); --i >= 0;)
-        if (auto l = getListenerLocked (i))
-            l->audioProcessorChanged (this, details);
+    listeners.call ([this, &details] (AudioProcessorListener& l) { l.audioProcessorChanged (this, details); });
 }
 
 void AudioProcessor::checkForDuplicateParamID (AudioProcessorParameter* param)
@@ -1285,9 +1275,7 @@ void AudioProcessor::sendParamChangeMessageToListeners (int parameterIndex, floa
     {
         if (isPositiveAndBelow (parameterIndex, getNumParameters()))
         {
-            for (int i = listeners.size(); --i >= 0;)
-                if (auto* l = getListenerLocked (i))
-                    l->audioProcessorParameterChanged (this, parameterIndex, newValue);
+            listeners.call ([=] (AudioProcessorListener& l) { l.audioProcessorParameterChanged (this, parameterIndex, newValue); });
         }
         else
         {
@@ -1313,9 +1301,7 @@ void AudioProcessor::beginParameterChangeGesture (int parameterIndex)
             changingParams.setBit (parameterIndex);
            #endif
 
-            for (int i = listeners.size(); --i >= 0;)
-                if (auto* l = getListenerLocked (i))
-                    l->audioProcessorParameterChangeGestureBegin (this, parameterIndex);
+            listeners.call ([=] (AudioProcessorListener& l) { l.audioProcessorParameterChangeGestureBegin (this, parameterIndex); });
         }
         else
         {
@@ -1342,9 +1328,7 @@ void AudioProcessor::endParameterChangeGesture (int parameterIndex)
             changingParams.clearBit (parameterIndex);
            #endif
 
-            for (int i = listeners.size(); --i >= 0;)
-                if (auto* l = getListenerLocked (i))
-                    l->audioProcessorParameterChangeGestureEnd (this, parameterIndex);
+            listeners.call ([=] (AudioProcessorListener& l) { l.audioProcessorParameterChangeGestureEnd (this, parameterIndex); });
         }
         else
         {
@@ -1530,19 +1514,14 @@ void AudioProcessorParameter::beginChangeGesture()
     isPerformingGesture = true;
    #endif
 
-    ScopedLock lock (listenerLock);
-
-    for (int i = listeners.size(); --i >= 0;)
-        if (auto* l = listeners[i])
-            l->parameterGestureChanged (getParameterIndex(), true);
+    auto index = getParameterIndex();
+    listeners.call ([index] (Listener& l) { l.parameterGestureChanged (index, true); });
 
     if (processor != nullptr && parameterIndex >= 0)
     {
         // audioProcessorParameterChangeGestureBegin callbacks will shortly be deprecated and
         // this code will be removed.
-        for (int i = processor->listeners.size(); --i >= 0;)
-            if (auto* l = processor->listeners[i])
-                l->audioProcessorParameterChangeGestureBegin (processor, getParameterIndex());
+        processor->listeners.call ([this, index] (AudioProcessorListener& l) { l.audioProcessorParameterChangeGestureBegin (processor, index); });
     }
 }
 
@@ -1556,37 +1535,27 @@ void AudioProcessorParameter::endChangeGesture()
     isPerformingGesture = false;
    #endif
 
-    ScopedLock lock (listenerLock);
-
-    for (int i = listeners.size(); --i >= 0;)
-        if (auto* l = listeners[i])
-            l->parameterGestureChanged (getParameterIndex(), false);
+    auto index = getParameterIndex();
+    listeners.call ([index] (Listener& l) { l.parameterGestureChanged (index, false); });
 
     if (processor != nullptr && parameterIndex >= 0)
     {
         // audioProcessorParameterChangeGestureEnd callbacks will shortly be deprecated and
         // this code will be removed.
-        for (int i = processor->listeners.size(); --i >= 0;)
-            if (auto* l = processor->listeners[i])
-                l->audioProcessorParameterChangeGestureEnd (processor, getParameterIndex());
+        processor->listeners.call ([this, index] (AudioProcessorListener& l) { l.audioProcessorParameterChangeGestureEnd (processor, index); });
     }
 }
 
 void AudioProcessorParameter::sendValueChangedMessageToListeners (float newValue)
 {
-    ScopedLock lock (listenerLock);
-
-    for (int i = listeners.size(); --i >= 0;)
-        if (auto* l = listeners [i])
-            l->parameterValueChanged (getParameterIndex(), newValue);
+    auto index = getParameterIndex();
+    listeners.call ([index, newValue] (Listener& l) { l.parameterValueChanged (index, newValue); });
 
     if (processor != nullptr && parameterIndex >= 0)
     {
         // audioProcessorParameterChanged callbacks will shortly be deprecated and
         // this code will be removed.
-        for (int i = processor->listeners.size(); --i >= 0;)
-            if (auto* l = processor->listeners[i])
-                l->audioProcessorParameterChanged (processor, getParameterIndex(), newValue);
+        processor->listeners.call ([this, index, newValue] (AudioProcessorListener& l) { l.audioProcessorParameterChanged (processor, index, newValue); });
     }
 }
 
@@ -1623,14 +1592,12 @@ StringArray AudioProcessorParameter::getAllValueStrings() const
 
 void AudioProcessorParameter::addListener (AudioProcessorParameter::Listener* newListener)
 {
-    const ScopedLock sl (listenerLock);
-    listeners.addIfNotAlreadyThere (newListener);
+    listeners.add (newListener);
 }
 
 void AudioProcessorParameter::removeListener (AudioProcessorParameter::Listener* listenerToRemove)
 {
-    const ScopedLock sl (listenerLock);
-    listeners.removeFirstMatchingValue (listenerToRemove);
+    listeners.remove (listenerToRemove);
 }
 
 } // namespace juce
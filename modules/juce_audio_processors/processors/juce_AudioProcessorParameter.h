@@ -269,6 +269,11 @@ public:
     /** Registers a listener to receive events when the parameter's state changes.
         If the listener is already registered, this will not register it again.
 
+        The listeners are called without taking any locks, so it's safe for a parameter's
+        value to be changed on the audio thread while listeners are being added or removed
+        on other threads. Once removeListener() has returned, the listener won't be called
+        again.
+
         @see removeListener
     */
     void addListener (Listener* newListener);
@@ -289,8 +294,7 @@ private:
     friend class LegacyAudioParameter;
     AudioProcessor* processor = nullptr;
     int parameterIndex = -1;
-    CriticalSection listenerLock;
-    Array<Listener*> listeners;
+    RealtimeListenerList<Listener> listeners;
     mutable StringArray valueStrings;
 
    #if JUCE_DEBUG
@@ -82,10 +82,12 @@ private:
     using Listener = AudioProcessorValueTreeState::Listener;
 
 public:
-    explicit ParameterAdapter (RangedAudioParameter& parameterIn)
+    explicit ParameterAdapter (RangedAudioParameter& parameterIn,
+                               std::atomic<ParameterAdapter*>* changedAdapterListToUse = nullptr)
         : parameter (parameterIn),
           // For legacy reasons, the unnormalised value should *not* be snapped on construction
-          unnormalisedValue (getRange().convertFrom0to1 (parameter.getDefaultValue()))
+          unnormalisedValue (getRange().convertFrom0to1 (parameter.getDefaultValue())),
+          changedAdapterList (changedAdapterListToUse)
     {
         parameter.addListener (this);
 
@@ -149,11 +151,43 @@ public:
         return true;
     }
 
+    /** Takes all the adapters that have pushed themselves onto a changed-adapter list,
+        and calls the given function for each of them.
+    */
+    template <typename Callback>
+    static void takeChangedAdapters (std::atomic<ParameterAdapter*>& list, Callback&& callback)
+    {
+        auto* adapter = list.exchange (nullptr, std::memory_order_acquire);
+
+        while (adapter != nullptr)
+        {
+            // once the flag is cleared, the adapter may be pushed again and its link overwritten
+            auto* next = adapter->nextChangedAdapter;
+            adapter->isInChangedAdapterList = false;
+            callback (*adapter);
+            adapter = next;
+        }
+    }
+
     ValueTree tree;
 
 private:
     void parameterGestureChanged (int, bool) override {}
 
+    void addToChangedAdapterList() noexcept
+    {
+        if (changedAdapterList == nullptr || isInChangedAdapterList.exchange (true))
+            return;
+
+        auto* head = changedAdapterList->load (std::memory_order_relaxed);
+
+        do
+        {
+            nextChangedAdapter = head;
+        }
+        while (! changedAdapterList->compare_exchange_weak (head, this, std::memory_order_release, std::memory_order_relaxed));
+    }
+
     void parameterValueChanged (int, float) override
     {
         const auto newValue = denormalise (parameter.getValue());
@@ -165,6 +199,7 @@ private:
         listeners.call ([this] (Listener& l) { l.parameterChanged (parameter.paramID, unnormalisedValue); });
         listenersNeedCalling = false;
         needsUpdate = true;
+        addToChangedAdapterList();
     }
 
     float denormalise (float normalised) const
@@ -185,38 +220,15 @@ private:
         parameter.setValueNotifyingHost (value);
     }
 
-    class LockedListeners
-    {
-    public:
-        template <typename Fn>
-        void call (Fn&& fn)
-        {
-            const CriticalSection::ScopedLockType lock (mutex);
-            listeners.call (std::forward<Fn> (fn));
-        }
-
-        void add (Listener* l)
-        {
-            const CriticalSection::ScopedLockType lock (mutex);
-            listeners.add (l);
-        }
-
-        void remove (Listener* l)
-        {
-            const CriticalSection::ScopedLockType lock (mutex);
-            listeners.remove (l);
-        }
-
-    private:
-        CriticalSection mutex;
-        ListenerList<Listener> listeners;
-    };
-
     RangedAudioParameter& parameter;
-    LockedListeners listeners;
+    RealtimeListenerList<Listener> listeners;
     std::atomic<float> unnormalisedValue { 0.0f };
     std::atomic<bool> needsUpdate { true }, listenersNeedCalling { true };
     bool ignoreParameterChangedCallbacks { false };
+
+    std::atomic<ParameterAdapter*>* changedAdapterList;
+    ParameterAdapter* nextChangedAdapter = nullptr;
+    std::atomic<bool> isInChangedAdapterList { false };
 };
 
 //==============================================================================
@@ -338,7 +350,7 @@ RangedAudioParameter* AudioProcessorValueTreeState::createAndAddParameter (std::
 //==============================================================================
 void AudioProcessorValueTreeState::addParameterAdapter (RangedAudioParameter& param)
 {
-    adapterTable.emplace (param.paramID, std::make_unique<ParameterAdapter> (param));
+    adapterTable.emplace (param.paramID, std::make_unique<ParameterAdapter> (param, &changedAdapters));
 }
 
 AudioProcessorValueTreeState::ParameterAdapter* AudioProcessorValueTreeState::getParameterAdapter (StringRef paramID) const
@@ -475,9 +487,23 @@ bool AudioProcessorValueTreeState::flushParameterValuesToValueTree()
     return anyUpdated;
 }
 
+bool AudioProcessorValueTreeState::flushChangedParameterValuesToValueTree()
+{
+    ScopedLock lock (valueTreeChanging);
+
+    bool anyUpdated = false;
+
+    ParameterAdapter::takeChangedAdapters (changedAdapters, [&] (ParameterAdapter& adapter)
+    {
+        anyUpdated |= adapter.flushToTree (valuePropertyID, undoManager);
+    });
+
+    return anyUpdated;
+}
+
 void AudioProcessorValueTreeState::timerCallback()
 {
-    auto anythingUpdated = flushParameterValuesToValueTree();
+    auto anythingUpdated = flushChangedParameterValuesToValueTree();
 
     startTimer (anythingUpdated ? 1000 / 50
                                 : jlimit (50, 500, getTimerInterval() + 20));
@@ -951,6 +977,71 @@ public:
             expectEquals (listener.value, newValue);
             expectEquals (listener.id, String (key));
         }
+
+        beginTest ("Only the parameters that have changed are flushed to the tree");
+        {
+            TestAudioProcessor proc (createLayout (100));
+            auto& apvts = proc.state;
+
+            expect (apvts.changedAdapters.load() == nullptr);
+            expect (! apvts.flushChangedParameterValuesToValueTree());
+
+            apvts.getParameter ("p5")->setValueNotifyingHost (0.25f);
+            apvts.getParameter ("p7")->setValueNotifyingHost (0.75f);
+            apvts.getParameter ("p5")->setValueNotifyingHost (0.5f);
+
+            expect (apvts.changedAdapters.load() != nullptr);
+            expect (apvts.flushChangedParameterValuesToValueTree());
+            expect (apvts.changedAdapters.load() == nullptr);
+            expect (! apvts.flushChangedParameterValuesToValueTree());
+
+            auto getTreeValue = [&] (const String& id)
+            {
+                return (float) apvts.state.getChildWithProperty ("id", id).getProperty ("value");
+            };
+
+            expectEquals (getTreeValue ("p5"), 0.5f);
+            expectEquals (getTreeValue ("p7"), 0.75f);
+            expectEquals (getTreeValue ("p6"), 0.0f);
+        }
+
+        beginTest ("Changed parameters are flushed when there are many parameters");
+        {
+            const int numParameters = 3000, numChanged = 10;
+            TestAudioProcessor proc (createLayout (numParameters));
+            auto& apvts = proc.state;
+            auto r = getRandom();
+
+            for (int repeat = 0; repeat < 20; ++repeat)
+            {
+                std::map<String, float> changedValues;
+
+                for (int i = 0; i < numChanged; ++i)
+                {
+                    auto id = "p" + String (r.nextInt (numParameters));
+                    auto* param = apvts.getParameter (id);
+                    param->setValueNotifyingHost (r.nextFloat());
+                    changedValues[id] = param->convertFrom0to1 (param->getValue());
+                }
+
+                expect (apvts.flushChangedParameterValuesToValueTree());
+                expect (! apvts.flushChangedParameterValuesToValueTree());
+
+                for (auto& changed : changedValues)
+                    expectWithinAbsoluteError ((float) apvts.state.getChildWithProperty ("id", changed.first).getProperty ("value"),
+                                               changed.second, 1.0e-6f);
+            }
+        }
+    }
+
+    static ParameterLayout createLayout (int numParameters)
+    {
+        ParameterLayout layout;
+
+        for (int i = 0; i < numParameters; ++i)
+            layout.add (std::make_unique<AudioParameterFloat> ("p" + String (i), "Parameter " + String (i), 0.0f, 1.0f, 0.0f));
+
+        return layout;
     }
 };
 
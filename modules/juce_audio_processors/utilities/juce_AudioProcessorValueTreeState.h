@@ -303,7 +303,12 @@ public:
         virtual void parameterChanged (const String& parameterID, float newValue) = 0;
     };
 
-    /** Attaches a callback to one of the parameters, which will be called when the parameter changes. */
+    /** Attaches a callback to one of the parameters, which will be called when the parameter changes.
+
+        The callback is made synchronously on whichever thread changed the parameter, which may well
+        be the audio thread. Listeners are called without taking any locks, so it's safe to add and
+        remove them on other threads while that's happening.
+    */
     void addParameterListener (StringRef parameterID, Listener* listener);
 
     /** Removes a callback that was previously added with addParameterCallback(). */
@@ -527,12 +532,14 @@ private:
     //==============================================================================
    #if JUCE_UNIT_TESTS
     friend struct ParameterAdapterTests;
+    friend class AudioProcessorValueTreeStateTests;
    #endif
 
     void addParameterAdapter (RangedAudioParameter&);
     ParameterAdapter* getParameterAdapter (StringRef) const;
 
     bool flushParameterValuesToValueTree();
+    bool flushChangedParameterValuesToValueTree();
     void setNewState (ValueTree);
     void timerCallback() override;
 
@@ -550,6 +557,11 @@ private:
 
     std::map<StringRef, std::unique_ptr<ParameterAdapter>, StringRefLessThan> adapterTable;
 
+    // A lock-free stack of the adapters whose values have changed since they were last
+    // written to the tree. They push themselves onto it from whatever thread changes the
+    // parameter, and the timer takes the whole stack.
+    std::atomic<ParameterAdapter*> changedAdapters { nullptr };
+
     CriticalSection valueTreeChanging;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioProcessorValueTreeState)
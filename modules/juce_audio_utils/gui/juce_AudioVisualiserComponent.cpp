@@ -211,6 +211,23 @@ void AudioVisualiserComponent::getChannelAsPath (Path& path, const Range<float>*
 void AudioVisualiserComponent::paintChannel (Graphics& g, Rectangle<float> area,
                                              const Range<float>* levels, int numLevels, int nextSample)
 {
+    auto numColumns = area.getWidth() * g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    // With more levels than pixel columns, filling a column at a time is much quicker than
+    // filling the whole path. Otherwise the path is drawn, because it joins up the levels
+    // smoothly rather than drawing each one as a flat step.
+    if ((float) numLevels > numColumns)
+    {
+        // the levels are held in a circular buffer, so this puts them back into time order
+        HeapBlock<Range<float>> orderedLevels ((size_t) numLevels);
+
+        for (int i = 0; i < numLevels; ++i)
+            orderedLevels[i] = levels[(nextSample + i) % numLevels];
+
+        g.fillWaveformEnvelope (orderedLevels, numLevels, area, { -1.0f, 1.0f });
+        return;
+    }
+
     Path p;
     getChannelAsPath (p, levels, numLevels, nextSample);
 
@@ -102,8 +102,10 @@ public:
     void setRepaintRate (int frequencyInHz);
 
     /** Draws a channel of audio data in the given bounds.
-        The default implementation just calls getChannelAsPath() and fits this into the given
-        area. You may want to override this to draw things differently.
+        The default implementation fills the path from getChannelAsPath() into the given area,
+        or, when there are more levels than pixel columns, uses Graphics::fillWaveformEnvelope()
+        to fill each column between its lowest and highest levels. You may want to override
+        this to draw things differently.
     */
     virtual void paintChannel (Graphics&, Rectangle<float> bounds,
                                const Range<float>* levels, int numLevels, int nextSample);
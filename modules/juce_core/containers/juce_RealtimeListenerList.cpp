@@ -0,0 +1,363 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+RealtimeListenerListBase::RealtimeListenerListBase()
+{
+    readerCounts[0] = 0;
+    readerCounts[1] = 0;
+}
+
+RealtimeListenerListBase::~RealtimeListenerListBase()
+{
+    // You're deleting a list while another thread is still calling its listeners!
+    jassert (readerCounts[0] == 0 && readerCounts[1] == 0);
+
+    delete currentSnapshot.load();
+
+    for (auto& r : retiredSnapshots)
+        delete r.snapshot;
+}
+
+//==============================================================================
+RealtimeListenerListBase::ScopedReader::ScopedReader (const RealtimeListenerListBase& l) noexcept
+    : list (l),
+      readerCount (l.readerCounts[l.epoch.load() & 1]),
+      previousReader (getReadersOnThisThread())
+{
+    // The count must be incremented before the snapshot is loaded, so that a writer
+    // which has replaced the snapshot can tell whether anyone might still be using it
+    ++readerCount;
+    snapshot = list.currentSnapshot.load();
+    getReadersOnThisThread() = this;
+}
+
+RealtimeListenerListBase::ScopedReader::~ScopedReader() noexcept
+{
+    getReadersOnThisThread() = previousReader;
+    --readerCount;
+}
+
+bool RealtimeListenerListBase::ScopedReader::isStillInList (void* item) const noexcept
+{
+    // Any snapshot that's published while this reader is registered is also protected
+    // by it, so it's safe to look at the current one here
+    auto* current = list.currentSnapshot.load();
+    return current == snapshot || (current != nullptr && current->contains (item));
+}
+
+// The readers on each thread form a stack, so that a list can tell whether the
+// thread that's modifying it is inside one of its own callbacks
+const RealtimeListenerListBase::ScopedReader*& RealtimeListenerListBase::getReadersOnThisThread() noexcept
+{
+    static thread_local const ScopedReader* readers = nullptr;
+    return readers;
+}
+
+bool RealtimeListenerListBase::isBeingReadOnThisThread() const noexcept
+{
+    for (auto* r = getReadersOnThisThread(); r != nullptr; r = r->previousReader)
+        if (&r->list == this)
+            return true;
+
+    return false;
+}
+
+//==============================================================================
+int RealtimeListenerListBase::size() const noexcept
+{
+    const ScopedReader reader (*this);
+    return reader.snapshot != nullptr ? reader.snapshot->size() : 0;
+}
+
+bool RealtimeListenerListBase::containsItem (void* item) const noexcept
+{
+    const ScopedReader reader (*this);
+    return reader.snapshot != nullptr && reader.snapshot->contains (item);
+}
+
+bool RealtimeListenerListBase::addItem (void* item)
+{
+    return modify ([item] (Snapshot& s) { return s.addIfNotAlreadyThere (item); }, false);
+}
+
+bool RealtimeListenerListBase::removeItem (void* item)
+{
+    return modify ([item] (Snapshot& s) { return s.removeAllInstancesOf (item) > 0; }, true);
+}
+
+void RealtimeListenerListBase::clearItems()
+{
+    modify ([] (Snapshot& s) { auto wasEmpty = s.isEmpty(); s.clear(); return ! wasEmpty; }, true);
+}
+
+void RealtimeListenerListBase::collectGarbage()
+{
+    const ScopedLock sl (writerLock);
+    deleteUnreachableSnapshots();
+}
+
+//==============================================================================
+/*  Readers register themselves in one of two counters, chosen by the parity of the
+    epoch when they start. The epoch can only move on when the counter that it's about
+    to re-use has drained, so once it has advanced twice since a snapshot was replaced,
+    every reader that could have loaded that snapshot must have finished with it.
+*/
+template <typename ModifierFunction>
+bool RealtimeListenerListBase::modify (ModifierFunction&& modifier, bool waitForReaders)
+{
+    uint32 epochWhenRetired;
+
+    {
+        const ScopedLock sl (writerLock);
+
+        auto* oldSnapshot = currentSnapshot.load();
+        std::unique_ptr<Snapshot> newSnapshot (oldSnapshot != nullptr ? new Snapshot (*oldSnapshot)
+                                                                       : new Snapshot());
+
+        if (! modifier (*newSnapshot))
+            return false;
+
+        currentSnapshot = newSnapshot.release();
+        epochWhenRetired = epoch.load();
+
+        if (oldSnapshot != nullptr)
+            retiredSnapshots.add ({ oldSnapshot, epochWhenRetired });
+
+        if (! waitForReaders)
+        {
+            deleteUnreachableSnapshots();
+            return true;
+        }
+    }
+
+    // If this thread is inside a callback then waiting would deadlock, so the old
+    // snapshot will just be deleted later on instead
+    if (! isBeingReadOnThisThread())
+    {
+        for (;;)
+        {
+            {
+                const ScopedLock sl (writerLock);
+
+                if (epoch.load() - epochWhenRetired < 2)
+                    tryToAdvanceEpoch();
+
+                if (epoch.load() - epochWhenRetired >= 2)
+                    break;
+            }
+
+            Thread::yield();
+        }
+    }
+
+    const ScopedLock sl (writerLock);
+    deleteUnreachableSnapshots();
+    return true;
+}
+
+bool RealtimeListenerListBase::tryToAdvanceEpoch() noexcept
+{
+    auto currentEpoch = epoch.load();
+
+    if (readerCounts[(currentEpoch + 1) & 1].load() != 0)
+        return false;
+
+    epoch = currentEpoch + 1;
+    return true;
+}
+
+void RealtimeListenerListBase::deleteUnreachableSnapshots()
+{
+    for (int i = 0; i < 2 && ! retiredSnapshots.isEmpty(); ++i)
+        if (epoch.load() - retiredSnapshots.getReference (0).epochWhenRetired < 2)
+            tryToAdvanceEpoch();
+
+    auto currentEpoch = epoch.load();
+
+    while (! retiredSnapshots.isEmpty() && currentEpoch - retiredSnapshots.getReference (0).epochWhenRetired >= 2)
+        delete retiredSnapshots.removeAndReturn (0).snapshot;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class RealtimeListenerListTests  : public UnitTest
+{
+public:
+    RealtimeListenerListTests()
+        : UnitTest ("RealtimeListenerList", UnitTestCategories::containers)
+    {}
+
+    struct TestListener
+    {
+        void callback (int value)       { lastValue = value; ++numCalls; }
+
+        std::atomic<int> lastValue { 0 }, numCalls { 0 };
+    };
+
+    struct BackgroundThread  : public Thread
+    {
+        BackgroundThread (std::function<void (Thread&)> fn)  : Thread ("listener list test"), function (std::move (fn))
+        {
+            startThread();
+        }
+
+        ~BackgroundThread() override    { stopThread (10000); }
+
+        void run() override    { function (*this); }
+
+        std::function<void (Thread&)> function;
+    };
+
+    void runTest() override
+    {
+        beginTest ("Basics");
+        {
+            RealtimeListenerList<TestListener> list;
+            TestListener a, b, c;
+
+            expect (list.isEmpty());
+            list.add (&a);
+            list.add (&b);
+            list.add (&a);
+            expectEquals (list.size(), 2);
+            expect (list.contains (&a) && list.contains (&b) && ! list.contains (&c));
+
+            list.call ([] (TestListener& l) { l.callback (1); });
+            expect (a.lastValue == 1 && b.lastValue == 1 && c.numCalls == 0);
+
+            list.callExcluding (&a, [] (TestListener& l) { l.callback (2); });
+            expect (a.lastValue == 1 && b.lastValue == 2);
+
+            list.remove (&a);
+            list.remove (&c);
+            expectEquals (list.size(), 1);
+
+            list.call ([] (TestListener& l) { l.callback (3); });
+            expect (a.lastValue == 1 && b.lastValue == 3);
+
+            list.clear();
+            expect (list.isEmpty());
+        }
+
+        beginTest ("Modifying the list from a callback");
+        {
+            RealtimeListenerList<TestListener> list;
+            TestListener a, b, c;
+            list.add (&a);
+            list.add (&b);
+
+            list.call ([&] (TestListener& l)
+            {
+                l.callback (1);
+                list.remove (&a);
+                list.remove (&b);
+                list.add (&c);
+            });
+
+            // whichever listener is called first removes the other one, which mustn't
+            // be called after that, and listeners that are added during the call wait
+            // for the next one
+            expectEquals (a.numCalls + b.numCalls, 1);
+            expectEquals (c.numCalls.load(), 0);
+            expectEquals (list.size(), 1);
+            expect (list.contains (&c));
+
+            list.call ([] (TestListener& l) { l.callback (2); });
+            expect (c.numCalls == 1 && a.numCalls + b.numCalls == 1);
+
+            list.collectGarbage();
+        }
+
+        beginTest ("Adding and removing while other threads call the listeners");
+        {
+            RealtimeListenerList<TestListener> list, otherList;
+            std::atomic<int> numBadCalls { 0 };
+
+            // The listeners are re-used rather than deleted, so that a call to one which
+            // has been removed can be detected without touching freed memory
+            struct CheckedListener  : public TestListener
+            {
+                std::atomic<bool> isInList { false };
+            };
+
+            CheckedListener listeners[8];
+            std::vector<std::unique_ptr<BackgroundThread>> callers;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                callers.emplace_back (new BackgroundThread ([&] (Thread& t)
+                {
+                    while (! t.threadShouldExit())
+                        list.call ([&] (TestListener& l)
+                                   {
+                                       if (! static_cast<CheckedListener&> (l).isInList)
+                                           ++numBadCalls;
+
+                                       l.callback (1);
+                                   });
+                }));
+            }
+
+            TestListener outer;
+            otherList.add (&outer);
+            auto r = getRandom();
+
+            for (int i = 0; i < 2000; ++i)
+            {
+                auto& listener = listeners[i % numElementsInArray (listeners)];
+                listener.isInList = true;
+                list.add (&listener);
+
+                if (r.nextBool())
+                    Thread::yield();
+
+                auto removeListener = [&]
+                {
+                    list.remove (&listener);
+                    listener.isInList = false;
+                };
+
+                // being inside a call to a different list mustn't stop remove() from
+                // waiting for the threads that are calling this one
+                if (r.nextBool())
+                    otherList.call ([&] (TestListener&) { removeListener(); });
+                else
+                    removeListener();
+            }
+
+            callers.clear();
+            expectEquals (numBadCalls.load(), 0);
+            expect (list.isEmpty());
+        }
+    }
+};
+
+static RealtimeListenerListTests realtimeListenerListTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,229 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    The non-templated part of RealtimeListenerList, which handles the publishing and
+    reclamation of its snapshots.
+
+    You shouldn't need to use this class directly - see RealtimeListenerList instead.
+
+    @tags{Core}
+*/
+class JUCE_API  RealtimeListenerListBase
+{
+public:
+    //==============================================================================
+    /** Returns the number of listeners in the current snapshot. */
+    int size() const noexcept;
+
+    /** Returns true if there are no listeners in the current snapshot. */
+    bool isEmpty() const noexcept                   { return size() == 0; }
+
+    /** Deletes any old snapshots that no thread can still be reading.
+
+        This happens automatically whenever a listener is added or removed, so you only
+        need to call it if you want old snapshots freed sooner than that.
+    */
+    void collectGarbage();
+
+protected:
+    //==============================================================================
+    RealtimeListenerListBase();
+    ~RealtimeListenerListBase();
+
+    using Snapshot = Array<void*>;
+
+    bool addItem (void*);
+    bool removeItem (void*);
+    void clearItems();
+    bool containsItem (void*) const noexcept;
+
+    /** Holds a read-side reference to the current snapshot. */
+    struct ScopedReader
+    {
+        ScopedReader (const RealtimeListenerListBase&) noexcept;
+        ~ScopedReader() noexcept;
+
+        /** Returns true if an item from this reader's snapshot hasn't been removed
+            from the list since the snapshot was taken.
+        */
+        bool isStillInList (void* item) const noexcept;
+
+        const Snapshot* snapshot;
+
+    private:
+        const RealtimeListenerListBase& list;
+        std::atomic<int>& readerCount;
+        const ScopedReader* const previousReader;
+
+        friend class RealtimeListenerListBase;
+        JUCE_DECLARE_NON_COPYABLE (ScopedReader)
+    };
+
+private:
+    //==============================================================================
+    struct RetiredSnapshot
+    {
+        Snapshot* snapshot;
+        uint32 epochWhenRetired;
+    };
+
+    std::atomic<Snapshot*> currentSnapshot { nullptr };
+    std::atomic<uint32> epoch { 0 };
+    mutable std::atomic<int> readerCounts[2];
+    CriticalSection writerLock;
+    Array<RetiredSnapshot> retiredSnapshots;
+
+    template <typename ModifierFunction>
+    bool modify (ModifierFunction&&, bool waitForReaders);
+
+    bool tryToAdvanceEpoch() noexcept;
+    void deleteUnreachableSnapshots();
+    bool isBeingReadOnThisThread() const noexcept;
+
+    static const ScopedReader*& getReadersOnThisThread() noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (RealtimeListenerListBase)
+};
+
+//==============================================================================
+/**
+    A list of listeners that can be called from a real-time thread while other threads
+    add and remove listeners.
+
+    This works like a ListenerList, but the listeners are held in an immutable snapshot
+    which is replaced whenever a listener is added or removed. Calling the listeners
+    never locks, blocks or allocates: it just registers itself as a reader, iterates the
+    current snapshot and unregisters again, so it's safe to do from an audio callback.
+    The work of copying the list and deleting old snapshots is all done by the threads
+    that add and remove listeners.
+
+    Once remove() has returned, the listener that was removed won't be called again, so
+    it's safe to delete it. To make that guarantee, remove() waits for any calls that are
+    iterating an older snapshot on other threads to finish, and a call checks that each
+    listener is still in the list before calling it, so a listener that's removed by an
+    earlier callback is skipped. The exception is when remove() is called from inside one
+    of this list's callbacks, in which case it can't wait (as it'd be waiting for itself),
+    and other threads may still be partway through calling the removed listener when it
+    returns.
+
+    @code
+    RealtimeListenerList<MyListenerType> listeners;
+
+    // on the message thread..
+    listeners.add (someListener);
+
+    // on the audio thread..
+    listeners.call ([] (MyListenerType& l) { l.myCallbackMethod (1234, true); });
+    @endcode
+
+    @see ListenerList
+
+    @tags{Core}
+*/
+template <class ListenerClass>
+class RealtimeListenerList  : public RealtimeListenerListBase
+{
+public:
+    //==============================================================================
+    /** Creates an empty list. */
+    RealtimeListenerList() = default;
+
+    /** Destructor.
+        Make sure that no other thread is still calling the listeners when this is deleted.
+    */
+    ~RealtimeListenerList() = default;
+
+    //==============================================================================
+    /** Adds a listener to the list.
+        A listener can only be added once, so if the listener is already in the list,
+        this method has no effect. This may allocate, so don't call it on a real-time thread.
+    */
+    void add (ListenerClass* listenerToAdd)
+    {
+        if (listenerToAdd != nullptr)
+            addItem (listenerToAdd);
+        else
+            jassertfalse;  // Listeners can't be null pointers!
+    }
+
+    /** Removes a listener from the list.
+        If the listener wasn't in the list, this has no effect. This may allocate and wait
+        for other threads, so don't call it on a real-time thread.
+    */
+    void remove (ListenerClass* listenerToRemove)
+    {
+        jassert (listenerToRemove != nullptr); // Listeners can't be null pointers!
+        removeItem (listenerToRemove);
+    }
+
+    /** Removes all the listeners. */
+    void clear()                                            { clearItems(); }
+
+    /** Returns true if the specified listener has been added to the list. */
+    bool contains (ListenerClass* listener) const noexcept  { return containsItem (listener); }
+
+    //==============================================================================
+    /** Calls a function on each listener in the list.
+        This is wait-free and doesn't allocate, so it can be used on a real-time thread.
+    */
+    template <typename Callback>
+    void call (Callback&& callback) const
+    {
+        const ScopedReader reader (*this);
+
+        if (auto* snapshot = reader.snapshot)
+        {
+            for (int i = snapshot->size(); --i >= 0;)
+            {
+                auto* item = snapshot->getUnchecked (i);
+
+                // an earlier callback may have removed this listener
+                if (reader.isStillInList (item))
+                    callback (*static_cast<ListenerClass*> (item));
+            }
+        }
+    }
+
+    /** Calls a function on all but the specified listener in the list.
+        This can be useful if the caller is also a listener and needs to exclude itself.
+    */
+    template <typename Callback>
+    void callExcluding (ListenerClass* listenerToExclude, Callback&& callback) const
+    {
+        call ([&] (ListenerClass& l)
+              {
+                  if (&l != listenerToExclude)
+                      callback (l);
+              });
+    }
+
+private:
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE (RealtimeListenerList)
+};
+
+} // namespace juce
@@ -71,6 +71,7 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     }
 
     Time timeout;
+    uint32 timeOutCheckCount = 0;
 
     using Args = const var::NativeFunctionArgs&;
     using TokenType = const char*;
@@ -78,13 +79,21 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     void execute (const String& code)
     {
         ExpressionTreeBuilder tb (code);
-        std::unique_ptr<BlockStatement> (tb.parseStatementList())->perform (Scope ({}, *this, *this), nullptr);
+        CompiledCode compiled;
+        CodeGenerator::compileStatements (compiled, *std::unique_ptr<BlockStatement> (tb.parseStatementList()));
+
+        StackFrame frame (compiled);
+        compiled.run (Scope ({}, *this, *this), frame);
     }
 
     var evaluate (const String& code)
     {
         ExpressionTreeBuilder tb (code);
-        return ExpPtr (tb.parseExpression())->getResult (Scope ({}, *this, *this));
+        CompiledCode compiled;
+        CodeGenerator::compileExpression (compiled, *ExpPtr (tb.parseExpression()));
+
+        StackFrame frame (compiled);
+        return compiled.run (Scope ({}, *this, *this), frame);
     }
 
     //==============================================================================
@@ -102,10 +111,33 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     static Identifier getPrototypeIdentifier()                { static const Identifier i ("prototype"); return i; }
     static var* getPropertyPointer (DynamicObject& o, const Identifier& i) noexcept   { return o.getProperties().getVarPointer (i); }
 
+    // Each instruction that looks up a property by name has a cache holding the index at which
+    // it last found it. Objects and scopes that are used repeatedly (e.g. by a loop or a function
+    // that gets called many times) tend to have their properties in the same order, so this
+    // usually lets the lookup skip the linear search. The index is only ever used as a hint, so
+    // it doesn't matter if several threads running the same code overwrite each other's values.
+    static var* findProperty (DynamicObject& o, const Identifier& name, std::atomic<int>& cache) noexcept
+    {
+        auto& props = o.getProperties();
+        auto index = cache.load (std::memory_order_relaxed);
+
+        if (isPositiveAndBelow (index, props.size()) && props.begin()[index].name == name)
+            return props.getVarPointerAt (index);
+
+        index = props.indexOf (name);
+
+        if (index < 0)
+            return nullptr;
+
+        cache.store (index, std::memory_order_relaxed);
+        return props.getVarPointerAt (index);
+    }
+
     //==============================================================================
     struct CodeLocation
     {
         CodeLocation (const String& code) noexcept        : program (code), location (program.getCharPointer()) {}
+        CodeLocation (const String& code, String::CharPointerType l) noexcept  : program (code), location (l) {}
         CodeLocation (const CodeLocation& other) noexcept : program (other.program), location (other.location) {}
 
         void throwError (const String& message) const
@@ -126,21 +158,466 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     };
 
     //==============================================================================
-    struct Scope
+    struct Scope;
+    struct StackFrame;
+    struct CodeGenerator;
+
+    // Where a binary operator's operand comes from
+    enum class Operand  : uint8
     {
-        Scope (const Scope* p, ReferenceCountedObjectPtr<RootObject> rt, DynamicObject::Ptr scp) noexcept
-            : parent (p), root (std::move (rt)),
-              scope (std::move (scp)) {}
+        stack,
+        local,               // a local slot, falling back to a lookup by name if the local isn't in its slot
+        constant
+    };
 
-        const Scope* const parent;
-        ReferenceCountedObjectPtr<RootObject> root;
-        DynamicObject::Ptr scope;
+    enum class OpCode  : uint8
+    {
+        pushConstant,        // a = constant index
+        pushUndefined,
+        pop,
+        getLocal,            // a = local slot, b = cache index
+        setLocal,            // a = local slot, b = cache index
+        defineLocal,         // a = local slot
+        getName,             // a = name index, b = cache index
+        setName,             // a = name index, b = cache index
+        storeLocal,          // a = local slot, b = cache index
+        storeName,           // a = name index, b = cache index
+        defineName,          // a = name index
+        getProperty,         // a = name index, b = cache index
+        setProperty,         // a = name index
+        getElement,
+        setElement,
+        newObject,
+        defineProperty,      // a = name index
+        newArray,            // a = number of elements
+
+        // For these, a and b are the indexes of any operands that aren't on the stack
+        add, subtract, multiply, divide, modulo,
+        bitwiseOr, bitwiseAnd, bitwiseXor, leftShift, rightShift, rightShiftUnsigned,
+        equals, notEquals, lessThan, lessThanOrEqual, greaterThan, greaterThanOrEqual,
+        typeEquals, typeNotEquals,
+        toBool,
+        jump,                // a = target
+        jumpIfFalse,         // a = target
+        jumpIfTrue,          // a = target
+        logicalAnd,          // a = target, which is jumped to with false pushed if the value is false
+        logicalOr,           // a = target, which is jumped to with true pushed if the value is true
+        getMethod,           // a = name index, b = cache index
+        call,                // a = number of arguments
+        callMethod,          // a = number of arguments, b = name index
+        construct,           // a = number of arguments
+        checkTimeOut,
+        returnValue,
+        end,
+        throwError           // a = constant index of the message
+    };
+
+    static int getStackChange (OpCode op, int a) noexcept
+    {
+        switch (op)
+        {
+            case OpCode::pushConstant:
+            case OpCode::pushUndefined:
+            case OpCode::getLocal:
+            case OpCode::getName:
+            case OpCode::newObject:
+            case OpCode::getMethod:           return 1;
+
+            case OpCode::setLocal:
+            case OpCode::setName:
+            case OpCode::getProperty:
+            case OpCode::toBool:
+            case OpCode::jump:
+            case OpCode::checkTimeOut:
+            case OpCode::end:
+            case OpCode::throwError:          return 0;
+
+            case OpCode::setElement:          return -2;
+            case OpCode::newArray:            return 1 - a;
+            case OpCode::call:
+            case OpCode::construct:           return -a;
+            case OpCode::callMethod:          return -a - 1;
+
+            case OpCode::pop:
+            case OpCode::storeLocal:
+            case OpCode::storeName:
+            case OpCode::defineLocal:
+            case OpCode::defineName:
+            case OpCode::setProperty:
+            case OpCode::getElement:
+            case OpCode::defineProperty:
+            case OpCode::add:
+            case OpCode::subtract:
+            case OpCode::multiply:
+            case OpCode::divide:
+            case OpCode::modulo:
+            case OpCode::bitwiseOr:
+            case OpCode::bitwiseAnd:
+            case OpCode::bitwiseXor:
+            case OpCode::leftShift:
+            case OpCode::rightShift:
+            case OpCode::rightShiftUnsigned:
+            case OpCode::equals:
+            case OpCode::notEquals:
+            case OpCode::lessThan:
+            case OpCode::lessThanOrEqual:
+            case OpCode::greaterThan:
+            case OpCode::greaterThanOrEqual:
+            case OpCode::typeEquals:
+            case OpCode::typeNotEquals:
+            case OpCode::jumpIfFalse:
+            case OpCode::jumpIfTrue:
+            case OpCode::logicalAnd:
+            case OpCode::logicalOr:
+            case OpCode::returnValue:
+            default:                          return -1;
+        }
+    }
+
+    static TokenType getOperatorToken (OpCode op) noexcept
+    {
+        switch (op)
+        {
+            case OpCode::add:                 return TokenTypes::plus;
+            case OpCode::subtract:            return TokenTypes::minus;
+            case OpCode::multiply:            return TokenTypes::times;
+            case OpCode::divide:              return TokenTypes::divide;
+            case OpCode::modulo:              return TokenTypes::modulo;
+            case OpCode::bitwiseOr:           return TokenTypes::bitwiseOr;
+            case OpCode::bitwiseAnd:          return TokenTypes::bitwiseAnd;
+            case OpCode::bitwiseXor:          return TokenTypes::bitwiseXor;
+            case OpCode::leftShift:           return TokenTypes::leftShift;
+            case OpCode::rightShift:          return TokenTypes::rightShift;
+            case OpCode::rightShiftUnsigned:  return TokenTypes::rightShiftUnsigned;
+            case OpCode::equals:              return TokenTypes::equals;
+            case OpCode::notEquals:           return TokenTypes::notEquals;
+            case OpCode::lessThan:            return TokenTypes::lessThan;
+            case OpCode::lessThanOrEqual:     return TokenTypes::lessThanOrEqual;
+            case OpCode::greaterThan:         return TokenTypes::greaterThan;
+            case OpCode::greaterThanOrEqual:  return TokenTypes::greaterThanOrEqual;
+            default:                          jassertfalse; return TokenTypes::eof;
+        }
+    }
+
+    //==============================================================================
+    // The bytecode for a function body, or for a script or expression passed to the engine.
+    // Once compiled it's never modified (apart from the lookup caches), so a function can be
+    // run by several threads at once.
+    struct CompiledCode
+    {
+        struct Instruction
+        {
+            OpCode op;
+            Operand lhs, rhs;
+            int a, b;
+            String::CharPointerType::CharType* position;
+        };
+
+        String program;
+        Array<Instruction> instructions;
+        Array<var> constants;
+        Array<Identifier> names, localNames;
+        int numCaches = 0, maxStackDepth = 0;
+        bool usesThis = false;
+        std::unique_ptr<std::atomic<int>[]> caches;
+
+        std::atomic<int>& getCache (int index) const noexcept   { return caches[(size_t) index]; }
+
+        void throwError (const Instruction& i, const String& message) const
+        {
+            CodeLocation (program, String::CharPointerType (i.position)).throwError (message);
+        }
+
+        void checkTimeOut (const Scope& s, const Instruction& i) const
+        {
+            // Reading the clock costs more than running a typical loop body, so it's only done every so often
+            if ((s.root->timeOutCheckCount++ & 63) == 0 && Time::getCurrentTime() > s.root->timeout)
+                throwError (i, s.root->timeout == Time() ? "Interrupted" : "Execution timed-out");
+        }
+
+        var run (const Scope& s, StackFrame& frame) const
+        {
+            auto* locals = frame.values.data();
+            auto* sp = locals + localNames.size();
+            auto* code = instructions.begin();
+            auto* ip = code;
+
+            // The slots above the stack pointer are always left holding void values, so a value can be
+            // pushed by constructing it in place, without having to release the previous one.
+            auto pop  = [&sp]() -> var  { return std::move (*--sp); };
+            auto drop = [&sp]           { *--sp = var(); };
+
+            for (;;)
+            {
+                auto& i = *ip++;
+
+                switch (i.op)
+                {
+                    case OpCode::pushConstant:   new (sp++) var (constants.getReference (i.a)); break;
+                    case OpCode::pushUndefined:  new (sp++) var (var::undefined()); break;
+                    case OpCode::pop:            drop(); break;
+
+                    case OpCode::getLocal:
+                        if (s.scope == nullptr && frame.isDefined[i.a])
+                            new (sp++) var (locals[i.a]);
+                        else
+                            new (sp++) var (s.findSymbolInParentScopes (localNames.getReference (i.a), getCache (i.b)));
+                        break;
+
+                    case OpCode::setLocal:
+                        if (s.scope == nullptr && frame.isDefined[i.a])
+                            locals[i.a] = sp[-1];
+                        else
+                            s.assign (localNames.getReference (i.a), sp[-1], getCache (i.b));
+                        break;
+
+                    case OpCode::storeLocal:
+                        if (s.scope == nullptr && frame.isDefined[i.a])
+                            locals[i.a] = pop();
+                        else
+                            s.assign (localNames.getReference (i.a), pop(), getCache (i.b));
+                        break;
+
+                    case OpCode::defineLocal:
+                        if (s.scope == nullptr)
+                            frame.define (i.a, pop());
+                        else
+                            s.scope->setProperty (localNames.getReference (i.a), pop());
+                        break;
+
+                    case OpCode::getName:        new (sp++) var (s.findSymbolInParentScopes (names.getReference (i.a), getCache (i.b))); break;
+                    case OpCode::setName:        s.assign (names.getReference (i.a), sp[-1], getCache (i.b)); break;
+                    case OpCode::storeName:      s.assign (names.getReference (i.a), pop(), getCache (i.b)); break;
+                    case OpCode::defineName:     s.getScopeObject().setProperty (names.getReference (i.a), pop()); break;
+
+                    case OpCode::getProperty:
+                    {
+                        auto& target = sp[-1];
+                        const auto& name = names.getReference (i.a);
+                        static const Identifier lengthID ("length");
+
+                        if (name == lengthID)
+                        {
+                            if (auto* array = target.getArray())   { target = array->size(); break; }
+                            if (target.isString())                 { target = target.toString().length(); break; }
+                        }
+
+                        var result (var::undefined());
+
+                        if (auto* o = target.getDynamicObject())
+                            if (auto* v = findProperty (*o, name, getCache (i.b)))
+                                result = *v;
+
+                        target = std::move (result);
+                        break;
+                    }
+
+                    case OpCode::setProperty:
+                    {
+                        auto target = pop();
+
+                        if (auto* o = target.getDynamicObject())
+                            o->setProperty (names.getReference (i.a), sp[-1]);
+                        else
+                            throwError (i, "Cannot assign to this expression!");
+
+                        break;
+                    }
+
+                    case OpCode::getElement:
+                        sp[-2] = getElement (sp[-2], sp[-1]);
+                        drop();
+                        break;
+
+                    case OpCode::setElement:
+                    {
+                        auto key = pop();
+                        auto target = pop();
+                        setElement (i, target, key, sp[-1]);
+                        break;
+                    }
+
+                    case OpCode::newObject:      new (sp++) var (new DynamicObject()); break;
+
+                    case OpCode::defineProperty:
+                    {
+                        auto value = pop();
+                        sp[-1].getDynamicObject()->setProperty (names.getReference (i.a), value);
+                        break;
+                    }
+
+                    case OpCode::newArray:
+                    {
+                        Array<var> a (sp - i.a, i.a);
+                        sp = popArguments (sp, i.a);
+                        new (sp++) var (std::move (a));
+                        break;
+                    }
+
+                    case OpCode::add:
+                    case OpCode::subtract:
+                    case OpCode::multiply:
+                    case OpCode::divide:
+                    case OpCode::modulo:
+                    case OpCode::bitwiseOr:
+                    case OpCode::bitwiseAnd:
+                    case OpCode::bitwiseXor:
+                    case OpCode::leftShift:
+                    case OpCode::rightShift:
+                    case OpCode::rightShiftUnsigned:
+                    case OpCode::equals:
+                    case OpCode::notEquals:
+                    case OpCode::lessThan:
+                    case OpCode::lessThanOrEqual:
+                    case OpCode::greaterThan:
+                    case OpCode::greaterThanOrEqual:
+                    {
+                        auto* base = sp - ((i.lhs == Operand::stack ? 1 : 0) + (i.rhs == Operand::stack ? 1 : 0));
+                        auto& lhs = i.lhs == Operand::stack ? base[0] : readOperand (i.lhs, i.a, s, frame, sp);
+                        auto& rhs = i.rhs == Operand::stack ? sp[-1]  : readOperand (i.rhs, i.b, s, frame, sp);
+
+                        auto result = applyBinaryOperator (i, lhs, rhs);
+
+                        while (sp != base)
+                            drop();
+
+                        new (sp++) var (std::move (result));
+                        break;
+                    }
+
+                    case OpCode::typeEquals:     sp[-2] = areTypeEqual (sp[-2], sp[-1]);   drop(); break;
+                    case OpCode::typeNotEquals:  sp[-2] = ! areTypeEqual (sp[-2], sp[-1]); drop(); break;
+                    case OpCode::toBool:         sp[-1] = (bool) sp[-1]; break;
+
+                    case OpCode::jump:           ip = code + i.a; break;
+                    case OpCode::jumpIfFalse:    if (! pop()) ip = code + i.a; break;
+                    case OpCode::jumpIfTrue:     if (pop()) ip = code + i.a; break;
+                    case OpCode::logicalAnd:     if (! pop()) { new (sp++) var (false); ip = code + i.a; } break;
+                    case OpCode::logicalOr:      if (pop())   { new (sp++) var (true);  ip = code + i.a; } break;
+
+                    case OpCode::getMethod:
+                    {
+                        auto method = findMethod (s, i, sp[-1]);
+                        new (sp++) var (std::move (method));
+                        break;
+                    }
+
+                    case OpCode::call:
+                    {
+                        auto* args = sp - i.a;
+                        auto& function = args[-1];
+                        var thisObject;
+
+                        // A function that's called without an object gets the caller's scope as 'this'. Only
+                        // create that if it can be used, because it moves the caller's locals out of the frame.
+                        auto* fo = dynamic_cast<FunctionObject*> (function.getObject());
+
+                        if (fo == nullptr || fo->code->usesThis)
+                            thisObject = &s.getScopeObject();
+
+                        checkTimeOut (s, i);
+                        auto result = invokeFunction (s, i, function, thisObject, args, nullptr);
+                        sp = popArguments (sp, i.a + 1);
+                        new (sp++) var (std::move (result));
+                        break;
+                    }
+
+                    case OpCode::callMethod:
+                    {
+                        auto* args = sp - i.a;
+                        checkTimeOut (s, i);
+                        auto result = invokeFunction (s, i, args[-1], args[-2], args, &names.getReference (i.b));
+                        sp = popArguments (sp, i.a + 2);
+                        new (sp++) var (std::move (result));
+                        break;
+                    }
+
+                    case OpCode::construct:
+                    {
+                        auto* args = sp - i.a;
+                        auto& classOrFunc = args[-1];
+                        const bool isFunc = isFunction (classOrFunc);
+                        var result (var::undefined());
+
+                        if (isFunc || classOrFunc.getDynamicObject() != nullptr)
+                        {
+                            DynamicObject::Ptr newObject (new DynamicObject());
+
+                            if (isFunc)
+                            {
+                                checkTimeOut (s, i);
+                                invokeFunction (s, i, classOrFunc, newObject.get(), args, nullptr);
+                            }
+                            else
+                            {
+                                newObject->setProperty (getPrototypeIdentifier(), classOrFunc);
+                            }
+
+                            result = newObject.get();
+                        }
+
+                        sp = popArguments (sp, i.a + 1);
+                        new (sp++) var (std::move (result));
+                        break;
+                    }
+
+                    case OpCode::checkTimeOut:   checkTimeOut (s, i); break;
+                    case OpCode::returnValue:    return pop();
+                    case OpCode::end:            return {};
+                    case OpCode::throwError:     throwError (i, constants.getReference (i.a).toString()); break;
+                    default:                     jassertfalse; return {};
+                }
+            }
+        }
+
+        // If a local isn't in its slot, its value gets looked up and pushed onto the stack instead.
+        const var& readOperand (Operand kind, int index, const Scope& s, StackFrame& frame, var*& sp) const
+        {
+            if (kind == Operand::constant)
+                return constants.getReference (index);
+
+            if (s.scope == nullptr && frame.isDefined[index])
+                return frame.values[(size_t) index];
+
+            new (sp++) var (s.findSymbolInParentScopes (localNames.getReference (index), getCache (index)));
+            return sp[-1];
+        }
+
+        static var* popArguments (var* sp, int num) noexcept
+        {
+            for (int i = 0; i < num; ++i)
+                *--sp = var();
+
+            return sp;
+        }
+
+        var invokeFunction (const Scope& s, const Instruction& i, const var& function, const var& thisObject,
+                            const var* args, const Identifier* methodName) const
+        {
+            const var::NativeFunctionArgs nativeArgs (thisObject, args, i.a);
+
+            if (var::NativeFunction nativeFunction = function.getNativeFunction())
+                return nativeFunction (nativeArgs);
 
-        var findFunctionCall (const CodeLocation& location, const var& targetObject, const Identifier& functionName) const
+            if (auto* fo = dynamic_cast<FunctionObject*> (function.getObject()))
+                return fo->invoke (s, nativeArgs);
+
+            if (methodName != nullptr)
+                if (auto* o = thisObject.getDynamicObject())
+                    if (o->hasMethod (*methodName)) // allow an overridden DynamicObject::invokeMethod to accept a method call.
+                        return o->invokeMethod (*methodName, nativeArgs);
+
+            throwError (i, "This expression is not a function!");
+            return {};
+        }
+
+        var findMethod (const Scope& s, const Instruction& i, const var& targetObject) const
         {
+            const auto& functionName = names.getReference (i.a);
+
             if (auto* o = targetObject.getDynamicObject())
             {
-                if (auto* prop = getPropertyPointer (*o, functionName))
+                if (auto* prop = findProperty (*o, functionName, getCache (i.b)))
                     return *prop;
 
                 for (auto* p = o->getProperty (getPrototypeIdentifier()).getDynamicObject(); p != nullptr;
@@ -156,20 +633,222 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             }
 
             if (targetObject.isString())
-                if (auto* m = findRootClassProperty (StringClass::getClassName(), functionName))
+                if (auto* m = s.findRootClassProperty (StringClass::getClassName(), functionName))
                     return *m;
 
             if (targetObject.isArray())
-                if (auto* m = findRootClassProperty (ArrayClass::getClassName(), functionName))
+                if (auto* m = s.findRootClassProperty (ArrayClass::getClassName(), functionName))
                     return *m;
 
-            if (auto* m = findRootClassProperty (ObjectClass::getClassName(), functionName))
+            if (auto* m = s.findRootClassProperty (ObjectClass::getClassName(), functionName))
                 return *m;
 
-            location.throwError ("Unknown function '" + functionName.toString() + "'");
+            throwError (i, "Unknown function '" + functionName.toString() + "'");
             return {};
         }
 
+        static var getElement (const var& arrayVar, const var& key)
+        {
+            if (const auto* array = arrayVar.getArray())
+                if (key.isInt() || key.isInt64() || key.isDouble())
+                    return (*array) [static_cast<int> (key)];
+
+            if (auto* o = arrayVar.getDynamicObject())
+                if (key.isString())
+                    if (auto* v = getPropertyPointer (*o, Identifier (key)))
+                        return *v;
+
+            return var::undefined();
+        }
+
+        void setElement (const Instruction& i, const var& arrayVar, const var& key, const var& newValue) const
+        {
+            if (auto* array = arrayVar.getArray())
+            {
+                if (key.isInt() || key.isInt64() || key.isDouble())
+                {
+                    const int index = key;
+                    while (array->size() < index)
+                        array->add (var::undefined());
+
+                    array->set (index, newValue);
+                    return;
+                }
+            }
+
+            if (auto* o = arrayVar.getDynamicObject())
+            {
+                if (key.isString())
+                {
+                    o->setProperty (Identifier (key), newValue);
+                    return;
+                }
+            }
+
+            throwError (i, "Cannot assign to this expression!");
+        }
+
+        var applyBinaryOperator (const Instruction& i, const var& a, const var& b) const
+        {
+            // the most common cases are checked first
+            if (a.isInt64() && b.isInt64())     return applyToInts (i, a, b);
+            if (a.isDouble() && b.isDouble())   return applyToDoubles (i, a, b);
+
+            if ((a.isUndefined() || a.isVoid()) && (b.isUndefined() || b.isVoid()))
+            {
+                if (i.op == OpCode::equals)     return true;
+                if (i.op == OpCode::notEquals)  return false;
+
+                return var::undefined();
+            }
+
+            if (isNumericOrUndefined (a) && isNumericOrUndefined (b))
+                return (a.isDouble() || b.isDouble()) ? applyToDoubles (i, a, b) : applyToInts (i, a, b);
+
+            if (a.isArray() || a.isObject())
+            {
+                if (i.op == OpCode::equals)     return a == b;
+                if (i.op == OpCode::notEquals)  return a != b;
+
+                return throwTypeError (i, a.isArray() ? "Array" : "Object");
+            }
+
+            return applyToStrings (i, a.toString(), b.toString());
+        }
+
+        var applyToDoubles (const Instruction& i, double a, double b) const
+        {
+            switch (i.op)
+            {
+                case OpCode::add:                 return a + b;
+                case OpCode::subtract:            return a - b;
+                case OpCode::multiply:            return a * b;
+                case OpCode::divide:              return b != 0 ? a / b : std::numeric_limits<double>::infinity();
+                case OpCode::modulo:              return b != 0 ? fmod (a, b) : std::numeric_limits<double>::infinity();
+                case OpCode::equals:              return a == b;
+                case OpCode::notEquals:           return a != b;
+                case OpCode::lessThan:            return a < b;
+                case OpCode::lessThanOrEqual:     return a <= b;
+                case OpCode::greaterThan:         return a > b;
+                case OpCode::greaterThanOrEqual:  return a >= b;
+                default:                          return throwTypeError (i, "Double");
+            }
+        }
+
+        var applyToInts (const Instruction& i, int64 a, int64 b) const
+        {
+            switch (i.op)
+            {
+                case OpCode::add:                 return a + b;
+                case OpCode::subtract:            return a - b;
+                case OpCode::multiply:            return a * b;
+                case OpCode::divide:              return b != 0 ? var ((double) a / (double) b) : var (std::numeric_limits<double>::infinity());
+                case OpCode::modulo:              return b != 0 ? var (a % b) : var (std::numeric_limits<double>::infinity());
+                case OpCode::bitwiseOr:           return a | b;
+                case OpCode::bitwiseAnd:          return a & b;
+                case OpCode::bitwiseXor:          return a ^ b;
+                case OpCode::leftShift:           return ((int) a) << (int) b;
+                case OpCode::rightShift:          return ((int) a) >> (int) b;
+                case OpCode::rightShiftUnsigned:  return (int) (((uint32) a) >> (int) b);
+                case OpCode::equals:              return a == b;
+                case OpCode::notEquals:           return a != b;
+                case OpCode::lessThan:            return a < b;
+                case OpCode::lessThanOrEqual:     return a <= b;
+                case OpCode::greaterThan:         return a > b;
+                case OpCode::greaterThanOrEqual:  return a >= b;
+                default:                          return throwTypeError (i, "Integer");
+            }
+        }
+
+        var applyToStrings (const Instruction& i, const String& a, const String& b) const
+        {
+            switch (i.op)
+            {
+                case OpCode::add:                 return a + b;
+                case OpCode::equals:              return a == b;
+                case OpCode::notEquals:           return a != b;
+                case OpCode::lessThan:            return a < b;
+                case OpCode::lessThanOrEqual:     return a <= b;
+                case OpCode::greaterThan:         return a > b;
+                case OpCode::greaterThanOrEqual:  return a >= b;
+                default:                          return throwTypeError (i, "String");
+            }
+        }
+
+        var throwTypeError (const Instruction& i, const char* typeName) const
+        {
+            throwError (i, getTokenName (getOperatorToken (i.op)) + " is not allowed on the " + typeName + " type");
+            return {};
+        }
+    };
+
+    //==============================================================================
+    // Holds a function's local variables (in the slots that the compiler gave them), followed by
+    // the stack that its code uses for evaluating expressions.
+    struct StackFrame
+    {
+        explicit StackFrame (const CompiledCode& c)
+            : code (c),
+              values ((size_t) (c.localNames.size() + c.maxStackDepth)),
+              isDefined (c.localNames.size(), true)
+        {}
+
+        void define (int slot, var value)
+        {
+            values[(size_t) slot] = std::move (value);
+            isDefined[slot] = true;
+        }
+
+        var* findLocal (const Identifier& name) noexcept
+        {
+            for (int i = 0; i < code.localNames.size(); ++i)
+                if (isDefined[i] && code.localNames.getReference (i) == name)
+                    return &values[(size_t) i];
+
+            return nullptr;
+        }
+
+        const CompiledCode& code;
+        std::vector<var> values;
+        HeapBlock<bool> isDefined;
+
+        JUCE_DECLARE_NON_COPYABLE (StackFrame)
+    };
+
+    //==============================================================================
+    struct Scope
+    {
+        Scope (const Scope* p, ReferenceCountedObjectPtr<RootObject> rt, DynamicObject::Ptr scp) noexcept
+            : parent (p), root (std::move (rt)),
+              scope (std::move (scp)) {}
+
+        Scope (const Scope* p, ReferenceCountedObjectPtr<RootObject> rt, StackFrame& f) noexcept
+            : parent (p), root (std::move (rt)),
+              frame (&f) {}
+
+        const Scope* const parent;
+        ReferenceCountedObjectPtr<RootObject> root;
+
+        // For a function call, this stays null while the function's locals are held in its
+        // stack frame, and is only created if something needs the scope as an object.
+        mutable DynamicObject::Ptr scope;
+        StackFrame* const frame = nullptr;
+
+        DynamicObject& getScopeObject() const
+        {
+            if (scope == nullptr)
+            {
+                // From now on, this call's locals are kept as properties of the scope object.
+                scope = new DynamicObject();
+
+                for (int i = 0; i < frame->code.localNames.size(); ++i)
+                    if (frame->isDefined[i])
+                        scope->setProperty (frame->code.localNames.getReference (i), frame->values[(size_t) i]);
+            }
+
+            return *scope;
+        }
+
         var* findRootClassProperty (const Identifier& className, const Identifier& propName) const
         {
             if (auto* cls = root->getProperty (className).getDynamicObject())
@@ -178,13 +857,33 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             return nullptr;
         }
 
-        var findSymbolInParentScopes (const Identifier& name) const
+        var findSymbolInParentScopes (const Identifier& name, std::atomic<int>& cache) const
         {
-            if (auto v = getPropertyPointer (*scope, name))
-                return *v;
+            for (auto* s = this; s != nullptr; s = s->parent)
+            {
+                if (s->scope != nullptr)
+                {
+                    if (auto* v = findProperty (*s->scope, name, cache))
+                        return *v;
+                }
+                else if (auto* v = s->frame->findLocal (name))
+                {
+                    return *v;
+                }
+            }
+
+            return var::undefined();
+        }
+
+        void assign (const Identifier& name, var newValue, std::atomic<int>& cache) const
+        {
+            auto* v = scope != nullptr ? findProperty (*scope, name, cache)
+                                       : frame->findLocal (name);
 
-            return parent != nullptr ? parent->findSymbolInParentScopes (name)
-                                     : var::undefined();
+            if (v != nullptr)
+                *v = std::move (newValue);
+            else
+                root->setProperty (name, newValue);
         }
 
         bool findAndInvokeMethod (const Identifier& function, const var::NativeFunctionArgs& args, var& result) const
@@ -232,12 +931,6 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             return false;
         }
 
-        void checkTimeOut (const CodeLocation& location) const
-        {
-            if (Time::getCurrentTime() > root->timeout)
-                location.throwError (root->timeout == Time() ? "Interrupted" : "Execution timed-out");
-        }
-
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Scope)
     };
 
@@ -247,8 +940,8 @@ struct JavascriptEngine::RootObject   : public DynamicObject
         Statement (const CodeLocation& l) noexcept : location (l) {}
         virtual ~Statement() {}
 
-        enum ResultCode  { ok = 0, returnWasHit, breakWasHit, continueWasHit };
-        virtual ResultCode perform (const Scope&, var*) const  { return ok; }
+        virtual void compile (CodeGenerator&) const {}
+        virtual void declareLocals (CodeGenerator&) const {}
 
         CodeLocation location;
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Statement)
@@ -258,10 +951,23 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         Expression (const CodeLocation& l) noexcept : Statement (l) {}
 
-        virtual var getResult (const Scope&) const            { return var::undefined(); }
-        virtual void assign (const Scope&, const var&) const  { location.throwError ("Cannot assign to this expression!"); }
+        virtual void compileResult (CodeGenerator& g) const      { g.emit (OpCode::pushUndefined, location); }
+        virtual void compileAssignment (CodeGenerator& g) const  { g.emitError ("Cannot assign to this expression!", location); }
+
+        // Like compileAssignment(), but for when the assigned value isn't needed afterwards.
+        virtual void compileStore (CodeGenerator& g) const       { compileAssignment (g); g.emit (OpCode::pop, location); }
+
+        // Lets an instruction read the value from wherever it already lives, rather than from a copy
+        // pushed onto the stack. A local can only be read in place if nothing could change it first.
+        virtual Operand compileOperand (CodeGenerator& g, int& /*index*/, bool /*canReadLocal*/) const
+        {
+            compileResult (g);
+            return Operand::stack;
+        }
+
+        virtual bool canChangeLocals() const                      { return true; }
 
-        ResultCode perform (const Scope& s, var*) const override  { getResult (s); return ok; }
+        void compile (CodeGenerator& g) const override           { compileResult (g); g.emit (OpCode::pop, location); }
     };
 
     using ExpPtr = std::unique_ptr<Expression>;
@@ -270,13 +976,16 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         BlockStatement (const CodeLocation& l) noexcept : Statement (l) {}
 
-        ResultCode perform (const Scope& s, var* returnedValue) const override
+        void compile (CodeGenerator& g) const override
         {
             for (auto* statement : statements)
-                if (auto r = statement->perform (s, returnedValue))
-                    return r;
+                statement->compile (g);
+        }
 
-            return ok;
+        void declareLocals (CodeGenerator& g) const override
+        {
+            for (auto* statement : statements)
+                statement->declareLocals (g);
         }
 
         OwnedArray<Statement> statements;
@@ -286,9 +995,21 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         IfStatement (const CodeLocation& l) noexcept : Statement (l) {}
 
-        ResultCode perform (const Scope& s, var* returnedValue) const override
+        void compile (CodeGenerator& g) const override
+        {
+            condition->compileResult (g);
+            auto jumpToFalseBranch = g.emitJump (OpCode::jumpIfFalse, location);
+            trueBranch->compile (g);
+            auto jumpToEnd = g.emitJump (OpCode::jump, location);
+            g.setJumpTarget (jumpToFalseBranch);
+            falseBranch->compile (g);
+            g.setJumpTarget (jumpToEnd);
+        }
+
+        void declareLocals (CodeGenerator& g) const override
         {
-            return (condition->getResult(s) ? trueBranch : falseBranch)->perform (s, returnedValue);
+            trueBranch->declareLocals (g);
+            falseBranch->declareLocals (g);
         }
 
         ExpPtr condition;
@@ -299,12 +1020,14 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         VarStatement (const CodeLocation& l) noexcept : Statement (l) {}
 
-        ResultCode perform (const Scope& s, var*) const override
+        void compile (CodeGenerator& g) const override
         {
-            s.scope->setProperty (name, initialiser->getResult (s));
-            return ok;
+            initialiser->compileResult (g);
+            g.emitVariableDefinition (name, location);
         }
 
+        void declareLocals (CodeGenerator& g) const override  { g.addLocal (name); }
+
         Identifier name;
         ExpPtr initialiser;
     };
@@ -313,25 +1036,41 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         LoopStatement (const CodeLocation& l, bool isDo) noexcept : Statement (l), isDoLoop (isDo) {}
 
-        ResultCode perform (const Scope& s, var* returnedValue) const override
+        void compile (CodeGenerator& g) const override
         {
-            initialiser->perform (s, nullptr);
+            initialiser->compile (g);
+            auto start = g.getNextAddress();
+            g.beginLoop();
 
-            while (isDoLoop || condition->getResult (s))
+            if (isDoLoop)
             {
-                s.checkTimeOut (location);
-                auto r = body->perform (s, returnedValue);
-
-                if (r == returnWasHit)   return r;
-                if (r == breakWasHit)    break;
-
-                iterator->perform (s, nullptr);
-
-                if (isDoLoop && r != continueWasHit && ! condition->getResult (s))
-                    break;
+                g.emit (OpCode::checkTimeOut, location);
+                body->compile (g);
+                iterator->compile (g);
+                condition->compileResult (g);
+                g.setJumpTarget (g.emitJump (OpCode::jumpIfTrue, location), start);
+
+                // as a do-loop has no iterator, a 'continue' goes straight back to the body without testing the condition
+                g.endLoop (start);
+            }
+            else
+            {
+                condition->compileResult (g);
+                auto jumpToEnd = g.emitJump (OpCode::jumpIfFalse, location);
+                g.emit (OpCode::checkTimeOut, location);
+                body->compile (g);
+                auto continueTarget = g.getNextAddress();
+                iterator->compile (g);
+                g.setJumpTarget (g.emitJump (OpCode::jump, location), start);
+                g.setJumpTarget (jumpToEnd);
+                g.endLoop (continueTarget);
             }
+        }
 
-            return ok;
+        void declareLocals (CodeGenerator& g) const override
+        {
+            initialiser->declareLocals (g);
+            body->declareLocals (g);
         }
 
         std::unique_ptr<Statement> initialiser, iterator, body;
@@ -343,10 +1082,10 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         ReturnStatement (const CodeLocation& l, Expression* v) noexcept : Statement (l), returnValue (v) {}
 
-        ResultCode perform (const Scope& s, var* ret) const override
+        void compile (CodeGenerator& g) const override
         {
-            if (ret != nullptr)  *ret = returnValue->getResult (s);
-            return returnWasHit;
+            returnValue->compileResult (g);
+            g.emit (OpCode::returnValue, location);
         }
 
         ExpPtr returnValue;
@@ -355,19 +1094,27 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     struct BreakStatement  : public Statement
     {
         BreakStatement (const CodeLocation& l) noexcept : Statement (l) {}
-        ResultCode perform (const Scope&, var*) const override  { return breakWasHit; }
+        void compile (CodeGenerator& g) const override  { g.emitBreak (location); }
     };
 
     struct ContinueStatement  : public Statement
     {
         ContinueStatement (const CodeLocation& l) noexcept : Statement (l) {}
-        ResultCode perform (const Scope&, var*) const override  { return continueWasHit; }
+        void compile (CodeGenerator& g) const override  { g.emitContinue (location); }
     };
 
     struct LiteralValue  : public Expression
     {
         LiteralValue (const CodeLocation& l, const var& v) noexcept : Expression (l), value (v) {}
-        var getResult (const Scope&) const override   { return value; }
+        void compileResult (CodeGenerator& g) const override   { g.emit (OpCode::pushConstant, location, g.addConstant (value)); }
+        bool canChangeLocals() const override                  { return false; }
+
+        Operand compileOperand (CodeGenerator& g, int& index, bool) const override
+        {
+            index = g.addConstant (value);
+            return Operand::constant;
+        }
+
         var value;
     };
 
@@ -375,14 +1122,21 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         UnqualifiedName (const CodeLocation& l, const Identifier& n) noexcept : Expression (l), name (n) {}
 
-        var getResult (const Scope& s) const override  { return s.findSymbolInParentScopes (name); }
+        void compileResult (CodeGenerator& g) const override      { g.emitNameLookup (name, location); }
+        void compileAssignment (CodeGenerator& g) const override  { g.emitNameAssignment (name, location, false); }
+        void compileStore (CodeGenerator& g) const override       { g.emitNameAssignment (name, location, true); }
+        bool canChangeLocals() const override                     { return false; }
 
-        void assign (const Scope& s, const var& newValue) const override
+        Operand compileOperand (CodeGenerator& g, int& index, bool canReadLocal) const override
         {
-            if (auto* v = getPropertyPointer (*s.scope, name))
-                *v = newValue;
-            else
-                s.root->setProperty (name, newValue);
+            auto slot = g.findLocal (name);
+
+            // slot 0 is 'this', which has to go through emitNameLookup() so the function knows it's used
+            if (! canReadLocal || slot <= 0)
+                return Expression::compileOperand (g, index, canReadLocal);
+
+            index = slot;
+            return Operand::local;
         }
 
         Identifier name;
@@ -392,30 +1146,16 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         DotOperator (const CodeLocation& l, ExpPtr& p, const Identifier& c) noexcept : Expression (l), parent (p.release()), child (c) {}
 
-        var getResult (const Scope& s) const override
+        void compileResult (CodeGenerator& g) const override
         {
-            auto p = parent->getResult (s);
-            static const Identifier lengthID ("length");
-
-            if (child == lengthID)
-            {
-                if (auto* array = p.getArray())   return array->size();
-                if (p.isString())                 return p.toString().length();
-            }
-
-            if (auto* o = p.getDynamicObject())
-                if (auto* v = getPropertyPointer (*o, child))
-                    return *v;
-
-            return var::undefined();
+            parent->compileResult (g);
+            g.emit (OpCode::getProperty, location, g.addName (child), g.addCache());
         }
 
-        void assign (const Scope& s, const var& newValue) const override
+        void compileAssignment (CodeGenerator& g) const override
         {
-            if (auto* o = parent->getResult (s).getDynamicObject())
-                o->setProperty (child, newValue);
-            else
-                Expression::assign (s, newValue);
+            parent->compileResult (g);
+            g.emit (OpCode::setProperty, location, g.addName (child));
         }
 
         ExpPtr parent;
@@ -426,51 +1166,18 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         ArraySubscript (const CodeLocation& l) noexcept : Expression (l) {}
 
-        var getResult (const Scope& s) const override
+        void compileResult (CodeGenerator& g) const override
         {
-            auto arrayVar = object->getResult (s); // must stay alive for the scope of this method
-            auto key = index->getResult (s);
-
-            if (const auto* array = arrayVar.getArray())
-                if (key.isInt() || key.isInt64() || key.isDouble())
-                    return (*array) [static_cast<int> (key)];
-
-            if (auto* o = arrayVar.getDynamicObject())
-                if (key.isString())
-                    if (auto* v = getPropertyPointer (*o, Identifier (key)))
-                        return *v;
-
-            return var::undefined();
+            object->compileResult (g);
+            index->compileResult (g);
+            g.emit (OpCode::getElement, location);
         }
 
-        void assign (const Scope& s, const var& newValue) const override
+        void compileAssignment (CodeGenerator& g) const override
         {
-            auto arrayVar = object->getResult (s); // must stay alive for the scope of this method
-            auto key = index->getResult (s);
-
-            if (auto* array = arrayVar.getArray())
-            {
-                if (key.isInt() || key.isInt64() || key.isDouble())
-                {
-                    const int i = key;
-                    while (array->size() < i)
-                        array->add (var::undefined());
-
-                    array->set (i, newValue);
-                    return;
-                }
-            }
-
-            if (auto* o = arrayVar.getDynamicObject())
-            {
-                if (key.isString())
-                {
-                    o->setProperty (Identifier (key), newValue);
-                    return;
-                }
-            }
-
-            Expression::assign (s, newValue);
+            object->compileResult (g);
+            index->compileResult (g);
+            g.emit (OpCode::setElement, location);
         }
 
         ExpPtr object, index;
@@ -487,189 +1194,165 @@ struct JavascriptEngine::RootObject   : public DynamicObject
 
     struct BinaryOperator  : public BinaryOperatorBase
     {
-        BinaryOperator (const CodeLocation& l, ExpPtr& a, ExpPtr& b, TokenType op) noexcept
-            : BinaryOperatorBase (l, a, b, op) {}
+        BinaryOperator (const CodeLocation& l, ExpPtr& a, ExpPtr& b, TokenType op, OpCode code) noexcept
+            : BinaryOperatorBase (l, a, b, op), opCode (code) {}
 
-        virtual var getWithUndefinedArg() const                           { return var::undefined(); }
-        virtual var getWithDoubles (double, double) const                 { return throwError ("Double"); }
-        virtual var getWithInts (int64, int64) const                      { return throwError ("Integer"); }
-        virtual var getWithArrayOrObject (const var& a, const var&) const { return throwError (a.isArray() ? "Array" : "Object"); }
-        virtual var getWithStrings (const String&, const String&) const   { return throwError ("String"); }
-
-        var getResult (const Scope& s) const override
-        {
-            var a (lhs->getResult (s)), b (rhs->getResult (s));
-
-            if ((a.isUndefined() || a.isVoid()) && (b.isUndefined() || b.isVoid()))
-                return getWithUndefinedArg();
+        void compileResult (CodeGenerator& g) const override   { g.emitBinaryOperator (opCode, *lhs, *rhs, location); }
 
-            if (isNumericOrUndefined (a) && isNumericOrUndefined (b))
-                return (a.isDouble() || b.isDouble()) ? getWithDoubles (a, b) : getWithInts (a, b);
-
-            if (a.isArray() || a.isObject())
-                return getWithArrayOrObject (a, b);
-
-            return getWithStrings (a.toString(), b.toString());
-        }
-
-        var throwError (const char* typeName) const
-            { location.throwError (getTokenName (operation) + " is not allowed on the " + typeName + " type"); return {}; }
+        OpCode opCode;
     };
 
     struct EqualsOp  : public BinaryOperator
     {
-        EqualsOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::equals) {}
-        var getWithUndefinedArg() const override                               { return true; }
-        var getWithDoubles (double a, double b) const override                 { return a == b; }
-        var getWithInts (int64 a, int64 b) const override                      { return a == b; }
-        var getWithStrings (const String& a, const String& b) const override   { return a == b; }
-        var getWithArrayOrObject (const var& a, const var& b) const override   { return a == b; }
+        EqualsOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::equals, OpCode::equals) {}
     };
 
     struct NotEqualsOp  : public BinaryOperator
     {
-        NotEqualsOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::notEquals) {}
-        var getWithUndefinedArg() const override                               { return false; }
-        var getWithDoubles (double a, double b) const override                 { return a != b; }
-        var getWithInts (int64 a, int64 b) const override                      { return a != b; }
-        var getWithStrings (const String& a, const String& b) const override   { return a != b; }
-        var getWithArrayOrObject (const var& a, const var& b) const override   { return a != b; }
+        NotEqualsOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::notEquals, OpCode::notEquals) {}
     };
 
     struct LessThanOp  : public BinaryOperator
     {
-        LessThanOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::lessThan) {}
-        var getWithDoubles (double a, double b) const override                 { return a < b; }
-        var getWithInts (int64 a, int64 b) const override                      { return a < b; }
-        var getWithStrings (const String& a, const String& b) const override   { return a < b; }
+        LessThanOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::lessThan, OpCode::lessThan) {}
     };
 
     struct LessThanOrEqualOp  : public BinaryOperator
     {
-        LessThanOrEqualOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::lessThanOrEqual) {}
-        var getWithDoubles (double a, double b) const override                 { return a <= b; }
-        var getWithInts (int64 a, int64 b) const override                      { return a <= b; }
-        var getWithStrings (const String& a, const String& b) const override   { return a <= b; }
+        LessThanOrEqualOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::lessThanOrEqual, OpCode::lessThanOrEqual) {}
     };
 
     struct GreaterThanOp  : public BinaryOperator
     {
-        GreaterThanOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::greaterThan) {}
-        var getWithDoubles (double a, double b) const override                 { return a > b; }
-        var getWithInts (int64 a, int64 b) const override                      { return a > b; }
-        var getWithStrings (const String& a, const String& b) const override   { return a > b; }
+        GreaterThanOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::greaterThan, OpCode::greaterThan) {}
     };
 
     struct GreaterThanOrEqualOp  : public BinaryOperator
     {
-        GreaterThanOrEqualOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::greaterThanOrEqual) {}
-        var getWithDoubles (double a, double b) const override                 { return a >= b; }
-        var getWithInts (int64 a, int64 b) const override                      { return a >= b; }
-        var getWithStrings (const String& a, const String& b) const override   { return a >= b; }
+        GreaterThanOrEqualOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::greaterThanOrEqual, OpCode::greaterThanOrEqual) {}
     };
 
     struct AdditionOp  : public BinaryOperator
     {
-        AdditionOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::plus) {}
-        var getWithDoubles (double a, double b) const override                 { return a + b; }
-        var getWithInts (int64 a, int64 b) const override                      { return a + b; }
-        var getWithStrings (const String& a, const String& b) const override   { return a + b; }
+        AdditionOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::plus, OpCode::add) {}
     };
 
     struct SubtractionOp  : public BinaryOperator
     {
-        SubtractionOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::minus) {}
-        var getWithDoubles (double a, double b) const override { return a - b; }
-        var getWithInts (int64 a, int64 b) const override      { return a - b; }
+        SubtractionOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::minus, OpCode::subtract) {}
     };
 
     struct MultiplyOp  : public BinaryOperator
     {
-        MultiplyOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::times) {}
-        var getWithDoubles (double a, double b) const override { return a * b; }
-        var getWithInts (int64 a, int64 b) const override      { return a * b; }
+        MultiplyOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::times, OpCode::multiply) {}
     };
 
     struct DivideOp  : public BinaryOperator
     {
-        DivideOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::divide) {}
-        var getWithDoubles (double a, double b) const override  { return b != 0 ? a / b : std::numeric_limits<double>::infinity(); }
-        var getWithInts (int64 a, int64 b) const override       { return b != 0 ? var ((double) a / (double) b) : var (std::numeric_limits<double>::infinity()); }
+        DivideOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::divide, OpCode::divide) {}
     };
 
     struct ModuloOp  : public BinaryOperator
     {
-        ModuloOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::modulo) {}
-        var getWithDoubles (double a, double b) const override  { return b != 0 ? fmod (a, b) : std::numeric_limits<double>::infinity(); }
-        var getWithInts (int64 a, int64 b) const override       { return b != 0 ? var (a % b) : var (std::numeric_limits<double>::infinity()); }
+        ModuloOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::modulo, OpCode::modulo) {}
     };
 
     struct BitwiseOrOp  : public BinaryOperator
     {
-        BitwiseOrOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::bitwiseOr) {}
-        var getWithInts (int64 a, int64 b) const override   { return a | b; }
+        BitwiseOrOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::bitwiseOr, OpCode::bitwiseOr) {}
     };
 
     struct BitwiseAndOp  : public BinaryOperator
     {
-        BitwiseAndOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::bitwiseAnd) {}
-        var getWithInts (int64 a, int64 b) const override   { return a & b; }
+        BitwiseAndOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::bitwiseAnd, OpCode::bitwiseAnd) {}
     };
 
     struct BitwiseXorOp  : public BinaryOperator
     {
-        BitwiseXorOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::bitwiseXor) {}
-        var getWithInts (int64 a, int64 b) const override   { return a ^ b; }
+        BitwiseXorOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::bitwiseXor, OpCode::bitwiseXor) {}
     };
 
     struct LeftShiftOp  : public BinaryOperator
     {
-        LeftShiftOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::leftShift) {}
-        var getWithInts (int64 a, int64 b) const override   { return ((int) a) << (int) b; }
+        LeftShiftOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::leftShift, OpCode::leftShift) {}
     };
 
     struct RightShiftOp  : public BinaryOperator
     {
-        RightShiftOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::rightShift) {}
-        var getWithInts (int64 a, int64 b) const override   { return ((int) a) >> (int) b; }
+        RightShiftOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::rightShift, OpCode::rightShift) {}
     };
 
     struct RightShiftUnsignedOp  : public BinaryOperator
     {
-        RightShiftUnsignedOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::rightShiftUnsigned) {}
-        var getWithInts (int64 a, int64 b) const override   { return (int) (((uint32) a) >> (int) b); }
+        RightShiftUnsignedOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperator (l, a, b, TokenTypes::rightShiftUnsigned, OpCode::rightShiftUnsigned) {}
     };
 
     struct LogicalAndOp  : public BinaryOperatorBase
     {
         LogicalAndOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperatorBase (l, a, b, TokenTypes::logicalAnd) {}
-        var getResult (const Scope& s) const override       { return lhs->getResult (s) && rhs->getResult (s); }
+
+        void compileResult (CodeGenerator& g) const override
+        {
+            lhs->compileResult (g);
+            auto jumpToEnd = g.emitJump (OpCode::logicalAnd, location);
+            rhs->compileResult (g);
+            g.emit (OpCode::toBool, location);
+            g.setJumpTarget (jumpToEnd);
+        }
     };
 
     struct LogicalOrOp  : public BinaryOperatorBase
     {
         LogicalOrOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperatorBase (l, a, b, TokenTypes::logicalOr) {}
-        var getResult (const Scope& s) const override       { return lhs->getResult (s) || rhs->getResult (s); }
+
+        void compileResult (CodeGenerator& g) const override
+        {
+            lhs->compileResult (g);
+            auto jumpToEnd = g.emitJump (OpCode::logicalOr, location);
+            rhs->compileResult (g);
+            g.emit (OpCode::toBool, location);
+            g.setJumpTarget (jumpToEnd);
+        }
     };
 
     struct TypeEqualsOp  : public BinaryOperatorBase
     {
         TypeEqualsOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperatorBase (l, a, b, TokenTypes::typeEquals) {}
-        var getResult (const Scope& s) const override       { return areTypeEqual (lhs->getResult (s), rhs->getResult (s)); }
+        void compileResult (CodeGenerator& g) const override  { lhs->compileResult (g); rhs->compileResult (g); g.emit (OpCode::typeEquals, location); }
     };
 
     struct TypeNotEqualsOp  : public BinaryOperatorBase
     {
         TypeNotEqualsOp (const CodeLocation& l, ExpPtr& a, ExpPtr& b) noexcept : BinaryOperatorBase (l, a, b, TokenTypes::typeNotEquals) {}
-        var getResult (const Scope& s) const override       { return ! areTypeEqual (lhs->getResult (s), rhs->getResult (s)); }
+        void compileResult (CodeGenerator& g) const override  { lhs->compileResult (g); rhs->compileResult (g); g.emit (OpCode::typeNotEquals, location); }
     };
 
     struct ConditionalOp  : public Expression
     {
         ConditionalOp (const CodeLocation& l) noexcept : Expression (l) {}
 
-        var getResult (const Scope& s) const override              { return (condition->getResult (s) ? trueBranch : falseBranch)->getResult (s); }
-        void assign (const Scope& s, const var& v) const override  { (condition->getResult (s) ? trueBranch : falseBranch)->assign (s, v); }
+        void compileResult (CodeGenerator& g) const override
+        {
+            condition->compileResult (g);
+            auto jumpToFalseBranch = g.emitJump (OpCode::jumpIfFalse, location);
+            trueBranch->compileResult (g);
+            auto jumpToEnd = g.emitJump (OpCode::jump, location);
+            g.setJumpTarget (jumpToFalseBranch);
+            g.adjustStackDepth (-1); // only one of the branches' results is on the stack
+            falseBranch->compileResult (g);
+            g.setJumpTarget (jumpToEnd);
+        }
+
+        void compileAssignment (CodeGenerator& g) const override
+        {
+            condition->compileResult (g);
+            auto jumpToFalseBranch = g.emitJump (OpCode::jumpIfFalse, location);
+            trueBranch->compileAssignment (g);
+            auto jumpToEnd = g.emitJump (OpCode::jump, location);
+            g.setJumpTarget (jumpToFalseBranch);
+            falseBranch->compileAssignment (g);
+            g.setJumpTarget (jumpToEnd);
+        }
 
         ExpPtr condition, trueBranch, falseBranch;
     };
@@ -678,11 +1361,16 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         Assignment (const CodeLocation& l, ExpPtr& dest, ExpPtr& source) noexcept : Expression (l), target (dest.release()), newValue (source.release()) {}
 
-        var getResult (const Scope& s) const override
+        void compileResult (CodeGenerator& g) const override
         {
-            auto value = newValue->getResult (s);
-            target->assign (s, value);
-            return value;
+            newValue->compileResult (g);
+            target->compileAssignment (g);
+        }
+
+        void compile (CodeGenerator& g) const override
+        {
+            newValue->compileResult (g);
+            target->compileStore (g);
         }
 
         ExpPtr target, newValue;
@@ -693,11 +1381,17 @@ struct JavascriptEngine::RootObject   : public DynamicObject
         SelfAssignment (const CodeLocation& l, Expression* dest, Expression* source) noexcept
             : Expression (l), target (dest), newValue (source) {}
 
-        var getResult (const Scope& s) const override
+        void compileResult (CodeGenerator& g) const override
+        {
+            newValue->compileResult (g);
+            target->compileAssignment (g);
+        }
+
+        // As a statement, the result isn't needed, so a post-increment is the same as a pre-increment
+        void compile (CodeGenerator& g) const override
         {
-            auto value = newValue->getResult (s);
-            target->assign (s, value);
-            return value;
+            newValue->compileResult (g);
+            target->compileStore (g);
         }
 
         Expression* target; // Careful! this pointer aliases a sub-term of newValue!
@@ -709,11 +1403,12 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         PostAssignment (const CodeLocation& l, Expression* dest, Expression* source) noexcept : SelfAssignment (l, dest, source) {}
 
-        var getResult (const Scope& s) const override
+        void compileResult (CodeGenerator& g) const override
         {
-            auto oldValue = target->getResult (s);
-            target->assign (s, newValue->getResult (s));
-            return oldValue;
+            target->compileResult (g);
+            newValue->compileResult (g);
+            target->compileAssignment (g);
+            g.emit (OpCode::pop, location);
         }
     };
 
@@ -721,40 +1416,27 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         FunctionCall (const CodeLocation& l) noexcept : Expression (l) {}
 
-        var getResult (const Scope& s) const override
+        void compileResult (CodeGenerator& g) const override
         {
             if (auto* dot = dynamic_cast<DotOperator*> (object.get()))
             {
-                auto thisObject = dot->parent->getResult (s);
-                return invokeFunction (s, s.findFunctionCall (location, thisObject, dot->child), thisObject);
+                auto name = g.addName (dot->child);
+                dot->parent->compileResult (g);
+                g.emit (OpCode::getMethod, location, name, g.addCache());
+                compileArguments (g);
+                g.emit (OpCode::callMethod, location, arguments.size(), name);
+                return;
             }
 
-            auto function = object->getResult (s);
-            return invokeFunction (s, function, var (s.scope.get()));
+            object->compileResult (g);
+            compileArguments (g);
+            g.emit (OpCode::call, location, arguments.size());
         }
 
-        var invokeFunction (const Scope& s, const var& function, const var& thisObject) const
+        void compileArguments (CodeGenerator& g) const
         {
-            s.checkTimeOut (location);
-            Array<var> argVars;
-
             for (auto* a : arguments)
-                argVars.add (a->getResult (s));
-
-            const var::NativeFunctionArgs args (thisObject, argVars.begin(), argVars.size());
-
-            if (var::NativeFunction nativeFunction = function.getNativeFunction())
-                return nativeFunction (args);
-
-            if (auto* fo = dynamic_cast<FunctionObject*> (function.getObject()))
-                return fo->invoke (s, args);
-
-            if (auto* dot = dynamic_cast<DotOperator*> (object.get()))
-                if (auto* o = thisObject.getDynamicObject())
-                    if (o->hasMethod (dot->child)) // allow an overridden DynamicObject::invokeMethod to accept a method call.
-                        return o->invokeMethod (dot->child, args);
-
-            location.throwError ("This expression is not a function!"); return {};
+                a->compileResult (g);
         }
 
         ExpPtr object;
@@ -765,22 +1447,11 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         NewOperator (const CodeLocation& l) noexcept : FunctionCall (l) {}
 
-        var getResult (const Scope& s) const override
+        void compileResult (CodeGenerator& g) const override
         {
-            var classOrFunc = object->getResult (s);
-            const bool isFunc = isFunction (classOrFunc);
-
-            if (! (isFunc || classOrFunc.getDynamicObject() != nullptr))
-                return var::undefined();
-
-            DynamicObject::Ptr newObject (new DynamicObject());
-
-            if (isFunc)
-                invokeFunction (s, classOrFunc, newObject.get());
-            else
-                newObject->setProperty (getPrototypeIdentifier(), classOrFunc);
-
-            return newObject.get();
+            object->compileResult (g);
+            compileArguments (g);
+            g.emit (OpCode::construct, location, arguments.size());
         }
     };
 
@@ -788,14 +1459,15 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         ObjectDeclaration (const CodeLocation& l) noexcept : Expression (l) {}
 
-        var getResult (const Scope& s) const override
+        void compileResult (CodeGenerator& g) const override
         {
-            DynamicObject::Ptr newObject (new DynamicObject());
+            g.emit (OpCode::newObject, location);
 
             for (int i = 0; i < names.size(); ++i)
-                newObject->setProperty (names.getUnchecked(i), initialisers.getUnchecked(i)->getResult (s));
-
-            return newObject.get();
+            {
+                initialisers.getUnchecked(i)->compileResult (g);
+                g.emit (OpCode::defineProperty, location, g.addName (names.getReference (i)));
+            }
         }
 
         Array<Identifier> names;
@@ -806,22 +1478,210 @@ struct JavascriptEngine::RootObject   : public DynamicObject
     {
         ArrayDeclaration (const CodeLocation& l) noexcept : Expression (l) {}
 
-        var getResult (const Scope& s) const override
+        void compileResult (CodeGenerator& g) const override
         {
-            Array<var> a;
-
-            for (int i = 0; i < values.size(); ++i)
-                a.add (values.getUnchecked(i)->getResult (s));
+            for (auto* v : values)
+                v->compileResult (g);
 
-            // std::move() needed here for older compilers
-            JUCE_BEGIN_IGNORE_WARNINGS_GCC_LIKE ("-Wredundant-move")
-            return std::move (a);
-            JUCE_END_IGNORE_WARNINGS_GCC_LIKE
+            g.emit (OpCode::newArray, location, values.size());
         }
 
         OwnedArray<Expression> values;
     };
 
+    //==============================================================================
+    // Turns a parsed function body, script or expression into bytecode. In a function, the
+    // parameters and every variable declared with 'var' are given a slot in the stack frame,
+    // so they can be accessed without looking them up by name.
+    struct CodeGenerator
+    {
+        CodeGenerator (CompiledCode& c, const CodeLocation& l, bool hasLocalSlots)
+            : code (c), useLocalSlots (hasLocalSlots)
+        {
+            code.program = l.program;
+        }
+
+        static void compileStatements (CompiledCode& code, const Statement& statements)
+        {
+            CodeGenerator g (code, statements.location, false);
+            statements.compile (g);
+            g.finish (statements.location);
+        }
+
+        static void compileExpression (CompiledCode& code, const Expression& expression)
+        {
+            CodeGenerator g (code, expression.location, false);
+            expression.compileResult (g);
+            g.emit (OpCode::returnValue, expression.location);
+            g.finish (expression.location);
+        }
+
+        static void compileFunction (CompiledCode& code, const Array<Identifier>& parameters, const Statement& body)
+        {
+            static const Identifier thisIdent ("this");
+
+            CodeGenerator g (code, body.location, true);
+            g.addLocal (thisIdent);
+
+            for (auto& p : parameters)
+                g.addLocal (p);
+
+            body.declareLocals (g);
+            code.numCaches = code.localNames.size(); // used when reading an operand from a local that's not in its slot
+
+            body.compile (g);
+            g.finish (body.location);
+        }
+
+        //==============================================================================
+        void emit (OpCode op, const CodeLocation& l, int a = 0, int b = 0)
+        {
+            code.instructions.add ({ op, Operand::stack, Operand::stack, a, b, l.location.getAddress() });
+            adjustStackDepth (getStackChange (op, a));
+        }
+
+        int emitJump (OpCode op, const CodeLocation& l)
+        {
+            emit (op, l);
+            return code.instructions.size() - 1;
+        }
+
+        int getNextAddress() const noexcept                       { return code.instructions.size(); }
+        void setJumpTarget (int jump)                             { setJumpTarget (jump, getNextAddress()); }
+        void setJumpTarget (int jump, int target)                 { code.instructions.getReference (jump).a = target; }
+
+        void adjustStackDepth (int change) noexcept
+        {
+            stackDepth += change;
+            jassert (stackDepth >= 0);
+            code.maxStackDepth = jmax (code.maxStackDepth, stackDepth);
+        }
+
+        void emitError (const String& message, const CodeLocation& l)
+        {
+            emit (OpCode::throwError, l, addConstant (message));
+        }
+
+        int addConstant (const var& v)
+        {
+            code.constants.add (v);
+            return code.constants.size() - 1;
+        }
+
+        int addName (const Identifier& name)
+        {
+            code.names.addIfNotAlreadyThere (name);
+            return code.names.indexOf (name);
+        }
+
+        int addCache() noexcept                                   { return code.numCaches++; }
+        void addLocal (const Identifier& name)                    { code.localNames.addIfNotAlreadyThere (name); }
+        int findLocal (const Identifier& name) const              { return useLocalSlots ? code.localNames.indexOf (name) : -1; }
+
+        //==============================================================================
+        void emitNameLookup (const Identifier& name, const CodeLocation& l)
+        {
+            auto slot = findLocal (name);
+
+            if (slot < 0)
+            {
+                emit (OpCode::getName, l, addName (name), addCache());
+                return;
+            }
+
+            if (slot == 0)
+                code.usesThis = true;
+
+            emit (OpCode::getLocal, l, slot, addCache());
+        }
+
+        void emitNameAssignment (const Identifier& name, const CodeLocation& l, bool discardValue)
+        {
+            auto slot = findLocal (name);
+
+            if (slot < 0)
+                emit (discardValue ? OpCode::storeName : OpCode::setName, l, addName (name), addCache());
+            else
+                emit (discardValue ? OpCode::storeLocal : OpCode::setLocal, l, slot, addCache());
+        }
+
+        void emitBinaryOperator (OpCode op, const Expression& lhs, const Expression& rhs, const CodeLocation& l)
+        {
+            CompiledCode::Instruction i { op, Operand::stack, Operand::stack, 0, 0, l.location.getAddress() };
+
+            i.lhs = lhs.compileOperand (*this, i.a, ! rhs.canChangeLocals());
+            i.rhs = rhs.compileOperand (*this, i.b, true);
+            code.instructions.add (i);
+
+            auto numStackOperands = (i.lhs == Operand::stack ? 1 : 0) + (i.rhs == Operand::stack ? 1 : 0);
+            adjustStackDepth (2); // leaves room for any locals that have to be looked up by name
+            adjustStackDepth (-1 - numStackOperands);
+        }
+
+        void emitVariableDefinition (const Identifier& name, const CodeLocation& l)
+        {
+            auto slot = findLocal (name);
+
+            if (slot < 0)
+                emit (OpCode::defineName, l, addName (name));
+            else
+                emit (OpCode::defineLocal, l, slot);
+        }
+
+        //==============================================================================
+        void beginLoop()
+        {
+            loops.push_back ({});
+        }
+
+        void endLoop (int continueTarget)
+        {
+            for (auto jump : loops.back().continueJumps)
+                setJumpTarget (jump, continueTarget);
+
+            for (auto jump : loops.back().breakJumps)
+                setJumpTarget (jump);
+
+            loops.pop_back();
+        }
+
+        // Outside a loop, 'break' and 'continue' just stop the function or script.
+        void emitBreak (const CodeLocation& l)
+        {
+            auto jump = emitJump (OpCode::jump, l);
+            (loops.empty() ? exitJumps : loops.back().breakJumps).add (jump);
+        }
+
+        void emitContinue (const CodeLocation& l)
+        {
+            auto jump = emitJump (OpCode::jump, l);
+            (loops.empty() ? exitJumps : loops.back().continueJumps).add (jump);
+        }
+
+        void finish (const CodeLocation& l)
+        {
+            for (auto jump : exitJumps)
+                setJumpTarget (jump);
+
+            emit (OpCode::end, l);
+
+            code.caches.reset (new std::atomic<int>[(size_t) jmax (1, code.numCaches)]);
+
+            for (int i = 0; i < code.numCaches; ++i)
+                code.getCache (i).store (0);
+        }
+
+        CompiledCode& code;
+        const bool useLocalSlots;
+        int stackDepth = 0;
+
+        struct LoopJumps  { Array<int> breakJumps, continueJumps; };
+        std::vector<LoopJumps> loops;
+        Array<int> exitJumps;
+
+        JUCE_DECLARE_NON_COPYABLE (CodeGenerator)
+    };
+
     //==============================================================================
     struct FunctionObject  : public DynamicObject
     {
@@ -840,25 +1700,33 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             out << "function " << functionCode;
         }
 
-        var invoke (const Scope& s, const var::NativeFunctionArgs& args) const
+        void compile (const Statement& body)
         {
-            DynamicObject::Ptr functionRoot (new DynamicObject());
+            code.reset (new CompiledCode());
+            CodeGenerator::compileFunction (*code, parameters, body);
 
-            static const Identifier thisIdent ("this");
-            functionRoot->setProperty (thisIdent, args.thisObject);
+            parameterSlots.clearQuick();
+
+            for (auto& p : parameters)
+                parameterSlots.add (code->localNames.indexOf (p));
+        }
+
+        var invoke (const Scope& s, const var::NativeFunctionArgs& args) const
+        {
+            StackFrame frame (*code);
+            frame.define (0, args.thisObject);
 
             for (int i = 0; i < parameters.size(); ++i)
-                functionRoot->setProperty (parameters.getReference(i),
-                                           i < args.numArguments ? args.arguments[i] : var::undefined());
+                frame.define (parameterSlots.getUnchecked (i),
+                              i < args.numArguments ? args.arguments[i] : var::undefined());
 
-            var result;
-            body->perform (Scope (&s, s.root, functionRoot), &result);
-            return result;
+            return code->run (Scope (&s, s.root, frame), frame);
         }
 
         String functionCode;
         Array<Identifier> parameters;
-        std::unique_ptr<Statement> body;
+        Array<int> parameterSlots;
+        std::unique_ptr<CompiledCode> code;
     };
 
     //==============================================================================
@@ -1085,7 +1953,7 @@ struct JavascriptEngine::RootObject   : public DynamicObject
             }
 
             match (TokenTypes::closeParen);
-            fo.body.reset (parseBlock());
+            fo.compile (*std::unique_ptr<BlockStatement> (parseBlock()));
         }
 
         Expression* parseExpression()
@@ -1914,6 +2782,115 @@ const NamedValueSet& JavascriptEngine::getRootObjectProperties() const noexcept
     return root->getProperties();
 }
 
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class JavascriptEngineTests  : public UnitTest
+{
+public:
+    JavascriptEngineTests()
+        : UnitTest ("JavascriptEngine", UnitTestCategories::javascript)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Property lookups");
+        {
+            JavascriptEngine engine;
+
+            expect (engine.execute ("var o = { a: 1, b: 2, c: 3 };"
+                                    "function f (x, y) { var z = x * y; return z + o.c; }"
+                                    "var total = 0;"
+                                    "for (var i = 0; i < 10; ++i) total += f (i, o.b);").wasOk());
+
+            expectEquals ((int) engine.evaluate ("total"), 120);
+
+            // same expressions evaluated against objects with different property layouts
+            expect (engine.execute ("function getB (obj) { return obj.b; }"
+                                    "var r1 = getB ({ a: 1, b: 2 });"
+                                    "var r2 = getB ({ b: 3 });"
+                                    "var r3 = getB ({ x: 1, y: 2, z: 3, b: 4 });"
+                                    "var r4 = getB ({ a: 1 });").wasOk());
+
+            expectEquals ((int) engine.evaluate ("r1"), 2);
+            expectEquals ((int) engine.evaluate ("r2"), 3);
+            expectEquals ((int) engine.evaluate ("r3"), 4);
+            expect (engine.evaluate ("r4").isUndefined());
+
+            // a local shadowing a global must still be found first
+            expect (engine.execute ("var v = 1;"
+                                    "function g (useLocal) { if (useLocal) { var v = 2; return v; } return v; }"
+                                    "var s1 = g (false); var s2 = g (true);").wasOk());
+
+            expectEquals ((int) engine.evaluate ("s1"), 1);
+            expectEquals ((int) engine.evaluate ("s2"), 2);
+
+            var::NativeFunctionArgs args ({}, nullptr, 0);
+            expectEquals ((int) engine.callFunction ("g", args), 1);
+        }
+
+        beginTest ("Functions");
+        {
+            JavascriptEngine engine;
+
+            expect (engine.execute ("function sumTo (n) { var t = 0; for (var i = 0; i < n; i++) { if (i == 3) continue; if (i > 8) break; t += i; } return t; }"
+                                    "function missing (a, b) { return typeof (b); }"
+                                    "function outer() { var x = 5; function inner() { return x * 2; } return inner(); }"
+                                    "function beforeDefinition() { var r = q + 1; var q = 4; return r; }"
+                                    "var q = 10;"
+                                    "var counter = { count: 1, next: function() { this.count++; return this.count; } };"
+                                    "function sideEffects() { var a = 1; return a + (a = 5); }").wasOk());
+
+            expectEquals ((int) engine.evaluate ("sumTo (100)"), 33);
+            expectEquals (engine.evaluate ("missing (1)").toString(), String ("undefined"));
+            expectEquals ((int) engine.evaluate ("outer()"), 10);
+            expectEquals ((int) engine.evaluate ("beforeDefinition()"), 11);
+            expectEquals ((int) engine.evaluate ("counter.next() + counter.next()"), 5);
+            expectEquals ((int) engine.evaluate ("sideEffects()"), 6);
+
+            Result result (Result::ok());
+            engine.evaluate ("sumTo (1) = 2", &result);
+            expect (result.getErrorMessage().contains ("Cannot assign to this expression!"));
+
+            engine.evaluate ("noSuchObject.noSuchMethod()", &result);
+            expect (result.getErrorMessage().contains ("Unknown function 'noSuchMethod'"));
+
+            engine.maximumExecutionTime = RelativeTime::milliseconds (50);
+            expect (engine.execute ("while (true) {}").getErrorMessage().endsWith ("Execution timed-out"));
+        }
+
+        beginTest ("Typical scripts");
+        {
+            struct Script { const char* code; const char* result; var expected; };
+
+            const Script scripts[] =
+            {
+                { "function fib (n) { return n < 2 ? n : fib (n - 1) + fib (n - 2); }", "fib (18)", 2584 },
+                { "var sum = 0; for (var i = 0; i < 20000; ++i) { var x = i % 7; sum += x * x; }", "sum", 259987 },
+                { "var p = { gain: 0.5, pan: 0.0, note: 60 }; var acc = 0;"
+                  "for (var i = 0; i < 10000; ++i) { p.note = 60 + i % 12; acc += p.gain * p.note + p.pan; }", "acc", 327492.0 },
+                { "var events = [];"
+                  "for (var i = 0; i < 2000; ++i) events.push ({ note: i % 128, velocity: 100 });"
+                  "var out = 0; for (var i = 0; i < events.length; ++i) { var e = events[i]; if (e.velocity > 64) out += Math.max (e.note, 10); }", "out", 125960 },
+                { "var s = \"\"; for (var i = 0; i < 2000; ++i) s += String.fromCharCode (65 + i % 26);", "s.length + s.substring (25, 28)", "2000ZAB" }
+            };
+
+            for (auto& s : scripts)
+            {
+                JavascriptEngine engine;
+                auto result = engine.execute (s.code);
+                expect (result.wasOk(), result.getErrorMessage());
+                expect (engine.evaluate (s.result) == s.expected, s.result);
+            }
+        }
+    }
+};
+
+static JavascriptEngineTests javascriptEngineTests;
+
+#endif
+
 JUCE_END_IGNORE_WARNINGS_MSVC
 
 } // namespace juce
@@ -131,6 +131,7 @@
 #include "containers/juce_NamedValueSet.cpp"
 #include "containers/juce_OwnedArray.cpp"
 #include "containers/juce_PropertySet.cpp"
+#include "containers/juce_RealtimeListenerList.cpp"
 #include "containers/juce_ReferenceCountedArray.cpp"
 #include "containers/juce_SparseSet.cpp"
 #include "files/juce_DirectoryIterator.cpp"
@@ -166,6 +167,7 @@
 #include "text/juce_Identifier.cpp"
 #include "text/juce_LocalisedStrings.cpp"
 #include "text/juce_String.cpp"
+#include "text/juce_SmallString.cpp"
 #include "streams/juce_OutputStream.cpp"
 #include "text/juce_StringArray.cpp"
 #include "text/juce_StringPairArray.cpp"
@@ -98,7 +98,18 @@ public:
             auto numWritten = (int) ::write (pipeOut, sourceBuffer, (size_t) bytesThisTime);
 
             if (numWritten <= 0)
-                return -1;
+            {
+                // if the pipe is full, wait for the reader to catch up rather than failing
+                // part-way through a write
+                if (errno != EWOULDBLOCK || stopReadOperation.load())
+                    return -1;
+
+                const int maxWaitingTime = 30;
+                waitForOutput (pipeOut, timeoutEnd == 0 ? maxWaitingTime
+                                                        : jmin (maxWaitingTime,
+                                                                (int) (timeoutEnd - Time::getMillisecondCounter())));
+                continue;
+            }
 
             bytesWritten += numWritten;
             sourceBuffer += numWritten;
@@ -178,6 +189,12 @@ private:
         poll (&pfd, 1, timeoutMsecs);
     }
 
+    static void waitForOutput (int handle, int timeoutMsecs) noexcept
+    {
+        pollfd pfd { handle, POLLOUT, 0 };
+        poll (&pfd, 1, timeoutMsecs);
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Pimpl)
 };
 
@@ -0,0 +1,380 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+SmallString::SmallString() noexcept
+{
+    clearInline();
+}
+
+SmallString::SmallString (const char* t)
+{
+    // As with String, if you get an assertion here, then you're trying to create a string
+    // from 8-bit data that contains values greater than 127. Use CharPointer_UTF8 instead.
+    jassert (t == nullptr || CharPointer_ASCII::isValidString (t, std::numeric_limits<int>::max()));
+
+    assign (CharPointer_ASCII (t));
+}
+
+SmallString::SmallString (CharPointerType t)    { assign (t); }
+SmallString::SmallString (StringRef t)          { assign (t.text); }
+
+SmallString::SmallString (const String& t)
+{
+    if (CharPointerType::getBytesRequiredFor (t.getCharPointer()) <= (size_t) maxInlineLength * sizeof (CharType))
+        assign (t.getCharPointer());
+    else
+        heapString = t;
+}
+
+SmallString::SmallString (const SmallString& other) noexcept
+    : heapString (other.heapString)
+{
+    copyInlineFrom (other);
+}
+
+SmallString::SmallString (SmallString&& other) noexcept
+    : heapString (std::move (other.heapString))
+{
+    copyInlineFrom (other);
+    other.clearInline();
+}
+
+SmallString& SmallString::operator= (const SmallString& other) noexcept
+{
+    if (! (isStoredInline() && other.isStoredInline()))
+        heapString = other.heapString;
+
+    copyInlineFrom (other);
+    return *this;
+}
+
+SmallString& SmallString::operator= (SmallString&& other) noexcept
+{
+    if (this != &other)
+    {
+        heapString = std::move (other.heapString);
+        copyInlineFrom (other);
+        other.clearInline();
+    }
+
+    return *this;
+}
+
+SmallString::~SmallString() noexcept {}
+
+//==============================================================================
+template <typename CharPointer>
+void SmallString::assign (CharPointer t)
+{
+    if (t.getAddress() == nullptr)
+    {
+        clearInline();
+        return;
+    }
+
+    auto numBytes = CharPointerType::getBytesRequiredFor (t);
+
+    if (numBytes <= (size_t) maxInlineLength * sizeof (CharType))
+    {
+        CharPointerType (inlineText).writeAll (t);
+        numInlineUnits = (uint8) (numBytes / sizeof (CharType));
+    }
+    else
+    {
+        heapString = String (t);
+        clearInline();
+    }
+}
+
+void SmallString::clearInline() noexcept
+{
+    inlineText[0] = 0;
+    numInlineUnits = 0;
+}
+
+void SmallString::copyInlineFrom (const SmallString& other) noexcept
+{
+    memcpy (inlineText, other.inlineText, sizeof (inlineText));
+    numInlineUnits = other.numInlineUnits;
+}
+
+SmallString::CharPointerType SmallString::getCharPointer() const noexcept
+{
+    return isStoredInline() ? CharPointerType (inlineText)
+                            : heapString.getCharPointer();
+}
+
+String SmallString::toString() const
+{
+    return isStoredInline() ? String (CharPointerType (inlineText))
+                            : heapString;
+}
+
+//==============================================================================
+SmallString& SmallString::operator+= (StringRef other)
+{
+    if (other.isEmpty())
+        return *this;
+
+    // if the text is part of this string, it'd get overwritten while it's being appended
+    auto start = getCharPointer();
+
+    if (other.text.getAddress() >= start.getAddress() && other.text.getAddress() <= start.findTerminatingNull().getAddress())
+    {
+        const SmallString copy (other);
+        return operator+= (StringRef (copy.getCharPointer()));
+    }
+
+    if (isStoredInline())
+    {
+        auto extraBytes = CharPointerType::getBytesRequiredFor (other.text);
+        auto totalUnits = (size_t) numInlineUnits + extraBytes / sizeof (CharType);
+
+        if (totalUnits <= (size_t) maxInlineLength)
+        {
+            CharPointerType (inlineText + numInlineUnits).writeAll (other.text);
+            numInlineUnits = (uint8) totalUnits;
+            return *this;
+        }
+
+        String s;
+        s.preallocateBytes ((totalUnits + 1) * sizeof (CharType));
+        s += StringRef (CharPointerType (inlineText));
+        heapString = std::move (s);
+        clearInline();
+    }
+
+    heapString += other;
+    return *this;
+}
+
+SmallString& SmallString::operator+= (const SmallString& other)
+{
+    return operator+= (StringRef (other.getCharPointer()));
+}
+
+SmallString JUCE_CALLTYPE operator+ (SmallString s1, StringRef s2)        { return s1 += s2; }
+SmallString JUCE_CALLTYPE operator+ (SmallString s1, const char* s2)      { return s1 += StringRef (s2); }
+SmallString JUCE_CALLTYPE operator+ (SmallString s1, const String& s2)    { return s1 += StringRef (s2); }
+
+//==============================================================================
+int SmallString::compare (StringRef other) const noexcept
+{
+    return getCharPointer().compare (other.text);
+}
+
+bool SmallString::operator== (const SmallString& other) const noexcept
+{
+    if (isStoredInline() && other.isStoredInline())
+        return numInlineUnits == other.numInlineUnits
+                && memcmp (inlineText, other.inlineText, numInlineUnits * sizeof (CharType)) == 0;
+
+    // a string that fits inline is never stored on the heap, so the two can't be equal
+    if (isStoredInline() != other.isStoredInline())
+        return false;
+
+    return heapString == other.heapString;
+}
+
+size_t SmallString::hash() const noexcept
+{
+    return HashGenerator<size_t>::calculate (getCharPointer());
+}
+
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class SmallStringTests  : public UnitTest
+{
+public:
+    SmallStringTests()
+        : UnitTest ("SmallString class", UnitTestCategories::text)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Basics");
+        {
+            SmallString empty;
+            expect (empty.isEmpty());
+            expect (empty.isStoredInline());
+            expectEquals (empty.length(), 0);
+            expect (empty == "");
+            expect (empty.toString().isEmpty());
+
+            SmallString s ("gain");
+            expect (s.isNotEmpty());
+            expect (s.isStoredInline());
+            expectEquals (s.length(), 4);
+            expect (s == "gain");
+            expect (s != "gains");
+            expectEquals (s.toString(), String ("gain"));
+
+            auto longText = String::repeatedString ("abcdef", 10);
+            SmallString l (longText);
+            expect (! l.isStoredInline());
+            expect (l == longText);
+            expect (l.getCharPointer() == longText.getCharPointer());
+
+            SmallString utf8 (CharPointer_UTF8 ("\xc2\xaf\\_(\xe3\x83\x84)_/\xc2\xaf"));
+            expectEquals (utf8.length(), 9);
+            expect (utf8 == String (CharPointer_UTF8 ("\xc2\xaf\\_(\xe3\x83\x84)_/\xc2\xaf")));
+        }
+
+        beginTest ("Copying");
+        {
+            SmallString a ("level"), b (String::repeatedString ("x", 100));
+
+            SmallString c (a), d (b);
+            expect (c == a && d == b);
+            expect (c.isStoredInline() && ! d.isStoredInline());
+
+            c = b;
+            d = a;
+            expect (c == b && d == a);
+            expect (c.isStoredInline() == b.isStoredInline());
+
+            SmallString e (std::move (c));
+            expect (e == b);
+        }
+
+        beginTest ("Moved-from strings are empty");
+        {
+            for (auto& text : { String ("gain"), String::repeatedString ("x", 100) })
+            {
+                SmallString a (text), b (text), c, d;
+
+                c = std::move (a);
+                SmallString e (std::move (b));
+                expect (c == text && e == text);
+
+                for (auto* movedFrom : { &a, &b })
+                {
+                    expect (movedFrom->isEmpty());
+                    expect (movedFrom->isStoredInline());
+                    expectEquals (movedFrom->length(), 0);
+                    expect (movedFrom->toString().isEmpty());
+                }
+
+                // a moved-from string can be used again
+                a += StringRef ("abc");
+                expect (a == "abc");
+            }
+        }
+
+        beginTest ("Appending part of the same string");
+        {
+            SmallString inlineText ("abcdef");
+            inlineText += StringRef (inlineText);
+            expect (inlineText == "abcdefabcdef");
+
+            auto secondHalf = inlineText.getCharPointer() + 6;
+            inlineText += StringRef (secondHalf);
+            expect (inlineText == "abcdefabcdefabcdef");
+
+            auto longText = String::repeatedString ("xyz", 20);
+            SmallString heapText (longText);
+            heapText += StringRef (heapText.getCharPointer() + 3);
+            expect (heapText == longText + longText.substring (3));
+
+            heapText += heapText;
+            expect (heapText.length() == 2 * (longText.length() * 2 - 3));
+        }
+
+        beginTest ("Concatenation");
+        {
+            SmallString s;
+
+            for (int i = 0; i < 40; ++i)
+            {
+                s += String (i % 10);
+                expectEquals (s.length(), i + 1);
+                expect (s.isStoredInline() == (i < SmallString::maxInlineLength));
+            }
+
+            String expected;
+
+            for (int i = 0; i < 40; ++i)
+                expected << (i % 10);
+
+            expect (s == expected);
+
+            SmallString t ("ab");
+            t += t;
+            expect (t == "abab");
+            expect (t + "cd" == "ababcd");
+        }
+
+        beginTest ("Comparison");
+        {
+            SmallString a ("abc"), b ("abd"), longA (String::repeatedString ("a", 50));
+
+            expect (a < b);
+            expect (! (b < a));
+            expect (a.compare ("abc") == 0);
+            expect (a.compare (String ("abb")) > 0);
+            expect (longA < a);
+            expect (a != longA);
+            expect (a == StringRef ("abc"));
+            expectEquals (a.hash(), String ("abc").hash());
+            expectEquals (longA.hash(), String::repeatedString ("a", 50).hash());
+        }
+
+        beginTest ("Matches String");
+        {
+            auto r = getRandom();
+            StringArray sources;
+
+            for (int i = 0; i < 64; ++i)
+                sources.add (String::repeatedString ("x", r.nextInt (60)) + String (i));
+
+            for (int i = 0; i < 2000; ++i)
+            {
+                auto& a = sources.getReference (r.nextInt (sources.size()));
+                auto& b = sources.getReference (r.nextInt (sources.size()));
+
+                SmallString smallA (a), smallB (b), copy;
+                copy = smallA;
+
+                expectEquals (copy.toString(), a);
+                expectEquals ((smallA + b).toString(), a + b);
+                expect ((smallA == smallB) == (a == b));
+                expect ((smallA < smallB) == (a.compare (b) < 0));
+                expect (smallA.isStoredInline() == (smallA.length() <= SmallString::maxInlineLength));
+
+                copy += smallB;
+                expectEquals (copy.toString(), a + b);
+            }
+        }
+    }
+};
+
+static SmallStringTests smallStringUnitTests;
+
+#endif
+
+} // namespace juce
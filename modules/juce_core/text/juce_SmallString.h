@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A string class that stores short strings inline, without any heap allocation.
+
+    A normal String always allocates a reference-counted buffer for its text, and
+    every copy of it performs an atomic increment. That's fine for most purposes,
+    but for code that creates and copies lots of very short strings (parameter names,
+    identifiers, tags, etc.) the allocations and atomic operations can add up.
+
+    A SmallString keeps any text that fits into maxInlineLength characters (in the
+    String's native encoding) in a buffer inside the object itself, so creating,
+    copying and comparing these strings never touches the heap or any atomics.
+    Longer strings fall back to being held by an ordinary String, so there's no
+    limit on the length of text that can be stored.
+
+    It's not intended as a full replacement for String - it just provides the basic
+    operations needed for storing, comparing and concatenating text, and can be
+    passed anywhere that takes a StringRef without any conversion overhead.
+
+    @code
+    SmallString name ("gain");
+    name += "_left";
+
+    myStringFunction (name);                  // takes a StringRef, so no allocation needed
+    String s = name.toString();               // only allocates if the string is stored inline
+    @endcode
+
+    @see String, StringRef
+
+    @tags{Core}
+*/
+class JUCE_API  SmallString  final
+{
+public:
+    using CharPointerType = String::CharPointerType;
+    using CharType        = CharPointerType::CharType;
+
+    /** The maximum number of encoded character units that can be stored without
+        falling back to a heap-allocated String.
+    */
+    static constexpr int maxInlineLength = (int) (23 / sizeof (CharType)) - 1;
+
+    //==============================================================================
+    /** Creates an empty string. */
+    SmallString() noexcept;
+
+    /** Creates a string from a zero-terminated ascii text string.
+        As with the String class, the text must be pure ascii - for UTF-8, use the
+        constructor that takes a CharPointer_UTF8.
+    */
+    SmallString (const char* text);
+
+    /** Creates a string from a zero-terminated text string in the String's native encoding. */
+    explicit SmallString (CharPointerType text);
+
+    /** Creates a copy of some text referred to by a StringRef. */
+    explicit SmallString (StringRef text);
+
+    /** Creates a SmallString from a String.
+        If the string is too long to be stored inline, this will share the String's
+        internal buffer rather than copying it.
+    */
+    explicit SmallString (const String& text);
+
+    /** Creates a copy of another string. */
+    SmallString (const SmallString&) noexcept;
+
+    /** Move constructor */
+    SmallString (SmallString&&) noexcept;
+
+    /** Replaces this string's contents with another string. */
+    SmallString& operator= (const SmallString&) noexcept;
+
+    /** Moves the contents of another string to the receiver */
+    SmallString& operator= (SmallString&&) noexcept;
+
+    /** Destructor. */
+    ~SmallString() noexcept;
+
+    //==============================================================================
+    /** Returns true if the string contains no characters. */
+    bool isEmpty() const noexcept                           { return numInlineUnits == 0 && heapString.isEmpty(); }
+
+    /** Returns true if the string contains at least one character. */
+    bool isNotEmpty() const noexcept                        { return ! isEmpty(); }
+
+    /** Returns the number of characters in the string. */
+    int length() const noexcept                             { return (int) getCharPointer().length(); }
+
+    /** Returns true if the text is currently held in the object's internal buffer
+        rather than in a heap-allocated String.
+    */
+    bool isStoredInline() const noexcept                    { return heapString.isEmpty(); }
+
+    //==============================================================================
+    /** Returns the character pointer currently being used to store this string.
+        The pointer is only valid until the SmallString is modified, moved or deleted.
+    */
+    CharPointerType getCharPointer() const noexcept;
+
+    /** Returns a StringRef that refers to this string's text.
+        The StringRef is only valid until the SmallString is modified, moved or deleted.
+    */
+    operator StringRef() const noexcept                     { return StringRef (getCharPointer()); }
+
+    /** Returns a String containing this text.
+        If the text is stored inline, this will need to allocate a new String.
+    */
+    String toString() const;
+
+    //==============================================================================
+    /** Appends some text to the end of this string. */
+    SmallString& operator+= (StringRef textToAppend);
+
+    /** Appends another SmallString to the end of this string. */
+    SmallString& operator+= (const SmallString& textToAppend);
+
+    /** Case-sensitive comparison with another string.
+        @returns 0 if the two strings are identical; negative if this string comes before
+                 the other one alphabetically, or positive if it comes after it.
+    */
+    int compare (StringRef other) const noexcept;
+
+    /** Case-sensitive comparison of two SmallStrings. */
+    bool operator== (const SmallString& other) const noexcept;
+    /** Case-sensitive comparison of two SmallStrings. */
+    bool operator!= (const SmallString& other) const noexcept   { return ! operator== (other); }
+    /** Case-sensitive comparison of two SmallStrings. */
+    bool operator<  (const SmallString& other) const noexcept   { return compare (other) < 0; }
+
+    /** Case-sensitive comparison with a StringRef. */
+    bool operator== (StringRef other) const noexcept            { return compare (other) == 0; }
+    /** Case-sensitive comparison with a StringRef. */
+    bool operator!= (StringRef other) const noexcept            { return compare (other) != 0; }
+
+    /** Case-sensitive comparison with a String. */
+    bool operator== (const String& other) const noexcept        { return compare (other) == 0; }
+    /** Case-sensitive comparison with a String. */
+    bool operator!= (const String& other) const noexcept        { return compare (other) != 0; }
+
+    /** Case-sensitive comparison with a string literal. */
+    bool operator== (const char* other) const noexcept          { return compare (other) == 0; }
+    /** Case-sensitive comparison with a string literal. */
+    bool operator!= (const char* other) const noexcept          { return compare (other) != 0; }
+
+    /** Generates a probably-unique hashcode from this string, matching the value that
+        String::hash() would return for the same text.
+    */
+    size_t hash() const noexcept;
+
+private:
+    //==============================================================================
+    String heapString;
+    CharType inlineText[maxInlineLength + 1] = {};
+    uint8 numInlineUnits = 0;
+
+    template <typename CharPointer>
+    void assign (CharPointer);
+    void clearInline() noexcept;
+    void copyInlineFrom (const SmallString&) noexcept;
+};
+
+/** Concatenates two strings. */
+JUCE_API SmallString JUCE_CALLTYPE operator+ (SmallString string1, StringRef string2);
+/** Concatenates two strings. */
+JUCE_API SmallString JUCE_CALLTYPE operator+ (SmallString string1, const char* string2);
+/** Concatenates two strings. */
+JUCE_API SmallString JUCE_CALLTYPE operator+ (SmallString string1, const String& string2);
+
+} // namespace juce
+
+#if ! DOXYGEN
+namespace std
+{
+    template <> struct hash<juce::SmallString>
+    {
+        size_t operator() (const juce::SmallString& s) const noexcept    { return s.hash(); }
+    };
+}
+#endif
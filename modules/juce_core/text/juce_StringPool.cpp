@@ -23,13 +23,10 @@
 namespace juce
 {
 
-static const int minNumberOfStringsForGarbageCollection = 300;
+static const int numStringPoolShards = 32;
+static const int minNumberOfStringsForGarbageCollection = 300 / numStringPoolShards;
 static const uint32 garbageCollectionInterval = 30000;
 
-
-StringPool::StringPool() noexcept  : lastGarbageCollectionTime (0) {}
-StringPool::~StringPool() {}
-
 struct StartEndString
 {
     StartEndString (String::CharPointerType s, String::CharPointerType e) noexcept : start (s), end (e) {}
@@ -58,44 +55,160 @@ static int compareStrings (const StartEndString& string1, const String& string2)
     return 0;
 }
 
-template <typename NewStringType>
-static String addPooledString (Array<String>& strings, const NewStringType& newString)
+// The hash is calculated from the unicode characters rather than the encoded bytes, so that
+// all the different ways of passing in the same string end up in the same place.
+static uint32 mixStringPoolHash (uint32 h) noexcept
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    return h ^ (h >> 16);
+}
+
+template <typename CharPointer>
+static uint32 calculateStringPoolHash (CharPointer t) noexcept
+{
+    uint32 result = 0;
+
+    while (! t.isEmpty())
+        result = 31 * result + (uint32) t.getAndAdvance();
+
+    return mixStringPoolHash (result);
+}
+
+static uint32 calculateStringPoolHash (const String& s) noexcept
 {
-    int start = 0;
-    int end = strings.size();
+    return calculateStringPoolHash (s.getCharPointer());
+}
+
+static uint32 calculateStringPoolHash (const StartEndString& s) noexcept
+{
+    uint32 result = 0;
+
+    for (auto t = s.start; t < s.end && ! t.isEmpty();)
+        result = 31 * result + (uint32) t.getAndAdvance();
+
+    return mixStringPoolHash (result);
+}
+
+//==============================================================================
+// Each shard is an open-addressed hash table with its own lock. Empty slots are
+// marked by an empty string, as the pool never stores those.
+struct StringPool::Shard
+{
+    template <typename NewStringType>
+    String findOrAdd (const NewStringType& newString, uint32 hash)
+    {
+        const SpinLock::ScopedLockType sl (lock);
+
+        if (auto* existing = find (newString, hash))
+            return existing->string;
+
+        garbageCollectIfNeeded();
+
+        if ((numUsed + 1) * 2 > (int) entries.size())
+            rehash (jmax (16, (int) entries.size() * 2));
 
-    while (start < end)
+        auto& slot = findFreeSlot (hash);
+        slot.string = newString;
+        slot.hash = hash;
+        ++numUsed;
+        return slot.string;
+    }
+
+    void garbageCollect()
+    {
+        const SpinLock::ScopedLockType sl (lock);
+        rehash ((int) entries.size());
+        lastGarbageCollectionTime = Time::getApproximateMillisecondCounter();
+    }
+
+private:
+    struct Entry
     {
-        const String& startString = strings.getReference (start);
-        const int startComp = compareStrings (newString, startString);
+        String string;
+        uint32 hash = 0;
+    };
+
+    std::vector<Entry> entries;
+    int numUsed = 0;
+    uint32 lastGarbageCollectionTime = 0;
+    SpinLock lock;
 
-        if (startComp == 0)
-            return startString;
+    template <typename NewStringType>
+    Entry* find (const NewStringType& newString, uint32 hash) noexcept
+    {
+        if (entries.empty())
+            return nullptr;
 
-        const int halfway = (start + end) / 2;
+        auto mask = entries.size() - 1;
 
-        if (halfway == start)
+        for (auto i = (size_t) hash & mask;; i = (i + 1) & mask)
         {
-            if (startComp > 0)
-                ++start;
+            auto& e = entries[i];
+
+            if (e.string.isEmpty())
+                return nullptr;
 
-            break;
+            if (e.hash == hash && compareStrings (newString, e.string) == 0)
+                return &e;
         }
+    }
+
+    Entry& findFreeSlot (uint32 hash) noexcept
+    {
+        auto mask = entries.size() - 1;
+
+        for (auto i = (size_t) hash & mask;; i = (i + 1) & mask)
+            if (entries[i].string.isEmpty())
+                return entries[i];
+    }
+
+    // Rebuilds the table with a new size, dropping any strings that are no longer
+    // referenced from outside the pool.
+    void rehash (int newSize)
+    {
+        std::vector<Entry> oldEntries ((size_t) newSize);
+        std::swap (oldEntries, entries);
+        numUsed = 0;
 
-        const String& halfwayString = strings.getReference (halfway);
-        const int halfwayComp = compareStrings (newString, halfwayString);
+        for (auto& e : oldEntries)
+        {
+            if (e.string.isNotEmpty() && e.string.getReferenceCount() > 1)
+            {
+                auto& slot = findFreeSlot (e.hash);
+                slot.string = std::move (e.string);
+                slot.hash = e.hash;
+                ++numUsed;
+            }
+        }
+    }
 
-        if (halfwayComp == 0)
-            return halfwayString;
+    void garbageCollectIfNeeded()
+    {
+        auto now = Time::getApproximateMillisecondCounter();
 
-        if (halfwayComp > 0)
-            start = halfway;
-        else
-            end = halfway;
+        if (numUsed > minNumberOfStringsForGarbageCollection
+             && now > lastGarbageCollectionTime + garbageCollectionInterval)
+        {
+            rehash ((int) entries.size());
+            lastGarbageCollectionTime = now;
+        }
     }
+};
+
+//==============================================================================
+StringPool::StringPool() noexcept  : shards (new Shard[(size_t) numStringPoolShards]) {}
+StringPool::~StringPool() {}
 
-    strings.insert (start, newString);
-    return strings.getReference (start);
+template <typename NewStringType>
+String StringPool::addPooledString (const NewStringType& newString)
+{
+    auto hash = calculateStringPoolHash (newString);
+
+    // (uses the top bits to pick a shard, and the bottom bits to pick a slot within it)
+    return shards[(size_t) (hash >> 27) % (size_t) numStringPoolShards].findOrAdd (newString, hash);
 }
 
 String StringPool::getPooledString (const char* const newString)
@@ -103,9 +216,7 @@ String StringPool::getPooledString (const char* const newString)
     if (newString == nullptr || *newString == 0)
         return {};
 
-    const ScopedLock sl (lock);
-    garbageCollectIfNeeded();
-    return addPooledString (strings, CharPointer_UTF8 (newString));
+    return addPooledString (CharPointer_UTF8 (newString));
 }
 
 String StringPool::getPooledString (String::CharPointerType start, String::CharPointerType end)
@@ -113,9 +224,7 @@ String StringPool::getPooledString (String::CharPointerType start, String::CharP
     if (start.isEmpty() || start == end)
         return {};
 
-    const ScopedLock sl (lock);
-    garbageCollectIfNeeded();
-    return addPooledString (strings, StartEndString (start, end));
+    return addPooledString (StartEndString (start, end));
 }
 
 String StringPool::getPooledString (StringRef newString)
@@ -123,9 +232,7 @@ String StringPool::getPooledString (StringRef newString)
     if (newString.isEmpty())
         return {};
 
-    const ScopedLock sl (lock);
-    garbageCollectIfNeeded();
-    return addPooledString (strings, newString.text);
+    return addPooledString (newString.text);
 }
 
 String StringPool::getPooledString (const String& newString)
@@ -133,27 +240,13 @@ String StringPool::getPooledString (const String& newString)
     if (newString.isEmpty())
         return {};
 
-    const ScopedLock sl (lock);
-    garbageCollectIfNeeded();
-    return addPooledString (strings, newString);
-}
-
-void StringPool::garbageCollectIfNeeded()
-{
-    if (strings.size() > minNumberOfStringsForGarbageCollection
-         && Time::getApproximateMillisecondCounter() > lastGarbageCollectionTime + garbageCollectionInterval)
-        garbageCollect();
+    return addPooledString (newString);
 }
 
 void StringPool::garbageCollect()
 {
-    const ScopedLock sl (lock);
-
-    for (int i = strings.size(); --i >= 0;)
-        if (strings.getReference(i).getReferenceCount() == 1)
-            strings.remove (i);
-
-    lastGarbageCollectionTime = Time::getApproximateMillisecondCounter();
+    for (int i = 0; i < numStringPoolShards; ++i)
+        shards[(size_t) i].garbageCollect();
 }
 
 StringPool& StringPool::getGlobalPool() noexcept
@@ -162,4 +255,112 @@ StringPool& StringPool::getGlobalPool() noexcept
     return pool;
 }
 
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class StringPoolTests  : public UnitTest
+{
+public:
+    StringPoolTests()
+        : UnitTest ("StringPool", UnitTestCategories::text)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Pooling");
+        {
+            StringPool pool;
+
+            auto a = pool.getPooledString ("abc");
+            expect (a == "abc");
+            expect (pool.getPooledString ("abc").getCharPointer() == a.getCharPointer());
+            expect (pool.getPooledString (String ("abc")).getCharPointer() == a.getCharPointer());
+            expect (pool.getPooledString (StringRef ("abc")).getCharPointer() == a.getCharPointer());
+
+            String longer ("abcdef");
+            auto start = longer.getCharPointer();
+            auto end = start + 3;
+            expect (pool.getPooledString (start, end).getCharPointer() == a.getCharPointer());
+
+            expect (pool.getPooledString ("abd").getCharPointer() != a.getCharPointer());
+            expect (pool.getPooledString ("").isEmpty());
+            expect (pool.getPooledString (nullptr).isEmpty());
+
+            StringArray names;
+
+            for (int i = 0; i < 2000; ++i)
+                names.add (pool.getPooledString ("name" + String (i)));
+
+            for (int i = 0; i < 2000; ++i)
+                expect (pool.getPooledString ("name" + String (i)).getCharPointer() == names[i].getCharPointer());
+        }
+
+        beginTest ("Garbage collection");
+        {
+            StringPool pool;
+            auto kept = pool.getPooledString ("kept");
+            auto keptAddress = kept.getCharPointer().getAddress();
+
+            auto temp = pool.getPooledString ("temporary");
+            expectEquals (temp.getReferenceCount(), 2);
+            temp = {};
+
+            pool.garbageCollect();
+
+            expect (pool.getPooledString ("kept").getCharPointer().getAddress() == keptAddress);
+            expect (pool.getPooledString ("temporary") == "temporary");
+        }
+
+        beginTest ("Multithreaded Identifier creation");
+        {
+            const int numThreads = 4, numNames = 1000, numRepeats = 20;
+            StringArray names;
+
+            for (int i = 0; i < numNames; ++i)
+                names.add ("parameter_" + String (i));
+
+            OwnedArray<IdentifierCreatorThread> threads;
+
+            for (int i = 0; i < numThreads; ++i)
+                threads.add (new IdentifierCreatorThread (names, numRepeats));
+
+            for (auto* t : threads)
+                t->startThread();
+
+            for (auto* t : threads)
+                t->stopThread (-1);
+
+            for (auto* t : threads)
+                for (int i = 0; i < numNames; ++i)
+                    expect (t->results[(size_t) i] == threads[0]->results[(size_t) i]);
+        }
+    }
+
+private:
+    struct IdentifierCreatorThread  : public Thread
+    {
+        IdentifierCreatorThread (const StringArray& namesToUse, int repeats)
+            : Thread ("StringPool test"), names (namesToUse), numRepeats (repeats)
+        {}
+
+        void run() override
+        {
+            results.resize ((size_t) names.size());
+
+            for (int r = 0; r < numRepeats; ++r)
+                for (int i = 0; i < names.size(); ++i)
+                    results[(size_t) i] = Identifier (names[i]);
+        }
+
+        const StringArray& names;
+        const int numRepeats;
+        std::vector<Identifier> results;
+    };
+};
+
+static StringPoolTests stringPoolUnitTests;
+
+#endif
+
 } // namespace juce
@@ -34,6 +34,10 @@ namespace juce
     compare two pooled strings for equality, as you can simply compare their pointers. It
     also cuts down on storage if you're using many copies of the same string.
 
+    Internally, the strings are spread across a set of hash tables that each have their
+    own lock, so lookups are O(1) on average, and threads that are asking for different
+    strings will rarely have to wait for each other.
+
     @tags{Core}
 */
 class JUCE_API  StringPool
@@ -78,11 +82,11 @@ public:
     static StringPool& getGlobalPool() noexcept;
 
 private:
-    Array<String> strings;
-    CriticalSection lock;
-    uint32 lastGarbageCollectionTime;
+    struct Shard;
+    std::unique_ptr<Shard[]> shards;
 
-    void garbageCollectIfNeeded();
+    template <typename NewStringType>
+    String addPooledString (const NewStringType&);
 
     JUCE_DECLARE_NON_COPYABLE (StringPool)
 };
@@ -112,6 +112,279 @@ private:
     JUCE_DECLARE_NON_COPYABLE (GZIPCompressorHelper)
 };
 
+//==============================================================================
+// Splits the incoming data into blocks which are deflated by jobs on a ThreadPool,
+// and then stitches the results together into a single zlib, gzip or raw stream.
+class GZIPCompressorOutputStream::ParallelCompressorHelper
+{
+public:
+    ParallelCompressorHelper (ThreadPool& p, int compressionLevel, int windowBits,
+                              int blockSizeToUse, BlockIndex* indexToFill)
+        : pool (p),
+          compLevel ((compressionLevel < 0 || compressionLevel > 9) ? -1 : compressionLevel),
+          format (windowBits < 0 ? rawFormat : (windowBits > MAX_WBITS ? gzipFormat : zlibFormat)),
+          blockSize ((size_t) jmax (1024, blockSizeToUse)),
+          maxBlocksInFlight (jmax (2, p.getNumThreads() * 2 + 1)),
+          index (indexToFill)
+    {
+        if (index != nullptr)
+        {
+            index->blocks.clear();
+            index->totalUncompressedSize = 0;
+        }
+    }
+
+    ~ParallelCompressorHelper()
+    {
+        // the jobs refer to the blocks, so they must all be done before we can delete anything
+        for (auto* b : pending)
+            b->finished.wait();
+    }
+
+    bool write (const uint8* data, size_t dataSize, OutputStream& out)
+    {
+        // When you call flush() on a gzip stream, the stream is closed, and you can
+        // no longer continue to write data to it!
+        jassert (! finished);
+
+        while (dataSize > 0 && ! failed)
+        {
+            if (currentBlock == nullptr)
+                currentBlock.reset (getFreeBlock());
+
+            auto numToCopy = jmin (dataSize, blockSize - currentBlock->numInputBytes);
+            memcpy (addBytesToPointer (currentBlock->input.getData(), currentBlock->numInputBytes), data, numToCopy);
+            currentBlock->numInputBytes += numToCopy;
+            data += numToCopy;
+            dataSize -= numToCopy;
+
+            if (currentBlock->numInputBytes == blockSize)
+                submitCurrentBlock (false, out);
+        }
+
+        return ! failed;
+    }
+
+    bool finish (OutputStream& out)
+    {
+        if (! finished)
+        {
+            finished = true;
+
+            if (currentBlock == nullptr)
+                currentBlock.reset (getFreeBlock());
+
+            submitCurrentBlock (true, out);
+
+            while (! pending.isEmpty())
+                writeNextPendingBlock (out);
+
+            if (! failed)
+                writeTrailer (out);
+
+            if (index != nullptr)
+                index->totalUncompressedSize = totalBytesIn;
+        }
+
+        return ! failed;
+    }
+
+private:
+    enum StreamFormat { zlibFormat, gzipFormat, rawFormat };
+
+    struct Block
+    {
+        explicit Block (size_t size)  : input (size) {}
+
+        void compress (int compLevel)
+        {
+            using namespace zlibNamespace;
+
+            z_stream stream;
+            zerostruct (stream);
+
+            if (deflateInit2 (&stream, compLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+                return;
+
+            if (dictionary.getSize() > 0)
+                deflateSetDictionary (&stream, static_cast<const Bytef*> (dictionary.getData()), (uInt) dictionary.getSize());
+
+            output.setSize (deflateBound (&stream, (uLong) numInputBytes) + 64, false);
+            size_t numOutputBytes = 0;
+
+            stream.next_in  = static_cast<Bytef*> (input.getData());
+            stream.avail_in = (z_uInt) numInputBytes;
+
+            for (;;)
+            {
+                if (numOutputBytes == output.getSize())
+                    output.setSize (output.getSize() * 2, false);
+
+                stream.next_out  = addBytesToPointer (static_cast<Bytef*> (output.getData()), numOutputBytes);
+                stream.avail_out = (z_uInt) (output.getSize() - numOutputBytes);
+
+                auto result = deflate (&stream, isLast ? Z_FINISH : Z_SYNC_FLUSH);
+                numOutputBytes = output.getSize() - stream.avail_out;
+
+                if (result == Z_STREAM_END || (result == Z_OK && ! isLast && stream.avail_out > 0))
+                {
+                    ok = true;
+                    break;
+                }
+
+                if (result != Z_OK)
+                    break;
+            }
+
+            numCompressedBytes = numOutputBytes;
+            deflateEnd (&stream);
+        }
+
+        MemoryBlock input, output, dictionary;
+        size_t numInputBytes = 0, numCompressedBytes = 0;
+        uint32 checksum = 0;
+        bool isLast = false, ok = false;
+        WaitableEvent finished { true };
+    };
+
+    ThreadPool& pool;
+    const int compLevel;
+    const StreamFormat format;
+    const size_t blockSize;
+    const int maxBlocksInFlight;
+    BlockIndex* const index;
+
+    std::unique_ptr<Block> currentBlock;
+    OwnedArray<Block> pending, spareBlocks;
+    MemoryBlock previousBlockTail;
+    int64 totalBytesIn = 0, totalBytesOut = 0;
+    uint32 runningChecksum = 0;
+    bool headerWritten = false, finished = false, failed = false;
+
+    Block* getFreeBlock()
+    {
+        if (auto* b = spareBlocks.removeAndReturn (spareBlocks.size() - 1))
+            return b;
+
+        return new Block (blockSize);
+    }
+
+    void submitCurrentBlock (bool isLast, OutputStream& out)
+    {
+        auto* b = currentBlock.release();
+        b->isLast = isLast;
+        b->ok = false;
+        b->finished.reset();
+
+        // Unless the blocks need to be decompressed independently, each one is primed with the end
+        // of the previous block, which keeps the compression ratio close to that of a single stream
+        if (index == nullptr && previousBlockTail.getSize() > 0)
+            b->dictionary = previousBlockTail;
+        else
+            b->dictionary.reset();
+
+        if (index == nullptr && ! isLast)
+        {
+            auto tailSize = jmin (b->numInputBytes, (size_t) 32768);
+            previousBlockTail.replaceWith (addBytesToPointer (b->input.getData(), b->numInputBytes - tailSize), tailSize);
+        }
+
+        const auto level = compLevel;
+        const auto useCRC = (format == gzipFormat);
+
+        pool.addJob ([b, level, useCRC]
+        {
+            using namespace zlibNamespace;
+            auto* data = static_cast<const Bytef*> (b->input.getData());
+            auto size = (uInt) b->numInputBytes;
+
+            b->checksum = useCRC ? (uint32) crc32 (crc32 (0, nullptr, 0), data, size)
+                                 : (uint32) adler32 (adler32 (0, nullptr, 0), data, size);
+            b->compress (level);
+            b->finished.signal();
+        });
+
+        pending.add (b);
+
+        while (pending.size() >= maxBlocksInFlight)
+            writeNextPendingBlock (out);
+    }
+
+    void writeNextPendingBlock (OutputStream& out)
+    {
+        using namespace zlibNamespace;
+
+        std::unique_ptr<Block> b (pending.removeAndReturn (0));
+        b->finished.wait();
+
+        if (! failed)
+        {
+            if (! headerWritten)
+                writeHeader (out);
+
+            if (! b->ok)
+                failed = true;
+
+            if (index != nullptr)
+                index->blocks.add ({ totalBytesOut, totalBytesIn });
+
+            if (format == gzipFormat)
+                runningChecksum = (uint32) crc32_combine (runningChecksum, b->checksum, (z_off_t) b->numInputBytes);
+            else
+                runningChecksum = (uint32) adler32_combine (runningChecksum, b->checksum, (z_off_t) b->numInputBytes);
+
+            if (b->numCompressedBytes > 0 && ! out.write (b->output.getData(), b->numCompressedBytes))
+                failed = true;
+
+            totalBytesIn  += (int64) b->numInputBytes;
+            totalBytesOut += (int64) b->numCompressedBytes;
+        }
+
+        b->numInputBytes = 0;
+        spareBlocks.add (b.release());
+    }
+
+    void writeHeader (OutputStream& out)
+    {
+        headerWritten = true;
+
+        if (format == gzipFormat)
+        {
+            const uint8 header[] = { 0x1f, 0x8b, 8, 0,   0, 0, 0, 0,
+                                     (uint8) (compLevel == 9 ? 2 : (compLevel == 1 ? 4 : 0)),
+                                     0xff };
+            failed = ! out.write (header, sizeof (header));
+            totalBytesOut = (int64) sizeof (header);
+            runningChecksum = 0;
+        }
+        else if (format == zlibFormat)
+        {
+            auto level = compLevel < 0 ? 6 : compLevel;
+            auto levelFlags = level < 2 ? 0 : (level < 6 ? 1 : (level == 6 ? 2 : 3));
+            auto header = (0x78 << 8) | (levelFlags << 6);
+            header += 31 - (header % 31);
+
+            failed = ! out.writeShortBigEndian ((short) header);
+            totalBytesOut = 2;
+            runningChecksum = 1;
+        }
+        else
+        {
+            runningChecksum = 1;
+        }
+    }
+
+    void writeTrailer (OutputStream& out)
+    {
+        if (format == gzipFormat)
+            failed = ! (out.writeInt ((int) runningChecksum) && out.writeInt ((int) (uint32) totalBytesIn));
+        else if (format == zlibFormat)
+            failed = ! out.writeIntBigEndian ((int) runningChecksum);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ParallelCompressorHelper)
+};
+
 //==============================================================================
 GZIPCompressorOutputStream::GZIPCompressorOutputStream (OutputStream& s, int compressionLevel, int windowBits)
    : GZIPCompressorOutputStream (&s, compressionLevel, false, windowBits)
@@ -125,6 +398,13 @@ GZIPCompressorOutputStream::GZIPCompressorOutputStream (OutputStream* out, int c
     jassert (out != nullptr);
 }
 
+GZIPCompressorOutputStream::GZIPCompressorOutputStream (OutputStream& s, ThreadPool& threadPool, int compressionLevel,
+                                                        int windowBits, int blockSize, BlockIndex* indexToFill)
+   : destStream (&s, false),
+     parallelHelper (new ParallelCompressorHelper (threadPool, compressionLevel, windowBits, blockSize, indexToFill))
+{
+}
+
 GZIPCompressorOutputStream::~GZIPCompressorOutputStream()
 {
     flush();
@@ -132,7 +412,11 @@ GZIPCompressorOutputStream::~GZIPCompressorOutputStream()
 
 void GZIPCompressorOutputStream::flush()
 {
-    helper->finish (*destStream);
+    if (parallelHelper != nullptr)
+        parallelHelper->finish (*destStream);
+    else
+        helper->finish (*destStream);
+
     destStream->flush();
 }
 
@@ -140,6 +424,9 @@ bool GZIPCompressorOutputStream::write (const void* destBuffer, size_t howMany)
 {
     jassert (destBuffer != nullptr && (ssize_t) howMany >= 0);
 
+    if (parallelHelper != nullptr)
+        return parallelHelper->write (static_cast<const uint8*> (destBuffer), howMany, *destStream);
+
     return helper->write (static_cast<const uint8*> (destBuffer), howMany, *destStream);
 }
 
@@ -154,6 +441,66 @@ bool GZIPCompressorOutputStream::setPosition (int64 /*newPosition*/)
     return false;
 }
 
+//==============================================================================
+static const int blockIndexMagicNumber = 0x78697a67;
+
+void GZIPCompressorOutputStream::BlockIndex::writeToStream (OutputStream& out) const
+{
+    out.writeInt (blockIndexMagicNumber);
+    out.writeCompressedInt (blocks.size());
+    out.writeInt64 (totalUncompressedSize);
+
+    for (auto& b : blocks)
+    {
+        out.writeInt64 (b.compressedOffset);
+        out.writeInt64 (b.uncompressedOffset);
+    }
+}
+
+bool GZIPCompressorOutputStream::BlockIndex::readFromStream (InputStream& in)
+{
+    blocks.clear();
+    totalUncompressedSize = 0;
+
+    if (in.readInt() != blockIndexMagicNumber)
+        return false;
+
+    auto numBlocks = in.readCompressedInt();
+
+    if (numBlocks < 0)
+        return false;
+
+    totalUncompressedSize = in.readInt64();
+
+    // Each block takes up 16 bytes, so a count that's too big for the rest of the stream
+    // means the data is corrupt, and mustn't be trusted for the allocation below
+    auto bytesRemaining = in.getNumBytesRemaining();
+
+    if (bytesRemaining >= 0 && (int64) numBlocks > bytesRemaining / 16)
+    {
+        totalUncompressedSize = 0;
+        return false;
+    }
+
+    blocks.ensureStorageAllocated (bytesRemaining >= 0 ? numBlocks : jmin (numBlocks, 1024));
+
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        if (in.isExhausted())
+        {
+            blocks.clear();
+            return false;
+        }
+
+        Block b;
+        b.compressedOffset   = in.readInt64();
+        b.uncompressedOffset = in.readInt64();
+        blocks.add (b);
+    }
+
+    return true;
+}
+
 
 //==============================================================================
 //==============================================================================
@@ -204,6 +551,147 @@ struct GZIPTests  : public UnitTest
                                 original.getData(),
                                 original.getDataSize()) == 0);
         }
+
+        ThreadPool pool (4);
+
+        beginTest ("Multi-threaded");
+        {
+            const int windowBits[] = { 0, GZIPCompressorOutputStream::windowBitsGZIP, GZIPCompressorOutputStream::windowBitsRaw };
+            const GZIPDecompressorInputStream::Format formats[] = { GZIPDecompressorInputStream::zlibFormat,
+                                                                    GZIPDecompressorInputStream::gzipFormat,
+                                                                    GZIPDecompressorInputStream::deflateFormat };
+
+            for (int i = 0; i < 30; ++i)
+            {
+                auto formatIndex = i % 3;
+                auto original = createTestData (rng, rng.nextInt (300000));
+                MemoryOutputStream compressed;
+
+                {
+                    GZIPCompressorOutputStream zipper (compressed, pool, rng.nextInt (10), windowBits[formatIndex],
+                                                       rng.nextInt (20000) + 1024);
+
+                    for (size_t pos = 0; pos < original.getSize();)
+                    {
+                        auto num = jmin ((size_t) rng.nextInt (50000) + 1, original.getSize() - pos);
+                        expect (zipper.write (addBytesToPointer (original.getData(), pos), num));
+                        pos += num;
+                    }
+                }
+
+                MemoryInputStream compressedInput (compressed.getData(), compressed.getDataSize(), false);
+                GZIPDecompressorInputStream unzipper (&compressedInput, false, formats[formatIndex]);
+                MemoryBlock uncompressed;
+                unzipper.readIntoMemoryBlock (uncompressed);
+
+                expect (uncompressed == original);
+            }
+        }
+
+        beginTest ("Block index");
+        {
+            auto original = createTestData (rng, 500000);
+            MemoryOutputStream compressed;
+            GZIPCompressorOutputStream::BlockIndex index;
+
+            {
+                GZIPCompressorOutputStream zipper (compressed, pool, 6, GZIPCompressorOutputStream::windowBitsGZIP, 16384, &index);
+                zipper.write (original.getData(), original.getSize());
+            }
+
+            expectEquals (index.totalUncompressedSize, (int64) original.getSize());
+            expectEquals (index.blocks.size(), (int) (original.getSize() / 16384) + 1);
+
+            MemoryOutputStream indexData;
+            index.writeToStream (indexData);
+
+            GZIPCompressorOutputStream::BlockIndex loadedIndex;
+            MemoryInputStream indexInput (indexData.getData(), indexData.getDataSize(), false);
+            expect (loadedIndex.readFromStream (indexInput));
+            expectEquals (loadedIndex.blocks.size(), index.blocks.size());
+            expectEquals (loadedIndex.totalUncompressedSize, index.totalUncompressedSize);
+
+            MemoryInputStream compressedInput (compressed.getData(), compressed.getDataSize(), false);
+            GZIPDecompressorInputStream unzipper (&compressedInput, false, GZIPDecompressorInputStream::gzipFormat);
+            unzipper.setBlockIndex (loadedIndex);
+            expectEquals (unzipper.getTotalLength(), (int64) original.getSize());
+
+            for (int i = 0; i < 50; ++i)
+            {
+                auto pos = (int64) rng.nextInt ((int) original.getSize());
+                char buffer[100];
+
+                expect (unzipper.setPosition (pos));
+                expectEquals (unzipper.getPosition(), pos);
+
+                auto numRead = unzipper.read (buffer, (int) sizeof (buffer));
+                expectEquals (numRead, (int) jmin ((int64) sizeof (buffer), (int64) original.getSize() - pos));
+                expect (memcmp (buffer, addBytesToPointer (original.getData(), pos), (size_t) numRead) == 0);
+            }
+
+            MemoryInputStream badInput (original.getData(), 100, false);
+            expect (! loadedIndex.readFromStream (badInput));
+
+            // a block count that's larger than the data that follows it must be rejected
+            MemoryOutputStream corruptData;
+            corruptData.writeInt (blockIndexMagicNumber);
+            corruptData.writeCompressedInt (std::numeric_limits<int>::max());
+            corruptData.writeInt64 (1000);
+            corruptData.writeInt64 (0);
+            corruptData.writeInt64 (0);
+
+            MemoryInputStream corruptInput (corruptData.getData(), corruptData.getDataSize(), false);
+            expect (! loadedIndex.readFromStream (corruptInput));
+            expect (loadedIndex.blocks.isEmpty());
+        }
+
+        beginTest ("Compression ratio");
+        {
+            auto original = createTestData (rng, 4000000);
+
+            auto compress = [&original] (ThreadPool* threadPool)
+            {
+                MemoryOutputStream compressed;
+
+                {
+                    std::unique_ptr<GZIPCompressorOutputStream> zipper (threadPool != nullptr ? new GZIPCompressorOutputStream (compressed, *threadPool, 6)
+                                                                                              : new GZIPCompressorOutputStream (compressed, 6));
+                    zipper->write (original.getData(), original.getSize());
+                }
+
+                return compressed.getMemoryBlock();
+            };
+
+            auto serial   = compress (nullptr);
+            auto parallel = compress (&pool);
+
+            // priming each block with the previous one's data should keep the ratio close to the serial one
+            expect (parallel.getSize() < serial.getSize() + serial.getSize() / 20);
+
+            MemoryInputStream compressedInput (parallel, false);
+            GZIPDecompressorInputStream unzipper (compressedInput);
+            MemoryBlock uncompressed;
+            unzipper.readIntoMemoryBlock (uncompressed);
+
+            expect (uncompressed == original);
+        }
+    }
+
+    // generates data with enough repetition in it to be compressible
+    static MemoryBlock createTestData (Random& rng, int size)
+    {
+        MemoryBlock data ((size_t) size);
+        StringArray words ("the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "and", "cat");
+
+        for (int pos = 0; pos < size;)
+        {
+            auto word = words[rng.nextInt (words.size())] + (rng.nextInt (20) == 0 ? String (rng.nextInt (1000)) : String (" "));
+            auto num = jmin (word.length(), size - pos);
+            memcpy (addBytesToPointer (data.getData(), pos), word.toRawUTF8(), (size_t) num);
+            pos += num;
+        }
+
+        return data;
     }
 };
 
@@ -31,6 +31,15 @@ namespace juce
     the gzip data is closed - this means that no more data can be written to
     it, and any subsequent attempts to call write() will cause an assertion.
 
+    If you create the stream with a ThreadPool, the data is split into blocks which
+    are compressed in parallel by jobs on the pool, and then written to the destination
+    stream in order, producing a single valid zlib, gzip or raw deflate stream. Each block
+    normally uses the end of the previous block as its dictionary, so the compression ratio
+    is close to that of the single-threaded mode. If you ask for a BlockIndex to be
+    generated, the blocks are compressed independently instead, and the index can later be
+    given to a GZIPDecompressorInputStream to let it jump straight to any position in the
+    uncompressed data.
+
     @see GZIPDecompressorInputStream
 
     @tags{Core}
@@ -71,6 +80,63 @@ public:
                                 bool deleteDestStreamWhenDestroyed = false,
                                 int windowBits = 0);
 
+    //==============================================================================
+    /**
+        Describes where each independently-compressed block starts in a stream that
+        was written by a multi-threaded GZIPCompressorOutputStream.
+
+        You can store this alongside the compressed data, and pass it to
+        GZIPDecompressorInputStream::setBlockIndex() to allow random access to the
+        uncompressed data without having to decompress everything before it.
+    */
+    struct JUCE_API  BlockIndex
+    {
+        /** The position of one block. */
+        struct Block
+        {
+            /** The offset of the block's data, relative to the start of the compressed stream. */
+            int64 compressedOffset;
+
+            /** The position in the uncompressed data at which the block begins. */
+            int64 uncompressedOffset;
+        };
+
+        /** The blocks, in the order in which they appear in the stream. */
+        Array<Block> blocks;
+
+        /** The total size of the uncompressed data. */
+        int64 totalUncompressedSize = 0;
+
+        /** Writes the index to a stream in a compact binary format. */
+        void writeToStream (OutputStream&) const;
+
+        /** Replaces the contents of this index with one that was written by writeToStream().
+            Returns false if the data wasn't a valid index.
+        */
+        bool readFromStream (InputStream&);
+    };
+
+    /** Creates a multi-threaded compression stream.
+
+        @param destStream           the stream into which the compressed data will be written
+        @param threadPool           the pool on which the blocks will be compressed - this must
+                                    not be deleted before the stream has been flushed or destroyed
+        @param compressionLevel     how much to compress the data, between 0 and 9 (see the other
+                                    constructor for details)
+        @param windowBits           selects the format of the output - this can be 0 for zlib format,
+                                    or one of the WindowBitsValues for a gzip or raw deflate stream
+        @param blockSize            the number of bytes of uncompressed data in each block
+        @param indexToFill          if this isn't null, the blocks will be compressed independently of
+                                    each other, and their positions will be written to this index. The
+                                    index will be complete when the stream has been flushed.
+    */
+    GZIPCompressorOutputStream (OutputStream& destStream,
+                                ThreadPool& threadPool,
+                                int compressionLevel = -1,
+                                int windowBits = 0,
+                                int blockSize = 128 * 1024,
+                                BlockIndex* indexToFill = nullptr);
+
     /** Destructor. */
     ~GZIPCompressorOutputStream() override;
 
@@ -102,6 +168,9 @@ private:
     class GZIPCompressorHelper;
     std::unique_ptr<GZIPCompressorHelper> helper;
 
+    class ParallelCompressorHelper;
+    std::unique_ptr<ParallelCompressorHelper> parallelHelper;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GZIPCompressorOutputStream)
 };
 
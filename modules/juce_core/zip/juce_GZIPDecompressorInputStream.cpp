@@ -207,9 +207,17 @@ GZIPDecompressorInputStream::~GZIPDecompressorInputStream()
 
 int64 GZIPDecompressorInputStream::getTotalLength()
 {
+    if (uncompressedStreamLength < 0 && ! blockIndex.blocks.isEmpty())
+        return blockIndex.totalUncompressedSize;
+
     return uncompressedStreamLength;
 }
 
+void GZIPDecompressorInputStream::setBlockIndex (const GZIPCompressorOutputStream::BlockIndex& newIndex)
+{
+    blockIndex = newIndex;
+}
+
 int GZIPDecompressorInputStream::read (void* destBuffer, int howMany)
 {
     jassert (destBuffer != nullptr && howMany >= 0);
@@ -274,6 +282,36 @@ int64 GZIPDecompressorInputStream::getPosition()
 
 bool GZIPDecompressorInputStream::setPosition (int64 newPos)
 {
+    if (! blockIndex.blocks.isEmpty())
+    {
+        // find the last block that starts at or before the target position..
+        int start = 0, end = blockIndex.blocks.size();
+
+        while (end - start > 1)
+        {
+            auto mid = (start + end) / 2;
+
+            if (blockIndex.blocks.getReference (mid).uncompressedOffset <= newPos)
+                start = mid;
+            else
+                end = mid;
+        }
+
+        auto& block = blockIndex.blocks.getReference (start);
+
+        // ..and jump straight to it if that's quicker than reading forwards from where we are
+        if (newPos < currentPos || block.uncompressedOffset > currentPos)
+        {
+            if (sourceStream->setPosition (originalSourcePos + block.compressedOffset))
+            {
+                isEof = false;
+                activeBufferSize = 0;
+                currentPos = block.uncompressedOffset;
+                helper.reset (new GZIPDecompressHelper (deflateFormat));
+            }
+        }
+    }
+
     if (newPos < currentPos)
     {
         // to go backwards, reset the stream and start again..
@@ -72,6 +72,19 @@ public:
     /** Destructor. */
     ~GZIPDecompressorInputStream() override;
 
+    //==============================================================================
+    /** Provides an index of independently-compressed blocks for the source data.
+
+        If the source stream was written by a multi-threaded GZIPCompressorOutputStream
+        which generated a BlockIndex, giving that index to this stream will let
+        setPosition() jump directly to the block containing the target position,
+        rather than having to decompress all of the data that comes before it.
+        This also allows getTotalLength() to return the size of the uncompressed data.
+
+        The source stream must be seekable for this to be of any use.
+    */
+    void setBlockIndex (const GZIPCompressorOutputStream::BlockIndex& index);
+
     //==============================================================================
     int64 getPosition() override;
     bool setPosition (int64 pos) override;
@@ -88,6 +101,7 @@ private:
     int activeBufferSize = 0;
     int64 originalSourcePos, currentPos = 0;
     HeapBlock<uint8> buffer;
+    GZIPCompressorOutputStream::BlockIndex blockIndex;
 
     class GZIPDecompressHelper;
     std::unique_ptr<GZIPDecompressHelper> helper;
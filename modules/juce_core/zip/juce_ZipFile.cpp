@@ -125,12 +125,17 @@ static int64 findCentralDirectoryFileHeader (InputStream& input, int& numEntries
 //==============================================================================
 struct ZipFile::ZipInputStream  : public InputStream
 {
-    ZipInputStream (ZipFile& zf, const ZipFile::ZipEntryHolder& zei)
+    ZipInputStream (ZipFile& zf, const ZipFile::ZipEntryHolder& zei, const MemoryMappedFile* mappedFile)
         : file (zf),
           zipEntryHolder (zei),
           inputStream (zf.inputStream)
     {
-        if (zf.inputSource != nullptr)
+        if (mappedFile != nullptr)
+        {
+            streamToDelete.reset (new MemoryInputStream (mappedFile->getData(), mappedFile->getSize(), false));
+            inputStream = streamToDelete.get();
+        }
+        else if (zf.inputSource != nullptr)
         {
             streamToDelete.reset (file.inputSource->createInputStream());
             inputStream = streamToDelete.get();
@@ -238,7 +243,7 @@ ZipFile::ZipFile (InputStream& stream)  : inputStream (&stream)
     init();
 }
 
-ZipFile::ZipFile (const File& file)  : inputSource (new FileInputSource (file))
+ZipFile::ZipFile (const File& file)  : inputSource (new FileInputSource (file)), sourceFile (file)
 {
     init();
 }
@@ -299,12 +304,17 @@ const ZipFile::ZipEntry* ZipFile::getEntry (const String& fileName, bool ignoreC
 }
 
 InputStream* ZipFile::createStreamForEntry (const int index)
+{
+    return createStreamForEntry (index, nullptr);
+}
+
+InputStream* ZipFile::createStreamForEntry (const int index, const MemoryMappedFile* mappedFile)
 {
     InputStream* stream = nullptr;
 
     if (auto* zei = entries[index])
     {
-        stream = new ZipInputStream (*this, *zei);
+        stream = new ZipInputStream (*this, *zei, mappedFile);
 
         if (zei->isCompressed)
         {
@@ -399,25 +409,109 @@ Result ZipFile::uncompressTo (const File& targetDirectory,
     return Result::ok();
 }
 
-Result ZipFile::uncompressEntry (int index, const File& targetDirectory, bool shouldOverwriteFiles)
+static String getEntryPath (const ZipFile::ZipEntry& entry)
 {
-    auto* zei = entries.getUnchecked (index);
-
    #if JUCE_WINDOWS
-    auto entryPath = zei->entry.filename;
+    return entry.filename;
    #else
-    auto entryPath = zei->entry.filename.replaceCharacter ('\\', '/');
+    return entry.filename.replaceCharacter ('\\', '/');
    #endif
+}
+
+static bool isDirectoryPath (const String& entryPath)
+{
+    return entryPath.endsWithChar ('/') || entryPath.endsWithChar ('\\');
+}
+
+Result ZipFile::uncompressTo (const File& targetDirectory, bool shouldOverwriteFiles, ThreadPool& threadPool)
+{
+    std::unique_ptr<MemoryMappedFile> mappedFile;
+
+    if (sourceFile != File())
+    {
+        mappedFile.reset (new MemoryMappedFile (sourceFile, MemoryMappedFile::readOnly));
+
+        if (mappedFile->getData() == nullptr)
+            mappedFile.reset();
+    }
+
+    // The folders are all created up-front, because several threads trying to create
+    // the same folder at the same time could fail.
+    Array<int> fileEntries;
+
+    for (int i = 0; i < entries.size(); ++i)
+    {
+        auto entryPath = getEntryPath (entries.getUnchecked (i)->entry);
+
+        if (entryPath.isEmpty())
+            continue;
+
+        auto targetFile = targetDirectory.getChildFile (entryPath);
+
+        if (isDirectoryPath (entryPath))
+        {
+            auto result = targetFile.createDirectory();
+
+            if (result.failed())
+                return result;
+        }
+        else
+        {
+            if (! targetFile.getParentDirectory().createDirectory())
+                return Result::fail ("Failed to create target folder: " + targetFile.getParentDirectory().getFullPathName());
+
+            fileEntries.add (i);
+        }
+    }
+
+    if (fileEntries.isEmpty())
+        return Result::ok();
+
+    std::vector<Result> results ((size_t) fileEntries.size(), Result::ok());
+    std::atomic<int> numJobsRemaining { fileEntries.size() };
+    WaitableEvent allJobsFinished;
+
+    for (int i = 0; i < fileEntries.size(); ++i)
+    {
+        threadPool.addJob ([&, i]
+        {
+            results[(size_t) i] = uncompressEntry (fileEntries.getUnchecked (i), targetDirectory,
+                                                   shouldOverwriteFiles, mappedFile.get());
+
+            if (--numJobsRemaining == 0)
+                allJobsFinished.signal();
+        });
+    }
+
+    allJobsFinished.wait();
+
+    for (auto& result : results)
+        if (result.failed())
+            return result;
+
+    return Result::ok();
+}
+
+Result ZipFile::uncompressEntry (int index, const File& targetDirectory, bool shouldOverwriteFiles)
+{
+    return uncompressEntry (index, targetDirectory, shouldOverwriteFiles, nullptr);
+}
+
+Result ZipFile::uncompressEntry (int index, const File& targetDirectory, bool shouldOverwriteFiles,
+                                 const MemoryMappedFile* mappedFile)
+{
+    auto* zei = entries.getUnchecked (index);
+    auto entryPath = getEntryPath (zei->entry);
 
     if (entryPath.isEmpty())
         return Result::ok();
 
     auto targetFile = targetDirectory.getChildFile (entryPath);
 
-    if (entryPath.endsWithChar ('/') || entryPath.endsWithChar ('\\'))
+    if (isDirectoryPath (entryPath))
         return targetFile.createDirectory(); // (entry is a directory, not a file)
 
-    std::unique_ptr<InputStream> in (createStreamForEntry (index));
+    std::unique_ptr<InputStream> in (createStreamForEntry (index, mappedFile));
 
     if (in == nullptr)
         return Result::fail ("Failed to open the zip file for reading");
@@ -469,9 +563,12 @@ struct ZipFile::Builder::Item
         symbolicLink = (file.exists() && file.isSymbolicLink());
     }
 
-    bool writeData (OutputStream& target, const int64 overallStartPosition)
+    // This may be called on a background thread before writeData(), or if it hasn't been,
+    // writeData() will call it.
+    void compressData()
     {
-        MemoryOutputStream compressedData ((size_t) file.getSize());
+        compressedData.reset (new MemoryOutputStream ((size_t) file.getSize()));
+        compressionSucceeded = true;
 
         if (symbolicLink)
         {
@@ -480,28 +577,45 @@ struct ZipFile::Builder::Item
             uncompressedSize = relativePath.length();
 
             checksum = zlibNamespace::crc32 (0, (uint8_t*) relativePath.toRawUTF8(), (unsigned int) uncompressedSize);
-            compressedData << relativePath;
+            *compressedData << relativePath;
         }
         else if (compressionLevel > 0)
         {
-            GZIPCompressorOutputStream compressor (compressedData, compressionLevel,
+            GZIPCompressorOutputStream compressor (*compressedData, compressionLevel,
                                                    GZIPCompressorOutputStream::windowBitsRaw);
-            if (! writeSource (compressor))
-                return false;
+            compressionSucceeded = writeSource (compressor);
         }
         else
         {
-            if (! writeSource (compressedData))
-                return false;
+            compressionSucceeded = writeSource (*compressedData);
         }
 
-        compressedSize = (int64) compressedData.getDataSize();
+        compressionFinished.signal();
+    }
+
+    void waitForCompression() const
+    {
+        compressionFinished.wait();
+    }
+
+    bool writeData (OutputStream& target, const int64 overallStartPosition)
+    {
+        if (compressedData == nullptr)
+            compressData();
+
+        std::unique_ptr<MemoryOutputStream> data (std::move (compressedData));
+        compressionFinished.reset();
+
+        if (! compressionSucceeded)
+            return false;
+
+        compressedSize = (int64) data->getDataSize();
         headerStart = target.getPosition() - overallStartPosition;
 
         target.writeInt (0x04034b50);
         writeFlagsAndSizes (target);
         target << storedPathname
-               << compressedData;
+               << *data;
 
         return true;
     }
@@ -529,7 +643,9 @@ private:
     int64 compressedSize = 0, uncompressedSize = 0, headerStart = 0;
     int compressionLevel = 0;
     unsigned long checksum = 0;
-    bool symbolicLink = false;
+    bool symbolicLink = false, compressionSucceeded = false;
+    std::unique_ptr<MemoryOutputStream> compressedData;
+    WaitableEvent compressionFinished;
 
     static void writeTimeAndDate (OutputStream& target, Time t)
     {
@@ -615,11 +731,58 @@ bool ZipFile::Builder::writeToStream (OutputStream& target, double* const progre
             return false;
     }
 
+    writeCentralDirectory (target, fileStart);
+
+    if (progress != nullptr)
+        *progress = 1.0;
+
+    return true;
+}
+
+bool ZipFile::Builder::writeToStream (OutputStream& target, double* const progress, ThreadPool& threadPool) const
+{
+    auto fileStart = target.getPosition();
+    auto maxItemsInProgress = jmax (1, threadPool.getNumThreads() * 2);
+    int numItemsStarted = 0;
+
+    for (int i = 0; i < items.size(); ++i)
+    {
+        for (; numItemsStarted < jmin (items.size(), i + maxItemsInProgress); ++numItemsStarted)
+        {
+            auto* item = items.getUnchecked (numItemsStarted);
+            threadPool.addJob ([item] { item->compressData(); });
+        }
+
+        if (progress != nullptr)
+            *progress = (i + 0.5) / items.size();
+
+        auto* item = items.getUnchecked (i);
+        item->waitForCompression();
+
+        if (! item->writeData (target, fileStart))
+        {
+            // the jobs that are still running refer to the items, so must finish first
+            for (int j = i + 1; j < numItemsStarted; ++j)
+                items.getUnchecked (j)->waitForCompression();
+
+            return false;
+        }
+    }
+
+    writeCentralDirectory (target, fileStart);
+
+    if (progress != nullptr)
+        *progress = 1.0;
+
+    return true;
+}
+
+void ZipFile::Builder::writeCentralDirectory (OutputStream& target, int64 fileStart) const
+{
     auto directoryStart = target.getPosition();
 
     for (auto* item : items)
-        if (! item->writeDirectoryEntry (target))
-            return false;
+        item->writeDirectoryEntry (target);
 
     auto directoryEnd = target.getPosition();
 
@@ -631,11 +794,6 @@ bool ZipFile::Builder::writeToStream (OutputStream& target, double* const progre
     target.writeInt ((int) (directoryEnd - directoryStart));
     target.writeInt ((int) (directoryStart - fileStart));
     target.writeShort (0);
-
-    if (progress != nullptr)
-        *progress = 1.0;
-
-    return true;
 }
 
 
@@ -649,6 +807,30 @@ struct ZIPTests   : public UnitTest
         : UnitTest ("ZIP", UnitTestCategories::compression)
     {}
 
+    static MemoryBlock createTestData (Random& r, size_t size)
+    {
+        // (repeated runs of random words, so that it's compressible but not trivially so)
+        MemoryBlock block (size);
+        auto* data = static_cast<uint8*> (block.getData());
+
+        for (size_t i = 0; i < size;)
+        {
+            auto word = (uint8) r.nextInt (256);
+            auto runLength = jmin ((size_t) r.nextInt (64) + 1, size - i);
+            memset (data + i, word, runLength);
+            i += runLength;
+        }
+
+        return block;
+    }
+
+    static void addEntries (ZipFile::Builder& builder, const Array<MemoryBlock>& blocks, Time time)
+    {
+        for (int i = 0; i < blocks.size(); ++i)
+            builder.addEntry (new MemoryInputStream (blocks.getReference (i), false), 6,
+                              "folder" + String (i % 3) + "/entry" + String (i), time);
+    }
+
     void runTest() override
     {
         beginTest ("ZIP");
@@ -681,6 +863,71 @@ struct ZIPTests   : public UnitTest
             std::unique_ptr<InputStream> input (zip.createStreamForEntry (*entry));
             expectEquals (input->readEntireStreamAsString(), entryName);
         }
+
+        beginTest ("Multi-threaded ZIP");
+        {
+            auto r = getRandom();
+            Array<MemoryBlock> sources;
+
+            for (int i = 0; i < 24; ++i)
+                sources.add (createTestData (r, (size_t) (r.nextInt (200000) + 1000)));
+
+            ThreadPool pool (4);
+            auto time = Time::getCurrentTime();
+
+            MemoryBlock serialData, parallelData;
+
+            {
+                ZipFile::Builder serialBuilder, parallelBuilder;
+                addEntries (serialBuilder, sources, time);
+                addEntries (parallelBuilder, sources, time);
+
+                MemoryOutputStream serialOut (serialData, false), parallelOut (parallelData, false);
+
+                expect (serialBuilder.writeToStream (serialOut, nullptr));
+
+                double progress = 0;
+                expect (parallelBuilder.writeToStream (parallelOut, &progress, pool));
+                expectEquals (progress, 1.0);
+            }
+
+            expect (serialData == parallelData);
+
+            auto tempFolder = File::createTempFile ("ziptest");
+            auto zipFile = tempFolder.getChildFile ("test.zip");
+            expect (tempFolder.createDirectory());
+            expect (zipFile.replaceWithData (parallelData.getData(), parallelData.getSize()));
+
+            {
+                ZipFile zip (zipFile);
+                expectEquals (zip.getNumEntries(), sources.size());
+
+                expect (zip.uncompressTo (tempFolder.getChildFile ("serial")).wasOk());
+                expect (zip.uncompressTo (tempFolder.getChildFile ("parallel"), true, pool).wasOk());
+            }
+
+            for (int i = 0; i < sources.size(); ++i)
+            {
+                auto path = "folder" + String (i % 3) + "/entry" + String (i);
+                MemoryBlock extracted;
+
+                expect (tempFolder.getChildFile ("parallel").getChildFile (path).loadFileAsData (extracted));
+                expect (extracted == sources.getReference (i));
+            }
+
+            {
+                // a ZipFile using a shared stream should also work
+                MemoryInputStream mi (parallelData, false);
+                ZipFile zip (mi);
+                expect (zip.uncompressTo (tempFolder.getChildFile ("fromStream"), true, pool).wasOk());
+
+                MemoryBlock extracted;
+                expect (tempFolder.getChildFile ("fromStream/folder1/entry7").loadFileAsData (extracted));
+                expect (extracted == sources.getReference (7));
+            }
+
+            tempFolder.deleteRecursively();
+        }
     }
 };
 
@@ -164,6 +164,27 @@ public:
     Result uncompressTo (const File& targetDirectory,
                          bool shouldOverwriteFiles = true);
 
+    /** Uncompresses all of the files in the zip file, using a thread pool to
+        decompress several entries at the same time.
+
+        This does the same job as the other uncompressTo() method, but each file entry is
+        extracted by a job on the thread pool that is supplied, and the method blocks until
+        all of them have finished.
+
+        If the ZipFile was created from a File, the archive is memory-mapped while the entries
+        are being read, so the threads won't have to compete for access to it. If it was created
+        with a user-supplied InputStream, then the entries will all have to share that stream,
+        which means the threads can only read from it one at a time.
+
+        @param targetDirectory      the root folder to uncompress to
+        @param shouldOverwriteFiles whether to overwrite existing files with similarly-named ones
+        @param threadPool           the pool on which the entries will be uncompressed
+        @returns success if the file is successfully unzipped
+    */
+    Result uncompressTo (const File& targetDirectory,
+                         bool shouldOverwriteFiles,
+                         ThreadPool& threadPool);
+
     /** Uncompresses one of the entries from the zip file.
 
         This will expand the entry and write it in a target directory. The entry's path is used to
@@ -227,11 +248,30 @@ public:
         */
         bool writeToStream (OutputStream& target, double* progress) const;
 
+        /** Generates the zip file, writing it to the specified stream, and using a
+            thread pool to compress several of the entries at the same time.
+
+            The entries are still written to the target stream in the order in which they
+            were added, so the resulting file is identical to the one that the other
+            writeToStream() method would produce. Only a limited number of entries are
+            compressed ahead of the one being written, to avoid holding too much of the
+            compressed data in memory.
+
+            Be careful that any streams added with addEntry() can safely be read on a
+            different thread to the one that calls this method.
+
+            If the progress parameter is non-null, it will be updated with an approximate
+            progress status between 0 and 1.0
+        */
+        bool writeToStream (OutputStream& target, double* progress, ThreadPool& threadPool) const;
+
         //==============================================================================
     private:
         struct Item;
         OwnedArray<Item> items;
 
+        void writeCentralDirectory (OutputStream&, int64 fileStart) const;
+
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Builder)
     };
 
@@ -245,6 +285,7 @@ private:
     InputStream* inputStream = nullptr;
     std::unique_ptr<InputStream> streamToDelete;
     std::unique_ptr<InputSource> inputSource;
+    File sourceFile;
 
    #if JUCE_DEBUG
     struct OpenStreamCounter
@@ -252,13 +293,15 @@ private:
         OpenStreamCounter() = default;
         ~OpenStreamCounter();
 
-        int numOpenStreams = 0;
+        std::atomic<int> numOpenStreams { 0 };
     };
 
     OpenStreamCounter streamCounter;
    #endif
 
     void init();
+    InputStream* createStreamForEntry (int index, const MemoryMappedFile*);
+    Result uncompressEntry (int index, const File& targetDirectory, bool shouldOverwriteFiles, const MemoryMappedFile*);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ZipFile)
 };
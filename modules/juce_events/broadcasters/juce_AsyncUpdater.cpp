@@ -37,9 +37,116 @@ public:
     AsyncUpdater& owner;
     Atomic<int> shouldDeliver;
 
+    // used by the CoalescedDispatcher
+    AsyncUpdaterMessage* nextPending = nullptr;
+    std::atomic<bool> isQueued { false };
+
     JUCE_DECLARE_NON_COPYABLE (AsyncUpdaterMessage)
 };
 
+//==============================================================================
+/*  Rather than each AsyncUpdater posting its own message, the ones that have been
+    triggered are pushed onto a lock-free intrusive list. Only the updater that finds
+    the list empty posts a message, and when that arrives the message thread delivers
+    everything that's in the list in one go, in the order they were triggered.
+
+    This means that triggering thousands of updaters in a burst only puts a single
+    message into the system queue.
+*/
+struct AsyncUpdater::CoalescedDispatcher
+{
+    static bool add (AsyncUpdaterMessage& message)
+    {
+        // this message is already waiting in the list
+        if (message.isQueued.exchange (true))
+            return true;
+
+        message.incReferenceCount();
+        auto* head = pending.load (std::memory_order_relaxed);
+
+        do
+        {
+            message.nextPending = head;
+        }
+        while (! pending.compare_exchange_weak (head, &message, std::memory_order_release, std::memory_order_relaxed));
+
+        if (head != nullptr)
+            return true;
+
+        if ((new DispatchMessage())->post())
+            return true;
+
+        // The message queue has gone away, so nothing in the list will be delivered
+        releaseAll (pending.exchange (nullptr, std::memory_order_acquire), false);
+        return false;
+    }
+
+    static void dispatchAll()
+    {
+        // The list holds the most recently triggered updater first, so it needs reversing
+        auto* item = pending.exchange (nullptr, std::memory_order_acquire);
+        AsyncUpdaterMessage* reversed = nullptr;
+
+        while (item != nullptr)
+        {
+            auto* next = item->nextPending;
+            item->nextPending = reversed;
+            reversed = item;
+            item = next;
+        }
+
+        releaseAll (reversed, true);
+    }
+
+    static void releaseAll (AsyncUpdaterMessage* item, bool deliver)
+    {
+        while (item != nullptr)
+        {
+            ReferenceCountedObjectPtr<AsyncUpdaterMessage> message (item);
+            item->decReferenceCount();
+            item = item->nextPending;
+
+            // clear the flag first, so that a callback can trigger its own updater again
+            message->isQueued = false;
+
+            if (deliver)
+            {
+                JUCE_TRY
+                {
+                    message->messageCallback();
+                }
+                JUCE_CATCH_EXCEPTION
+            }
+            else
+            {
+                message->shouldDeliver.set (0);
+            }
+        }
+    }
+
+    struct DispatchMessage  : public CallbackMessage
+    {
+        ~DispatchMessage() override
+        {
+            // if the message queue was shut down before this arrived, just release the updaters
+            if (! delivered)
+                releaseAll (pending.exchange (nullptr, std::memory_order_acquire), false);
+        }
+
+        void messageCallback() override
+        {
+            delivered = true;
+            dispatchAll();
+        }
+
+        bool delivered = false;
+    };
+
+    static std::atomic<AsyncUpdaterMessage*> pending;
+};
+
+std::atomic<AsyncUpdater::AsyncUpdaterMessage*> AsyncUpdater::CoalescedDispatcher::pending { nullptr };
+
 //==============================================================================
 AsyncUpdater::AsyncUpdater()
 {
@@ -66,7 +173,7 @@ void AsyncUpdater::triggerAsyncUpdate()
     JUCE_ASSERT_MESSAGE_MANAGER_EXISTS
 
     if (activeMessage->shouldDeliver.compareAndSetBool (1, 0))
-        if (! activeMessage->post())
+        if (! CoalescedDispatcher::add (*activeMessage))
             cancelPendingUpdate(); // if the message queue fails, this avoids getting
                                    // trapped waiting for the message to arrive
 }
@@ -90,4 +197,138 @@ bool AsyncUpdater::isUpdatePending() const noexcept
     return activeMessage->shouldDeliver.value != 0;
 }
 
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AsyncUpdaterTests  : public UnitTest
+{
+public:
+    AsyncUpdaterTests()
+        : UnitTest ("AsyncUpdater", UnitTestCategories::threads)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Delivery");
+        {
+            Array<int> order;
+            OwnedArray<TestUpdater> updaters;
+
+            for (int i = 0; i < 10; ++i)
+                updaters.add (new TestUpdater ([&order, i] (TestUpdater&) { order.add (i); }));
+
+            for (int i = 9; i >= 0; --i)
+                updaters[i]->triggerAsyncUpdate();
+
+            updaters[9]->triggerAsyncUpdate();
+            updaters[3]->cancelPendingUpdate();
+            updaters[5]->handleUpdateNowIfNeeded();
+            updaters.remove (7);
+
+            expect (updaters[0]->isUpdatePending());
+            expect (! updaters[3]->isUpdatePending());
+
+            UnitTestHelpers::runMessageLoopUntil ([&] { return order.size() == 8; });
+            UnitTestHelpers::runMessageLoopUntil ([] { return false; }, 20);
+
+            expectEquals (order.size(), 8);
+            expectEquals (order[0], 5);
+
+            // the remaining updaters should arrive in the order they were triggered
+            const int expected[] = { 9, 8, 6, 4, 2, 1, 0 };
+
+            for (int i = 0; i < numElementsInArray (expected); ++i)
+                expectEquals (order[i + 1], expected[i]);
+        }
+
+        beginTest ("Retriggering from a callback");
+        {
+            int numCallbacks = 0;
+
+            TestUpdater updater ([&] (TestUpdater& u)
+            {
+                if (++numCallbacks < 5)
+                    u.triggerAsyncUpdate();
+            });
+
+            updater.triggerAsyncUpdate();
+            UnitTestHelpers::runMessageLoopUntil ([&] { return numCallbacks == 5; });
+
+            expectEquals (numCallbacks, 5);
+            expect (! updater.isUpdatePending());
+        }
+
+        beginTest ("Triggering from several threads");
+        {
+            const int numUpdaters = 500;
+            OwnedArray<TestUpdater> updaters;
+            int numCallbacks = 0;
+
+            for (int i = 0; i < numUpdaters; ++i)
+                updaters.add (new TestUpdater ([&] (TestUpdater&) { ++numCallbacks; }));
+
+            {
+                OwnedArray<UnitTestHelpers::BackgroundThread> threads;
+
+                for (int t = 0; t < 4; ++t)
+                    threads.add (new UnitTestHelpers::BackgroundThread ([&]
+                    {
+                        for (int repeat = 0; repeat < 20; ++repeat)
+                            for (auto* u : updaters)
+                                u->triggerAsyncUpdate();
+                    }));
+            }
+
+            UnitTestHelpers::runMessageLoopUntil ([&] { return std::none_of (updaters.begin(), updaters.end(),
+                                                                             [] (TestUpdater* u) { return u->isUpdatePending(); }); });
+
+            expect (numCallbacks >= numUpdaters);
+            expect (numCallbacks <= numUpdaters * 80);
+        }
+
+        beginTest ("Many updaters triggered each frame");
+        {
+            const int numUpdaters = 2000, numFrames = 10;
+            OwnedArray<TestUpdater> updaters;
+            int numCallbacks = 0;
+
+            for (int i = 0; i < numUpdaters; ++i)
+                updaters.add (new TestUpdater ([&] (TestUpdater&) { ++numCallbacks; }));
+
+            for (int frame = 0; frame < numFrames; ++frame)
+            {
+                {
+                    UnitTestHelpers::BackgroundThread trigger ([&]
+                    {
+                        for (auto* u : updaters)
+                        {
+                            u->triggerAsyncUpdate();
+                            u->triggerAsyncUpdate();
+                        }
+                    });
+                }
+
+                // each updater is called once per frame, however many times it was triggered
+                UnitTestHelpers::runMessageLoopUntil ([&] { return numCallbacks >= (frame + 1) * numUpdaters; }, 5000);
+                expectEquals (numCallbacks, (frame + 1) * numUpdaters);
+            }
+        }
+    }
+
+    struct TestUpdater  : public AsyncUpdater
+    {
+        TestUpdater (std::function<void (TestUpdater&)> fn)  : callback (std::move (fn)) {}
+
+        void handleAsyncUpdate() override   { callback (*this); }
+
+        std::function<void (TestUpdater&)> callback;
+    };
+};
+
+static AsyncUpdaterTests asyncUpdaterTests;
+
+#endif
+
 } // namespace juce
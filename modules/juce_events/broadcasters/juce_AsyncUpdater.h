@@ -57,8 +57,20 @@ public:
         If an update callback is already pending but hasn't happened yet, calling
         this method will have no effect.
 
+        Updaters that are triggered at around the same time are delivered together,
+        so a burst of calls to this method on lots of different AsyncUpdaters will
+        only post a single message to the system queue.
+
+        Because of this, the callback isn't ordered with respect to other messages.
+        If another AsyncUpdater has already been triggered and is still waiting, this
+        one joins the message that was posted for it, so its callback may happen before
+        a message that was posted in between - e.g. with MessageManager::callAsync().
+        Updaters are always called back in the order in which they were triggered, but
+        if you need a callback to happen after some other message, post both of them
+        in the same way.
+
         It's thread-safe to call this method from any thread, BUT beware of calling
-        it from a real-time (e.g. audio) thread, because it involves posting a message
+        it from a real-time (e.g. audio) thread, because it may involve posting a message
         to the system queue, which means it may block (and in general will do on
         most OSes).
     */
@@ -101,6 +113,7 @@ public:
 private:
     //==============================================================================
     class AsyncUpdaterMessage;
+    struct CoalescedDispatcher;
     friend class ReferenceCountedObjectPtr<AsyncUpdaterMessage>;
     ReferenceCountedObjectPtr<AsyncUpdaterMessage> activeMessage;
 
@@ -28,6 +28,9 @@ enum { magicMastSlaveConnectionHeader = 0x712baf04 };
 static const char* startMessage = "__ipc_st";
 static const char* killMessage  = "__ipc_k_";
 static const char* pingMessage  = "__ipc_p_";
+static const char* sharedMemoryMessage = "__ipc_sm";
+static const char* sharedMemoryOpenedMessage = "__ipc_so";
+static const char* sharedMemoryFailedMessage = "__ipc_sf";
 enum { specialMessageSize = 8, defaultTimeoutMs = 8000 };
 
 static bool isMessageType (const MemoryBlock& mb, const char* messageType) noexcept
@@ -81,6 +84,95 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChildProcessPingThread)
 };
 
+//==============================================================================
+// Streams blocks of data in both directions through a pair of shared-memory ring
+// buffers, with a thread that delivers each incoming block to a callback.
+struct ChildProcessSharedMemoryChannel  : private Thread
+{
+    ChildProcessSharedMemoryChannel (std::function<void (const MemoryBlock&)> callback)
+        : Thread ("IPC shared memory"), handleBlock (std::move (callback))
+    {
+    }
+
+    ~ChildProcessSharedMemoryChannel() override
+    {
+        outgoing.close();
+        incoming.close();
+        stopThread (4000);
+    }
+
+    bool create (const String& pipeName, int bufferSize)
+    {
+        return start (outgoing.create (pipeName + "_ms", bufferSize)
+                       && incoming.create (pipeName + "_sm", bufferSize));
+    }
+
+    bool openExisting (const String& pipeName)
+    {
+        return start (incoming.openExisting (pipeName + "_ms")
+                       && outgoing.openExisting (pipeName + "_sm"));
+    }
+
+    bool send (const void* data, size_t numBytes, int timeOutMilliseconds)
+    {
+        return numBytes <= (size_t) outgoing.getMaxBlockSize()
+                && outgoing.write (data, (int) numBytes, timeOutMilliseconds);
+    }
+
+private:
+    SharedMemoryRingBuffer incoming, outgoing;
+    std::function<void (const MemoryBlock&)> handleBlock;
+
+    bool start (bool openedSuccessfully)
+    {
+        if (openedSuccessfully)
+            startThread (8);
+
+        return openedSuccessfully;
+    }
+
+    void run() override
+    {
+        MemoryBlock block;
+
+        while (! threadShouldExit())
+        {
+            if (incoming.read (block, 100))
+                handleBlock (block);
+            else if (incoming.isClosed())
+                break;
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ChildProcessSharedMemoryChannel)
+};
+
+//==============================================================================
+// Holds a connection's shared-memory channel, which gets set up on the connection's
+// thread while other threads may already be trying to send data through it.
+struct ChildProcessSharedMemoryHolder
+{
+    void set (std::unique_ptr<ChildProcessSharedMemoryChannel> newChannel)
+    {
+        {
+            const ScopedLock sl (lock);
+            std::swap (channel, newChannel);
+        }
+
+        // the old channel (if any) is deleted here, now that no-one can be sending through it
+    }
+
+    bool send (const void* data, size_t numBytes, int timeOutMilliseconds)
+    {
+        const ScopedLock sl (lock);
+        return channel != nullptr && channel->send (data, numBytes, timeOutMilliseconds);
+    }
+
+private:
+    CriticalSection lock;
+    std::unique_ptr<ChildProcessSharedMemoryChannel> channel;
+};
+
 //==============================================================================
 struct ChildProcessMaster::Connection  : public InterprocessConnection,
                                          private ChildProcessPingThread
@@ -99,7 +191,18 @@ struct ChildProcessMaster::Connection  : public InterprocessConnection,
         stopThread (10000);
     }
 
+    // Waits for the slave to say whether it managed to open its end of the shared-memory channel
+    bool waitForSharedMemoryToOpen (int timeoutMilliseconds)
+    {
+        return sharedMemoryReplyReceived.wait (timeoutMilliseconds) && sharedMemoryOpened;
+    }
+
+    ChildProcessSharedMemoryHolder sharedMemory;
+
 private:
+    WaitableEvent sharedMemoryReplyReceived;
+    std::atomic<bool> sharedMemoryOpened { false };
+
     void connectionMade() override  {}
     void connectionLost() override  { owner.handleConnectionLost(); }
 
@@ -110,8 +213,20 @@ private:
     {
         pingReceived();
 
-        if (m.getSize() != specialMessageSize || ! isMessageType (m, pingMessage))
-            owner.handleMessageFromSlave (m);
+        if (m.getSize() == specialMessageSize)
+        {
+            if (isMessageType (m, pingMessage))
+                return;
+
+            if (isMessageType (m, sharedMemoryOpenedMessage) || isMessageType (m, sharedMemoryFailedMessage))
+            {
+                sharedMemoryOpened = isMessageType (m, sharedMemoryOpenedMessage);
+                sharedMemoryReplyReceived.signal();
+                return;
+            }
+        }
+
+        owner.handleMessageFromSlave (m);
     }
 
     ChildProcessMaster& owner;
@@ -128,6 +243,7 @@ ChildProcessMaster::~ChildProcessMaster()
 }
 
 void ChildProcessMaster::handleConnectionLost() {}
+void ChildProcessMaster::handleBulkDataFromSlave (const MemoryBlock&) {}
 
 bool ChildProcessMaster::sendMessageToSlave (const MemoryBlock& mb)
 {
@@ -138,8 +254,17 @@ bool ChildProcessMaster::sendMessageToSlave (const MemoryBlock& mb)
     return false;
 }
 
+bool ChildProcessMaster::sendBulkDataToSlave (const void* data, size_t numBytes, int timeOutMilliseconds)
+{
+    if (connection != nullptr)
+        return connection->sharedMemory.send (data, numBytes, timeOutMilliseconds);
+
+    jassertfalse; // this can only be used when the connection is active!
+    return false;
+}
+
 bool ChildProcessMaster::launchSlaveProcess (const File& executable, const String& commandLineUniqueID,
-                                             int timeoutMs, int streamFlags)
+                                             int timeoutMs, int streamFlags, int sharedMemoryBufferSize)
 {
     killSlaveProcess();
 
@@ -153,10 +278,26 @@ bool ChildProcessMaster::launchSlaveProcess (const File& executable, const Strin
 
     if (childProcess->start (args, streamFlags))
     {
-        connection.reset (new Connection (*this, pipeName, timeoutMs <= 0 ? defaultTimeoutMs : timeoutMs));
+        if (timeoutMs <= 0)
+            timeoutMs = defaultTimeoutMs;
+
+        connection.reset (new Connection (*this, pipeName, timeoutMs));
 
         if (connection->isConnected())
         {
+            if (sharedMemoryBufferSize > 0)
+            {
+                std::unique_ptr<ChildProcessSharedMemoryChannel> channel (new ChildProcessSharedMemoryChannel ([this] (const MemoryBlock& m) { handleBulkDataFromSlave (m); }));
+
+                // The slave opens its end of the channel before it gets the start message, and
+                // replies to say whether it managed to. If it didn't, nothing would ever read
+                // from the channel, so it's not kept.
+                if (channel->create (pipeName, sharedMemoryBufferSize)
+                     && sendMessageToSlave ({ sharedMemoryMessage, specialMessageSize })
+                     && connection->waitForSharedMemoryToOpen (timeoutMs))
+                    connection->sharedMemory.set (std::move (channel));
+            }
+
             sendMessageToSlave ({ startMessage, specialMessageSize });
             return true;
         }
@@ -183,10 +324,10 @@ void ChildProcessMaster::killSlaveProcess()
 struct ChildProcessSlave::Connection  : public InterprocessConnection,
                                         private ChildProcessPingThread
 {
-    Connection (ChildProcessSlave& p, const String& pipeName, int timeout)
+    Connection (ChildProcessSlave& p, const String& pipe, int timeout)
         : InterprocessConnection (false, magicMastSlaveConnectionHeader),
           ChildProcessPingThread (timeout),
-          owner (p)
+          owner (p), pipeName (pipe)
     {
         connectToPipe (pipeName, timeoutMs);
         startThread (4);
@@ -197,8 +338,11 @@ struct ChildProcessSlave::Connection  : public InterprocessConnection,
         stopThread (10000);
     }
 
+    ChildProcessSharedMemoryHolder sharedMemory;
+
 private:
     ChildProcessSlave& owner;
+    const String pipeName;
 
     void connectionMade() override  {}
     void connectionLost() override  { owner.handleConnectionLost(); }
@@ -219,6 +363,18 @@ private:
         if (isMessageType (m, startMessage))
             return owner.handleConnectionMade();
 
+        if (isMessageType (m, sharedMemoryMessage))
+        {
+            std::unique_ptr<ChildProcessSharedMemoryChannel> channel (new ChildProcessSharedMemoryChannel ([this] (const MemoryBlock& b) { owner.handleBulkDataFromMaster (b); }));
+            auto opened = channel->openExisting (pipeName);
+
+            if (opened)
+                sharedMemory.set (std::move (channel));
+
+            sendMessage ({ opened ? sharedMemoryOpenedMessage : sharedMemoryFailedMessage, specialMessageSize });
+            return;
+        }
+
         owner.handleMessageFromMaster (m);
     }
 
@@ -231,6 +387,7 @@ ChildProcessSlave::~ChildProcessSlave() {}
 
 void ChildProcessSlave::handleConnectionMade() {}
 void ChildProcessSlave::handleConnectionLost() {}
+void ChildProcessSlave::handleBulkDataFromMaster (const MemoryBlock&) {}
 
 bool ChildProcessSlave::sendMessageToMaster (const MemoryBlock& mb)
 {
@@ -241,6 +398,15 @@ bool ChildProcessSlave::sendMessageToMaster (const MemoryBlock& mb)
     return false;
 }
 
+bool ChildProcessSlave::sendBulkDataToMaster (const void* data, size_t numBytes, int timeOutMilliseconds)
+{
+    if (connection != nullptr)
+        return connection->sharedMemory.send (data, numBytes, timeOutMilliseconds);
+
+    jassertfalse; // this can only be used when the connection is active!
+    return false;
+}
+
 bool ChildProcessSlave::initialiseFromCommandLine (const String& commandLine,
                                                    const String& commandLineUniqueID,
                                                    int timeoutMs)
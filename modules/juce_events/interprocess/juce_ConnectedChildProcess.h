@@ -102,6 +102,31 @@ public:
     */
     bool sendMessageToMaster (const MemoryBlock&);
 
+    //==============================================================================
+    /** This will be called to deliver blocks of data that the master process sends with
+        ChildProcessMaster::sendBulkDataToSlave().
+
+        The call will be made on a high-priority background thread which is dedicated to
+        reading the shared-memory channel, so be careful with your thread-safety!
+    */
+    virtual void handleBulkDataFromMaster (const MemoryBlock&);
+
+    /** Sends a block of data to the master using the shared-memory channel.
+
+        This is only possible if the master launched this process with a non-zero
+        sharedMemoryBufferSize, and can be used once handleConnectionMade() has been called.
+        It's intended for streaming large amounts of data such as audio or MIDI buffers,
+        and is much faster than sendMessageToMaster(), which should still be used for
+        control messages.
+
+        If the buffer is full, this will wait for up to the given number of milliseconds for
+        the master to read enough data to make room. Returns false if the channel isn't
+        available, the block is too big for it, or the timeout expires.
+        If successful, the data will emerge in a call to your
+        ChildProcessMaster::handleBulkDataFromSlave().
+    */
+    bool sendBulkDataToMaster (const void* data, size_t numBytes, int timeOutMilliseconds = 1000);
+
 private:
     struct Connection;
     std::unique_ptr<Connection> connection;
@@ -160,11 +185,19 @@ public:
 
         If a child process is already running, this will call killSlaveProcess() and
         start a new one.
+
+        If sharedMemoryBufferSize is greater than zero, a pair of SharedMemoryRingBuffers of
+        this size will also be created, so that sendBulkDataToSlave() and
+        ChildProcessSlave::sendBulkDataToMaster() can be used to stream data between the
+        processes. This waits for the slave to confirm that it has opened its end of the
+        channel, and if shared memory isn't available on this platform or the slave can't
+        open it, the launch will still succeed, but those methods will return false.
     */
     bool launchSlaveProcess (const File& executableToLaunch,
                              const String& commandLineUniqueID,
                              int timeoutMs = 0,
-                             int streamFlags = ChildProcess::wantStdOut | ChildProcess::wantStdErr);
+                             int streamFlags = ChildProcess::wantStdOut | ChildProcess::wantStdErr,
+                             int sharedMemoryBufferSize = 0);
 
     /** Sends a kill message to the slave, and disconnects from it.
         Note that this won't wait for it to terminate.
@@ -188,6 +221,30 @@ public:
     */
     bool sendMessageToSlave (const MemoryBlock&);
 
+    //==============================================================================
+    /** This will be called to deliver blocks of data that the slave process sends with
+        ChildProcessSlave::sendBulkDataToMaster().
+
+        The call will be made on a high-priority background thread which is dedicated to
+        reading the shared-memory channel, so be careful with your thread-safety!
+    */
+    virtual void handleBulkDataFromSlave (const MemoryBlock&);
+
+    /** Sends a block of data to the slave using the shared-memory channel.
+
+        This is only possible if the slave was launched with a non-zero sharedMemoryBufferSize.
+        It's intended for streaming large amounts of data such as audio or MIDI buffers,
+        and is much faster than sendMessageToSlave(), which should still be used for
+        control messages.
+
+        If the buffer is full, this will wait for up to the given number of milliseconds for
+        the slave to read enough data to make room. Returns false if the channel isn't
+        available, the block is too big for it, or the timeout expires.
+        If successful, the data will emerge in a call to your
+        ChildProcessSlave::handleBulkDataFromMaster().
+    */
+    bool sendBulkDataToSlave (const void* data, size_t numBytes, int timeOutMilliseconds = 1000);
+
 private:
     std::unique_ptr<ChildProcess> childProcess;
 
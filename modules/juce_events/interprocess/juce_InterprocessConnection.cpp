@@ -70,11 +70,523 @@ class InterprocessConnection::SafeAction : public SafeActionImpl
     using SafeActionImpl::SafeActionImpl;
 };
 
+//==============================================================================
+// Keeps hold of the buffers of messages that have been delivered, so that they can
+// be re-used for incoming messages rather than allocating a new block for each one.
+class MessageBufferPoolImpl
+{
+public:
+    MemoryBlock take (size_t size)
+    {
+        MemoryBlock block;
+
+        {
+            const SpinLock::ScopedLockType sl (lock);
+
+            if (! spareBlocks.empty())
+            {
+                block = std::move (spareBlocks.back());
+                spareBlocks.pop_back();
+            }
+        }
+
+        block.setSize (size, false);
+        return block;
+    }
+
+    void recycle (MemoryBlock&& block)
+    {
+        if (block.getSize() == 0 || block.getSize() > maxPooledBlockSize)
+            return;
+
+        const SpinLock::ScopedLockType sl (lock);
+
+        if (spareBlocks.size() < maxPooledBlocks)
+            spareBlocks.push_back (std::move (block));
+    }
+
+private:
+    enum { maxPooledBlocks = 16, maxPooledBlockSize = 1024 * 1024 };
+
+    SpinLock lock;
+    std::vector<MemoryBlock> spareBlocks;
+};
+
+class InterprocessConnection::MessageBufferPool : public MessageBufferPoolImpl
+{
+};
+
+//==============================================================================
+/*  Services the sockets of many connections using a small pool of threads.
+
+    Each socket is registered with epoll using EPOLLONESHOT, so that only one thread
+    at a time can be handling a particular socket. When its handler returns, the
+    socket is re-armed with whichever events its client is interested in next.
+*/
+class InterprocessConnection::SocketReactor
+{
+public:
+    struct Client
+    {
+        virtual ~Client() = default;
+
+        /** Called on one of the I/O threads when the socket is ready.
+            Return false to stop the socket being watched.
+        */
+        virtual bool handleSocketEvents (bool readable, bool writable) = 0;
+
+        /** Returns true if the client has some data queued that it wants to send. */
+        virtual bool wantsToWrite() const = 0;
+
+        uint64 reactorID = 0;
+    };
+
+    explicit SocketReactor (int numThreads)
+    {
+       #if JUCE_LINUX
+        epollHandle = epoll_create1 (EPOLL_CLOEXEC);
+        wakeHandle = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+        if (epollHandle >= 0 && wakeHandle >= 0)
+        {
+            epoll_event event {};
+            event.events = EPOLLIN;
+            event.data.u64 = 0;
+
+            if (epoll_ctl (epollHandle, EPOLL_CTL_ADD, wakeHandle, &event) == 0)
+            {
+                for (int i = 0; i < jmax (1, numThreads); ++i)
+                {
+                    threads.add (new IOThread (*this));
+                    threads.getLast()->startThread();
+                }
+            }
+        }
+       #else
+        ignoreUnused (numThreads);
+       #endif
+    }
+
+    ~SocketReactor()
+    {
+        for (auto* t : threads)
+            t->signalThreadShouldExit();
+
+       #if JUCE_LINUX
+        if (wakeHandle >= 0)
+        {
+            // the eventfd is never read, so it stays signalled and wakes every thread
+            uint64_t one = 1;
+            ignoreUnused (::write (wakeHandle, &one, sizeof (one)));
+        }
+       #endif
+
+        for (auto* t : threads)
+            t->stopThread (4000);
+
+        threads.clear();
+
+        // All the clients must have been removed before the reactor is deleted!
+        jassert (registrations.empty());
+
+       #if JUCE_LINUX
+        if (wakeHandle >= 0)   ::close (wakeHandle);
+        if (epollHandle >= 0)  ::close (epollHandle);
+       #endif
+    }
+
+    bool isValid() const noexcept       { return ! threads.isEmpty(); }
+
+    bool addClient (Client& client, int socketHandle)
+    {
+        const ScopedLock sl (lock);
+
+        client.reactorID = ++lastID;
+        Registration r { &client, socketHandle };
+        registrations[client.reactorID] = r;
+
+        if (! updateEvents (r, false))
+        {
+            registrations.erase (client.reactorID);
+            return false;
+        }
+
+        return true;
+    }
+
+    void removeClient (Client& client)
+    {
+        {
+            const ScopedLock sl (lock);
+            auto r = registrations.find (client.reactorID);
+
+            if (r == registrations.end())
+                return;
+
+           #if JUCE_LINUX
+            epoll_ctl (epollHandle, EPOLL_CTL_DEL, r->second.socketHandle, nullptr);
+           #endif
+
+            if (! r->second.isBeingHandled)
+            {
+                registrations.erase (r);
+                return;
+            }
+
+            r->second.isRemoved = true;
+
+            // if this is being called from inside the client's own callback, the
+            // registration will be cleaned up when the callback returns
+            if (r->second.handlingThread == Thread::getCurrentThreadId())
+                return;
+        }
+
+        for (;;)
+        {
+            {
+                const ScopedLock sl (lock);
+
+                if (registrations.find (client.reactorID) == registrations.end())
+                    return;
+            }
+
+            handlerFinished.wait (5);
+        }
+    }
+
+    void clientWantsToWrite (Client& client)
+    {
+        const ScopedLock sl (lock);
+        auto r = registrations.find (client.reactorID);
+
+        // if the client is currently being handled, its events will be updated afterwards
+        if (r != registrations.end() && ! r->second.isBeingHandled && ! r->second.isRemoved)
+            updateEvents (r->second, true);
+    }
+
+private:
+    //==============================================================================
+    struct Registration
+    {
+        Client* client;
+        int socketHandle;
+        bool isBeingHandled = false, isRemoved = false;
+        Thread::ThreadID handlingThread = {};
+    };
+
+    struct IOThread  : public Thread
+    {
+        IOThread (SocketReactor& r)  : Thread ("JUCE IPC reactor"), owner (r) {}
+        void run() override     { owner.runIOThread (*this); }
+
+        SocketReactor& owner;
+        JUCE_DECLARE_NON_COPYABLE (IOThread)
+    };
+
+    CriticalSection lock;
+    std::map<uint64, Registration> registrations;
+    uint64 lastID = 0;
+    WaitableEvent handlerFinished;
+    OwnedArray<IOThread> threads;
+    int epollHandle = -1, wakeHandle = -1;
+
+    bool updateEvents (const Registration& r, bool isAlreadyRegistered)
+    {
+       #if JUCE_LINUX
+        epoll_event event {};
+        event.events = EPOLLIN | EPOLLONESHOT | (r.client->wantsToWrite() ? (uint32) EPOLLOUT : 0u);
+        event.data.u64 = r.client->reactorID;
+
+        return epoll_ctl (epollHandle, isAlreadyRegistered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+                          r.socketHandle, &event) == 0;
+       #else
+        ignoreUnused (r, isAlreadyRegistered);
+        return false;
+       #endif
+    }
+
+    void runIOThread (Thread& thread)
+    {
+       #if JUCE_LINUX
+        epoll_event events[16];
+
+        while (! thread.threadShouldExit())
+        {
+            auto numEvents = epoll_wait (epollHandle, events, numElementsInArray (events), -1);
+
+            if (numEvents < 0 && errno != EINTR)
+                break;
+
+            for (int i = 0; i < numEvents && ! thread.threadShouldExit(); ++i)
+                if (events[i].data.u64 != 0)
+                    handleEvents (events[i].data.u64, events[i].events);
+        }
+       #else
+        ignoreUnused (thread);
+       #endif
+    }
+
+    void handleEvents (uint64 clientID, uint32 events)
+    {
+        Client* client = nullptr;
+
+        {
+            const ScopedLock sl (lock);
+            auto r = registrations.find (clientID);
+
+            if (r == registrations.end() || r->second.isRemoved)
+                return;
+
+            r->second.isBeingHandled = true;
+            r->second.handlingThread = Thread::getCurrentThreadId();
+            client = r->second.client;
+        }
+
+       #if JUCE_LINUX
+        auto keepWatching = client->handleSocketEvents ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0,
+                                                        (events & EPOLLOUT) != 0);
+       #else
+        auto keepWatching = client->handleSocketEvents (events != 0, false);
+       #endif
+
+        {
+            const ScopedLock sl (lock);
+            auto r = registrations.find (clientID);
+
+            if (r != registrations.end())
+            {
+                r->second.isBeingHandled = false;
+
+                if (r->second.isRemoved)
+                {
+                    registrations.erase (r);
+                }
+                else if (! (keepWatching && updateEvents (r->second, true)))
+                {
+                   #if JUCE_LINUX
+                    epoll_ctl (epollHandle, EPOLL_CTL_DEL, r->second.socketHandle, nullptr);
+                   #endif
+                    registrations.erase (r);
+                }
+            }
+        }
+
+        handlerFinished.signal();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (SocketReactor)
+};
+
+//==============================================================================
+/*  Reads and writes the socket of a connection that's being serviced by a SocketReactor.
+    Incoming data is read in large chunks and split into messages, and outgoing messages
+    are appended to a queue which is written by the I/O threads in as few calls as possible.
+*/
+struct InterprocessConnection::ReactorConnection  : public SocketReactor::Client
+{
+    ReactorConnection (InterprocessConnection& o, int handle)
+        : owner (o), socketHandle (handle)
+    {
+    }
+
+    bool handleSocketEvents (bool readable, bool writable) override
+    {
+        if ((writable && ! flushOutput()) || (readable && ! readIncomingData()))
+        {
+            if (isActive.exchange (false))
+            {
+               #if JUCE_LINUX
+                // make sure that the peer sees the connection close, e.g. if it sent something we refused
+                ::shutdown (socketHandle, SHUT_RDWR);
+               #endif
+
+                owner.threadIsRunning = false;
+                owner.connectionLostInt();
+            }
+
+            return false;
+        }
+
+        return isActive;
+    }
+
+    bool wantsToWrite() const override
+    {
+        return hasOutputToWrite;
+    }
+
+    bool queueMessage (const void* messageData, size_t messageSize)
+    {
+        if (! isActive)
+            return false;
+
+        {
+            const ScopedLock sl (outputLock);
+
+            uint32 messageHeader[2] = { ByteOrder::swapIfBigEndian (owner.magicMessageHeader),
+                                        ByteOrder::swapIfBigEndian ((uint32) messageSize) };
+
+            auto totalSize = numQueuedBytes + sizeof (messageHeader) + messageSize;
+
+            // if the other end isn't reading, don't let the queue grow without limit
+            if (numQueuedBytes > 0 && totalSize > owner.maximumQueuedOutputSize)
+                return false;
+
+            if (queuedOutput.getSize() < totalSize)
+                queuedOutput.ensureSize (jmax (totalSize, queuedOutput.getSize() * 2));
+
+            auto* dest = addBytesToPointer (queuedOutput.getData(), numQueuedBytes);
+            memcpy (dest, messageHeader, sizeof (messageHeader));
+
+            if (messageSize > 0)
+                memcpy (addBytesToPointer (dest, sizeof (messageHeader)), messageData, messageSize);
+
+            numQueuedBytes = totalSize;
+            hasOutputToWrite = true;
+        }
+
+        owner.reactor->clientWantsToWrite (*this);
+        return true;
+    }
+
+    InterprocessConnection& owner;
+    const int socketHandle;
+    std::atomic<bool> isActive { true };
+
+private:
+    //==============================================================================
+    CriticalSection outputLock;
+    MemoryBlock queuedOutput, outputBeingSent;
+    size_t numQueuedBytes = 0, numBytesToSend = 0, numBytesSent = 0;
+    std::atomic<bool> hasOutputToWrite { false };
+
+    HeapBlock<uint8> readBuffer { (size_t) readBufferSize };
+    uint32 messageHeader[2];
+    size_t numHeaderBytesReceived = 0, messageSize = 0, numMessageBytesReceived = 0;
+    MemoryBlock incomingMessage;
+
+    enum { readBufferSize = 65536, maxReadsPerEvent = 16 };
+
+    bool flushOutput()
+    {
+       #if JUCE_LINUX
+        for (;;)
+        {
+            if (numBytesSent == numBytesToSend)
+            {
+                // swap in everything that's been queued since the last write, so that
+                // the senders don't have to wait while we're writing to the socket
+                const ScopedLock sl (outputLock);
+
+                if (numQueuedBytes == 0)
+                {
+                    hasOutputToWrite = false;
+                    return true;
+                }
+
+                outputBeingSent.swapWith (queuedOutput);
+                numBytesToSend = numQueuedBytes;
+                numBytesSent = 0;
+                numQueuedBytes = 0;
+            }
+
+            if (! isActive)
+                return true;
+
+            auto bytesWritten = ::send (socketHandle, addBytesToPointer (outputBeingSent.getData(), numBytesSent),
+                                        numBytesToSend - numBytesSent, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+            if (bytesWritten < 0)
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+            numBytesSent += (size_t) bytesWritten;
+        }
+       #else
+        return false;
+       #endif
+    }
+
+    bool readIncomingData()
+    {
+       #if JUCE_LINUX
+        // limit the amount read in one go, so that a busy connection can't starve the others
+        for (int i = 0; i < maxReadsPerEvent && isActive; ++i)
+        {
+            auto bytesRead = ::recv (socketHandle, readBuffer, (size_t) readBufferSize, MSG_DONTWAIT);
+
+            if (bytesRead == 0)
+                return false;
+
+            if (bytesRead < 0)
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+            if (! processIncomingData (readBuffer, (size_t) bytesRead))
+                return false;
+
+            if (bytesRead < readBufferSize)
+                break;
+        }
+
+        return true;
+       #else
+        return false;
+       #endif
+    }
+
+    bool processIncomingData (const uint8* data, size_t size)
+    {
+        while (size > 0 && isActive)
+        {
+            if (numHeaderBytesReceived < sizeof (messageHeader))
+            {
+                auto num = jmin (size, sizeof (messageHeader) - numHeaderBytesReceived);
+                memcpy (addBytesToPointer (messageHeader, numHeaderBytesReceived), data, num);
+                numHeaderBytesReceived += num;
+                data += num;
+                size -= num;
+
+                if (numHeaderBytesReceived < sizeof (messageHeader))
+                    break;
+
+                if (ByteOrder::swapIfBigEndian (messageHeader[0]) != owner.magicMessageHeader)
+                    return false;
+
+                messageSize = (size_t) ByteOrder::swapIfBigEndian (messageHeader[1]);
+
+                if (messageSize > owner.maximumMessageSize)
+                    return false;
+
+                numMessageBytesReceived = 0;
+                incomingMessage = owner.bufferPool->take (messageSize);
+            }
+
+            auto num = jmin (size, messageSize - numMessageBytesReceived);
+            memcpy (addBytesToPointer (incomingMessage.getData(), numMessageBytesReceived), data, num);
+            numMessageBytesReceived += num;
+            data += num;
+            size -= num;
+
+            if (numMessageBytesReceived == messageSize)
+            {
+                numHeaderBytesReceived = 0;
+
+                if (messageSize > 0)
+                    owner.deliverDataInt (std::move (incomingMessage));
+            }
+        }
+
+        return true;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ReactorConnection)
+};
+
 //==============================================================================
 InterprocessConnection::InterprocessConnection (bool callbacksOnMessageThread, uint32 magicMessageHeaderNumber)
     : useMessageThread (callbacksOnMessageThread),
       magicMessageHeader (magicMessageHeaderNumber),
-      safeAction (std::make_shared<SafeAction> (*this))
+      safeAction (std::make_shared<SafeAction> (*this)),
+      bufferPool (std::make_shared<MessageBufferPool>())
 {
     thread.reset (new ConnectionThread (*this));
 }
@@ -91,6 +603,8 @@ InterprocessConnection::~InterprocessConnection()
     callbackConnectionState = false;
     disconnect (4000, Notify::no);
     thread.reset();
+    reactorConnection.reset();
+    reactor.reset();
 }
 
 //==============================================================================
@@ -149,6 +663,13 @@ void InterprocessConnection::disconnect (int timeoutMs, Notify notify)
 {
     thread->signalThreadShouldExit();
 
+    if (reactorConnection != nullptr)
+    {
+        reactorConnection->isActive = false;
+        reactor->removeClient (*reactorConnection);
+        threadIsRunning = false;
+    }
+
     {
         const ScopedReadLock sl (pipeAndSocketLock);
         if (socket != nullptr)  socket->close();
@@ -199,27 +720,96 @@ String InterprocessConnection::getConnectedHostName() const
 //==============================================================================
 bool InterprocessConnection::sendMessage (const MemoryBlock& message)
 {
-    uint32 messageHeader[2] = { ByteOrder::swapIfBigEndian (magicMessageHeader),
-                                ByteOrder::swapIfBigEndian ((uint32) message.getSize()) };
+    return sendMessage (message.getData(), message.getSize());
+}
 
-    MemoryBlock messageData (sizeof (messageHeader) + message.getSize());
-    messageData.copyFrom (messageHeader, 0, sizeof (messageHeader));
-    messageData.copyFrom (message.getData(), sizeof (messageHeader), message.getSize());
+bool InterprocessConnection::sendMessage (const void* messageData, size_t numBytes)
+{
+    jassert (messageData != nullptr || numBytes == 0);
 
-    return writeData (messageData.getData(), (int) messageData.getSize()) == (int) messageData.getSize();
+    {
+        const ScopedReadLock sl (pipeAndSocketLock);
+
+        if (reactorConnection != nullptr && socket != nullptr)
+            return reactorConnection->queueMessage (messageData, numBytes);
+    }
+
+    uint32 messageHeader[2] = { ByteOrder::swapIfBigEndian (magicMessageHeader),
+                                ByteOrder::swapIfBigEndian ((uint32) numBytes) };
+
+    return writeMessage (messageHeader, sizeof (messageHeader), messageData, numBytes);
 }
 
-int InterprocessConnection::writeData (void* data, int dataSize)
+bool InterprocessConnection::writeMessage (const void* header, size_t headerSize, const void* data, size_t dataSize)
 {
     const ScopedReadLock sl (pipeAndSocketLock);
 
+    // stops the header and data of messages from different threads getting interleaved
+    const ScopedLock wl (writeLock);
+
     if (socket != nullptr)
-        return socket->write (data, dataSize);
+    {
+       #if JUCE_WINDOWS
+        MemoryBlock messageData (headerSize + dataSize);
+        messageData.copyFrom (header, 0, headerSize);
+        messageData.copyFrom (data, (int) headerSize, dataSize);
+
+        return socket->write (messageData.getData(), (int) messageData.getSize()) == (int) messageData.getSize();
+       #else
+        // write the header and the data with a single call, without copying them into one block
+        iovec parts[2] = { { const_cast<void*> (header), headerSize },
+                           { const_cast<void*> (data),   dataSize } };
+        auto* part = parts;
+        int numParts = dataSize > 0 ? 2 : 1;
+
+        while (numParts > 0)
+        {
+            auto bytesWritten = ::writev (socket->getRawSocketHandle(), part, numParts);
+
+            if (bytesWritten < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                // (this can't use StreamingSocket::waitUntilReady(), which gives up if the
+                // connection's thread is already waiting for something to read)
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    pollfd pfd { socket->getRawSocketHandle(), POLLOUT, 0 };
+
+                    if (::poll (&pfd, 1, 1000) >= 0 || errno == EINTR)
+                        continue;
+                }
+
+                return false;
+            }
+
+            // skip over the parts that have been sent, and whatever's been sent of the next one
+            auto remaining = (size_t) bytesWritten;
+
+            while (numParts > 0 && remaining >= part->iov_len)
+            {
+                remaining -= part->iov_len;
+                ++part;
+                --numParts;
+            }
+
+            if (numParts > 0)
+            {
+                part->iov_base = addBytesToPointer (part->iov_base, remaining);
+                part->iov_len -= remaining;
+            }
+        }
+
+        return true;
+       #endif
+    }
 
     if (pipe != nullptr)
-        return pipe->write (data, dataSize, pipeReceiveMessageTimeout);
+        return pipe->write (header, (int) headerSize, pipeReceiveMessageTimeout) == (int) headerSize
+                && (dataSize == 0 || pipe->write (data, (int) dataSize, pipeReceiveMessageTimeout) == (int) dataSize);
 
-    return 0;
+    return false;
 }
 
 //==============================================================================
@@ -235,13 +825,41 @@ void InterprocessConnection::initialiseWithSocket (std::unique_ptr<StreamingSock
 {
     jassert (socket == nullptr && pipe == nullptr);
     socket = std::move (newSocket);
+    reactorConnection.reset();
+    reactor.reset();
     initialise();
 }
 
+void InterprocessConnection::initialiseWithReactor (std::unique_ptr<StreamingSocket> newSocket,
+                                                    std::shared_ptr<SocketReactor> newReactor)
+{
+    jassert (socket == nullptr && pipe == nullptr);
+
+    {
+        const ScopedWriteLock sl (pipeAndSocketLock);
+        socket = std::move (newSocket);
+        reactor = std::move (newReactor);
+        reactorConnection.reset (new ReactorConnection (*this, socket->getRawSocketHandle()));
+    }
+
+    safeAction->setSafe (true);
+    threadIsRunning = true;
+    connectionMadeInt();
+
+    if (! reactor->addClient (*reactorConnection, reactorConnection->socketHandle))
+    {
+        reactorConnection->isActive = false;
+        threadIsRunning = false;
+        connectionLostInt();
+    }
+}
+
 void InterprocessConnection::initialiseWithPipe (std::unique_ptr<NamedPipe> newPipe)
 {
     jassert (socket == nullptr && pipe == nullptr);
     pipe = std::move (newPipe);
+    reactorConnection.reset();
+    reactor.reset();
     initialise();
 }
 
@@ -297,10 +915,16 @@ void InterprocessConnection::connectionLostInt()
 
 struct DataDeliveryMessage  : public Message
 {
-    DataDeliveryMessage (std::shared_ptr<SafeActionImpl> ipc, const MemoryBlock& d)
-        : safeAction (ipc), data (d)
+    DataDeliveryMessage (std::shared_ptr<SafeActionImpl> ipc, MemoryBlock&& d,
+                         std::shared_ptr<MessageBufferPoolImpl> pool)
+        : safeAction (ipc), data (std::move (d)), bufferPool (pool)
     {}
 
+    ~DataDeliveryMessage() override
+    {
+        bufferPool->recycle (std::move (data));
+    }
+
     void messageCallback() override
     {
         safeAction->ifSafe ([this] (InterprocessConnection& owner)
@@ -311,16 +935,22 @@ struct DataDeliveryMessage  : public Message
 
     std::shared_ptr<SafeActionImpl> safeAction;
     MemoryBlock data;
+    std::shared_ptr<MessageBufferPoolImpl> bufferPool;
 };
 
-void InterprocessConnection::deliverDataInt (const MemoryBlock& data)
+void InterprocessConnection::deliverDataInt (MemoryBlock&& data)
 {
     jassert (callbackConnectionState);
 
     if (useMessageThread)
-        (new DataDeliveryMessage (safeAction, data))->post();
+    {
+        (new DataDeliveryMessage (safeAction, std::move (data), bufferPool))->post();
+    }
     else
+    {
         messageReceived (data);
+        bufferPool->recycle (std::move (data));
+    }
 }
 
 //==============================================================================
@@ -346,11 +976,20 @@ bool InterprocessConnection::readNextMessage()
     if (bytes == (int) sizeof (messageHeader)
          && ByteOrder::swapIfBigEndian (messageHeader[0]) == magicMessageHeader)
     {
-        auto bytesInMessage = (int) ByteOrder::swapIfBigEndian (messageHeader[1]);
+        auto messageSize = (size_t) ByteOrder::swapIfBigEndian (messageHeader[1]);
+
+        if (messageSize > maximumMessageSize || messageSize > (size_t) std::numeric_limits<int>::max())
+        {
+            deletePipeAndSocket();
+            connectionLostInt();
+            return false;
+        }
+
+        auto bytesInMessage = (int) messageSize;
 
         if (bytesInMessage > 0)
         {
-            MemoryBlock messageData ((size_t) bytesInMessage, true);
+            auto messageData = bufferPool->take ((size_t) bytesInMessage);
             int bytesRead = 0;
 
             while (bytesInMessage > 0)
@@ -368,8 +1007,12 @@ bool InterprocessConnection::readNextMessage()
                 bytesInMessage -= bytesIn;
             }
 
+            // pooled buffers aren't cleared, so blank out anything that wasn't received
+            if (bytesInMessage > 0)
+                zeromem (addBytesToPointer (messageData.getData(), bytesRead), (size_t) bytesInMessage);
+
             if (bytesRead >= 0)
-                deliverDataInt (messageData);
+                deliverDataInt (std::move (messageData));
         }
 
         return true;
@@ -428,4 +1071,180 @@ void InterprocessConnection::runThread()
     threadIsRunning = false;
 }
 
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class InterprocessConnectionTests  : public UnitTest
+{
+public:
+    InterprocessConnectionTests()
+        : UnitTest ("InterprocessConnection", UnitTestCategories::networking)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Socket messages");
+        {
+            SocketPair sockets;
+            expect (sockets.connect());
+            checkMessages (sockets.client, *sockets.server.connection, 500, 1000);
+            checkMessages (sockets.client, *sockets.server.connection, 20, 300000);
+        }
+
+        beginTest ("Partial socket writes");
+        {
+            SocketPair sockets;
+            expect (sockets.connect());
+
+           #if ! JUCE_WINDOWS
+            // with a tiny send buffer and a non-blocking socket, most messages only
+            // get sent a piece at a time
+            auto handle = sockets.client.getSocket()->getRawSocketHandle();
+            int bufferSize = 1024;
+            expect (setsockopt (handle, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof (bufferSize)) == 0);
+            expect (fcntl (handle, F_SETFL, fcntl (handle, F_GETFL, 0) | O_NONBLOCK) == 0);
+           #endif
+
+            checkMessages (sockets.client, *sockets.server.connection, 500, 1000);
+            checkMessages (sockets.client, *sockets.server.connection, 20, 300000);
+        }
+
+        beginTest ("Pipe messages");
+        {
+            PipePair pipes;
+            expect (pipes.connect());
+            checkMessages (pipes.sender, pipes.receiver, 500, 1000);
+            checkMessages (pipes.sender, pipes.receiver, 20, 300000);
+        }
+
+        beginTest ("Messages of different sizes");
+        {
+            for (auto messageSize : { 64, 4096, 65536 })
+            {
+                SocketPair sockets;
+                PipePair pipes;
+                expect (sockets.connect() && pipes.connect());
+
+                auto numMessages = jmax (100, 1024 * 1024 / messageSize);
+                checkMessages (sockets.client, *sockets.server.connection, numMessages, messageSize);
+                checkMessages (pipes.sender, pipes.receiver, numMessages, messageSize);
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    struct TestConnection  : public InterprocessConnection
+    {
+        TestConnection()  : InterprocessConnection (false) {}
+        ~TestConnection() override     { disconnect(); }
+
+        void connectionMade() override   {}
+        void connectionLost() override   {}
+
+        void messageReceived (const MemoryBlock& message) override
+        {
+            auto index = numReceived.load();
+
+            if (message.getSize() != expectedSize || ! matchesPattern (message.getData(), message.getSize(), index & 3))
+                ++numErrors;
+
+            if (++numReceived == numExpected)
+                finished.signal();
+        }
+
+        std::atomic<int> numReceived { 0 }, numErrors { 0 };
+        int numExpected = 0;
+        size_t expectedSize = 0;
+        WaitableEvent finished;
+    };
+
+    struct SocketPair
+    {
+        struct Server  : public InterprocessConnectionServer
+        {
+            ~Server() override     { stop(); }
+
+            InterprocessConnection* createConnectionObject() override
+            {
+                connection.reset (new TestConnection());
+                connected.signal();
+                return connection.get();
+            }
+
+            std::unique_ptr<TestConnection> connection;
+            WaitableEvent connected;
+        };
+
+        bool connect()
+        {
+            return server.beginWaitingForSocket (0, "127.0.0.1")
+                    && client.connectToSocket ("127.0.0.1", server.getBoundPort(), 2000)
+                    && server.connected.wait (5000);
+        }
+
+        Server server;
+        TestConnection client;
+    };
+
+    struct PipePair
+    {
+        bool connect()
+        {
+            auto name = "juce_ipc_test_" + String::toHexString (Random::getSystemRandom().nextInt64());
+            return receiver.createPipe (name, -1, true) && sender.connectToPipe (name, -1);
+        }
+
+        TestConnection receiver, sender;
+    };
+
+    static void fillPattern (void* data, size_t size, int index)
+    {
+        for (size_t i = 0; i < size; ++i)
+            static_cast<uint8*> (data)[i] = (uint8) (i * 7 + (size_t) index);
+    }
+
+    static bool matchesPattern (const void* data, size_t size, int index)
+    {
+        for (size_t i = 0; i < size; i += 97)
+            if (static_cast<const uint8*> (data)[i] != (uint8) (i * 7 + (size_t) index))
+                return false;
+
+        return true;
+    }
+
+    void checkMessages (InterprocessConnection& sender, TestConnection& receiver, int numMessages, int messageSize)
+    {
+        receiver.numReceived = 0;
+        receiver.numErrors = 0;
+        receiver.numExpected = numMessages;
+        receiver.expectedSize = (size_t) messageSize;
+
+        HeapBlock<uint8> messages ((size_t) messageSize * 4);
+
+        for (int i = 0; i < 4; ++i)
+            fillPattern (messages + i * messageSize, (size_t) messageSize, i);
+
+        for (int i = 0; i < numMessages; ++i)
+        {
+            // use a mix of the two sendMessage methods
+            if ((i & 1) == 0)
+                expect (sender.sendMessage (messages + (i & 3) * messageSize, (size_t) messageSize));
+            else
+                expect (sender.sendMessage (MemoryBlock (messages + (i & 3) * messageSize, (size_t) messageSize)));
+        }
+
+        expect (receiver.finished.wait (30000));
+
+        expectEquals (receiver.numReceived.load(), numMessages);
+        expectEquals (receiver.numErrors.load(), 0);
+    }
+};
+
+static InterprocessConnectionTests interprocessConnectionTests;
+
+#endif
+
 } // namespace juce
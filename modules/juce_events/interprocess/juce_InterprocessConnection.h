@@ -147,6 +147,39 @@ public:
     */
     String getConnectedHostName() const;
 
+    /** Sets the largest message that this connection will accept.
+
+        The size of each incoming message is read from its header before any of its data
+        arrives, so without a limit a misbehaving peer could make this end allocate an
+        arbitrarily large buffer. If a header announces a message that's bigger than this,
+        the connection is dropped and connectionLost() is called.
+
+        The default is 64MB.
+    */
+    void setMaximumMessageSize (size_t maxNumBytes) noexcept    { maximumMessageSize = maxNumBytes; }
+
+    /** Returns the largest message that this connection will accept.
+        @see setMaximumMessageSize
+    */
+    size_t getMaximumMessageSize() const noexcept               { return maximumMessageSize; }
+
+    /** Sets the amount of outgoing data that may be queued while waiting to be sent.
+
+        This only applies to connections that are serviced by an InterprocessConnectionServer's
+        pool of I/O threads, where sendMessage() adds the messages to a queue. If the other end
+        stops reading, the queue could otherwise keep on growing, so once it holds this many
+        bytes, sendMessage() will fail until some of it has been sent. A message is always
+        accepted when the queue is empty, however big it is.
+
+        The default is 64MB.
+    */
+    void setMaximumQueuedOutputSize (size_t maxNumBytes) noexcept   { maximumQueuedOutputSize = maxNumBytes; }
+
+    /** Returns the amount of outgoing data that may be queued while waiting to be sent.
+        @see setMaximumQueuedOutputSize
+    */
+    size_t getMaximumQueuedOutputSize() const noexcept              { return maximumQueuedOutputSize; }
+
     //==============================================================================
     /** Tries to send a message to the other end of this connection.
 
@@ -154,10 +187,27 @@ public:
         it succeeds, the connection object at the other end will receive the message by
         a callback to its messageReceived() method.
 
+        If this connection was created by an InterprocessConnectionServer that uses a shared
+        pool of I/O threads, the message is copied into a queue and this returns immediately.
+        Any messages that are queued before one of the I/O threads gets around to sending
+        them will be written to the socket in a single batch. If the other end isn't reading
+        them quickly enough and the queue has grown to the limit set by
+        setMaximumQueuedOutputSize(), this will fail and the message won't be sent.
+
         @see messageReceived
     */
     bool sendMessage (const MemoryBlock& message);
 
+    /** Tries to send a message to the other end of this connection.
+
+        This does the same thing as the version of sendMessage() that takes a MemoryBlock,
+        but lets you send data directly from your own buffer. When this connection writes to
+        its socket itself, the message header and the data are written with a single gathering
+        write, so the data isn't copied. When it's serviced by an InterprocessConnectionServer's
+        I/O threads, the data is copied into the output queue, as described above.
+    */
+    bool sendMessage (const void* messageData, size_t numBytes);
+
     //==============================================================================
     /** Called when the connection is first connected.
 
@@ -198,6 +248,7 @@ private:
     const bool useMessageThread;
     const uint32 magicMessageHeader;
     int pipeReceiveMessageTimeout = -1;
+    std::atomic<size_t> maximumMessageSize { 64 * 1024 * 1024 }, maximumQueuedOutputSize { 64 * 1024 * 1024 };
 
     friend class InterprocessConnectionServer;
     void initialise();
@@ -206,7 +257,7 @@ private:
     void deletePipeAndSocket();
     void connectionMadeInt();
     void connectionLostInt();
-    void deliverDataInt (const MemoryBlock&);
+    void deliverDataInt (MemoryBlock&&);
     bool readNextMessage();
     int readData (void*, int);
 
@@ -217,8 +268,19 @@ private:
     class SafeAction;
     std::shared_ptr<SafeAction> safeAction;
 
+    class MessageBufferPool;
+    std::shared_ptr<MessageBufferPool> bufferPool;
+    CriticalSection writeLock;
+
+    class SocketReactor;
+    struct ReactorConnection;
+    std::shared_ptr<SocketReactor> reactor;
+    std::unique_ptr<ReactorConnection> reactorConnection;
+
+    void initialiseWithReactor (std::unique_ptr<StreamingSocket>, std::shared_ptr<SocketReactor>);
+
     void runThread();
-    int writeData (void*, int);
+    bool writeMessage (const void* header, size_t headerSize, const void* data, size_t dataSize);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (InterprocessConnection)
 };
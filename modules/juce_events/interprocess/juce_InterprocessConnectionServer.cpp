@@ -27,6 +27,11 @@ InterprocessConnectionServer::InterprocessConnectionServer() : Thread ("JUCE IPC
 {
 }
 
+InterprocessConnectionServer::InterprocessConnectionServer (int numThreads)
+    : Thread ("JUCE IPC server"), numIOThreads (numThreads)
+{
+}
+
 InterprocessConnectionServer::~InterprocessConnectionServer()
 {
     stop();
@@ -41,6 +46,16 @@ bool InterprocessConnectionServer::beginWaitingForSocket (const int portNumber,
 
     if (socket->createListener (portNumber, bindAddress))
     {
+        if (numIOThreads > 0)
+        {
+            auto newReactor = std::make_shared<InterprocessConnection::SocketReactor> (numIOThreads);
+
+            if (newReactor->isValid())
+                reactor = std::move (newReactor);
+        }
+
+        // Connections are always accepted on this server's own thread, so that neither a slow
+        // accept nor createConnectionObject() can hold up one of the shared I/O threads.
         startThread();
         return true;
     }
@@ -58,6 +73,7 @@ void InterprocessConnectionServer::stop()
 
     stopThread (4000);
     socket.reset();
+    reactor.reset();
 }
 
 int InterprocessConnectionServer::getBoundPort() const noexcept
@@ -72,9 +88,273 @@ void InterprocessConnectionServer::run()
         std::unique_ptr<StreamingSocket> clientSocket (socket->waitForNextConnection());
 
         if (clientSocket != nullptr)
+        {
             if (auto* newConnection = createConnectionObject())
-                newConnection->initialiseWithSocket (std::move (clientSocket));
+            {
+                if (reactor != nullptr)
+                    newConnection->initialiseWithReactor (std::move (clientSocket), reactor);
+                else
+                    newConnection->initialiseWithSocket (std::move (clientSocket));
+            }
+        }
     }
 }
 
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class InterprocessConnectionServerTests  : public UnitTest
+{
+public:
+    InterprocessConnectionServerTests()
+        : UnitTest ("InterprocessConnectionServer", UnitTestCategories::networking)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Multiplexed echo");
+        {
+            EchoServer server (2);
+            expect (server.beginWaitingForSocket (0, "127.0.0.1"));
+
+            OwnedArray<TestClient> clients;
+
+            for (int i = 0; i < 4; ++i)
+            {
+                clients.add (new TestClient (100));
+                expect (clients.getLast()->connectToSocket ("127.0.0.1", server.getBoundPort(), 2000));
+            }
+
+            for (auto* c : clients)
+                c->sendNextMessage();
+
+            for (auto* c : clients)
+            {
+                expect (c->finished.wait (10000));
+                expectEquals (c->numErrors.load(), 0);
+                expectEquals (c->numReceived.load(), 100);
+            }
+        }
+
+        beginTest ("Batched sends keep their order");
+        {
+            EchoServer server (2);
+            expect (server.beginWaitingForSocket (0, "127.0.0.1"));
+
+            TestClient client (2000);
+            client.waitForEachReply = false;
+            expect (client.connectToSocket ("127.0.0.1", server.getBoundPort(), 2000));
+
+            for (int i = 0; i < 2000; ++i)
+                expect (client.sendNextMessage());
+
+            expect (client.finished.wait (10000));
+            expectEquals (client.numErrors.load(), 0);
+            expectEquals (client.numReceived.load(), 2000);
+        }
+
+        beginTest ("Disconnection");
+        {
+            EchoServer server (1);
+            expect (server.beginWaitingForSocket (0, "127.0.0.1"));
+
+            {
+                TestClient client (1);
+                expect (client.connectToSocket ("127.0.0.1", server.getBoundPort(), 2000));
+                client.sendNextMessage();
+                expect (client.finished.wait (10000));
+            }
+
+            expect (server.waitForConnectionCount (1));
+            expect (server.connectionLost.wait (10000));
+            expect (! server.getConnection (0)->isConnected());
+        }
+
+        beginTest ("Oversized messages");
+        {
+            for (auto numIOThreads : { 0, 2 })
+            {
+                EchoServer server (numIOThreads);
+                server.maximumMessageSize = 1000;
+                expect (server.beginWaitingForSocket (0, "127.0.0.1"));
+
+                TestClient client (1);
+                expect (client.connectToSocket ("127.0.0.1", server.getBoundPort(), 2000));
+                expect (client.sendNextMessage());
+                expect (client.finished.wait (10000));
+                expectEquals (client.numErrors.load(), 0);
+
+                MemoryBlock oversized (2000, true);
+                expect (client.sendMessage (oversized));
+                expect (server.connectionLost.wait (10000));
+                expect (! server.getConnection (0)->isConnected());
+                expectEquals (client.numReceived.load(), 1);
+            }
+        }
+
+        beginTest ("Queued output is limited");
+        {
+            EchoServer server (2);
+            expect (server.beginWaitingForSocket (0, "127.0.0.1"));
+
+            // a peer that never reads anything
+            StreamingSocket peer;
+            expect (peer.connect ("127.0.0.1", server.getBoundPort(), 2000));
+            expect (server.waitForConnectionCount (1));
+
+            auto* connection = server.getConnection (0);
+            connection->setMaximumQueuedOutputSize (1024 * 1024);
+
+            MemoryBlock message (65536, true);
+            int numSent = 0;
+
+            while (numSent < 2000 && connection->sendMessage (message))
+                ++numSent;
+
+            expect (numSent < 2000);
+            expect (connection->isConnected());
+
+            // but once the peer starts reading, the rest can be sent
+            HeapBlock<char> buffer (65536);
+            bool sentAfterReading = false;
+
+            for (int i = 0; i < 10000 && ! sentAfterReading; ++i)
+            {
+                peer.read (buffer, 65536, false);
+                sentAfterReading = connection->sendMessage (message);
+            }
+
+            expect (sentAfterReading);
+        }
+
+        beginTest ("Many clients");
+        {
+            for (auto numIOThreads : { 0, 2 })
+            {
+                const int numClients = 32, numRoundTrips = 200;
+                EchoServer server (numIOThreads);
+                expect (server.beginWaitingForSocket (0, "127.0.0.1"));
+
+                OwnedArray<TestClient> clients;
+
+                for (int i = 0; i < numClients; ++i)
+                {
+                    clients.add (new TestClient (numRoundTrips));
+                    expect (clients.getLast()->connectToSocket ("127.0.0.1", server.getBoundPort(), 2000));
+                }
+
+                expect (server.waitForConnectionCount (numClients));
+
+                for (auto* c : clients)
+                    c->sendNextMessage();
+
+                for (auto* c : clients)
+                {
+                    expect (c->finished.wait (30000));
+                    expectEquals (c->numErrors.load(), 0);
+                    expectEquals (c->numReceived.load(), numRoundTrips);
+                }
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    struct EchoConnection  : public InterprocessConnection
+    {
+        EchoConnection (WaitableEvent& lost)  : InterprocessConnection (false), connectionLostEvent (lost) {}
+        ~EchoConnection() override   { disconnect(); }
+
+        void connectionMade() override                              {}
+        void connectionLost() override                              { connectionLostEvent.signal(); }
+        void messageReceived (const MemoryBlock& message) override  { sendMessage (message); }
+
+        WaitableEvent& connectionLostEvent;
+    };
+
+    struct EchoServer  : public InterprocessConnectionServer
+    {
+        EchoServer (int numIOThreads)  : InterprocessConnectionServer (numIOThreads) {}
+        ~EchoServer() override     { stop(); }
+
+        InterprocessConnection* createConnectionObject() override
+        {
+            const ScopedLock sl (lock);
+            auto* connection = connections.add (new EchoConnection (connectionLost));
+            connection->setMaximumMessageSize (maximumMessageSize);
+            return connection;
+        }
+
+        bool waitForConnectionCount (int num)
+        {
+            for (int i = 0; i < 1000; ++i)
+            {
+                {
+                    const ScopedLock sl (lock);
+
+                    if (connections.size() >= num)
+                        return true;
+                }
+
+                juce::Thread::sleep (10);
+            }
+
+            return false;
+        }
+
+        InterprocessConnection* getConnection (int index)
+        {
+            const ScopedLock sl (lock);
+            return connections[index];
+        }
+
+        WaitableEvent connectionLost;
+        size_t maximumMessageSize = 64 * 1024 * 1024;
+        CriticalSection lock;
+        OwnedArray<EchoConnection> connections;
+    };
+
+    struct TestClient  : public InterprocessConnection
+    {
+        TestClient (int numMessages)  : InterprocessConnection (false), numMessagesToSend (numMessages) {}
+        ~TestClient() override     { disconnect(); }
+
+        void connectionMade() override   {}
+        void connectionLost() override   {}
+
+        bool sendNextMessage()
+        {
+            auto index = numSent++;
+            MemoryBlock message (&index, sizeof (index));
+            message.append (testPayload, sizeof (testPayload));
+            return sendMessage (message);
+        }
+
+        void messageReceived (const MemoryBlock& message) override
+        {
+            if (message.getSize() != sizeof (int) + sizeof (testPayload)
+                 || *static_cast<const int*> (message.getData()) != numReceived.load())
+                ++numErrors;
+
+            if (++numReceived == numMessagesToSend)
+                finished.signal();
+            else if (waitForEachReply)
+                sendNextMessage();
+        }
+
+        const int numMessagesToSend;
+        bool waitForEachReply = true;
+        int numSent = 0;
+        std::atomic<int> numReceived { 0 }, numErrors { 0 };
+        char testPayload[100] = {};
+        WaitableEvent finished;
+    };
+};
+
+static InterprocessConnectionServerTests interprocessConnectionServerTests;
+
+#endif
+
 } // namespace juce
@@ -44,6 +44,24 @@ public:
     */
     InterprocessConnectionServer();
 
+    /** Creates an uninitialised server object which will use a small, fixed pool of
+        I/O threads to service all the connections that it creates, rather than running a
+        separate thread for each of them. New connections are still accepted on the server's
+        own listener thread.
+
+        This makes it possible to serve large numbers of clients without the overhead
+        of hundreds of threads. The connectionMade(), connectionLost() and messageReceived()
+        callbacks of connections that don't use the message thread will be made on one of
+        the pool's threads, so they should return quickly. Messages sent by these
+        connections are queued and written in batches by the I/O threads.
+
+        This currently uses epoll, so is only available on Linux - on other platforms, the
+        server will fall back to using a thread per connection.
+
+        @param numIOThreads  the number of threads that will service the sockets
+    */
+    explicit InterprocessConnectionServer (int numIOThreads);
+
     /** Destructor. */
     ~InterprocessConnectionServer() override;
 
@@ -97,6 +115,9 @@ protected:
 private:
     //==============================================================================
     std::unique_ptr<StreamingSocket> socket;
+    const int numIOThreads = 0;
+
+    std::shared_ptr<InterprocessConnection::SocketReactor> reactor;
 
     void run() override;
 
@@ -0,0 +1,522 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #define JUCE_SHARED_MEMORY_RING_BUFFER_AVAILABLE 1
+#else
+ #define JUCE_SHARED_MEMORY_RING_BUFFER_AVAILABLE 0
+#endif
+
+//==============================================================================
+struct SharedMemoryRingBuffer::Pimpl
+{
+    // This lives at the start of the shared memory, followed by the data area.
+    // The read and write positions are byte counts which only ever increase, and each
+    // block is stored as a 32-bit length, 4 unused bytes, then the data, padded to a
+    // multiple of 8 bytes. A length of paddingMarker means that the rest of the space
+    // up to the end of the data area is unused, and the next block starts at the beginning.
+    struct Header
+    {
+        uint32 magic, capacity;
+        std::atomic<uint32> closed, dataSequence, spaceSequence, readerWaiting, writerWaiting;
+        alignas (64) std::atomic<uint64> writePosition;
+        alignas (64) std::atomic<uint64> readPosition;
+    };
+
+    static_assert (sizeof (Header) % 8 == 0, "The data area needs to be 8-byte aligned");
+
+    enum : uint32
+    {
+        magicNumber = 0x6a736d72,
+        paddingMarker = 0xffffffff,
+        blockHeaderSize = 8
+    };
+
+    Pimpl (const String& name, int capacityInBytes, bool shouldCreate)
+        : sharedMemoryName ("/" + name), isOwner (shouldCreate)
+    {
+       #if JUCE_SHARED_MEMORY_RING_BUFFER_AVAILABLE
+        if (isOwner)
+        {
+            auto dataSize = (size_t) jmax (1024, capacityInBytes + 7) & ~(size_t) 7;
+            mappedSize = sizeof (Header) + dataSize;
+
+            handle = shm_open (sharedMemoryName.toRawUTF8(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+            if (handle < 0 || ftruncate (handle, (off_t) mappedSize) != 0 || ! map())
+                return;
+
+            header = new (mappedMemory) Header();
+            header->capacity = (uint32) dataSize;
+            header->magic = magicNumber;
+        }
+        else
+        {
+            handle = shm_open (sharedMemoryName.toRawUTF8(), O_RDWR, 0600);
+
+            struct stat info;
+
+            if (handle < 0 || fstat (handle, &info) != 0 || (size_t) info.st_size <= sizeof (Header))
+                return;
+
+            mappedSize = (size_t) info.st_size;
+
+            if (! map())
+                return;
+
+            auto* h = static_cast<Header*> (mappedMemory);
+
+            if (h->magic != magicNumber || sizeof (Header) + h->capacity != mappedSize)
+                return;
+
+            header = h;
+        }
+
+        capacity = header->capacity;
+        data = static_cast<uint8*> (mappedMemory) + sizeof (Header);
+       #else
+        ignoreUnused (capacityInBytes);
+       #endif
+    }
+
+    ~Pimpl()
+    {
+       #if JUCE_SHARED_MEMORY_RING_BUFFER_AVAILABLE
+        if (mappedMemory != nullptr)
+            munmap (mappedMemory, mappedSize);
+
+        if (handle >= 0)
+        {
+            ::close (handle);
+
+            if (isOwner)
+                shm_unlink (sharedMemoryName.toRawUTF8());
+        }
+       #endif
+    }
+
+    bool isValid() const noexcept       { return header != nullptr; }
+
+    int getMaxBlockSize() const noexcept
+    {
+        return (int) (capacity / 2) - (int) blockHeaderSize;
+    }
+
+    void close()
+    {
+        header->closed = 1;
+        header->dataSequence++;
+        header->spaceSequence++;
+        wake (header->dataSequence);
+        wake (header->spaceSequence);
+    }
+
+    //==============================================================================
+    bool write (const void* sourceData, int numBytes, int timeOutMilliseconds)
+    {
+        if (numBytes < 0 || numBytes > getMaxBlockSize())
+        {
+            jassertfalse; // this block is too big for the buffer!
+            return false;
+        }
+
+        auto blockSize = getPaddedBlockSize ((size_t) numBytes);
+        auto deadline = getDeadline (timeOutMilliseconds);
+
+        for (;;)
+        {
+            if (header->closed != 0)
+                return false;
+
+            auto sequence = header->spaceSequence.load();
+            auto writePos = header->writePosition.load (std::memory_order_relaxed);
+            auto readPos  = header->readPosition.load (std::memory_order_acquire);
+
+            auto offset = (size_t) (writePos % capacity);
+            auto spaceBeforeEnd = capacity - offset;
+            auto spaceNeeded = blockSize + (spaceBeforeEnd < blockSize ? spaceBeforeEnd : 0);
+
+            if (capacity - (size_t) (writePos - readPos) >= spaceNeeded)
+            {
+                if (spaceBeforeEnd < blockSize)
+                {
+                    writeBlockLength (offset, paddingMarker);
+                    offset = 0;
+                }
+
+                writeBlockLength (offset, (uint32) numBytes);
+                memcpy (data + offset + blockHeaderSize, sourceData, (size_t) numBytes);
+
+                header->writePosition.store (writePos + spaceNeeded, std::memory_order_release);
+                header->dataSequence++;
+
+                if (header->readerWaiting != 0)
+                    wake (header->dataSequence);
+
+                return true;
+            }
+
+            if (! waitForChange (header->writerWaiting, header->spaceSequence, sequence, deadline))
+                return false;
+        }
+    }
+
+    bool read (MemoryBlock& destination, int timeOutMilliseconds)
+    {
+        auto deadline = getDeadline (timeOutMilliseconds);
+
+        for (;;)
+        {
+            auto sequence = header->dataSequence.load();
+            auto readPos  = header->readPosition.load (std::memory_order_relaxed);
+            auto writePos = header->writePosition.load (std::memory_order_acquire);
+
+            if (writePos != readPos)
+            {
+                auto offset = (size_t) (readPos % capacity);
+                auto length = readBlockLength (offset);
+
+                if (length == paddingMarker)
+                {
+                    header->readPosition.store (readPos + (capacity - offset), std::memory_order_release);
+                    continue;
+                }
+
+                // the other process has written something that doesn't make sense..
+                if ((size_t) length > (size_t) getMaxBlockSize()
+                     || getPaddedBlockSize (length) > (size_t) (writePos - readPos))
+                {
+                    close();
+                    return false;
+                }
+
+                destination.setSize ((size_t) length, false);
+                memcpy (destination.getData(), data + offset + blockHeaderSize, (size_t) length);
+
+                header->readPosition.store (readPos + getPaddedBlockSize (length), std::memory_order_release);
+                header->spaceSequence++;
+
+                if (header->writerWaiting != 0)
+                    wake (header->spaceSequence);
+
+                return true;
+            }
+
+            if (header->closed != 0)
+                return false;
+
+            if (! waitForChange (header->readerWaiting, header->dataSequence, sequence, deadline))
+                return false;
+        }
+    }
+
+    //==============================================================================
+    const String sharedMemoryName;
+    const bool isOwner;
+    int handle = -1;
+    void* mappedMemory = nullptr;
+    size_t mappedSize = 0, capacity = 0;
+    Header* header = nullptr;
+    uint8* data = nullptr;
+
+private:
+    bool map()
+    {
+       #if JUCE_SHARED_MEMORY_RING_BUFFER_AVAILABLE
+        auto* m = mmap (nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, handle, 0);
+
+        if (m == MAP_FAILED)
+            return false;
+
+        mappedMemory = m;
+        return true;
+       #else
+        return false;
+       #endif
+    }
+
+    static size_t getPaddedBlockSize (size_t numBytes) noexcept
+    {
+        return (blockHeaderSize + numBytes + 7) & ~(size_t) 7;
+    }
+
+    void writeBlockLength (size_t offset, uint32 length) noexcept
+    {
+        memcpy (data + offset, &length, sizeof (length));
+    }
+
+    uint32 readBlockLength (size_t offset) const noexcept
+    {
+        uint32 length;
+        memcpy (&length, data + offset, sizeof (length));
+        return length;
+    }
+
+    static uint32 getDeadline (int timeOutMilliseconds) noexcept
+    {
+        return timeOutMilliseconds >= 0 ? Time::getMillisecondCounter() + (uint32) timeOutMilliseconds : 0;
+    }
+
+    // Sleeps until the other end changes the sequence number, or the deadline passes
+    bool waitForChange (std::atomic<uint32>& waitingFlag, std::atomic<uint32>& sequence,
+                        uint32 lastSequence, uint32 deadline)
+    {
+        int timeoutMs = -1;
+
+        if (deadline != 0)
+        {
+            timeoutMs = (int) (deadline - Time::getMillisecondCounter());
+
+            if (timeoutMs <= 0)
+                return false;
+        }
+
+        waitingFlag = 1;
+
+       #if JUCE_LINUX
+        if (timeoutMs < 0)
+        {
+            syscall (SYS_futex, reinterpret_cast<uint32*> (&sequence), FUTEX_WAIT, lastSequence, nullptr, nullptr, 0);
+        }
+        else
+        {
+            timespec timeout { timeoutMs / 1000, (timeoutMs % 1000) * 1000000L };
+            syscall (SYS_futex, reinterpret_cast<uint32*> (&sequence), FUTEX_WAIT, lastSequence, &timeout, nullptr, 0);
+        }
+       #else
+        // without futexes, the best we can do is to keep polling
+        if (sequence.load() == lastSequence)
+            Thread::yield();
+       #endif
+
+        waitingFlag = 0;
+        return true;
+    }
+
+    static void wake (std::atomic<uint32>& sequence) noexcept
+    {
+       #if JUCE_LINUX
+        syscall (SYS_futex, reinterpret_cast<uint32*> (&sequence), FUTEX_WAKE, std::numeric_limits<int>::max(), nullptr, nullptr, 0);
+       #else
+        ignoreUnused (sequence);
+       #endif
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (Pimpl)
+};
+
+//==============================================================================
+SharedMemoryRingBuffer::SharedMemoryRingBuffer() {}
+
+SharedMemoryRingBuffer::~SharedMemoryRingBuffer()
+{
+    close();
+}
+
+bool SharedMemoryRingBuffer::create (const String& name, int capacityInBytes)
+{
+    close();
+    pimpl.reset (new Pimpl (name, capacityInBytes, true));
+
+    if (! pimpl->isValid())
+        pimpl.reset();
+
+    return pimpl != nullptr;
+}
+
+bool SharedMemoryRingBuffer::openExisting (const String& name)
+{
+    close();
+    pimpl.reset (new Pimpl (name, 0, false));
+
+    if (! pimpl->isValid())
+        pimpl.reset();
+
+    return pimpl != nullptr;
+}
+
+bool SharedMemoryRingBuffer::isOpen() const noexcept
+{
+    return pimpl != nullptr;
+}
+
+void SharedMemoryRingBuffer::close()
+{
+    if (pimpl != nullptr)
+        pimpl->close();
+}
+
+bool SharedMemoryRingBuffer::isClosed() const noexcept
+{
+    return pimpl == nullptr || pimpl->header->closed != 0;
+}
+
+bool SharedMemoryRingBuffer::write (const void* sourceData, int numBytes, int timeOutMilliseconds)
+{
+    jassert (sourceData != nullptr || numBytes == 0);
+    return pimpl != nullptr && pimpl->write (sourceData, numBytes, timeOutMilliseconds);
+}
+
+bool SharedMemoryRingBuffer::read (MemoryBlock& destination, int timeOutMilliseconds)
+{
+    return pimpl != nullptr && pimpl->read (destination, timeOutMilliseconds);
+}
+
+int SharedMemoryRingBuffer::getMaxBlockSize() const noexcept
+{
+    return pimpl != nullptr ? pimpl->getMaxBlockSize() : 0;
+}
+
+#undef JUCE_SHARED_MEMORY_RING_BUFFER_AVAILABLE
+
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class SharedMemoryRingBufferTests  : public UnitTest
+{
+public:
+    SharedMemoryRingBufferTests()
+        : UnitTest ("SharedMemoryRingBuffer", UnitTestCategories::networking)
+    {}
+
+    void runTest() override
+    {
+       #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+        auto name = "juce_rb_" + String::toHexString (getRandom().nextInt());
+
+        beginTest ("Create and open");
+        {
+            SharedMemoryRingBuffer writer, reader, duplicate;
+            expect (writer.create (name, 4096));
+            expect (! duplicate.create (name, 4096));
+            expect (reader.openExisting (name));
+            expect (writer.getMaxBlockSize() == reader.getMaxBlockSize());
+            expect (writer.getMaxBlockSize() > 1024);
+
+            MemoryBlock block;
+            expect (! reader.read (block, 0));
+            expect (writer.write ("hello", 5, 0));
+            expect (reader.read (block, 0));
+            expect (block.matches ("hello", 5));
+
+            writer.close();
+            expect (reader.isClosed());
+            expect (! reader.read (block, -1));
+        }
+
+        SharedMemoryRingBuffer unnamed;
+        expect (! unnamed.openExisting (name));
+
+        beginTest ("Streaming");
+        {
+            SharedMemoryRingBuffer writer, reader;
+            expect (writer.create (name, 10000));
+            expect (reader.openExisting (name));
+
+            const int numBlocks = 20000;
+            std::atomic<int> numErrors { 0 };
+
+            UnitTestHelpers::BackgroundThread readerThread ([&]
+            {
+                MemoryBlock block;
+
+                for (int i = 0; i < numBlocks; ++i)
+                    if (! (reader.read (block, 5000) && checkBlock (block, i)))
+                        ++numErrors;
+            });
+
+            Random r (getRandom().nextInt64());
+            MemoryBlock block;
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                fillBlock (block, i, r.nextInt (writer.getMaxBlockSize()));
+                expect (writer.write (block.getData(), (int) block.getSize(), 5000));
+            }
+
+            readerThread.stopThread (10000);
+            expectEquals (numErrors.load(), 0);
+        }
+
+        beginTest ("Round trips");
+        {
+            SharedMemoryRingBuffer requests, replies, requestsReader, repliesWriter;
+            expect (requests.create (name + "a", 64 * 1024) && requestsReader.openExisting (name + "a"));
+            expect (replies.create (name + "b", 64 * 1024) && repliesWriter.openExisting (name + "b"));
+
+            UnitTestHelpers::BackgroundThread echoThread ([&]
+            {
+                MemoryBlock block;
+
+                while (requestsReader.read (block, -1))
+                    repliesWriter.write (block.getData(), (int) block.getSize(), -1);
+            });
+
+            Random r (getRandom().nextInt64());
+            MemoryBlock request, reply;
+            int numMismatches = 0;
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                fillBlock (request, i, 1 + r.nextInt (4096));
+                expect (requests.write (request.getData(), (int) request.getSize(), 5000));
+
+                if (! (replies.read (reply, 5000) && reply == request))
+                    ++numMismatches;
+            }
+
+            expectEquals (numMismatches, 0);
+
+            requests.close();
+            echoThread.stopThread (10000);
+        }
+       #endif
+    }
+
+    static void fillBlock (MemoryBlock& block, int index, int size)
+    {
+        block.setSize ((size_t) size);
+
+        for (int i = 0; i < size; ++i)
+            block[i] = (char) (index + i);
+    }
+
+    static bool checkBlock (const MemoryBlock& block, int index)
+    {
+        for (int i = 0; i < (int) block.getSize(); ++i)
+            if (block[i] != (char) (index + i))
+                return false;
+
+        return true;
+    }
+};
+
+static SharedMemoryRingBufferTests sharedMemoryRingBufferTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A lock-free FIFO of variable-sized blocks of data, held in a named region of
+    shared memory so that it can be used to stream data between two processes.
+
+    One process calls create() to make the buffer, and the other one calls
+    openExisting() with the same name. After that, exactly one thread may call
+    write() and exactly one thread may call read() - these can be in either process,
+    and the ends don't need to be used in any particular direction.
+
+    Data is copied straight into the shared memory, so this is much faster than
+    sending it through a pipe or socket, which makes it suitable for streaming
+    blocks of audio or MIDI between processes. On Linux, a thread that's waiting
+    for data or space is put to sleep on a futex in the shared memory, so it
+    wakes up as soon as the other end has done its work. On other POSIX systems
+    the waiting threads poll, and on Windows this class isn't currently supported,
+    so create() and openExisting() will always fail.
+
+    @see InterprocessConnection, ChildProcessMaster
+
+    @tags{Events}
+*/
+class JUCE_API  SharedMemoryRingBuffer  final
+{
+public:
+    //==============================================================================
+    /** Creates a SharedMemoryRingBuffer that isn't attached to any memory yet. */
+    SharedMemoryRingBuffer();
+
+    /** Destructor.
+        This calls close() and releases the memory. Make sure that no other thread is
+        still using the buffer when it's deleted.
+    */
+    ~SharedMemoryRingBuffer();
+
+    //==============================================================================
+    /** Creates a new region of shared memory with the given name.
+
+        The name should be short (30 characters or less) and only contain alphanumeric
+        characters and underscores. The capacity is the total number of bytes that can be
+        buffered, and the largest block that can be written is a little less than half of this.
+
+        Returns false if the memory couldn't be created, e.g. if one with this name already exists.
+    */
+    bool create (const String& name, int capacityInBytes);
+
+    /** Attaches to a buffer which another process has made by calling create().
+        Returns false if it doesn't exist or isn't valid.
+    */
+    bool openExisting (const String& name);
+
+    /** Returns true if this object is attached to some shared memory. */
+    bool isOpen() const noexcept;
+
+    /** Marks the buffer as closed, which will cause any reads or writes that are waiting
+        at either end of the buffer to return false.
+        Any data that has already been written can still be read after the buffer is closed.
+    */
+    void close();
+
+    /** Returns true if either end of the buffer has called close(). */
+    bool isClosed() const noexcept;
+
+    //==============================================================================
+    /** Adds a block of data to the buffer.
+
+        If there isn't enough free space, this will wait for the reader to make some, for up
+        to the given number of milliseconds (or forever if the timeout is less than zero).
+
+        Returns true if the block was written, or false if it timed out, the buffer was closed,
+        or the block is bigger than getMaxBlockSize().
+    */
+    bool write (const void* sourceData, int numBytes, int timeOutMilliseconds);
+
+    /** Removes the next block of data from the buffer.
+
+        If the buffer is empty, this will wait for a block to arrive for up to the given number
+        of milliseconds (or forever if the timeout is less than zero). The destination block will
+        be resized to fit the data, so if you re-use the same MemoryBlock for each read, it won't
+        need to be reallocated unless the size of the data changes.
+
+        Returns true if a block was read, or false if it timed out or the buffer is empty and has
+        been closed.
+    */
+    bool read (MemoryBlock& destination, int timeOutMilliseconds);
+
+    /** Returns the size of the largest block that can be written. */
+    int getMaxBlockSize() const noexcept;
+
+private:
+    //==============================================================================
+    struct Pimpl;
+    std::unique_ptr<Pimpl> pimpl;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedMemoryRingBuffer)
+};
+
+} // namespace juce
@@ -51,6 +51,18 @@
 
 #elif JUCE_LINUX
  #include <unistd.h>
+ #include <sys/epoll.h>
+ #include <sys/eventfd.h>
+ #include <sys/syscall.h>
+ #include <linux/futex.h>
+#endif
+
+#if ! JUCE_WINDOWS
+ #include <sys/socket.h>
+ #include <sys/uio.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <fcntl.h>
 #endif
 
 //==============================================================================
@@ -65,6 +77,7 @@
 #include "timers/juce_Timer.cpp"
 #include "interprocess/juce_InterprocessConnection.cpp"
 #include "interprocess/juce_InterprocessConnectionServer.cpp"
+#include "interprocess/juce_SharedMemoryRingBuffer.cpp"
 #include "interprocess/juce_ConnectedChildProcess.cpp"
 #include "interprocess/juce_NetworkServiceDiscovery.cpp"
 
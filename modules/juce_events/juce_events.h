@@ -87,6 +87,7 @@
 #include "timers/juce_MultiTimer.h"
 #include "interprocess/juce_InterprocessConnection.h"
 #include "interprocess/juce_InterprocessConnectionServer.h"
+#include "interprocess/juce_SharedMemoryRingBuffer.h"
 #include "interprocess/juce_ConnectedChildProcess.h"
 #include "interprocess/juce_NetworkServiceDiscovery.h"
 
@@ -102,3 +103,7 @@
   #include "native/juce_win32_WinRTWrapper.h"
  #endif
 #endif
+
+#if JUCE_UNIT_TESTS
+ #include "unit_tests/juce_UnitTestHelpers.h"
+#endif
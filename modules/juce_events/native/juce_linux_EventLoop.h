@@ -45,6 +45,31 @@ namespace LinuxEventLoop
         @see registerFdCallback
     */
     void unregisterFdCallback (int fd);
+
+    //==============================================================================
+    /** Some statistics about the messages that have been posted to the message queue.
+
+        @see getMessageQueueStatistics
+    */
+    struct MessageQueueStatistics
+    {
+        int64 numMessagesPosted = 0;        /**< The number of messages that have been posted. */
+        int64 numMessagesDispatched = 0;    /**< The number of messages that have been delivered. */
+        int64 numWakeUps = 0;               /**< The number of times the message thread has been signalled that the queue is no longer empty. */
+        int64 numBatches = 0;               /**< The number of batches of messages that the message thread has collected. */
+        int queueDepth = 0;                 /**< The number of messages that are currently waiting to be delivered. */
+        int maxQueueDepth = 0;              /**< The largest number of messages that have been waiting at any one time. */
+        double averageLatencyMs = 0;        /**< The average time between a message being posted and delivered. */
+        double maxLatencyMs = 0;            /**< The longest time between a message being posted and delivered. */
+    };
+
+    /** Returns statistics about the messages that have been posted since the last call to
+        resetMessageQueueStatistics().
+    */
+    MessageQueueStatistics getMessageQueueStatistics();
+
+    /** Resets the values returned by getMessageQueueStatistics(). */
+    void resetMessageQueueStatistics();
 }
 
 } // namespace juce
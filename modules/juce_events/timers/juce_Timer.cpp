@@ -23,6 +23,253 @@
 namespace juce
 {
 
+//==============================================================================
+/*  A hierarchical timing wheel, which keeps track of a set of items that are each
+    due at a particular tick, with constant-time insertion and removal.
+
+    The first level has a slot for each of the next 256 ticks, and each of the four
+    levels above it has 64 slots, each covering 64 times as many ticks as a slot in
+    the level below. As time advances, the items in a higher-level slot get spread
+    out into the lower levels when their slot comes round, and items that reach
+    their expiry tick are moved onto a list of due items, in the order in which
+    they expired.
+
+    The Item class needs the members previousItem, nextItem, expiryTime and listIndex.
+*/
+template <typename Item>
+class TimerWheel
+{
+public:
+    TimerWheel() = default;
+
+    uint64 getCurrentTime() const noexcept      { return currentTime; }
+    int size() const noexcept                   { return numItems; }
+    bool hasDueItems() const noexcept           { return lists[dueList].first != nullptr; }
+
+    static bool contains (const Item& item) noexcept    { return item.listIndex >= 0; }
+
+    void add (Item& item, uint64 expiryTime) noexcept
+    {
+        jassert (! contains (item));
+        item.expiryTime = expiryTime;
+        append (item, getListIndexFor (expiryTime));
+        ++numItems;
+    }
+
+    void remove (Item& item) noexcept
+    {
+        jassert (contains (item));
+        unlink (item);
+        --numItems;
+    }
+
+    /** Removes and returns the item that expired first, or nullptr if none are due. */
+    Item* popFirstDueItem() noexcept
+    {
+        auto* item = lists[dueList].first;
+
+        if (item != nullptr)
+            remove (*item);
+
+        return item;
+    }
+
+    /** Moves the current time forward, moving any items that expire onto the due list. */
+    void advance (uint64 numTicks) noexcept
+    {
+        auto targetTime = currentTime + numTicks;
+
+        while (currentTime < targetTime)
+        {
+            if (numScheduled == 0)
+            {
+                currentTime = targetTime;
+                break;
+            }
+
+            if (numInFirstLevel == 0)
+            {
+                // nothing can expire before the next cascade, so skip straight to it
+                auto nextCascadeTime = (currentTime | (firstLevelSize - 1)) + 1;
+
+                if (nextCascadeTime > targetTime)
+                {
+                    currentTime = targetTime;
+                    break;
+                }
+
+                currentTime = nextCascadeTime;
+            }
+            else
+            {
+                ++currentTime;
+            }
+
+            processTick();
+        }
+    }
+
+    /** Returns the number of ticks until advance() might next move an item onto the due
+        list, or -1 if there aren't any items waiting.
+    */
+    int64 getTicksUntilNextExpiry() const noexcept
+    {
+        if (hasDueItems())
+            return 0;
+
+        if (numScheduled == 0)
+            return -1;
+
+        for (uint64 i = 1; i <= firstLevelSize; ++i)
+        {
+            auto time = currentTime + i;
+            auto index = (int) (time & (firstLevelSize - 1));
+
+            if (index == 0 || lists[index].first != nullptr)
+                return (int64) i;
+        }
+
+        jassertfalse;
+        return firstLevelSize;
+    }
+
+private:
+    //==============================================================================
+    struct List
+    {
+        Item* first = nullptr;
+        Item* last = nullptr;
+    };
+
+    enum
+    {
+        firstLevelBits = 8,
+        firstLevelSize = 1 << firstLevelBits,
+        levelBits = 6,
+        levelSize = 1 << levelBits,
+        numUpperLevels = 4,
+        dueList = firstLevelSize + numUpperLevels * levelSize,
+        numLists = dueList + 1
+    };
+
+    List lists[numLists];
+    uint64 currentTime = 0;
+    int numItems = 0, numScheduled = 0, numInFirstLevel = 0;
+
+    static int getShift (int upperLevel) noexcept    { return firstLevelBits + upperLevel * levelBits; }
+
+    int getListIndexFor (uint64 expiryTime) const noexcept
+    {
+        if (expiryTime <= currentTime)
+            return dueList;
+
+        auto delta = expiryTime - currentTime;
+
+        if (delta < firstLevelSize)
+            return (int) (expiryTime & (firstLevelSize - 1));
+
+        for (int level = 0; level < numUpperLevels; ++level)
+        {
+            auto shift = getShift (level);
+
+            if (delta < ((uint64) 1 << (shift + levelBits)) || level == numUpperLevels - 1)
+            {
+                // anything beyond the range of the top level goes into its furthest slot,
+                // and will get re-distributed when that comes round
+                auto time = jmin (expiryTime, currentTime + ((uint64) 1 << (shift + levelBits)) - 1);
+                return firstLevelSize + level * levelSize + (int) ((time >> shift) & (levelSize - 1));
+            }
+        }
+
+        jassertfalse;
+        return dueList;
+    }
+
+    void processTick() noexcept
+    {
+        auto index = (int) (currentTime & (firstLevelSize - 1));
+
+        if (index == 0)
+        {
+            for (int level = 0; level < numUpperLevels; ++level)
+            {
+                auto slot = (int) ((currentTime >> getShift (level)) & (levelSize - 1));
+                cascade (firstLevelSize + level * levelSize + slot);
+
+                if (slot != 0)
+                    break;
+            }
+        }
+
+        while (auto* item = lists[index].first)
+        {
+            unlink (*item);
+            append (*item, dueList);
+        }
+    }
+
+    void cascade (int listIndex) noexcept
+    {
+        auto* item = lists[listIndex].first;
+
+        while (item != nullptr)
+        {
+            auto* next = item->nextItem;
+            unlink (*item);
+            append (*item, getListIndexFor (item->expiryTime));
+            item = next;
+        }
+    }
+
+    void append (Item& item, int index) noexcept
+    {
+        auto& list = lists[index];
+        item.listIndex = index;
+        item.previousItem = list.last;
+        item.nextItem = nullptr;
+
+        if (list.last != nullptr)
+            list.last->nextItem = &item;
+        else
+            list.first = &item;
+
+        list.last = &item;
+        updateCounts (index, 1);
+    }
+
+    void unlink (Item& item) noexcept
+    {
+        auto& list = lists[item.listIndex];
+
+        if (item.previousItem != nullptr)
+            item.previousItem->nextItem = item.nextItem;
+        else
+            list.first = item.nextItem;
+
+        if (item.nextItem != nullptr)
+            item.nextItem->previousItem = item.previousItem;
+        else
+            list.last = item.previousItem;
+
+        updateCounts (item.listIndex, -1);
+        item.previousItem = nullptr;
+        item.nextItem = nullptr;
+        item.listIndex = -1;
+    }
+
+    void updateCounts (int index, int delta) noexcept
+    {
+        if (index != dueList)
+            numScheduled += delta;
+
+        if (index < firstLevelSize)
+            numInFirstLevel += delta;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (TimerWheel)
+};
+
+//==============================================================================
 class Timer::TimerThread  : private Thread,
                             private DeletedAtShutdown,
                             private AsyncUpdater
@@ -32,7 +279,6 @@ public:
 
     TimerThread()  : Thread ("JUCE Timer")
     {
-        timers.reserve (32);
         triggerAsyncUpdate();
     }
 
@@ -95,31 +341,35 @@ public:
 
         const LockType::ScopedLockType sl (lock);
 
-        while (! timers.empty())
+        // all the timers that have become due get called back together
+        while (auto* timer = timers.popFirstDueItem())
         {
-            auto& first = timers.front();
-
-            if (first.countdownMs > 0)
-                break;
+            auto now = timers.getCurrentTime();
+            auto drift = (double) (now - timer->expiryTime) + (double) (Time::getMillisecondCounter() - lastAdvanceTime);
 
-            auto* timer = first.timer;
-            first.countdownMs = timer->timerPeriodMs;
-            shuffleTimerBackInQueue (0);
-            notify();
+            timers.add (*timer, now + (uint64) timer->timerPeriodMs);
 
-            const LockType::ScopedUnlockType ul (lock);
+            auto callbackStart = Time::getHighResolutionTicks();
 
-            JUCE_TRY
             {
-                timer->timerCallback();
+                const LockType::ScopedUnlockType ul (lock);
+
+                JUCE_TRY
+                {
+                    timer->timerCallback();
+                }
+                JUCE_CATCH_EXCEPTION
             }
-            JUCE_CATCH_EXCEPTION
+
+            statistics.addCallback (Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - callbackStart) * 1000.0,
+                                    drift);
 
             // avoid getting stuck in a loop if a timer callback repeatedly takes too long
             if (Time::getMillisecondCounter() > timeout)
                 break;
         }
 
+        notify();
         callbackArrived.signal();
     }
 
@@ -156,17 +406,60 @@ public:
             instance->resetTimerCounter (tim);
     }
 
+    static Statistics getStatistics()
+    {
+        const LockType::ScopedLockType sl (lock);
+
+        auto result = statistics.getStatistics();
+        result.numTimersRunning = instance != nullptr ? instance->timers.size() : 0;
+        return result;
+    }
+
+    static void resetStatistics()
+    {
+        const LockType::ScopedLockType sl (lock);
+        statistics = {};
+    }
+
     static TimerThread* instance;
     static LockType lock;
 
 private:
-    struct TimerCountdown
+    struct StatisticsAccumulator
     {
-        Timer* timer;
-        int countdownMs;
+        void addCallback (double durationMs, double driftMs) noexcept
+        {
+            ++numCallbacks;
+            totalDurationMs += durationMs;
+            totalDriftMs += driftMs;
+            maxDurationMs = jmax (maxDurationMs, durationMs);
+            maxDriftMs = jmax (maxDriftMs, driftMs);
+        }
+
+        Statistics getStatistics() const noexcept
+        {
+            Statistics s;
+            s.numCallbacks = numCallbacks;
+            s.maxCallbackDurationMs = maxDurationMs;
+            s.maxDriftMs = maxDriftMs;
+
+            if (numCallbacks > 0)
+            {
+                s.averageCallbackDurationMs = totalDurationMs / (double) numCallbacks;
+                s.averageDriftMs = totalDriftMs / (double) numCallbacks;
+            }
+
+            return s;
+        }
+
+        int64 numCallbacks = 0;
+        double totalDurationMs = 0, maxDurationMs = 0, totalDriftMs = 0, maxDriftMs = 0;
     };
 
-    std::vector<TimerCountdown> timers;
+    TimerWheel<Timer> timers;
+    uint32 lastAdvanceTime = Time::getMillisecondCounter();
+    uint64 nextWakeUpTime = 0;
+    static StatisticsAccumulator statistics;
 
     WaitableEvent callbackArrived;
 
@@ -186,120 +479,54 @@ private:
     {
         // Trying to add a timer that's already here - shouldn't get to this point,
         // so if you get this assertion, let me know!
-        jassert (std::find_if (timers.begin(), timers.end(),
-                               [t] (TimerCountdown i) { return i.timer == t; }) == timers.end());
+        jassert (! timers.contains (*t));
 
-        auto pos = timers.size();
-
-        timers.push_back ({ t, t->timerPeriodMs });
-        t->positionInQueue = pos;
-        shuffleTimerForwardInQueue (pos);
-        notify();
+        timers.add (*t, timers.getCurrentTime() + (uint64) t->timerPeriodMs);
+        wakeUpIfNeeded (*t);
     }
 
     void removeTimer (Timer* t)
     {
-        auto pos = t->positionInQueue;
-        auto lastIndex = timers.size() - 1;
-
-        jassert (pos <= lastIndex);
-        jassert (timers[pos].timer == t);
-
-        for (auto i = pos; i < lastIndex; ++i)
-        {
-            timers[i] = timers[i + 1];
-            timers[i].timer->positionInQueue = i;
-        }
-
-        timers.pop_back();
+        timers.remove (*t);
     }
 
     void resetTimerCounter (Timer* t) noexcept
     {
-        auto pos = t->positionInQueue;
-
-        jassert (pos < timers.size());
-        jassert (timers[pos].timer == t);
+        auto newExpiryTime = timers.getCurrentTime() + (uint64) t->timerPeriodMs;
 
-        auto lastCountdown = timers[pos].countdownMs;
-        auto newCountdown = t->timerPeriodMs;
-
-        if (newCountdown != lastCountdown)
+        if (newExpiryTime != t->expiryTime)
         {
-            timers[pos].countdownMs = newCountdown;
-
-            if (newCountdown > lastCountdown)
-                shuffleTimerBackInQueue (pos);
-            else
-                shuffleTimerForwardInQueue (pos);
-
-            notify();
+            timers.remove (*t);
+            timers.add (*t, newExpiryTime);
+            wakeUpIfNeeded (*t);
         }
     }
 
-    void shuffleTimerBackInQueue (size_t pos)
+    int getTimeUntilFirstTimer (int numMillisecsElapsed)
     {
-        auto numTimers = timers.size();
-
-        if (pos < numTimers - 1)
-        {
-            auto t = timers[pos];
-
-            for (;;)
-            {
-                auto next = pos + 1;
-
-                if (next == numTimers || timers[next].countdownMs >= t.countdownMs)
-                    break;
+        const LockType::ScopedLockType sl (lock);
 
-                timers[pos] = timers[next];
-                timers[pos].timer->positionInQueue = pos;
+        timers.advance ((uint64) jmax (0, numMillisecsElapsed));
+        lastAdvanceTime = Time::getMillisecondCounter();
 
-                ++pos;
-            }
+        auto ticksUntilNextExpiry = timers.getTicksUntilNextExpiry();
+        auto timeUntilFirstTimer = ticksUntilNextExpiry < 0 ? 1000 : (int) jmin ((int64) 1000, ticksUntilNextExpiry);
 
-            timers[pos] = t;
-            t.timer->positionInQueue = pos;
-        }
+        nextWakeUpTime = timers.getCurrentTime() + (uint64) jlimit (0, 100, timeUntilFirstTimer);
+        return timeUntilFirstTimer;
     }
 
-    void shuffleTimerForwardInQueue (size_t pos)
+    // The thread only needs waking if a timer is now due before it was going to wake up
+    // anyway, which saves a lot of needless context-switching when timers are restarted.
+    void wakeUpIfNeeded (const Timer& t) noexcept
     {
-        if (pos > 0)
+        if (t.expiryTime < nextWakeUpTime)
         {
-            auto t = timers[pos];
-
-            while (pos > 0)
-            {
-                auto& prev = timers[(size_t) pos - 1];
-
-                if (prev.countdownMs <= t.countdownMs)
-                    break;
-
-                timers[pos] = prev;
-                timers[pos].timer->positionInQueue = pos;
-
-                --pos;
-            }
-
-            timers[pos] = t;
-            t.timer->positionInQueue = pos;
+            nextWakeUpTime = t.expiryTime;
+            notify();
         }
     }
 
-    int getTimeUntilFirstTimer (int numMillisecsElapsed)
-    {
-        const LockType::ScopedLockType sl (lock);
-
-        if (timers.empty())
-            return 1000;
-
-        for (auto& t : timers)
-            t.countdownMs -= numMillisecsElapsed;
-
-        return timers.front().countdownMs;
-    }
-
     void handleAsyncUpdate() override
     {
         startThread (7);
@@ -310,6 +537,7 @@ private:
 
 Timer::TimerThread* Timer::TimerThread::instance = nullptr;
 Timer::TimerThread::LockType Timer::TimerThread::lock;
+Timer::TimerThread::StatisticsAccumulator Timer::TimerThread::statistics;
 
 //==============================================================================
 Timer::Timer() noexcept {}
@@ -370,6 +598,16 @@ void JUCE_CALLTYPE Timer::callPendingTimersSynchronously()
         TimerThread::instance->callTimersSynchronously();
 }
 
+Timer::Statistics JUCE_CALLTYPE Timer::getStatistics()
+{
+    return TimerThread::getStatistics();
+}
+
+void JUCE_CALLTYPE Timer::resetStatistics()
+{
+    TimerThread::resetStatistics();
+}
+
 struct LambdaInvoker  : private Timer
 {
     LambdaInvoker (int milliseconds, std::function<void()> f)  : function (f)
@@ -394,4 +632,182 @@ void JUCE_CALLTYPE Timer::callAfterDelay (int milliseconds, std::function<void()
     new LambdaInvoker (milliseconds, f);
 }
 
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class TimerTests  : public UnitTest
+{
+public:
+    TimerTests()
+        : UnitTest ("Timer", UnitTestCategories::time)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Timer wheel");
+        {
+            auto r = getRandom();
+            TimerWheel<Item> wheel;
+            OwnedArray<Item> items;
+
+            for (int i = 0; i < 3000; ++i)
+            {
+                auto* item = items.add (new Item());
+                item->dueTime = (uint64) r.nextInt (1 << (8 + (i % 20)));
+
+                if (i % 100 == 0)
+                    item->dueTime += (uint64) 1 << 33;
+
+                wheel.add (*item, item->dueTime);
+            }
+
+            for (int i = 0; i < items.size(); i += 7)
+            {
+                wheel.remove (*items[i]);
+                items[i]->wasRemoved = true;
+            }
+
+            int numPopped = 0;
+            bool allOnTime = true, allInOrder = true;
+
+            while (wheel.size() > 0)
+            {
+                auto previousTime = wheel.getCurrentTime();
+                auto ticksToAdvance = r.nextBool() ? (uint64) r.nextInt (5000) : (uint64) r.nextInt64() & 0xfffffff;
+                wheel.advance (ticksToAdvance + 1);
+                uint64 lastDueTime = 0;
+
+                while (auto* item = wheel.popFirstDueItem())
+                {
+                    allOnTime = allOnTime && (item->dueTime <= wheel.getCurrentTime()
+                                               && (item->dueTime > previousTime || item->dueTime == 0));
+                    allInOrder = allInOrder && item->dueTime >= lastDueTime;
+                    lastDueTime = item->dueTime;
+                    item->wasPopped = true;
+                    ++numPopped;
+                }
+            }
+
+            expect (allOnTime);
+            expect (allInOrder);
+
+            int numExpected = 0;
+
+            for (auto* item : items)
+            {
+                if (! item->wasRemoved)
+                    ++numExpected;
+
+                expect (item->wasPopped != item->wasRemoved);
+            }
+
+            expectEquals (numPopped, numExpected);
+        }
+
+        // the rest of these tests need to be able to run the message loop
+        if (! MessageManager::getInstance()->isThisTheMessageThread())
+            return;
+
+        beginTest ("Timer callbacks");
+        {
+            Array<int> order;
+
+            std::unique_ptr<TestTimer> timer1 (new TestTimer ([&] (TestTimer& t) { order.add (30); t.stopTimer(); })),
+                                       timer2 (new TestTimer ([&] (TestTimer& t) { order.add (10); t.stopTimer(); })),
+                                       timer3 (new TestTimer ([&] (TestTimer& t) { order.add (20); t.stopTimer(); timer1->startTimer (30); }));
+
+            int numRepeats = 0;
+            TestTimer repeating ([&] (TestTimer&) { ++numRepeats; });
+
+            timer1->startTimer (30);
+            timer2->startTimer (10);
+            timer3->startTimer (20);
+            repeating.startTimer (5);
+
+            UnitTestHelpers::runMessageLoopUntil ([&] { return order.size() == 3; });
+            repeating.stopTimer();
+
+            expectEquals (order.size(), 3);
+            expectEquals (order[0], 10);
+            expectEquals (order[1], 20);
+            expectEquals (order[2], 30);
+            expect (numRepeats > 2);
+            expect (! timer1->isTimerRunning());
+
+            auto stopped = numRepeats;
+            UnitTestHelpers::runMessageLoopUntil ([] { return false; }, 30);
+            expectEquals (numRepeats, stopped);
+
+            auto stats = Timer::getStatistics();
+            expect (stats.numCallbacks >= 3);
+            expect (stats.maxDriftMs >= stats.averageDriftMs);
+        }
+
+        beginTest ("Many timers");
+        {
+            const int numTimers = 20000;
+            auto r = getRandom();
+            OwnedArray<TestTimer> timers;
+            int numCallbacks = 0;
+
+            for (int i = 0; i < numTimers; ++i)
+                timers.add (new TestTimer ([&] (TestTimer&) { ++numCallbacks; }));
+
+            for (auto* t : timers)
+                t->startTimer (1000 + r.nextInt (100000));
+
+            for (auto* t : timers)
+                t->startTimer (1000 + r.nextInt (100000));
+
+            expect (std::all_of (timers.begin(), timers.end(), [] (TestTimer* t) { return t->isTimerRunning(); }));
+
+            for (auto* t : timers)
+                t->stopTimer();
+
+            expect (std::none_of (timers.begin(), timers.end(), [] (TestTimer* t) { return t->isTimerRunning(); }));
+
+            Timer::resetStatistics();
+
+            for (int i = 0; i < 2000; ++i)
+                timers[i]->startTimer (5 + r.nextInt (50));
+
+            UnitTestHelpers::runMessageLoopUntil ([&] { return numCallbacks > 4000; });
+
+            for (auto* t : timers)
+                t->stopTimer();
+
+            expect (numCallbacks > 4000);
+            expect (Timer::getStatistics().numCallbacks >= numCallbacks);
+        }
+    }
+
+private:
+    struct Item
+    {
+        Item* previousItem = nullptr;
+        Item* nextItem = nullptr;
+        uint64 expiryTime = 0;
+        int listIndex = -1;
+
+        uint64 dueTime = 0;
+        bool wasRemoved = false, wasPopped = false;
+    };
+
+    struct TestTimer  : public Timer
+    {
+        TestTimer (std::function<void (TestTimer&)> cb)  : callback (std::move (cb)) {}
+        ~TestTimer() override   { stopTimer(); }
+
+        void timerCallback() override   { callback (*this); }
+
+        std::function<void (TestTimer&)> callback;
+    };
+};
+
+static TimerTests timerTests;
+
+#endif
+
 } // namespace juce
@@ -39,6 +39,12 @@ namespace juce
     anything that blocks the message queue for a period of time will also prevent
     any timers from running until it can carry on.
 
+    Starting, stopping and resetting a timer takes constant time, regardless of
+    how many other timers are running, and all the timers that become due at
+    around the same time are called back from a single message. If you need to
+    find out which timers are taking up too much time, getStatistics() will tell
+    you how long the callbacks are taking, and how late they're being made.
+
     If you need to have a single callback that is shared by multiple timers with
     different frequencies, then the MultiTimer class allows you to do that - its
     structure is very similar to the Timer class, but contains multiple timers
@@ -125,10 +131,38 @@ public:
     */
     static void JUCE_CALLTYPE callPendingTimersSynchronously();
 
+    //==============================================================================
+    /** Holds some statistics about the timer callbacks that have been made, which can
+        help to track down timers that are hogging the message thread.
+        @see getStatistics
+    */
+    struct Statistics
+    {
+        int numTimersRunning = 0;               /**< The number of timers that are currently running. */
+        int64 numCallbacks = 0;                 /**< The number of timer callbacks that have been made. */
+        double averageCallbackDurationMs = 0;   /**< The average time spent inside each timerCallback(). */
+        double maxCallbackDurationMs = 0;       /**< The longest time spent inside a single timerCallback(). */
+        double averageDriftMs = 0;              /**< On average, how long after its due time each callback was made. */
+        double maxDriftMs = 0;                  /**< The furthest that any callback has been made after its due time. */
+    };
+
+    /** Returns statistics about the timer callbacks that have been made since the
+        last call to resetStatistics().
+    */
+    static Statistics JUCE_CALLTYPE getStatistics();
+
+    /** Resets the values returned by getStatistics(). */
+    static void JUCE_CALLTYPE resetStatistics();
+
 private:
     class TimerThread;
     friend class TimerThread;
-    size_t positionInQueue = (size_t) -1;
+    template <typename> friend class TimerWheel;
+
+    Timer* previousItem = nullptr;
+    Timer* nextItem = nullptr;
+    uint64 expiryTime = 0;
+    int listIndex = -1;
     int timerPeriodMs = 0;
 
     Timer& operator= (const Timer&) = delete;
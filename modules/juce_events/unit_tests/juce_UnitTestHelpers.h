@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+// Utilities that are shared by the unit tests of the modules that use threads and the message loop.
+namespace UnitTestHelpers
+{
+    // Runs a function on its own thread, which is stopped and waited for when this object is deleted.
+    struct BackgroundThread  : public Thread
+    {
+        BackgroundThread (std::function<void()> fn)  : Thread ("unit test"), function (std::move (fn))
+        {
+            startThread();
+        }
+
+        ~BackgroundThread() override    { stopThread (10000); }
+
+        void run() override    { function(); }
+
+        std::function<void()> function;
+
+        JUCE_DECLARE_NON_COPYABLE (BackgroundThread)
+    };
+
+    // Runs the message loop until the condition is true, or the timeout has expired.
+    static inline void runMessageLoopUntil (std::function<bool()> condition, int timeoutMs = 2000)
+    {
+        auto endTime = Time::getMillisecondCounter() + (uint32) timeoutMs;
+
+        while (! condition() && Time::getMillisecondCounter() < endTime)
+            MessageManager::getInstance()->runDispatchLoopUntil (1);
+    }
+
+    // Waits on the calling thread until the condition is true, or the timeout has expired,
+    // and returns the condition's final value.
+    static inline bool waitUntil (std::function<bool()> condition, int timeoutMs = 5000)
+    {
+        for (auto endTime = Time::getMillisecondCounter() + (uint32) timeoutMs; Time::getMillisecondCounter() < endTime;)
+        {
+            if (condition())
+                return true;
+
+            Thread::sleep (1);
+        }
+
+        return condition();
+    }
+}
+
+} // namespace juce
@@ -48,6 +48,19 @@ namespace
 LowLevelGraphicsContext::LowLevelGraphicsContext() {}
 LowLevelGraphicsContext::~LowLevelGraphicsContext() {}
 
+void LowLevelGraphicsContext::fillVerticalSpans (Rectangle<float> area, const Range<float>* spans, int numSpans)
+{
+    RectangleList<float> columns;
+    columns.ensureStorageAllocated (numSpans);
+    auto columnWidth = area.getWidth() / (float) numSpans;
+
+    for (int i = 0; i < numSpans; ++i)
+        columns.addWithoutMerging ({ area.getX() + columnWidth * (float) i, spans[i].getStart(),
+                                     columnWidth, spans[i].getLength() });
+
+    fillRectList (columns);
+}
+
 //==============================================================================
 Graphics::Graphics (const Image& imageToDrawOnto)
     : contextHolder (imageToDrawOnto.createLowLevelContext()),
@@ -411,7 +424,8 @@ void Graphics::strokePath (const Path& path,
                            const AffineTransform& transform) const
 {
     Path stroke;
-    strokeType.createStrokedPath (stroke, path, transform, context.getPhysicalPixelScaleFactor());
+    RenderingHelpers::PathCache::getInstance().createStrokedPath (stroke, path, strokeType, transform,
+                                                                  context.getPhysicalPixelScaleFactor());
     fillPath (stroke);
 }
 
@@ -512,6 +526,93 @@ void Graphics::drawArrow (Line<float> line, float lineThickness, float arrowhead
     fillPath (p);
 }
 
+//==============================================================================
+void Graphics::drawWaveform (const float* samples, int numSamples, Rectangle<float> area,
+                             Range<float> valueRange, float lineThickness) const
+{
+    jassert (samples != nullptr || numSamples <= 0);
+
+    if (numSamples <= 0 || area.isEmpty() || valueRange.isEmpty())
+        return;
+
+    auto numColumns = jmax (1, roundToInt (area.getWidth() * context.getPhysicalPixelScaleFactor()));
+    auto yScale = -area.getHeight() / valueRange.getLength();
+    auto yOffset = area.getBottom() - valueRange.getStart() * yScale;
+
+    if (numSamples < numColumns * 2)
+    {
+        HeapBlock<Point<float>> points ((size_t) numSamples);
+        auto xScale = numSamples > 1 ? area.getWidth() / (float) (numSamples - 1) : 0.0f;
+
+        for (int i = 0; i < numSamples; ++i)
+            points[i] = { area.getX() + xScale * (float) i, yOffset + yScale * samples[i] };
+
+        Path p;
+        PathStrokeType (lineThickness).createStrokedPolyline (p, points, numSamples);
+        fillPath (p);
+        return;
+    }
+
+    HeapBlock<Range<float>> spans ((size_t) numColumns);
+    auto halfThickness = lineThickness * 0.5f;
+    int start = 0;
+
+    for (int i = 0; i < numColumns; ++i)
+    {
+        auto end = (int) (((int64) numSamples * (i + 1)) / numColumns);
+
+        // each column also includes the last sample of the one before it, so that a steep
+        // edge between two columns is drawn as a joined-up line
+        auto first = jmax (0, start - 1);
+        auto minMax = RenderingHelpers::SampleRanges::findMinAndMax (samples + first, end - first);
+
+        spans[i] = { yOffset + yScale * minMax.getEnd()   - halfThickness,
+                     yOffset + yScale * minMax.getStart() + halfThickness };
+        start = end;
+    }
+
+    context.fillVerticalSpans (area, spans, numColumns);
+}
+
+void Graphics::fillWaveformEnvelope (const Range<float>* levels, int numLevels, Rectangle<float> area,
+                                     Range<float> valueRange) const
+{
+    jassert (levels != nullptr || numLevels <= 0);
+
+    if (numLevels <= 0 || area.isEmpty() || valueRange.isEmpty())
+        return;
+
+    auto numColumns = jmax (1, roundToInt (area.getWidth() * context.getPhysicalPixelScaleFactor()));
+    auto yScale = -area.getHeight() / valueRange.getLength();
+    auto yOffset = area.getBottom() - valueRange.getStart() * yScale;
+
+    HeapBlock<Range<float>> spans ((size_t) numColumns);
+
+    for (int i = 0; i < numColumns; ++i)
+    {
+        auto first = (int) (((int64) numLevels * i) / numColumns);
+        auto end = jmax (first + 1, (int) (((int64) numLevels * (i + 1)) / numColumns));
+
+        Range<float> total;
+        bool isEmpty = true;
+
+        for (int j = first; j < end; ++j)
+        {
+            if (! levels[j].isEmpty())
+            {
+                total = isEmpty ? levels[j] : total.getUnionWith (levels[j]);
+                isEmpty = false;
+            }
+        }
+
+        spans[i] = isEmpty ? Range<float>()
+                           : Range<float> (yOffset + yScale * total.getEnd(),
+                                           yOffset + yScale * total.getStart());
+    }
+
+    context.fillVerticalSpans (area, spans, numColumns);
+}
+
 void Graphics::fillCheckerBoard (Rectangle<float> area, float checkWidth, float checkHeight,
                                  Colour colour1, Colour colour2) const
 {
@@ -635,6 +736,12 @@ void Graphics::setImageResamplingQuality (const Graphics::ResamplingQuality newQ
     context.setInterpolationQuality (newQuality);
 }
 
+void Graphics::setPathRasteriser (EdgeTable::PathRasteriser newRasteriser)
+{
+    saveStateIfPending();
+    context.setPathRasteriser (newRasteriser);
+}
+
 //==============================================================================
 void Graphics::drawImageAt (const Image& imageToDraw, int x, int y, bool fillAlphaChannel) const
 {
@@ -455,6 +455,38 @@ public:
                     float arrowheadWidth,
                     float arrowheadLength) const;
 
+    //==============================================================================
+    /** Draws a block of sample values as a waveform, stretched to fill a rectangle.
+
+        Each sample is plotted as a point, with the first one at the left of the area and
+        the last one at its right, and the start and end of valueRange being mapped onto the
+        bottom and top of the area. If there are more samples than there are pixel columns
+        to draw them into, the samples belonging to each column are reduced to their minimum
+        and maximum values and the column is filled between them. This is far quicker than
+        stroking a path through all the points, but it won't look quite the same: each column
+        is a solid vertical span, so steep or sparse sections look stepped rather than being
+        joined by smooth anti-aliased lines. When there are fewer samples than that, they're
+        stroked as a line in the normal way.
+
+        @see fillWaveformEnvelope
+    */
+    void drawWaveform (const float* samples, int numSamples,
+                       Rectangle<float> area, Range<float> valueRange,
+                       float lineThickness = 1.0f) const;
+
+    /** Fills the envelope described by a set of min/max ranges, stretched to fill a rectangle.
+
+        The ranges are spread evenly across the width of the area, and the start and end of
+        valueRange are mapped onto the bottom and top of the area. When there are more
+        ranges than pixel columns, each column is filled between the lowest and highest
+        values of the ranges that fall inside it, and when there are fewer, each range is
+        drawn as a flat step across the columns that it covers. Empty ranges are left unfilled.
+
+        @see drawWaveform
+    */
+    void fillWaveformEnvelope (const Range<float>* levels, int numLevels,
+                               Rectangle<float> area, Range<float> valueRange) const;
+
 
     //==============================================================================
     /** Types of rendering quality that can be specified when drawing images.
@@ -474,6 +506,18 @@ public:
     */
     void setImageResamplingQuality (const ResamplingQuality newQuality);
 
+    /** Changes the algorithm that the software renderer uses to work out which pixels a
+        filled path covers.
+
+        By default, EdgeTable::PathRasteriser::subScanline is used, but the analytic rasteriser
+        can be much faster for paths with very large numbers of edges, such as waveforms.
+        This only affects paths that are filled or stroked, not paths used as clip regions,
+        and contexts that don't use an EdgeTable to draw paths will ignore it.
+
+        @see EdgeTable::PathRasteriser
+    */
+    void setPathRasteriser (EdgeTable::PathRasteriser newRasteriser);
+
     /** Draws an image.
 
         This will draw the whole of an image, positioning its top-left corner at the
@@ -85,11 +85,23 @@ public:
     virtual void setOpacity (float) = 0;
     virtual void setInterpolationQuality (Graphics::ResamplingQuality) = 0;
 
+    /** Chooses the algorithm that's used to rasterise filled paths.
+        Contexts that don't render paths using an EdgeTable can ignore this.
+    */
+    virtual void setPathRasteriser (EdgeTable::PathRasteriser)  {}
+
     //==============================================================================
     virtual void fillRect (const Rectangle<int>&, bool replaceExistingContents) = 0;
     virtual void fillRect (const Rectangle<float>&) = 0;
     virtual void fillRectList (const RectangleList<float>&) = 0;
     virtual void fillPath (const Path&, const AffineTransform&) = 0;
+
+    /** Fills a vertical span in each of a row of equal-width columns that are spread across
+        an area, as used by Graphics::drawWaveform() and Graphics::fillWaveformEnvelope().
+        Each span holds the top and bottom y positions of its column. The default
+        implementation just fills the columns as a list of rectangles.
+    */
+    virtual void fillVerticalSpans (Rectangle<float> area, const Range<float>* spans, int numSpans);
     virtual void drawImage (const Image&, const AffineTransform&) = 0;
     virtual void drawLine (const Line<float>&) = 0;
 
@@ -41,4 +41,754 @@ LowLevelGraphicsSoftwareRenderer::LowLevelGraphicsSoftwareRenderer (const Image&
 
 LowLevelGraphicsSoftwareRenderer::~LowLevelGraphicsSoftwareRenderer() {}
 
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class SoftwareRendererPixelBlendingTests  : public UnitTest
+{
+public:
+    SoftwareRendererPixelBlendingTests()
+        : UnitTest ("Software renderer pixel blending", UnitTestCategories::graphics)
+    {}
+
+    void runTest() override
+    {
+        auto r = getRandom();
+
+        beginTest ("Blending runs of pixels matches the pixel classes");
+        {
+            for (int width = 1; width < 70; ++width)
+            {
+                for (int offset = 0; offset < 4; ++offset)
+                {
+                    auto src = createRandomPixels<PixelARGB> (r, width + offset);
+                    auto dest = createRandomPixels<PixelARGB> (r, width + offset);
+                    auto alpha = (uint32) r.nextInt (256);
+
+                    auto expected = dest, actual = dest;
+                    scalarBlend (expected.data() + offset, src.data() + offset, width, 0x100);
+                    RenderingHelpers::SpanBlending::blendPixels (actual.data() + offset, 4, src.data() + offset, 4, width);
+                    expect (pixelsMatch (expected, actual), "width " + String (width));
+
+                    expected = dest;
+                    actual = dest;
+                    scalarBlend (expected.data() + offset, src.data() + offset, width, alpha);
+                    RenderingHelpers::SpanBlending::blendPixels (actual.data() + offset, 4, src.data() + offset, 4, width, alpha);
+                    expect (pixelsMatch (expected, actual), "width " + String (width) + ", alpha " + String (alpha));
+                }
+            }
+        }
+
+        beginTest ("Blending a colour matches the pixel classes");
+        {
+            for (int width = 1; width < 70; ++width)
+            {
+                for (int offset = 0; offset < 4; ++offset)
+                {
+                    PixelARGB colour ((uint8) r.nextInt (256), (uint8) r.nextInt (256), (uint8) r.nextInt (256), (uint8) r.nextInt (256));
+                    colour.premultiply();
+
+                    checkColourBlend<PixelARGB>  (r, colour, width, offset);
+                    checkColourBlend<PixelRGB>   (r, colour, width, offset);
+                    checkColourBlend<PixelAlpha> (r, colour, width, offset);
+                }
+            }
+        }
+
+        beginTest ("Filled images match the pixel classes");
+        {
+            for (auto format : { Image::ARGB, Image::RGB, Image::SingleChannel })
+            {
+                Image image (format, 67, 23, false);
+                Image::BitmapData data (image, Image::BitmapData::readWrite);
+
+                for (int y = 0; y < image.getHeight(); ++y)
+                    for (int x = 0; x < image.getWidth(); ++x)
+                        data.setPixelColour (x, y, Colour ((uint32) r.nextInt()).withAlpha ((uint8) r.nextInt (256)));
+
+                auto expected = image.createCopy();
+                auto colour = Colour ((uint32) r.nextInt()).withAlpha (0.6f);
+                PixelARGB pixel (colour.getPixelARGB());
+
+                {
+                    Image::BitmapData expectedData (expected, Image::BitmapData::readWrite);
+
+                    for (int y = 0; y < image.getHeight(); ++y)
+                    {
+                        for (int x = 0; x < image.getWidth(); ++x)
+                        {
+                            auto* p = expectedData.getPixelPointer (x, y);
+
+                            if (format == Image::ARGB)      ((PixelARGB*)  p)->blend (pixel);
+                            else if (format == Image::RGB)  ((PixelRGB*)   p)->blend (pixel);
+                            else                            ((PixelAlpha*) p)->blend (pixel);
+                        }
+                    }
+                }
+
+                {
+                    Graphics g (image);
+                    g.setColour (colour);
+                    g.fillAll();
+                }
+
+                Image::BitmapData expectedData (expected, Image::BitmapData::readOnly);
+                bool matches = true;
+
+                for (int y = 0; y < image.getHeight(); ++y)
+                    matches = matches && memcmp (data.getLinePointer (y), expectedData.getLinePointer (y),
+                                                 (size_t) (image.getWidth() * data.pixelStride)) == 0;
+
+                expect (matches);
+            }
+        }
+
+        beginTest ("Full-screen fills");
+        {
+            const int width = 1920, height = 1080;
+            Image image (Image::ARGB, width, height, true);
+            Image sprite (Image::ARGB, width, height, true);
+            sprite.clear (sprite.getBounds(), Colours::orange.withAlpha (0.7f));
+
+            auto colour = Colours::red.withAlpha (0.5f);
+            PixelARGB expected (0, 0, 0, 0);
+            expected.blend (PixelARGB (colour.getPixelARGB()));
+
+            {
+                Graphics g (image);
+                g.setColour (colour);
+                g.fillAll();
+            }
+
+            expect (allPixelsAre (image, expected));
+
+            expected.blend (PixelARGB (Colours::orange.withAlpha (0.7f).getPixelARGB()));
+
+            {
+                Graphics g (image);
+                g.drawImageAt (sprite, 0, 0);
+            }
+
+            expect (allPixelsAre (image, expected));
+
+            auto src = createRandomPixels<PixelARGB> (r, width);
+            auto dest = createRandomPixels<PixelARGB> (r, width);
+            auto expectedSpan = dest;
+
+            scalarBlend (expectedSpan.data(), src.data(), width, 0x80);
+            RenderingHelpers::SpanBlending::blendPixels (dest.data(), 4, src.data(), 4, width, 0x80);
+            expect (pixelsMatch (expectedSpan, dest));
+        }
+    }
+
+    template <class PixelType>
+    static std::vector<PixelType> createRandomPixels (Random& r, int num)
+    {
+        std::vector<PixelType> pixels ((size_t) num);
+        r.fillBitsRandomly (pixels.data(), pixels.size() * sizeof (PixelType));
+        return pixels;
+    }
+
+    template <class PixelType>
+    static bool pixelsMatch (const std::vector<PixelType>& a, const std::vector<PixelType>& b)
+    {
+        return memcmp (a.data(), b.data(), a.size() * sizeof (PixelType)) == 0;
+    }
+
+    static bool allPixelsAre (const Image& image, PixelARGB expected)
+    {
+        const Image::BitmapData data (image, Image::BitmapData::readOnly);
+
+        for (int y = 0; y < data.height; ++y)
+            for (int x = 0; x < data.width; ++x)
+                if (((const PixelARGB*) data.getPixelPointer (x, y))->getNativeARGB() != expected.getNativeARGB())
+                    return false;
+
+        return true;
+    }
+
+    static void scalarBlend (PixelARGB* dest, const PixelARGB* src, int width, uint32 alpha)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            if (alpha < 0x100)
+                dest[i].blend (src[i], alpha);
+            else
+                dest[i].blend (src[i]);
+        }
+    }
+
+    template <class PixelType>
+    void checkColourBlend (Random& r, PixelARGB colour, int width, int offset)
+    {
+        auto dest = createRandomPixels<PixelType> (r, width + offset);
+        auto expected = dest, actual = dest;
+
+        for (int i = 0; i < width; ++i)
+            expected[(size_t) (i + offset)].blend (colour);
+
+        RenderingHelpers::SpanBlending::blendColour (actual.data() + offset, (int) sizeof (PixelType), colour, width);
+        expect (pixelsMatch (expected, actual), "width " + String (width) + ", pixel size " + String ((int) sizeof (PixelType)));
+    }
+};
+
+static SoftwareRendererPixelBlendingTests softwareRendererPixelBlendingTests;
+
+//==============================================================================
+class SoftwareRendererGlyphCacheTests  : public UnitTest
+{
+public:
+    SoftwareRendererGlyphCacheTests()
+        : UnitTest ("Software renderer glyph cache", UnitTestCategories::graphics)
+    {}
+
+    using SavedState = RenderingHelpers::SoftwareRendererSavedState;
+    using GlyphCache = SavedState::GlyphCacheType;
+
+    void runTest() override
+    {
+        auto r = getRandom();
+        const String text ("Quick brown foxes jump over the lazy dog 0123456789 {}@&%");
+
+        beginTest ("Glyph images match edge-tables");
+        {
+            for (auto height : { 7.0f, 12.0f, 15.5f, 23.0f, 40.0f, 90.0f })
+            {
+                Font font (height);
+                Array<int> glyphNumbers;
+                Array<float> offsets;
+                font.getGlyphPositions (text, glyphNumbers, offsets);
+
+                for (auto glyphNumber : glyphNumbers)
+                {
+                    Point<float> pos (10.0f + r.nextFloat() * 20.0f, height + r.nextFloat() * 10.0f);
+                    auto phase = RenderingHelpers::CachedGlyphBitmap<SavedState>::getSubpixelPhase (*font.getTypeface(), pos.x);
+
+                    RenderingHelpers::CachedGlyphBitmap<SavedState> bitmap;
+                    bitmap.generate (font, glyphNumber, phase);
+
+                    RenderingHelpers::CachedGlyphEdgeTable<SavedState> edgeTable;
+                    edgeTable.generate (font, glyphNumber, 0);
+
+                    // The bitmaps are drawn at the nearest quarter-pixel. Partially-covered pixels are
+                    // blended one at a time rather than in runs, which can make them differ by 1
+                    auto edgeTablePos = pos.withX (std::floor (pos.x * 4.0f + 0.5f) / 4.0f);
+
+                    for (auto format : { Image::ARGB, Image::RGB })
+                    {
+                        Image expected (format, 150, 150, true), actual (format, 150, 150, true);
+                        auto colour = Colour ((uint8) r.nextInt (100), (uint8) r.nextInt (100), (uint8) r.nextInt (100), 0.8f);
+
+                        SavedState expectedState (expected, expected.getBounds());
+                        expectedState.setFillType (colour);
+                        edgeTable.draw (expectedState, edgeTablePos);
+
+                        SavedState actualState (actual, actual.getBounds());
+                        actualState.setFillType (colour);
+                        bitmap.draw (actualState, pos);
+
+                        expect (imagesMatch (expected, actual, 1), "height " + String (height) + ", glyph " + String (glyphNumber));
+                    }
+                }
+            }
+        }
+
+        beginTest ("Glyphs are clipped correctly");
+        {
+            Image image (Image::ARGB, 300, 200, true);
+            Image clipped (Image::ARGB, 300, 200, true);
+
+            RectangleList<int> clip (image.getBounds());
+            clip.subtract ({ 20, 30, 100, 40 });
+            clip.subtract ({ 170, 90, 50, 90 });
+
+            auto seed = r.nextInt64();
+
+            for (auto* im : { &image, &clipped })
+            {
+                Graphics g (*im);
+                Random random (seed);
+
+                if (im == &clipped)
+                    g.reduceClipRegion (clip);
+
+                for (int i = 0; i < 10; ++i)
+                {
+                    g.setColour (Colour ((uint32) random.nextInt()).withAlpha (1.0f));
+                    g.setFont (10.0f + (float) i * 3.0f);
+                    g.drawSingleLineText (text, random.nextInt (50), 20 + i * 18);
+                }
+            }
+
+            bool matches = true;
+
+            for (int y = 0; y < image.getHeight(); ++y)
+                for (int x = 0; x < image.getWidth(); ++x)
+                    matches = matches && clipped.getPixelAt (x, y) == (clip.containsPoint ({ x, y }) ? image.getPixelAt (x, y)
+                                                                                                      : Colour());
+
+            expect (matches);
+        }
+
+        beginTest ("Statistics");
+        {
+            auto& cache = GlyphCache::getInstance();
+            cache.reset();
+
+            Image image (Image::RGB, 400, 50, true);
+            Graphics g (image);
+            g.setFont (14.0f);
+
+            auto stats = cache.getStatistics();
+            expect (stats.hits == 0 && stats.misses == 0 && stats.numGlyphs == 0);
+
+            g.drawSingleLineText (text, 0, 20);
+            stats = cache.getStatistics();
+            expect (stats.misses > 0);
+            expectEquals (stats.numGlyphs, (int) stats.misses);
+
+            g.drawSingleLineText (text, 0, 20);
+            auto newStats = cache.getStatistics();
+            expect (newStats.misses == stats.misses);
+            expect (newStats.hits == stats.hits * 2 + stats.misses);
+
+            cache.reset();
+            expectEquals (cache.getStatistics().numGlyphs, 0);
+        }
+
+        beginTest ("Concurrent lookups");
+        {
+            auto& cache = GlyphCache::getInstance();
+            cache.reset();
+
+            // A new typeface hasn't loaded any of its glyphs yet, so the threads all have to
+            // get their shapes from the font engine at the same time. The number of different
+            // glyphs is kept small enough that none of them get evicted from the cache.
+            Typeface::Ptr typeface (Typeface::createSystemTypefaceFor (Font())), referenceTypeface (Typeface::createSystemTypefaceFor (Font()));
+            const float heights[] = { 11.0f, 14.0f };
+            const int numThreads = 8, numLookups = 2000, numGlyphs = 20;
+
+            std::atomic<int> numFailures { 0 };
+            WaitableEvent start (true);
+            ThreadPool pool (numThreads);
+
+            for (int t = 0; t < numThreads; ++t)
+            {
+                pool.addJob ([&, t]
+                {
+                    Random random (t);
+                    start.wait();
+
+                    for (int i = 0; i < numLookups; ++i)
+                    {
+                        auto font = Font (typeface).withHeight (heights[random.nextInt (2)]);
+                        auto glyph = cache.findOrCreateGlyph (font, 33 + random.nextInt (numGlyphs), (float) random.nextInt (4) * 0.25f);
+
+                        if (glyph == nullptr)
+                            ++numFailures;
+                    }
+                });
+            }
+
+            start.signal();
+
+            while (pool.getNumJobs() > 0)
+                Thread::sleep (5);
+
+            auto stats = cache.getStatistics();
+            expectEquals (numFailures.load(), 0);
+            expect (stats.hits + stats.misses == numThreads * numLookups);
+            expect (stats.hits > stats.misses);
+
+            // each glyph must look the same as one that was created on a single thread
+            bool allMatch = true;
+
+            for (auto height : heights)
+            {
+                for (int glyphNumber = 33; glyphNumber < 33 + numGlyphs; ++glyphNumber)
+                {
+                    auto glyph = cache.findOrCreateGlyph (Font (typeface).withHeight (height), glyphNumber);
+
+                    RenderingHelpers::CachedGlyphBitmap<SavedState> reference;
+                    reference.generate (Font (referenceTypeface).withHeight (height), glyphNumber, 0);
+
+                    Image expected (Image::ARGB, 40, 40, true), actual (Image::ARGB, 40, 40, true);
+
+                    SavedState expectedState (expected, expected.getBounds());
+                    reference.draw (expectedState, { 10.0f, 25.0f });
+
+                    SavedState actualState (actual, actual.getBounds());
+                    glyph->draw (actualState, { 10.0f, 25.0f });
+
+                    allMatch = allMatch && imagesMatch (expected, actual, 0);
+                }
+            }
+
+            expect (allMatch);
+            cache.reset();
+        }
+    }
+
+    static bool imagesMatch (const Image& a, const Image& b, int tolerance)
+    {
+        const Image::BitmapData da (a, Image::BitmapData::readOnly), db (b, Image::BitmapData::readOnly);
+
+        for (int y = 0; y < da.height; ++y)
+            for (int x = 0; x < da.width * da.pixelStride; ++x)
+                if (std::abs ((int) da.getLinePointer (y)[x] - (int) db.getLinePointer (y)[x]) > tolerance)
+                    return false;
+
+        return true;
+    }
+};
+
+static SoftwareRendererGlyphCacheTests softwareRendererGlyphCacheTests;
+
+//==============================================================================
+class SoftwareRendererPathCacheTests  : public UnitTest
+{
+public:
+    SoftwareRendererPathCacheTests()
+        : UnitTest ("Software renderer path cache", UnitTestCategories::graphics)
+    {}
+
+    using PathCache = RenderingHelpers::PathCache;
+
+    void runTest() override
+    {
+        auto& cache = PathCache::getInstance();
+        auto r = getRandom();
+        auto waveform = createWaveform (r, 300);
+
+        beginTest ("Stroked paths");
+        {
+            cache.reset();
+            const PathStrokeType strokeType (2.0f, PathStrokeType::curved, PathStrokeType::rounded);
+            const auto transform = AffineTransform::scale (1.5f);
+
+            Path expected;
+            strokeType.createStrokedPath (expected, waveform, transform);
+
+            for (int i = 0; i < 3; ++i)
+            {
+                Path stroke;
+                cache.createStrokedPath (stroke, waveform, strokeType, transform, 1.0f);
+                expect (stroke == expected);
+            }
+
+            auto stats = cache.getStatistics();
+            expect (stats.hits == 1 && stats.misses == 2);
+            expectEquals (stats.numEntries, 1);
+
+            // changing the stroke or transform needs a different entry
+            Path stroke;
+            cache.createStrokedPath (stroke, waveform, PathStrokeType (3.0f), transform, 1.0f);
+            cache.createStrokedPath (stroke, waveform, strokeType, transform.translated (1.0f, 0.0f), 1.0f);
+            expect (cache.getStatistics().hits == 1);
+
+            // and small paths aren't worth caching
+            Path small;
+            small.addRoundedRectangle (1.0f, 2.0f, 30.0f, 20.0f, 4.0f);
+
+            for (int i = 0; i < 3; ++i)
+                cache.createStrokedPath (stroke, small, strokeType, {}, 1.0f);
+
+            expect (cache.getStatistics().misses == stats.misses + 2);
+        }
+
+        beginTest ("Cached edge-tables are drawn in the same way as new ones");
+        {
+            Path stroke;
+            PathStrokeType (1.5f).createStrokedPath (stroke, waveform);
+
+            for (auto rasteriser : { EdgeTable::PathRasteriser::subScanline, EdgeTable::PathRasteriser::analytic })
+            {
+                for (bool clipped : { false, true })
+                {
+                    cache.reset();
+
+                    auto draw = [&] (Point<float> offset)
+                    {
+                        Image image (Image::ARGB, 200, 140, true);
+                        Graphics g (image);
+                        g.setPathRasteriser (rasteriser);
+
+                        if (clipped)
+                            g.reduceClipRegion (50, 20, 73, 90);
+
+                        g.setColour (Colours::red);
+                        g.fillPath (stroke, AffineTransform::translation (offset));
+                        return image;
+                    };
+
+                    // the analytic rasteriser can round the rows along the edges of a clip region slightly
+                    // differently when it's given a table that extends beyond them
+                    auto tolerance = rasteriser == EdgeTable::PathRasteriser::analytic ? 2 : 1;
+
+                    auto uncached = draw ({ 0.25f, 0.5f });
+                    expect (imagesMatch (draw ({ 0.25f, 0.5f }), uncached, tolerance));
+                    expect (cache.getStatistics().numEntries == 1);
+
+                    // moving it by a whole number of pixels can use the same table
+                    auto moved = draw ({ 7.25f, -2.5f });
+                    expect (cache.getStatistics().hits == 1);
+
+                    cache.reset();
+                    auto expected = draw ({ 7.25f, -2.5f });
+                    expect (imagesMatch (moved, expected, tolerance));
+                }
+            }
+        }
+
+        beginTest ("Size limit");
+        {
+            cache.reset();
+            cache.setMaximumSize (64 * 1024);
+
+            for (int i = 0; i < 50; ++i)
+            {
+                auto path = createWaveform (r, 100);
+
+                for (int j = 0; j < 2; ++j)
+                {
+                    Path stroke;
+                    cache.createStrokedPath (stroke, path, PathStrokeType (1.0f), {}, 1.0f);
+                }
+            }
+
+            auto stats = cache.getStatistics();
+            expect (stats.numEntries > 0);
+            expect (stats.numBytes <= 64 * 1024);
+
+            cache.setMaximumSize (0);
+            expectEquals (cache.getStatistics().numEntries, 0);
+
+            cache.setMaximumSize (16 * 1024 * 1024);
+            cache.reset();
+        }
+
+        beginTest ("Repeated strokes");
+        {
+            auto longWaveform = createWaveform (r, 4000);
+            const int numFrames = 20;
+
+            auto drawFrames = [&] (bool resetCacheEachFrame)
+            {
+                Image image (Image::ARGB, 1000, 300, true);
+                Graphics g (image);
+                g.setColour (Colours::green.withAlpha (0.3f));
+                cache.reset();
+
+                for (int i = 0; i < numFrames; ++i)
+                {
+                    if (resetCacheEachFrame)
+                        cache.reset();
+
+                    g.strokePath (longWaveform, PathStrokeType (1.5f));
+                }
+
+                return image;
+            };
+
+            auto uncached = drawFrames (true);
+            auto cached = drawFrames (false);
+            auto stats = cache.getStatistics();
+
+            // each stroke looks up both the stroked path and its edge-table, which have to be
+            // seen twice before they're cached, and after that every frame is a hit
+            expectEquals ((int) stats.misses, 4);
+            expectEquals ((int) stats.hits, (numFrames - 2) * 2);
+            expect (imagesMatch (cached, uncached, 1));
+
+            cache.reset();
+        }
+    }
+
+    static Path createWaveform (Random& r, int numPoints)
+    {
+        Path p;
+        p.startNewSubPath (0.0f, 70.0f);
+
+        for (int i = 1; i < numPoints; ++i)
+            p.lineTo ((float) i * 0.5f, 70.0f + 50.0f * std::sin ((float) i * 0.07f) + r.nextFloat() * 8.0f);
+
+        return p;
+    }
+
+    static bool imagesMatch (const Image& a, const Image& b, int tolerance)
+    {
+        return SoftwareRendererGlyphCacheTests::imagesMatch (a, b, tolerance);
+    }
+};
+
+static SoftwareRendererPathCacheTests softwareRendererPathCacheTests;
+
+//==============================================================================
+class SoftwareRendererWaveformTests  : public UnitTest
+{
+public:
+    SoftwareRendererWaveformTests()
+        : UnitTest ("Software renderer waveforms", UnitTestCategories::graphics)
+    {}
+
+    void runTest() override
+    {
+        auto r = getRandom();
+
+        beginTest ("Min and max of sample blocks");
+        {
+            HeapBlock<float> samples (300);
+
+            for (int i = 0; i < 300; ++i)
+                samples[i] = r.nextFloat() * 2.0f - 1.0f;
+
+            for (int start = 0; start < 5; ++start)
+            {
+                for (int num = 1; num < 290; num += 7)
+                {
+                    auto expected = Range<float>::findMinAndMax (samples + start, num);
+                    expect (RenderingHelpers::SampleRanges::findMinAndMax (samples + start, num) == expected);
+                }
+            }
+        }
+
+        auto samples = createSamples (r, 20000);
+        const Rectangle<float> area (10.0f, 5.0f, 400.0f, 120.0f);
+
+        beginTest ("Dense waveforms");
+        {
+            auto image = draw (false, [&] (Graphics& g) { g.drawWaveform (samples.begin(), samples.size(), area, { -1.0f, 1.0f }); });
+
+            // every sample should lie on a painted pixel
+            for (int i = 0; i < samples.size(); i += 13)
+            {
+                auto x = (int) (area.getX() + area.getWidth() * (float) i / (float) samples.size());
+                auto y = jlimit (0, image.getHeight() - 1, (int) (area.getCentreY() - samples[i] * area.getHeight() * 0.5f));
+                expect (image.getPixelAt (x, y).getAlpha() > 0);
+            }
+
+            expect (image.getPixelAt (5, 60).isTransparent());
+            expect (image.getPixelAt (415, 60).isTransparent());
+
+            // and the spans should look the same as the default rectangle list version
+            auto rectangles = draw (true, [&] (Graphics& g) { g.drawWaveform (samples.begin(), samples.size(), area, { -1.0f, 1.0f }); });
+            expect (imagesMatch (image, rectangles, 2));
+        }
+
+        beginTest ("Sparse waveforms");
+        {
+            auto image = draw (false, [&] (Graphics& g) { g.drawWaveform (samples.begin(), 50, area, { -1.0f, 1.0f }, 2.0f); });
+
+            Path p;
+            p.startNewSubPath (area.getX(), area.getCentreY() - samples[0] * area.getHeight() * 0.5f);
+
+            for (int i = 1; i < 50; ++i)
+                p.lineTo (area.getX() + area.getWidth() * (float) i / 49.0f, area.getCentreY() - samples[i] * area.getHeight() * 0.5f);
+
+            auto expected = draw (false, [&] (Graphics& g) { g.strokePath (p, PathStrokeType (2.0f)); });
+            expect (imagesMatch (image, expected, 2));
+        }
+
+        beginTest ("Envelopes");
+        {
+            Array<Range<float>> levels;
+
+            for (int i = 0; i < 1000; ++i)
+                levels.add (i % 100 == 0 ? Range<float>() : Range<float>::findMinAndMax (samples.begin() + i * 20, 20));
+
+            for (bool useRectangles : { false, true })
+            {
+                auto image = draw (useRectangles, [&] (Graphics& g) { g.fillWaveformEnvelope (levels.begin(), levels.size(), area, { -1.0f, 1.0f }); });
+                auto scaled = draw (useRectangles, [&] (Graphics& g)
+                {
+                    g.addTransform (AffineTransform::scale (2.0f));
+                    g.fillWaveformEnvelope (levels.begin(), levels.size(), area / 2.0f, { -1.0f, 1.0f });
+                });
+
+                expect (imagesMatch (image, scaled, 2));
+                expect (image.getPixelAt (12, 65).getAlpha() > 0);
+                expect (image.getPixelAt (5, 65).isTransparent());
+            }
+
+            // an envelope with fewer levels than pixels fills each level's columns
+            const Range<float> twoLevels[] = { { 0.0f, 1.0f }, { -1.0f, 0.0f } };
+            auto image = draw (false, [&] (Graphics& g) { g.fillWaveformEnvelope (twoLevels, 2, area, { -1.0f, 1.0f }); });
+            expect (image.getPixelAt (100, 20).isOpaque() && image.getPixelAt (100, 100).isTransparent());
+            expect (image.getPixelAt (300, 20).isTransparent() && image.getPixelAt (300, 100).isOpaque());
+        }
+
+        beginTest ("Very long waveforms");
+        {
+            auto longSamples = createSamples (r, 100000);
+            auto drawLongWaveform = [&] (Graphics& g) { g.drawWaveform (longSamples.begin(), longSamples.size(), area, { -1.0f, 1.0f }); };
+
+            auto image = draw (false, drawLongWaveform);
+            expect (imagesMatch (image, draw (true, drawLongWaveform), 2));
+
+            // with hundreds of samples per pixel, every column gets painted
+            bool allColumnsPainted = true;
+
+            for (int x = (int) area.getX(); x < (int) area.getRight(); ++x)
+            {
+                bool painted = false;
+
+                for (int y = 0; y < image.getHeight() && ! painted; ++y)
+                    painted = image.getPixelAt (x, y).getAlpha() > 0;
+
+                allColumnsPainted = allColumnsPainted && painted;
+            }
+
+            expect (allColumnsPainted);
+        }
+    }
+
+    // draws as if the spans weren't supported by the context, to check against
+    struct RectangleListRenderer  : public LowLevelGraphicsSoftwareRenderer
+    {
+        using LowLevelGraphicsSoftwareRenderer::LowLevelGraphicsSoftwareRenderer;
+
+        void fillVerticalSpans (Rectangle<float> area, const Range<float>* spans, int numSpans) override
+        {
+            LowLevelGraphicsContext::fillVerticalSpans (area, spans, numSpans);
+        }
+    };
+
+    static Image draw (bool useRectangles, std::function<void (Graphics&)> drawFunction)
+    {
+        Image image (Image::ARGB, 420, 130, true, SoftwareImageType());
+        std::unique_ptr<LowLevelGraphicsContext> context;
+
+        if (useRectangles)
+            context.reset (new RectangleListRenderer (image));
+        else
+            context.reset (new LowLevelGraphicsSoftwareRenderer (image));
+
+        Graphics g (*context);
+        g.setColour (Colours::white);
+        drawFunction (g);
+        return image;
+    }
+
+    static Array<float> createSamples (Random& r, int num)
+    {
+        Array<float> samples;
+        samples.ensureStorageAllocated (num);
+
+        for (int i = 0; i < num; ++i)
+            samples.add (0.6f * std::sin ((float) i * 0.003f) + 0.3f * (r.nextFloat() * 2.0f - 1.0f));
+
+        return samples;
+    }
+
+    static bool imagesMatch (const Image& a, const Image& b, int tolerance)
+    {
+        return SoftwareRendererGlyphCacheTests::imagesMatch (a, b, tolerance);
+    }
+};
+
+static SoftwareRendererWaveformTests softwareRendererWaveformTests;
+
+#endif
+
 } // namespace juce
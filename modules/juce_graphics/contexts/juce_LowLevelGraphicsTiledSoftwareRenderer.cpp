@@ -0,0 +1,689 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+// The worker threads that are shared by the tiled renderer and the image blurring functions
+class SoftwareRenderingThreadPool  : public ThreadPool,
+                                     private DeletedAtShutdown
+{
+public:
+    SoftwareRenderingThreadPool()  : ThreadPool (LowLevelGraphicsTiledSoftwareRenderer::getNumWorkerThreads()) {}
+    ~SoftwareRenderingThreadPool() override     { clearSingletonInstance(); }
+
+    // Calls the function once for each index from 0 to numJobs - 1, using the calling thread
+    // and the pool's threads, and returns when they've all finished. The jobs are handed out
+    // from a shared counter, so threads that finish early pick up more of them. A pool job
+    // that doesn't start until every index has been taken just returns without calling the
+    // function, so anything that it refers to only needs to last until this returns.
+    static void performJobs (size_t numJobs, std::function<void (size_t)> job)
+    {
+        auto numWorkers = (size_t) LowLevelGraphicsTiledSoftwareRenderer::getNumWorkerThreads();
+
+        if (numWorkers == 0 || numJobs <= 1)
+        {
+            for (size_t i = 0; i < numJobs; ++i)
+                job (i);
+
+            return;
+        }
+
+        struct Batch
+        {
+            Batch (size_t num, std::function<void (size_t)>&& j)  : numJobs (num), job (std::move (j)) {}
+
+            void performJobs()
+            {
+                for (;;)
+                {
+                    auto index = nextJob++;
+
+                    if (index >= numJobs)
+                        return;
+
+                    job (index);
+
+                    if (++numJobsFinished == numJobs)
+                        finished.signal();
+                }
+            }
+
+            const size_t numJobs;
+            const std::function<void (size_t)> job;
+            std::atomic<size_t> nextJob { 0 }, numJobsFinished { 0 };
+            WaitableEvent finished;
+        };
+
+        auto batch = std::make_shared<Batch> (numJobs, std::move (job));
+        auto& pool = *getInstance();
+
+        for (auto i = jmin (numWorkers, numJobs - 1); i > 0; --i)
+            pool.addJob ([batch] { batch->performJobs(); });
+
+        batch->performJobs();
+        batch->finished.wait();
+    }
+
+    JUCE_DECLARE_SINGLETON (SoftwareRenderingThreadPool, false)
+};
+
+JUCE_IMPLEMENT_SINGLETON (SoftwareRenderingThreadPool)
+
+//==============================================================================
+LowLevelGraphicsTiledSoftwareRenderer::LowLevelGraphicsTiledSoftwareRenderer (const Image& imageToRenderOnto)
+    : LowLevelGraphicsTiledSoftwareRenderer (imageToRenderOnto, {}, RectangleList<int> (imageToRenderOnto.getBounds()))
+{
+}
+
+LowLevelGraphicsTiledSoftwareRenderer::LowLevelGraphicsTiledSoftwareRenderer (const Image& imageToRenderOnto, Point<int> origin,
+                                                                              const RectangleList<int>& clip)
+    : image (imageToRenderOnto),
+      initialOrigin (origin),
+      initialClip (clip),
+      stateTracker (imageToRenderOnto, origin, clip)
+{
+    // The glyph cache is a lazily-created singleton, so make sure it
+    // exists before more than one thread tries to use it
+    if (getNumWorkerThreads() > 0)
+        RenderingHelpers::SoftwareRendererSavedState::GlyphCacheType::getInstance();
+}
+
+LowLevelGraphicsTiledSoftwareRenderer::~LowLevelGraphicsTiledSoftwareRenderer()
+{
+    // If you hit this, your drawing code has a beginTransparencyLayer() call without
+    // a matching endTransparencyLayer()
+    jassert (transparencyLayerDepth == 0);
+
+    transparencyLayerDepth = 0;
+    flush();
+}
+
+int LowLevelGraphicsTiledSoftwareRenderer::getNumWorkerThreads()
+{
+    return jmax (0, SystemStats::getNumCpus() - 1);
+}
+
+//==============================================================================
+void LowLevelGraphicsTiledSoftwareRenderer::addStateChange (std::function<void (LowLevelGraphicsContext&)> op)
+{
+    operations.push_back ({ std::move (op), Operation::Type::stateChange, 0 });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::addDrawingOperation (std::function<void (LowLevelGraphicsContext&)> op)
+{
+    // nothing drawn outside the clip region can make any difference to the image
+    if (! stateTracker.isClipEmpty())
+    {
+        operations.push_back ({ std::move (op), Operation::Type::drawing,
+                                RenderingHelpers::PathCache::createOperationID() });
+        endOfLastDrawingOperation = operations.size();
+    }
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::renderTile (const RectangleList<int>& tileClip) const
+{
+    LowLevelGraphicsSoftwareRenderer renderer (image, initialOrigin, tileClip);
+
+    for (auto& op : operations)
+    {
+        // each tile looks up the same paths, which mustn't look like they're being drawn repeatedly
+        RenderingHelpers::PathCache::ScopedOperation scopedOperation (op.pathCacheOperationID);
+        op.perform (renderer);
+    }
+}
+
+// Once something has been drawn it's no longer needed, but the state changes have to be
+// kept so that the operations which follow them are drawn with the right clip and transform.
+// Without any drawing, a saveState() and its matching restoreState() cancel out, so they're
+// removed along with everything between them.
+void LowLevelGraphicsTiledSoftwareRenderer::removeDrawingOperations()
+{
+    std::vector<Operation> remaining;
+    std::vector<size_t> openSaves;
+
+    for (auto& op : operations)
+    {
+        if (op.type == Operation::Type::drawing)
+            continue;
+
+        if (op.type == Operation::Type::restoreState && ! openSaves.empty())
+        {
+            remaining.erase (remaining.begin() + (std::ptrdiff_t) openSaves.back(), remaining.end());
+            openSaves.pop_back();
+            continue;
+        }
+
+        if (op.type == Operation::Type::saveState)
+            openSaves.push_back (remaining.size());
+
+        remaining.push_back (std::move (op));
+    }
+
+    operations = std::move (remaining);
+    savedStateIndexes = std::move (openSaves);
+    endOfLastDrawingOperation = 0;
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::flush()
+{
+    if (transparencyLayerDepth > 0 || endOfLastDrawingOperation == 0)
+        return;
+
+    auto bounds = initialClip.getBounds();
+    auto numWorkers = getNumWorkerThreads();
+    auto bandHeight = tileHeight > 0 ? tileHeight
+                                     : (numWorkers > 0 ? jmax (32, bounds.getHeight() / ((numWorkers + 1) * 4) + 1)
+                                                       : bounds.getHeight());
+
+    std::vector<RectangleList<int>> tiles;
+
+    for (int y = bounds.getY(); y < bounds.getBottom(); y += bandHeight)
+    {
+        RectangleList<int> tile (initialClip);
+
+        if (tile.clipTo (Rectangle<int> (bounds.getX(), y, bounds.getWidth(), bandHeight)))
+            tiles.push_back (std::move (tile));
+    }
+
+    SoftwareRenderingThreadPool::performJobs (tiles.size(), [this, &tiles] (size_t i) { renderTile (tiles[i]); });
+    removeDrawingOperations();
+}
+
+//==============================================================================
+bool LowLevelGraphicsTiledSoftwareRenderer::isVectorDevice() const          { return false; }
+float LowLevelGraphicsTiledSoftwareRenderer::getPhysicalPixelScaleFactor()  { return stateTracker.getPhysicalPixelScaleFactor(); }
+Rectangle<int> LowLevelGraphicsTiledSoftwareRenderer::getClipBounds() const { return stateTracker.getClipBounds(); }
+bool LowLevelGraphicsTiledSoftwareRenderer::isClipEmpty() const             { return stateTracker.isClipEmpty(); }
+const Font& LowLevelGraphicsTiledSoftwareRenderer::getFont()                { return stateTracker.getFont(); }
+
+bool LowLevelGraphicsTiledSoftwareRenderer::clipRegionIntersects (const Rectangle<int>& r)
+{
+    return stateTracker.clipRegionIntersects (r);
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::setOrigin (Point<int> o)
+{
+    stateTracker.setOrigin (o);
+    addStateChange ([o] (LowLevelGraphicsContext& g) { g.setOrigin (o); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::addTransform (const AffineTransform& t)
+{
+    stateTracker.addTransform (t);
+    addStateChange ([t] (LowLevelGraphicsContext& g) { g.addTransform (t); });
+}
+
+bool LowLevelGraphicsTiledSoftwareRenderer::clipToRectangle (const Rectangle<int>& r)
+{
+    addStateChange ([r] (LowLevelGraphicsContext& g) { g.clipToRectangle (r); });
+    return stateTracker.clipToRectangle (r);
+}
+
+bool LowLevelGraphicsTiledSoftwareRenderer::clipToRectangleList (const RectangleList<int>& r)
+{
+    addStateChange ([r] (LowLevelGraphicsContext& g) { g.clipToRectangleList (r); });
+    return stateTracker.clipToRectangleList (r);
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::excludeClipRectangle (const Rectangle<int>& r)
+{
+    stateTracker.excludeClipRectangle (r);
+    addStateChange ([r] (LowLevelGraphicsContext& g) { g.excludeClipRectangle (r); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::clipToPath (const Path& p, const AffineTransform& t)
+{
+    stateTracker.clipToPath (p, t);
+    addStateChange ([p, t] (LowLevelGraphicsContext& g) { g.clipToPath (p, t); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::clipToImageAlpha (const Image& im, const AffineTransform& t)
+{
+    stateTracker.clipToImageAlpha (im, t);
+    addStateChange ([im, t] (LowLevelGraphicsContext& g) { g.clipToImageAlpha (im, t); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::saveState()
+{
+    stateTracker.saveState();
+    savedStateIndexes.push_back (operations.size());
+    operations.push_back ({ [] (LowLevelGraphicsContext& g) { g.saveState(); }, Operation::Type::saveState, 0 });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::restoreState()
+{
+    stateTracker.restoreState();
+
+    if (! savedStateIndexes.empty())
+    {
+        auto saveIndex = savedStateIndexes.back();
+        savedStateIndexes.pop_back();
+
+        // If nothing has been drawn since the matching saveState(), the state changes
+        // in between can't affect anything, so there's no need to keep them
+        if (endOfLastDrawingOperation <= saveIndex)
+        {
+            operations.erase (operations.begin() + (std::ptrdiff_t) saveIndex, operations.end());
+            return;
+        }
+    }
+
+    operations.push_back ({ [] (LowLevelGraphicsContext& g) { g.restoreState(); }, Operation::Type::restoreState, 0 });
+}
+
+// The software renderer places a layer's image at the top-left of the clip region, so if a
+// layer was split into tiles, each one would be drawn at a slightly different sub-pixel offset.
+// Instead, everything before the layer is flushed, and the whole layer is rendered in one go
+// when it ends. Because the layer restores the state afterwards, it can then be forgotten.
+void LowLevelGraphicsTiledSoftwareRenderer::beginTransparencyLayer (float opacity)
+{
+    if (transparencyLayerDepth == 0)
+    {
+        flush();
+        layerStartIndex = operations.size();
+    }
+
+    ++transparencyLayerDepth;
+
+    // The state tracker mustn't create a real layer, because ending it would draw onto the image
+    stateTracker.saveState();
+    addStateChange ([opacity] (LowLevelGraphicsContext& g) { g.beginTransparencyLayer (opacity); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::endTransparencyLayer()
+{
+    stateTracker.restoreState();
+    addStateChange ([] (LowLevelGraphicsContext& g) { g.endTransparencyLayer(); });
+
+    if (--transparencyLayerDepth == 0)
+    {
+        // everything before the layer was flushed when it began
+        if (endOfLastDrawingOperation > layerStartIndex)
+            renderTile (initialClip);
+
+        operations.erase (operations.begin() + (std::ptrdiff_t) layerStartIndex, operations.end());
+        endOfLastDrawingOperation = 0;
+
+        while (! savedStateIndexes.empty() && savedStateIndexes.back() >= layerStartIndex)
+            savedStateIndexes.pop_back();
+    }
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::setFill (const FillType& f)
+{
+    addStateChange ([f] (LowLevelGraphicsContext& g) { g.setFill (f); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::setOpacity (float opacity)
+{
+    addStateChange ([opacity] (LowLevelGraphicsContext& g) { g.setOpacity (opacity); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::setInterpolationQuality (Graphics::ResamplingQuality quality)
+{
+    addStateChange ([quality] (LowLevelGraphicsContext& g) { g.setInterpolationQuality (quality); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::setPathRasteriser (EdgeTable::PathRasteriser rasteriser)
+{
+    addStateChange ([rasteriser] (LowLevelGraphicsContext& g) { g.setPathRasteriser (rasteriser); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::setFont (const Font& f)
+{
+    // Resolving the typeface isn't thread-safe, so it needs to happen here rather than on the workers
+    f.getTypeface();
+
+    stateTracker.setFont (f);
+    addStateChange ([f] (LowLevelGraphicsContext& g) { g.setFont (f); });
+}
+
+//==============================================================================
+void LowLevelGraphicsTiledSoftwareRenderer::fillRect (const Rectangle<int>& r, bool replaceExistingContents)
+{
+    addDrawingOperation ([r, replaceExistingContents] (LowLevelGraphicsContext& g) { g.fillRect (r, replaceExistingContents); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::fillRect (const Rectangle<float>& r)
+{
+    addDrawingOperation ([r] (LowLevelGraphicsContext& g) { g.fillRect (r); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::fillRectList (const RectangleList<float>& list)
+{
+    addDrawingOperation ([list] (LowLevelGraphicsContext& g) { g.fillRectList (list); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::fillPath (const Path& p, const AffineTransform& t)
+{
+    addDrawingOperation ([p, t] (LowLevelGraphicsContext& g) { g.fillPath (p, t); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::fillVerticalSpans (Rectangle<float> area, const Range<float>* spans, int numSpans)
+{
+    Array<Range<float>> spanList (spans, numSpans);
+    addDrawingOperation ([area, spanList] (LowLevelGraphicsContext& g) { g.fillVerticalSpans (area, spanList.begin(), spanList.size()); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::drawImage (const Image& im, const AffineTransform& t)
+{
+    addDrawingOperation ([im, t] (LowLevelGraphicsContext& g) { g.drawImage (im, t); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::drawLine (const Line<float>& l)
+{
+    addDrawingOperation ([l] (LowLevelGraphicsContext& g) { g.drawLine (l); });
+}
+
+void LowLevelGraphicsTiledSoftwareRenderer::drawGlyph (int glyphNumber, const AffineTransform& t)
+{
+    addDrawingOperation ([glyphNumber, t] (LowLevelGraphicsContext& g) { g.drawGlyph (glyphNumber, t); });
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class TiledSoftwareRendererTests  : public UnitTest
+{
+public:
+    TiledSoftwareRendererTests()
+        : UnitTest ("LowLevelGraphicsTiledSoftwareRenderer", UnitTestCategories::graphics)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Output matches the serial renderer");
+        {
+            for (auto format : { Image::ARGB, Image::RGB })
+            {
+                for (auto tileHeight : { 1, 7, 64, 0 })
+                {
+                    Image serial (format, 300, 200, true), tiled (format, 300, 200, true);
+
+                    {
+                        LowLevelGraphicsSoftwareRenderer renderer (serial);
+                        Graphics g (renderer);
+                        drawScene (g, serial.getBounds(), 1234, 60);
+                    }
+
+                    {
+                        LowLevelGraphicsTiledSoftwareRenderer renderer (tiled);
+                        renderer.setTileHeight (tileHeight);
+                        Graphics g (renderer);
+                        drawScene (g, tiled.getBounds(), 1234, 60);
+                    }
+
+                    expect (imagesAreIdentical (serial, tiled), "tile height " + String (tileHeight));
+                }
+            }
+        }
+
+        beginTest ("Clipped contexts and flushing");
+        {
+            RectangleList<int> clip (Rectangle<int> (10, 10, 100, 50));
+            clip.add (Rectangle<int> (150, 80, 60, 90));
+
+            Image serial (Image::ARGB, 256, 192, true), tiled (Image::ARGB, 256, 192, true);
+
+            {
+                LowLevelGraphicsSoftwareRenderer renderer (serial, { 5, 3 }, clip);
+                Graphics g (renderer);
+                drawScene (g, { 0, 0, 250, 190 }, 99, 20);
+                drawScene (g, { 20, 20, 200, 150 }, 100, 20);
+            }
+
+            {
+                LowLevelGraphicsTiledSoftwareRenderer renderer (tiled, { 5, 3 }, clip);
+                renderer.setTileHeight (16);
+                Graphics g (renderer);
+                drawScene (g, { 0, 0, 250, 190 }, 99, 20);
+                renderer.flush();
+                drawScene (g, { 20, 20, 200, 150 }, 100, 20);
+            }
+
+            expect (imagesAreIdentical (serial, tiled));
+        }
+
+        beginTest ("Flushing inside saved states");
+        {
+            Image serial (Image::ARGB, 200, 150, true), tiled (Image::ARGB, 200, 150, true);
+
+            // the recorded state changes are trimmed whenever a saved state is restored, so
+            // make sure that flushing part-way through one doesn't lose anything
+            auto draw = [] (LowLevelGraphicsContext& context, std::function<void()> flush)
+            {
+                Graphics g (context);
+                g.addTransform (AffineTransform::translation (3.0f, 2.0f));
+
+                for (int i = 0; i < 50; ++i)
+                {
+                    Graphics::ScopedSaveState outer (g);
+                    g.reduceClipRegion (Rectangle<int> (i * 3, 0, 60, 150));
+                    g.setColour (Colour ((uint8) (i * 5), 100, (uint8) (255 - i * 5), 0.5f));
+
+                    {
+                        Graphics::ScopedSaveState inner (g);
+                        g.addTransform (AffineTransform::rotation (0.1f * (float) i, 100.0f, 75.0f));
+                        g.setColour (Colours::white.withAlpha (0.2f));
+                    }
+
+                    if (i % 7 == 3)
+                        flush();
+
+                    g.fillEllipse (Rectangle<float> (40.0f, 30.0f).withCentre ({ (float) i * 3.0f + 20.0f, 75.0f }));
+
+                    if (i % 5 == 1)
+                        flush();
+                }
+
+                g.setColour (Colours::orange);
+                g.fillRect (Rectangle<float> (10.0f, 10.0f, 30.0f, 20.0f));
+            };
+
+            {
+                LowLevelGraphicsSoftwareRenderer renderer (serial);
+                draw (renderer, [] {});
+            }
+
+            {
+                LowLevelGraphicsTiledSoftwareRenderer renderer (tiled);
+                renderer.setTileHeight (16);
+                draw (renderer, [&] { renderer.flush(); });
+            }
+
+            expect (imagesAreIdentical (serial, tiled));
+        }
+
+        beginTest ("Paths drawn across several tiles are only seen once by the path cache");
+        {
+            auto& cache = RenderingHelpers::PathCache::getInstance();
+            cache.reset();
+
+            Path star;
+            star.addStar ({ 100.0f, 75.0f }, 20, 30.0f, 70.0f);
+            Image image (Image::ARGB, 200, 150, true);
+
+            auto drawFrame = [&]
+            {
+                LowLevelGraphicsTiledSoftwareRenderer renderer (image);
+                renderer.setTileHeight (16);
+                Graphics g (renderer);
+                g.setColour (Colours::red);
+                g.fillPath (star);
+            };
+
+            drawFrame();
+            expectEquals (cache.getStatistics().numEntries, 0);
+
+            drawFrame();
+            expectEquals (cache.getStatistics().numEntries, 1);
+
+            cache.reset();
+        }
+
+        beginTest ("Large scenes with the default tile height");
+        {
+            const int width = 1920, height = 1080, numShapes = 200;
+            Image serial (Image::ARGB, width, height, true), tiled (Image::ARGB, width, height, true);
+
+            {
+                LowLevelGraphicsSoftwareRenderer renderer (serial);
+                Graphics g (renderer);
+                drawScene (g, serial.getBounds(), 42, numShapes);
+            }
+
+            {
+                LowLevelGraphicsTiledSoftwareRenderer renderer (tiled);
+                Graphics g (renderer);
+                drawScene (g, tiled.getBounds(), 42, numShapes);
+            }
+
+            expect (imagesAreIdentical (serial, tiled));
+        }
+    }
+
+    static void drawScene (Graphics& g, Rectangle<int> area, int seed, int numShapes)
+    {
+        Random r (seed);
+        auto bounds = area.toFloat();
+
+        auto randomPoint = [&]
+        {
+            return Point<float> (bounds.getX() + r.nextFloat() * bounds.getWidth(),
+                                 bounds.getY() + r.nextFloat() * bounds.getHeight());
+        };
+
+        auto randomColour = [&]  { return Colour ((uint32) r.nextInt()).withAlpha (0.3f + 0.7f * r.nextFloat()); };
+
+        Image sprite (Image::ARGB, 40, 30, true);
+
+        {
+            Graphics sg (sprite);
+            sg.setGradientFill (ColourGradient (Colours::red, 0, 0, Colours::transparentBlack, 40, 30, true));
+            sg.fillEllipse (0, 0, 40, 30);
+        }
+
+        g.fillAll (Colours::darkgrey);
+
+        for (int i = 0; i < numShapes; ++i)
+        {
+            Graphics::ScopedSaveState save (g);
+
+            auto p1 = randomPoint(), p2 = randomPoint();
+            auto size = 5.0f + r.nextFloat() * bounds.getHeight() * 0.3f;
+
+            switch (i % 8)
+            {
+                case 0:
+                    g.setGradientFill (ColourGradient (randomColour(), p1, randomColour(), p2, r.nextBool()));
+                    g.fillEllipse (Rectangle<float> (size, size * 0.7f).withCentre (p1));
+                    break;
+
+                case 1:
+                {
+                    Path star;
+                    star.addStar (p1, 7, size * 0.3f, size);
+                    g.setColour (randomColour());
+                    g.fillPath (star, AffineTransform::rotation (r.nextFloat(), p1.x, p1.y));
+                    break;
+                }
+
+                case 2:
+                    g.setColour (randomColour());
+                    g.drawLine ({ p1, p2 }, 0.5f + r.nextFloat() * 4.0f);
+                    break;
+
+                case 3:
+                    g.setColour (randomColour());
+                    g.setFont (8.0f + r.nextFloat() * 30.0f);
+                    g.drawText ("Tiled rendering " + String (i), Rectangle<float> (size * 3.0f, size).withCentre (p1),
+                                Justification::centred, false);
+                    break;
+
+                case 4:
+                    g.setOpacity (r.nextFloat());
+                    g.drawImage (sprite, Rectangle<float> (size, size).withCentre (p1));
+                    g.drawImageTransformed (sprite, AffineTransform::rotation (r.nextFloat() * 6.0f).translated (p2));
+                    break;
+
+                case 5:
+                {
+                    Path clip;
+                    clip.addEllipse (Rectangle<float> (size, size).withCentre (p1));
+                    g.reduceClipRegion (clip);
+                    g.excludeClipRegion (Rectangle<int> (10, 10).withCentre (p1.toInt()));
+                    g.setGradientFill (ColourGradient (randomColour(), p1, randomColour(), p2, false));
+                    g.fillRect (bounds);
+                    break;
+                }
+
+                case 6:
+                    g.beginTransparencyLayer (0.5f);
+                    g.setColour (randomColour());
+                    g.fillRoundedRectangle (Rectangle<float> (size, size * 0.5f).withCentre (p1), 4.0f);
+                    g.setColour (randomColour());
+                    g.fillRect (Rectangle<float> (size * 0.5f, size).withCentre (p2));
+                    g.endTransparencyLayer();
+                    break;
+
+                default:
+                {
+                    g.addTransform (AffineTransform::rotation (0.3f, p1.x, p1.y));
+                    g.setColour (randomColour());
+                    g.drawRect (Rectangle<float> (size, size * 0.6f).withCentre (p1), 2.5f);
+                    g.fillRect (Rectangle<int> (10, 10).withCentre (p2.toInt()));
+                    break;
+                }
+            }
+        }
+
+        HeapBlock<float> samples (2000);
+
+        for (int i = 0; i < 2000; ++i)
+            samples[i] = r.nextFloat() * 2.0f - 1.0f;
+
+        g.setColour (randomColour());
+        g.drawWaveform (samples, 2000, bounds.reduced (10.0f), { -1.0f, 1.0f });
+    }
+
+    static bool imagesAreIdentical (const Image& a, const Image& b)
+    {
+        for (int y = 0; y < a.getHeight(); ++y)
+            for (int x = 0; x < a.getWidth(); ++x)
+                if (a.getPixelAt (x, y) != b.getPixelAt (x, y))
+                    return false;
+
+        return true;
+    }
+};
+
+static TiledSoftwareRendererTests tiledSoftwareRendererTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A software renderer that records its drawing operations, and then rasterises
+    them in parallel by splitting the image into tiles.
+
+    When you draw into this context, nothing is actually rendered until flush() is
+    called (or the context is deleted). The image is then split into horizontal bands,
+    and the recorded operations are played back into each band on a shared pool of
+    worker threads, with the calling thread also taking part.
+
+    Each band is rendered by an ordinary LowLevelGraphicsSoftwareRenderer whose clip
+    region is restricted to that band, so the result is identical, pixel-for-pixel,
+    to rendering the same operations with a LowLevelGraphicsSoftwareRenderer.
+
+    Transparency layers are the exception: because the software renderer positions a
+    layer's image relative to the clip region, each layer is rendered in one piece on the
+    calling thread when it's ended, so drawing lots of layers will reduce the speed-up.
+
+    This is useful for rendering large, complex images on machines without a GPU.
+    For small images, or ones that only contain a few simple shapes, the overhead of
+    recording the operations will outweigh any benefit.
+
+    @code
+    Image image (Image::ARGB, 3840, 2160, true);
+
+    {
+        LowLevelGraphicsTiledSoftwareRenderer renderer (image);
+        Graphics g (renderer);
+        drawMyScene (g);
+    }   // the image is rendered when the context is deleted
+    @endcode
+
+    Paths, fills and fonts are copied when an operation is recorded, so they can be safely
+    modified or deleted before the image is rendered. Images are shared rather than copied,
+    so don't change the contents of an image that you've drawn until flush() has been called.
+
+    @see LowLevelGraphicsSoftwareRenderer
+
+    @tags{Graphics}
+*/
+class JUCE_API  LowLevelGraphicsTiledSoftwareRenderer   : public LowLevelGraphicsContext
+{
+public:
+    //==============================================================================
+    /** Creates a context to render into an image. */
+    LowLevelGraphicsTiledSoftwareRenderer (const Image& imageToRenderOnto);
+
+    /** Creates a context to render into a clipped subsection of an image. */
+    LowLevelGraphicsTiledSoftwareRenderer (const Image& imageToRenderOnto, Point<int> origin,
+                                           const RectangleList<int>& initialClip);
+
+    /** Destructor.
+        This renders anything that hasn't yet been flushed.
+    */
+    ~LowLevelGraphicsTiledSoftwareRenderer() override;
+
+    //==============================================================================
+    /** Renders all the operations that have been recorded so far, and waits for
+        them to be finished.
+
+        If this is called while a transparency layer is active, nothing will happen
+        until the layer has been ended.
+    */
+    void flush();
+
+    /** Sets the height of the bands that the image is split into.
+        By default (or if this is set to 0) the height is chosen so that each rendering
+        thread has a few bands to work on.
+    */
+    void setTileHeight (int newTileHeight) noexcept         { tileHeight = jmax (0, newTileHeight); }
+
+    /** Returns the number of worker threads that are used for rendering, in addition
+        to the thread that calls flush().
+    */
+    static int getNumWorkerThreads();
+
+    //==============================================================================
+    bool isVectorDevice() const override;
+    void setOrigin (Point<int>) override;
+    void addTransform (const AffineTransform&) override;
+    float getPhysicalPixelScaleFactor() override;
+    bool clipToRectangle (const Rectangle<int>&) override;
+    bool clipToRectangleList (const RectangleList<int>&) override;
+    void excludeClipRectangle (const Rectangle<int>&) override;
+    void clipToPath (const Path&, const AffineTransform&) override;
+    void clipToImageAlpha (const Image&, const AffineTransform&) override;
+    bool clipRegionIntersects (const Rectangle<int>&) override;
+    Rectangle<int> getClipBounds() const override;
+    bool isClipEmpty() const override;
+    void saveState() override;
+    void restoreState() override;
+    void beginTransparencyLayer (float opacity) override;
+    void endTransparencyLayer() override;
+    void setFill (const FillType&) override;
+    void setOpacity (float) override;
+    void setInterpolationQuality (Graphics::ResamplingQuality) override;
+    void setPathRasteriser (EdgeTable::PathRasteriser) override;
+    void fillRect (const Rectangle<int>&, bool replaceExistingContents) override;
+    void fillRect (const Rectangle<float>&) override;
+    void fillRectList (const RectangleList<float>&) override;
+    void fillPath (const Path&, const AffineTransform&) override;
+    void fillVerticalSpans (Rectangle<float>, const Range<float>*, int) override;
+    void drawImage (const Image&, const AffineTransform&) override;
+    void drawLine (const Line<float>&) override;
+    void setFont (const Font&) override;
+    const Font& getFont() override;
+    void drawGlyph (int glyphNumber, const AffineTransform&) override;
+
+private:
+    //==============================================================================
+    struct Operation
+    {
+        enum class Type { stateChange, saveState, restoreState, drawing };
+
+        std::function<void (LowLevelGraphicsContext&)> perform;
+        Type type;
+        uint32 pathCacheOperationID;
+    };
+
+    Image image;
+    Point<int> initialOrigin;
+    RectangleList<int> initialClip;
+
+    // This keeps track of the clip region and transform so that the queries can be
+    // answered while recording, but it never draws anything.
+    LowLevelGraphicsSoftwareRenderer stateTracker;
+
+    std::vector<Operation> operations;
+    std::vector<size_t> savedStateIndexes;
+    size_t endOfLastDrawingOperation = 0, layerStartIndex = 0;
+    int transparencyLayerDepth = 0, tileHeight = 0;
+
+    void addStateChange (std::function<void (LowLevelGraphicsContext&)>);
+    void addDrawingOperation (std::function<void (LowLevelGraphicsContext&)>);
+    void renderTile (const RectangleList<int>& tileClip) const;
+    void removeDrawingOperations();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LowLevelGraphicsTiledSoftwareRenderer)
+};
+
+} // namespace juce
@@ -38,14 +38,16 @@ void GlowEffect::setGlowProperties (float newRadius, Colour newColour, Point<int
 
 void GlowEffect::applyEffect (Image& image, Graphics& g, float scaleFactor, float alpha)
 {
-    Image temp (image.getFormat(), image.getWidth(), image.getHeight(), true);
+    // Only the alpha channel is used when drawing the glow, so there's no need to blur the others
+    Image temp (image.convertedToFormat (Image::SingleChannel));
+    temp.duplicateIfShared();
 
     ImageConvolutionKernel blurKernel (roundToInt (radius * scaleFactor * 2.0f));
 
     blurKernel.createGaussianBlur (radius);
     blurKernel.rescaleAllValues (radius);
 
-    blurKernel.applyToImage (temp, image, image.getBounds());
+    blurKernel.applyToImage (temp, temp, temp.getBounds());
 
     g.setColour (colour.withMultipliedAlpha (alpha));
     g.drawImageAt (temp, offset.x, offset.y, true);
@@ -28,8 +28,26 @@ namespace juce
 
 const int juce_edgeTableDefaultEdgesPerLine = 32;
 
+// Converts an absolute winding level, where 256 is one complete layer of coverage, to a pixel alpha
+static int getLevelForWindingRule (int level, bool useNonZeroWinding) noexcept
+{
+    if (level >> 8)
+    {
+        if (useNonZeroWinding)
+            return 255;
+
+        level &= 511;
+
+        if (level >> 8)
+            return 511 - level;
+    }
+
+    return level;
+}
+
 //==============================================================================
-EdgeTable::EdgeTable (Rectangle<int> area, const Path& path, const AffineTransform& transform)
+EdgeTable::EdgeTable (Rectangle<int> area, const Path& path, const AffineTransform& transform,
+                      PathRasteriser rasteriser)
    : bounds (area),
      // this is a very vague heuristic to make a rough guess at a good table size
      // for a given path, such that it's big enough to mostly avoid remapping, but also
@@ -38,6 +56,12 @@ EdgeTable::EdgeTable (Rectangle<int> area, const Path& path, const AffineTransfo
                             4 * (int) std::sqrt (path.data.size()))),
      lineStrideElements (maxEdgesPerLine * 2 + 1)
 {
+    if (rasteriser == PathRasteriser::analytic)
+    {
+        addPathWithAnalyticCoverage (path, transform);
+        return;
+    }
+
     allocate();
     int* t = table;
 
@@ -90,10 +114,12 @@ EdgeTable::EdgeTable (Rectangle<int> area, const Path& path, const AffineTransfo
                     auto step = jmin (stepSize, y2 - y1, 256 - (y1 & 255));
                     auto x = roundToInt (startX + multiplier * ((y1 + (step >> 1)) - startY));
 
+                    // Edges outside the bounds are moved onto them, so the pixels at the edge of
+                    // the table get the same coverage however wide the table is
                     if (x < leftLimit)
                         x = leftLimit;
-                    else if (x >= rightLimit)
-                        x = rightLimit - 1;
+                    else if (x > rightLimit)
+                        x = rightLimit;
 
                     addEdgePoint (x, y1 >> 8, direction * step);
                     y1 += step;
@@ -106,6 +132,97 @@ EdgeTable::EdgeTable (Rectangle<int> area, const Path& path, const AffineTransfo
     sanitiseLevels (path.isUsingNonZeroWinding());
 }
 
+static Rectangle<int> getBoundsOfSpans (int x, const Range<float>* spans, int numSpans) noexcept
+{
+    auto top = std::numeric_limits<float>::max();
+    auto bottom = std::numeric_limits<float>::lowest();
+
+    for (int i = 0; i < numSpans; ++i)
+    {
+        if (! spans[i].isEmpty())
+        {
+            top = jmin (top, spans[i].getStart());
+            bottom = jmax (bottom, spans[i].getEnd());
+        }
+    }
+
+    if (top > bottom)
+        return {};
+
+    auto y1 = (int) std::floor (jmax (top, -1.0e8f));
+    auto y2 = (int) std::ceil (jmin (bottom, 1.0e8f));
+
+    return { x, y1, numSpans, y2 - y1 };
+}
+
+EdgeTable::EdgeTable (Rectangle<int> clipLimits, int x, const Range<float>* spans, int numSpans)
+   : bounds (clipLimits.getIntersection (getBoundsOfSpans (x, spans, numSpans))),
+     maxEdgesPerLine (juce_edgeTableDefaultEdgesPerLine),
+     lineStrideElements (juce_edgeTableDefaultEdgesPerLine * 2 + 1)
+{
+    allocate();
+    clearLineSizes();
+
+    auto topLimit = bounds.getY() * 256;
+    auto bottomLimit = bounds.getBottom() * 256;
+
+    for (auto columnX = bounds.getX(); columnX < bounds.getRight(); ++columnX)
+    {
+        auto span = spans[columnX - x];
+
+        if (span.isEmpty())
+            continue;
+
+        auto top    = jmax (topLimit,    roundToInt (jmax (span.getStart(), -1.0e6f) * 256.0f));
+        auto bottom = jmin (bottomLimit, roundToInt (jmin (span.getEnd(),    1.0e6f) * 256.0f));
+        auto x1 = columnX << 8;
+        auto x2 = x1 + 256;
+
+        for (auto y = top >> 8; (y << 8) < bottom; ++y)
+        {
+            auto level = jmin (255, jmin (bottom, (y + 1) << 8) - jmax (top, y << 8));
+
+            if (level <= 0)
+                continue;
+
+            // The columns are added from left to right, so each one either extends the
+            // last run in the line, or starts a new one after it
+            auto* line = table + lineStrideElements * (y - bounds.getY());
+            auto numPoints = line[0];
+
+            if (numPoints + 2 > maxEdgesPerLine)
+            {
+                remapWithExtraSpace (numPoints + 2);
+                line = table + lineStrideElements * (y - bounds.getY());
+            }
+
+            auto* lastPoint = line + numPoints * 2 - 1;
+
+            if (numPoints > 0 && lastPoint[0] == x1)
+            {
+                if (lastPoint[-1] == level)
+                {
+                    lastPoint[0] = x2;
+                    continue;
+                }
+
+                lastPoint[1] = level;
+                lastPoint[2] = x2;
+                lastPoint[3] = 0;
+                line[0] = numPoints + 1;
+            }
+            else
+            {
+                line[numPoints * 2 + 1] = x1;
+                line[numPoints * 2 + 2] = level;
+                line[numPoints * 2 + 3] = x2;
+                line[numPoints * 2 + 4] = 0;
+                line[0] = numPoints + 2;
+            }
+        }
+    }
+}
+
 EdgeTable::EdgeTable (Rectangle<int> rectangleToAdd)
    : bounds (rectangleToAdd),
      maxEdgesPerLine (juce_edgeTableDefaultEdgesPerLine),
@@ -357,34 +474,323 @@ void EdgeTable::sanitiseLevels (const bool useNonZeroWinding) noexcept
                     --correctedNum;
                 }
 
-                auto corrected = std::abs (level);
+                items->x = x;
+                items->level = getLevelForWindingRule (std::abs (level), useNonZeroWinding);
+                ++items;
+            }
+
+            lineStart[0] = correctedNum;
+            (items - 1)->level = 0; // force the last level to 0, just in case something went wrong in creating the table
+        }
+
+        lineStart += lineStrideElements;
+    }
+}
+
+//==============================================================================
+// Converts a path into exact pixel coverage values, working down the area in bands of a few
+// rows at a time. Each band is rendered by adding the edges that cross it into a small grid of
+// cells, where each cell holds the change in winding that the edges make as they pass through
+// that pixel (the cover), and the area of the pixel that lies to the left of them. The pixel
+// levels can then be found by summing the cells from left to right, and a bitmap of the cells
+// that have been touched lets this skip over the runs of pixels that don't contain any edges.
+struct AnalyticPathRasteriser
+{
+    AnalyticPathRasteriser (Rectangle<int> tableBounds, Range<int> columnsToRender)
+        : tableRight (tableBounds.getRight()),
+          areaLeft (columnsToRender.getStart()),
+          leftLimit (columnsToRender.getStart() * 256),
+          rightLimit (columnsToRender.getEnd() * 256),
+          topLimit (tableBounds.getY() * 256),
+          heightLimit (tableBounds.getHeight() * 256),
+          numColumns (columnsToRender.getLength() + 1),
+          numWordsPerRow ((numColumns + 31) / 32)
+    {
+    }
+
+    void addPath (const Path& path, const AffineTransform& transform)
+    {
+        PathFlatteningIterator iter (path, transform);
+
+        while (iter.next())
+            addLine (iter.x1 * 256.0, iter.y1 * 256.0 - topLimit,
+                     iter.x2 * 256.0, iter.y2 * 256.0 - topLimit);
+    }
+
+    // Calls addRow (y, items, numItems) for each row that has any edges in it, where the items
+    // are pairs of x positions and levels, in the same format as an EdgeTable's lines.
+    template <typename RowCallback>
+    void render (bool useNonZeroWinding, RowCallback&& addRow)
+    {
+        if (edges.isEmpty())
+            return;
+
+        std::sort (edges.begin(), edges.end(), [] (const Edge& a, const Edge& b)  { return a.y1 < b.y1; });
+
+        auto numRows = heightLimit >> 8;
+        auto bandHeight = jlimit (1, 64, 65536 / numColumns);
 
-                if (corrected >> 8)
+        cells.calloc ((size_t) (bandHeight * numColumns));
+        touched.calloc ((size_t) (bandHeight * numWordsPerRow));
+        rowItems.malloc ((size_t) (numColumns * 4 + 2));
+
+        std::vector<Edge> activeEdges;
+        int nextEdge = 0;
+
+        for (int bandTop = (edges.getReference (0).y1 >> 8); bandTop < numRows; bandTop += bandHeight)
+        {
+            auto bandBottom = jmin (numRows, bandTop + bandHeight);
+
+            while (nextEdge < edges.size() && (edges.getReference (nextEdge).y1 >> 8) < bandBottom)
+                activeEdges.push_back (edges.getReference (nextEdge++));
+
+            if (activeEdges.empty())
+            {
+                if (nextEdge >= edges.size())
+                    break;
+
+                // skip down to the band where the next edge starts
+                bandTop = (edges.getReference (nextEdge).y1 >> 8) - bandHeight;
+                continue;
+            }
+
+            for (auto& e : activeEdges)
+                renderEdge (e, bandTop, bandBottom);
+
+            activeEdges.erase (std::remove_if (activeEdges.begin(), activeEdges.end(),
+                                               [bandBottom] (const Edge& e)  { return e.y2 <= (bandBottom << 8); }),
+                               activeEdges.end());
+
+            for (int y = bandTop; y < bandBottom; ++y)
+            {
+                auto numItems = createRowItems (y - bandTop, useNonZeroWinding);
+
+                if (numItems > 1)
+                    addRow (y, rowItems.get(), numItems);
+            }
+        }
+    }
+
+private:
+    struct Edge
+    {
+        int x1, y1, x2, y2, direction;
+    };
+
+    struct Cell
+    {
+        int cover, area;
+    };
+
+    const int tableRight, areaLeft, leftLimit, rightLimit, topLimit, heightLimit, numColumns, numWordsPerRow;
+    Array<Edge> edges;
+    HeapBlock<Cell> cells;
+    HeapBlock<uint32> touched;
+    HeapBlock<int> rowItems;
+
+    void addLine (double x1, double y1, double x2, double y2)
+    {
+        // Only the part of the line that's within the table's vertical range is needed
+        auto yMin = jlimit (0.0, (double) heightLimit, jmin (y1, y2));
+        auto yMax = jlimit (0.0, (double) heightLimit, jmax (y1, y2));
+
+        if (yMin >= yMax)
+            return;
+
+        auto xAtY = [=] (double y)  { return x1 + (x2 - x1) * (y - y1) / (y2 - y1); };
+        auto direction = y2 > y1 ? 1 : -1;
+        auto xTop = xAtY (yMin), xBottom = xAtY (yMax);
+
+        // Any part of the line that's beyond the left or right of the area is moved onto
+        // its edge, where it still changes the winding of all the pixels to its right
+        auto limits = xTop < xBottom ? std::make_pair ((double) leftLimit, (double) rightLimit)
+                                     : std::make_pair ((double) rightLimit, (double) leftLimit);
+
+        for (auto limit : { limits.first, limits.second })
+        {
+            if ((xTop < limit) != (xBottom < limit) && xTop != limit && xBottom != limit)
+            {
+                auto ySplit = yMin + (yMax - yMin) * (limit - xTop) / (xBottom - xTop);
+                addEdge (xTop, yMin, limit, ySplit, direction);
+                xTop = limit;
+                yMin = ySplit;
+            }
+        }
+
+        addEdge (xTop, yMin, xBottom, yMax, direction);
+    }
+
+    void addEdge (double x1, double y1, double x2, double y2, int direction)
+    {
+        auto clampX = [this] (double x)  { return jlimit (leftLimit, rightLimit, roundToInt (x)); };
+        Edge e { clampX (x1), roundToInt (y1), clampX (x2), roundToInt (y2), direction };
+
+        if (e.y1 < e.y2)
+            edges.add (e);
+    }
+
+    void renderEdge (const Edge& e, int bandTop, int bandBottom)
+    {
+        auto slope = (e.x2 - e.x1) / (double) (e.y2 - e.y1);
+        auto xAtY = [&] (int y)  { return e.x1 + roundToInt ((y - e.y1) * slope); };
+
+        auto top = jmax (e.y1, bandTop << 8);
+        auto bottom = jmin (e.y2, bandBottom << 8);
+
+        for (int row = top >> 8, lastRow = (bottom - 1) >> 8; row <= lastRow; ++row)
+        {
+            auto rowTop = row << 8;
+            auto y1 = jmax (top, rowTop), y2 = jmin (bottom, rowTop + 256);
+
+            renderScanline (row - bandTop, xAtY (y1), y1 - rowTop, xAtY (y2), y2 - rowTop, e.direction);
+        }
+    }
+
+    // Adds part of an edge that lies within a single row of pixels
+    void renderScanline (int row, int x1, int y1, int x2, int y2, int direction)
+    {
+        auto left = jmin (x1, x2), right = jmax (x1, x2);
+
+        if (left == right || (left >> 8) == ((right - 1) >> 8))
+        {
+            addToCell (left >> 8, row, x1, y1, x2, y2, direction);
+            return;
+        }
+
+        // split the edge where it crosses the boundaries between pixels
+        auto slope = (y2 - y1) / (double) (x2 - x1);
+        auto step = x2 > x1 ? 256 : -256;
+        auto x = x1, y = y1;
+        auto boundary = x2 > x1 ? ((x1 >> 8) + 1) << 8 : (x1 >> 8) << 8;
+
+        while (x2 > x1 ? boundary < x2 : boundary > x2)
+        {
+            auto boundaryY = y1 + roundToInt ((boundary - x1) * slope);
+            addToCell (jmin (x, boundary) >> 8, row, x, y, boundary, boundaryY, direction);
+            x = boundary;
+            y = boundaryY;
+            boundary += step;
+        }
+
+        addToCell (jmin (x, x2) >> 8, row, x, y, x2, y2, direction);
+    }
+
+    void addToCell (int cellX, int row, int x1, int y1, int x2, int y2, int direction) noexcept
+    {
+        auto dy = (y2 - y1) * direction;
+
+        if (dy == 0)
+            return;
+
+        auto column = cellX - areaLeft;
+        jassert (isPositiveAndBelow (column, numColumns));
+
+        auto& cell = cells[row * numColumns + column];
+        auto cellLeft = cellX << 8;
+        cell.cover += dy;
+        cell.area += (x1 - cellLeft + x2 - cellLeft) * dy;
+
+        touched[row * numWordsPerRow + (column >> 5)] |= (uint32) 1 << (column & 31);
+    }
+
+    // Sums the touched cells in a row to create a list of points, where each touched cell becomes
+    // a pixel with its own level, followed by a run of pixels at the level of the total cover so far
+    int createRowItems (int row, bool useNonZeroWinding) noexcept
+    {
+        auto* rowCells = cells + row * numColumns;
+        auto* rowWords = touched + row * numWordsPerRow;
+        auto* items = rowItems.get();
+        int numItems = 0, cover = 0;
+
+        auto addItem = [&] (int x, int level)
+        {
+            if (numItems > 0)
+            {
+                auto* last = items + (numItems - 1) * 2;
+
+                if (last[0] == (x << 8))
                 {
-                    if (useNonZeroWinding)
-                    {
-                        corrected = 255;
-                    }
+                    if (numItems > 1 && last[-1] == level)
+                        --numItems;
                     else
-                    {
-                        corrected &= 511;
+                        last[1] = level;
 
-                        if (corrected >> 8)
-                            corrected = 511 - corrected;
-                    }
+                    return;
                 }
 
-                items->x = x;
-                items->level = corrected;
-                ++items;
+                if (last[1] == level)
+                    return;
             }
 
-            lineStart[0] = correctedNum;
-            (items - 1)->level = 0; // force the last level to 0, just in case something went wrong in creating the table
+            items[numItems * 2] = x << 8;
+            items[numItems * 2 + 1] = level;
+            ++numItems;
+        };
+
+        for (int word = 0; word < numWordsPerRow; ++word)
+        {
+            auto bits = rowWords[word];
+            rowWords[word] = 0;
+
+            while (bits != 0)
+            {
+                auto bit = countNumberOfBits ((bits & (0u - bits)) - 1);
+                bits &= bits - 1;
+
+                auto column = word * 32 + bit;
+                auto& cell = rowCells[column];
+                auto x = areaLeft + column;
+
+                if (x < tableRight)
+                {
+                    // the area is measured to the left of the edges, in units of 1/512th of a level
+                    auto pixelLevel = (std::abs ((cover + cell.cover) * 512 - cell.area) + 256) >> 9;
+                    cover += cell.cover;
+
+                    addItem (x, getLevelForWindingRule (pixelLevel, useNonZeroWinding));
+                    addItem (x + 1, getLevelForWindingRule (std::abs (cover), useNonZeroWinding));
+                }
+
+                cell = {};
+            }
         }
 
-        lineStart += lineStrideElements;
+        if (numItems > 0 && items[numItems * 2 - 1] != 0)
+            addItem (tableRight, 0);
+
+        return numItems;
     }
+};
+
+void EdgeTable::addPathWithAnalyticCoverage (const Path& path, const AffineTransform& transform)
+{
+    maxEdgesPerLine = juce_edgeTableDefaultEdgesPerLine;
+    lineStrideElements = maxEdgesPerLine * 2 + 1;
+    allocate();
+    clearLineSizes();
+    needToCheckEmptiness = true;
+
+    // Only the columns that the path overlaps need to be rendered, because any edges that
+    // are beyond these will be moved onto them
+    auto pathBounds = path.getBoundsTransformed (transform).getSmallestIntegerContainer();
+    auto columns = Range<int> (bounds.getX(), bounds.getRight())
+                     .getIntersectionWith ({ pathBounds.getX(), pathBounds.getRight() });
+
+    if (columns.isEmpty() || bounds.isEmpty())
+        return;
+
+    AnalyticPathRasteriser rasteriser (bounds, columns);
+    rasteriser.addPath (path, transform);
+
+    rasteriser.render (path.isUsingNonZeroWinding(), [this] (int y, const int* items, int numItems)
+    {
+        if (numItems > maxEdgesPerLine)
+            remapTableForNumEdges (jmax (numItems, maxEdgesPerLine * 2));
+
+        auto* line = table + lineStrideElements * y;
+        line[0] = numItems;
+        memcpy (line + 1, items, (size_t) numItems * 2 * sizeof (int));
+    });
 }
 
 void EdgeTable::remapTableForNumEdges (const int newNumEdgesPerLine)
@@ -421,6 +827,11 @@ void EdgeTable::optimiseTable()
     remapTableForNumEdges (maxLineElements);
 }
 
+size_t EdgeTable::getMemoryUsage() const noexcept
+{
+    return getEdgeTableAllocationSize (lineStrideElements, bounds.getHeight()) * sizeof (int);
+}
+
 void EdgeTable::addEdgePoint (const int x, const int y, const int winding)
 {
     jassert (y >= 0 && y < bounds.getHeight());
@@ -838,4 +1249,326 @@ bool EdgeTable::isEmpty() noexcept
     return bounds.getHeight() == 0;
 }
 
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class EdgeTableTests  : public UnitTest
+{
+public:
+    EdgeTableTests()
+        : UnitTest ("EdgeTable", UnitTestCategories::graphics)
+    {}
+
+    void runTest() override
+    {
+        const Rectangle<int> area (0, 0, 64, 48);
+
+        beginTest ("Aligned rectangles are identical with both rasterisers");
+        {
+            Path p;
+            p.addRectangle (3.0f, 5.0f, 20.0f, 11.0f);
+            p.addRectangle (40.0f, 2.0f, 30.0f, 60.0f);
+
+            expect (getCoverage (area, p, EdgeTable::PathRasteriser::analytic)
+                     == getCoverage (area, p, EdgeTable::PathRasteriser::subScanline));
+        }
+
+        beginTest ("Analytic coverage of fractional rectangles");
+        {
+            Random r (0x1234);
+
+            for (int i = 0; i < 50; ++i)
+            {
+                Rectangle<float> rect (r.nextFloat() * 50.0f - 5.0f, r.nextFloat() * 40.0f - 5.0f,
+                                       r.nextFloat() * 20.0f, r.nextFloat() * 20.0f);
+                Path p;
+                p.addRectangle (rect);
+
+                auto coverage = getCoverage (area, p, EdgeTable::PathRasteriser::analytic);
+                int maxError = 0;
+
+                for (int y = 0; y < area.getHeight(); ++y)
+                {
+                    for (int x = 0; x < area.getWidth(); ++x)
+                    {
+                        auto overlap = rect.getIntersection (Rectangle<float> ((float) x, (float) y, 1.0f, 1.0f));
+                        auto expected = jmin (255, roundToInt (overlap.getWidth() * overlap.getHeight() * 256.0f));
+                        maxError = jmax (maxError, std::abs (coverage[(size_t) (y * area.getWidth() + x)] - expected));
+                    }
+                }
+
+                expectLessOrEqual (maxError, 2);
+            }
+        }
+
+        beginTest ("Winding rules");
+        {
+            Path p;
+            p.addRectangle (4.0f, 4.0f, 20.0f, 20.0f);
+            p.addRectangle (14.0f, 14.0f, 20.0f, 20.0f);
+
+            for (auto nonZero : { true, false })
+            {
+                p.setUsingNonZeroWinding (nonZero);
+                auto coverage = getCoverage (area, p, EdgeTable::PathRasteriser::analytic);
+
+                expect (coverage == getCoverage (area, p, EdgeTable::PathRasteriser::subScanline));
+                expectEquals (coverage[(size_t) (18 * area.getWidth() + 18)], nonZero ? 255 : 0);
+                expectEquals (coverage[(size_t) (8 * area.getWidth() + 8)], 255);
+            }
+        }
+
+        beginTest ("Polygons match a supersampled reference");
+        {
+            Path star;
+            star.addStar ({ 32.0f, 24.0f }, 7, 6.0f, 30.0f, 0.3f);
+            star.setUsingNonZeroWinding (false);
+
+            Path polygon;
+            polygon.startNewSubPath (3.2f, 40.7f);
+            polygon.lineTo (60.1f, 2.3f);
+            polygon.lineTo (35.3f, 24.6f);
+            polygon.lineTo (50.8f, 45.5f);
+            polygon.lineTo (20.2f, 30.1f);
+            polygon.closeSubPath();
+
+            for (auto* p : { &star, &polygon })
+            {
+                auto coverage = getCoverage (area, *p, EdgeTable::PathRasteriser::analytic);
+                int maxError = 0;
+
+                for (int y = 0; y < area.getHeight(); ++y)
+                {
+                    for (int x = 0; x < area.getWidth(); ++x)
+                    {
+                        int numInside = 0;
+
+                        for (int sy = 0; sy < 16; ++sy)
+                            for (int sx = 0; sx < 16; ++sx)
+                                if (p->contains ((float) x + ((float) sx + 0.5f) / 16.0f,
+                                                 (float) y + ((float) sy + 0.5f) / 16.0f))
+                                    ++numInside;
+
+                        maxError = jmax (maxError, std::abs (coverage[(size_t) (y * area.getWidth() + x)] - jmin (255, numInside)));
+                    }
+                }
+
+                expectLessOrEqual (maxError, 12);
+            }
+        }
+
+        beginTest ("Curved and stroked paths cover the same area with both rasterisers");
+        {
+            Path circle;
+            circle.addEllipse (5.3f, 4.1f, 37.7f, 39.2f);
+
+            Path stroke;
+            PathStrokeType (2.5f).createStrokedPath (stroke, createWaveform (area.toFloat(), 40, 3));
+
+            for (auto* p : { &circle, &stroke })
+                expectSameTotalCoverage (area, *p);
+        }
+
+        beginTest ("Clipping");
+        {
+            Path p;
+            p.addTriangle (-20.3f, -10.7f, 90.1f, 20.2f, -5.6f, 70.4f);
+
+            auto large = getCoverage ({ -30, -20, 130, 100 }, p, EdgeTable::PathRasteriser::analytic);
+            auto clipped = getCoverage ({ 10, 10, 30, 20 }, p, EdgeTable::PathRasteriser::analytic);
+            int maxDifference = 0;
+
+            for (int y = 0; y < 20; ++y)
+                for (int x = 0; x < 30; ++x)
+                    maxDifference = jmax (maxDifference, std::abs (clipped[(size_t) (y * 30 + x)]
+                                                                     - large[(size_t) ((y + 30) * 130 + x + 40)]));
+
+            expectLessOrEqual (maxDifference, 1);
+
+            EdgeTable empty ({ 0, 0, 10, 10 }, p, AffineTransform::translation (100.0f, 0.0f),
+                             EdgeTable::PathRasteriser::analytic);
+            expect (empty.isEmpty());
+        }
+
+        beginTest ("Graphics contexts");
+        {
+            Path p;
+            p.addStar ({ 30.0f, 22.0f }, 5, 8.5f, 20.3f, 0.1f);
+
+            auto expected = getCoverage (area, p, EdgeTable::PathRasteriser::analytic);
+
+            for (auto tiled : { false, true })
+            {
+                Image image (Image::ARGB, area.getWidth(), area.getHeight(), true, SoftwareImageType());
+
+                {
+                    std::unique_ptr<LowLevelGraphicsContext> context;
+
+                    if (tiled)
+                        context.reset (new LowLevelGraphicsTiledSoftwareRenderer (image));
+                    else
+                        context.reset (new LowLevelGraphicsSoftwareRenderer (image));
+
+                    Graphics g (*context);
+                    g.setColour (Colours::white);
+                    g.setPathRasteriser (EdgeTable::PathRasteriser::analytic);
+                    g.fillPath (p);
+                }
+
+                Image::BitmapData data (image, Image::BitmapData::readOnly);
+                int maxDifference = 0;
+
+                for (int y = 0; y < area.getHeight(); ++y)
+                    for (int x = 0; x < area.getWidth(); ++x)
+                        maxDifference = jmax (maxDifference, std::abs ((int) data.getPixelColour (x, y).getAlpha()
+                                                                        - expected[(size_t) (y * area.getWidth() + x)]));
+
+                expectLessOrEqual (maxDifference, 1);
+            }
+        }
+
+        beginTest ("Vertical spans");
+        {
+            Random r (0x4321);
+            const Rectangle<int> clip (5, 3, 50, 40);
+            const int firstColumn = 2, numSpans = 60;
+            Array<Range<float>> spans;
+
+            for (int i = 0; i < numSpans; ++i)
+            {
+                auto top = r.nextFloat() * 60.0f - 10.0f;
+                spans.add ({ top, i % 7 == 0 ? top : top + r.nextFloat() * 20.0f });
+            }
+
+            EdgeTable et (clip, firstColumn, spans.begin(), spans.size());
+            CoverageRecorder recorder (area);
+            et.iterate (recorder);
+            int maxError = 0;
+
+            for (int y = 0; y < area.getHeight(); ++y)
+            {
+                for (int x = 0; x < area.getWidth(); ++x)
+                {
+                    int expected = 0;
+
+                    if (clip.contains (x, y) && isPositiveAndBelow (x - firstColumn, numSpans))
+                    {
+                        auto span = spans[x - firstColumn];
+                        auto overlap = jmax (0.0f, jmin (span.getEnd(), (float) y + 1.0f) - jmax (span.getStart(), (float) y));
+                        expected = jmin (255, roundToInt (overlap * 256.0f));
+                    }
+
+                    maxError = jmax (maxError, std::abs (recorder.levels[(size_t) (y * area.getWidth() + x)] - expected));
+                }
+            }
+
+            expectLessOrEqual (maxError, 2);
+
+            EdgeTable empty (clip, 100, spans.begin(), spans.size());
+            expect (empty.isEmpty());
+        }
+
+        beginTest ("Large paths cover the same area with both rasterisers");
+        {
+            const Rectangle<int> screen (0, 0, 1920, 400);
+
+            Path filledEnvelope;
+            {
+                // a min/max envelope, as drawn by an audio thumbnail
+                Random r (42);
+                auto centre = screen.getCentreY();
+                filledEnvelope.startNewSubPath (0.0f, (float) centre);
+
+                for (int i = 0; i < 20000; ++i)
+                    filledEnvelope.lineTo ((float) i * 1920.0f / 20000.0f, (float) centre - r.nextFloat() * 180.0f);
+
+                for (int i = 20000; --i >= 0;)
+                    filledEnvelope.lineTo ((float) i * 1920.0f / 20000.0f, (float) centre + r.nextFloat() * 180.0f);
+
+                filledEnvelope.closeSubPath();
+            }
+
+            Path strokedWaveform;
+            PathStrokeType (1.5f).createStrokedPath (strokedWaveform, createWaveform (screen.toFloat(), 8000, 2));
+
+            Path spectrogram;
+
+            for (int band = 0; band < 16; ++band)
+                spectrogram.addPath (createWaveform (screen.toFloat().withTrimmedTop ((float) band * 20.0f)
+                                                                   .withHeight (40.0f), 2000, 10 + band));
+
+            for (auto* p : { &filledEnvelope, &spectrogram })
+                expectSameTotalCoverage (screen, *p);
+
+            // a dense stroke overlaps itself at almost every joint, and the analytic rasteriser
+            // adds up the coverage in those pixels rather than combining it
+            expectGreaterOrEqual (getTotalCoverage (screen, strokedWaveform, EdgeTable::PathRasteriser::analytic),
+                                  getTotalCoverage (screen, strokedWaveform, EdgeTable::PathRasteriser::subScanline));
+        }
+    }
+
+private:
+    struct CoverageRecorder
+    {
+        CoverageRecorder (Rectangle<int> a) : area (a), levels ((size_t) a.getWidth() * (size_t) a.getHeight(), 0) {}
+
+        void setEdgeTableYPos (int y) noexcept                  { line = &levels[(size_t) ((y - area.getY()) * area.getWidth())]; }
+        void handleEdgeTablePixel (int x, int level) noexcept   { line[x - area.getX()] = level; }
+        void handleEdgeTablePixelFull (int x) noexcept          { line[x - area.getX()] = 255; }
+        void handleEdgeTableLine (int x, int width, int level) noexcept       { while (--width >= 0) handleEdgeTablePixel (x++, level); }
+        void handleEdgeTableLineFull (int x, int width) noexcept              { while (--width >= 0) handleEdgeTablePixelFull (x++); }
+
+        Rectangle<int> area;
+        std::vector<int> levels;
+        int* line = nullptr;
+    };
+
+    static std::vector<int> getCoverage (Rectangle<int> area, const Path& p, EdgeTable::PathRasteriser rasteriser)
+    {
+        EdgeTable et (area, p, {}, rasteriser);
+        CoverageRecorder recorder (area);
+        et.iterate (recorder);
+        return recorder.levels;
+    }
+
+    static int64 getTotalCoverage (Rectangle<int> area, const Path& p, EdgeTable::PathRasteriser rasteriser)
+    {
+        auto coverage = getCoverage (area, p, rasteriser);
+        return std::accumulate (coverage.begin(), coverage.end(), (int64) 0);
+    }
+
+    void expectSameTotalCoverage (Rectangle<int> area, const Path& p)
+    {
+        auto analyticTotal = getTotalCoverage (area, p, EdgeTable::PathRasteriser::analytic);
+        auto subScanlineTotal = getTotalCoverage (area, p, EdgeTable::PathRasteriser::subScanline);
+
+        expect (subScanlineTotal > 0);
+        expectLessOrEqual (std::abs (analyticTotal - subScanlineTotal), subScanlineTotal / 100);
+    }
+
+    static Path createWaveform (Rectangle<float> area, int numPoints, int seed)
+    {
+        Random r (seed);
+        Path p;
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            auto x = area.getX() + area.getWidth() * (float) i / (float) (numPoints - 1);
+            auto y = area.getCentreY() + area.getHeight() * 0.45f * (float) std::sin (i * 0.05) * (r.nextFloat() * 2.0f - 1.0f);
+
+            if (i == 0)
+                p.startNewSubPath (x, y);
+            else
+                p.lineTo (x, y);
+        }
+
+        return p;
+    }
+};
+
+static EdgeTableTests edgeTableTests;
+
+#endif
+
 } // namespace juce
@@ -38,6 +38,28 @@ class JUCE_API  EdgeTable
 {
 public:
     //==============================================================================
+    /** The algorithms that can be used to convert a path into an EdgeTable. */
+    enum class PathRasteriser
+    {
+        /** Samples each of the path's edges on up to 256 sub-scanlines per row of pixels.
+            This is the default, and is fast for most paths.
+        */
+        subScanline,
+
+        /** Calculates the exact area of each pixel that the path covers, accumulating the
+            edges into a sparse set of pixel cells.
+
+            The amount of work and memory needed depends only on the number of pixels that
+            the edges pass through, so this is much better for paths with thousands of edges,
+            such as waveforms and spectrograms, and for shallow edges that cross many pixels.
+
+            Because the coverage of each edge within a pixel is added up rather than combined,
+            pixels where a path overlaps itself (e.g. at the joints of a stroked path) may come
+            out more opaque than they would with the sub-scanline rasteriser.
+        */
+        analytic
+    };
+
     /** Creates an edge table containing a path.
 
         A table is created with a fixed vertical range, and only sections of the path
@@ -46,10 +68,25 @@ public:
         @param clipLimits               only the region of the path that lies within this area will be added
         @param pathToAdd                the path to add to the table
         @param transform                a transform to apply to the path being added
+        @param rasteriser               the algorithm to use to calculate the pixels that the path covers
     */
     EdgeTable (Rectangle<int> clipLimits,
                const Path& pathToAdd,
-               const AffineTransform& transform);
+               const AffineTransform& transform,
+               PathRasteriser rasteriser = PathRasteriser::subScanline);
+
+    /** Creates an edge table containing a vertical span in each of a row of columns.
+
+        This is a quick way to rasterise a waveform or plot which has been reduced to the
+        range of values that falls into each column of pixels. The top and bottom of each span
+        are anti-aliased, and any empty spans are skipped.
+
+        @param clipLimits   only the parts of the spans that lie within this area will be added
+        @param x            the x position of the first column
+        @param spans        the top and bottom y positions of the span in each column
+        @param numSpans     the number of columns
+    */
+    EdgeTable (Rectangle<int> clipLimits, int x, const Range<float>* spans, int numSpans);
 
     /** Creates an edge table containing a rectangle. */
     explicit EdgeTable (Rectangle<int> rectangleToAdd);
@@ -91,6 +128,9 @@ public:
     */
     void optimiseTable();
 
+    /** Returns the number of bytes of memory that the table is using. */
+    size_t getMemoryUsage() const noexcept;
+
 
     //==============================================================================
     /** Iterates the lines in the table, for rendering.
@@ -214,6 +254,7 @@ private:
     void intersectWithEdgeTableLine (int y, const int* otherLine);
     void clipEdgeTableLineToRange (int* line, int x1, int x2) noexcept;
     void sanitiseLevels (bool useNonZeroWinding) noexcept;
+    void addPathWithAnalyticCoverage (const Path&, const AffineTransform&);
     static void copyEdgeTableData (int* dest, int destLineStride, const int* src, int srcLineStride, int numLines) noexcept;
 
     JUCE_LEAK_DETECTOR (EdgeTable)
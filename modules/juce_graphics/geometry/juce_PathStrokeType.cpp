@@ -438,6 +438,9 @@ namespace PathStrokeHelpers
         if (arrowhead != nullptr)
             shortenSubPath (subPath, arrowhead->startLength, arrowhead->endLength);
 
+        // each line usually adds one or two points along both sides of the stroke
+        destPath.preallocateSpace (subPath.size() * 12 + 32);
+
         auto& firstLine = subPath.getReference (0);
 
         auto lastX1 = firstLine.lx1;
@@ -540,6 +543,37 @@ namespace PathStrokeHelpers
         destPath.closeSubPath();
     }
 
+    // Calculates the edges of the stroke on either side of a line, and adds it to a sub-path
+    static void addLineSection (Array<LineSection>& subPath, LineSection& l,
+                                float dx, float dy, float hypotSquared, float width)
+    {
+        auto len = std::sqrt (hypotSquared);
+
+        if (len == 0.0f)
+        {
+            l.rx1 = l.rx2 = l.lx1 = l.lx2 = l.x1;
+            l.ry1 = l.ry2 = l.ly1 = l.ly2 = l.y1;
+        }
+        else
+        {
+            auto offset = width / len;
+            dx *= offset;
+            dy *= offset;
+
+            l.rx2 = l.x1 - dy;
+            l.ry2 = l.y1 + dx;
+            l.lx1 = l.x1 + dy;
+            l.ly1 = l.y1 - dx;
+
+            l.lx2 = l.x2 + dy;
+            l.ly2 = l.y2 - dx;
+            l.rx1 = l.x2 - dy;
+            l.ry1 = l.y2 + dx;
+        }
+
+        subPath.add (l);
+    }
+
     static void createStroke (const float thickness, const PathStrokeType::JointStyle jointStyle,
                               const PathStrokeType::EndCapStyle endStyle,
                               Path& destPath, const Path& source,
@@ -571,6 +605,7 @@ namespace PathStrokeHelpers
 
         const float maxMiterExtensionSquared = 9.0f * thickness * thickness;
         const float width = 0.5f * thickness;
+        const float minSegmentLength = 0.0001f;
 
         // Iterate the path, creating a list of the
         // left/right-hand lines along either side of it...
@@ -582,8 +617,6 @@ namespace PathStrokeHelpers
         l.x1 = 0;
         l.y1 = 0;
 
-        const float minSegmentLength = 0.0001f;
-
         while (it.next())
         {
             if (it.subPathIndex == 0)
@@ -608,31 +641,7 @@ namespace PathStrokeHelpers
 
             if (it.closesSubPath || hypotSquared > minSegmentLength || it.isLastInSubpath())
             {
-                auto len = std::sqrt (hypotSquared);
-
-                if (len == 0.0f)
-                {
-                    l.rx1 = l.rx2 = l.lx1 = l.lx2 = l.x1;
-                    l.ry1 = l.ry2 = l.ly1 = l.ly2 = l.y1;
-                }
-                else
-                {
-                    auto offset = width / len;
-                    dx *= offset;
-                    dy *= offset;
-
-                    l.rx2 = l.x1 - dy;
-                    l.ry2 = l.y1 + dx;
-                    l.lx1 = l.x1 + dy;
-                    l.ly1 = l.y1 - dx;
-
-                    l.lx2 = l.x2 + dy;
-                    l.ly2 = l.y2 - dx;
-                    l.rx1 = l.x2 - dy;
-                    l.ry1 = l.y2 + dx;
-                }
-
-                subPath.add (l);
+                addLineSection (subPath, l, dx, dy, hypotSquared, width);
 
                 if (it.closesSubPath)
                 {
@@ -650,6 +659,61 @@ namespace PathStrokeHelpers
         if (subPath.size() > 0)
             addSubPath (destPath, subPath, false, width, maxMiterExtensionSquared, jointStyle, endStyle, arrowhead);
     }
+
+    // This does the same job as createStroke() for a single open sub-path of straight lines,
+    // but goes straight from the points to the line sections, without needing a source path
+    // or a PathFlatteningIterator
+    static void createPolylineStroke (const float thickness, const PathStrokeType::JointStyle jointStyle,
+                                      const PathStrokeType::EndCapStyle endStyle,
+                                      Path& destPath, const Point<float>* points, int numPoints,
+                                      const AffineTransform& transform)
+    {
+        destPath.clear();
+
+        if (thickness <= 0 || numPoints < 2)
+            return;
+
+        destPath.setUsingNonZeroWinding (true);
+
+        const float maxMiterExtensionSquared = 9.0f * thickness * thickness;
+        const float width = 0.5f * thickness;
+        const float minSegmentLength = 0.0001f;
+        const bool isIdentity = transform.isIdentity();
+
+        Array<LineSection> subPath;
+        subPath.ensureStorageAllocated (numPoints - 1);
+
+        LineSection l;
+        l.x1 = points[0].x;
+        l.y1 = points[0].y;
+
+        if (! isIdentity)
+            transform.transformPoint (l.x1, l.y1);
+
+        for (int i = 1; i < numPoints; ++i)
+        {
+            l.x2 = points[i].x;
+            l.y2 = points[i].y;
+
+            if (! isIdentity)
+                transform.transformPoint (l.x2, l.y2);
+
+            float dx = l.x2 - l.x1;
+            float dy = l.y2 - l.y1;
+
+            auto hypotSquared = dx * dx + dy * dy;
+
+            if (hypotSquared > minSegmentLength || i == numPoints - 1)
+            {
+                addLineSection (subPath, l, dx, dy, hypotSquared, width);
+
+                l.x1 = l.x2;
+                l.y1 = l.y2;
+            }
+        }
+
+        addSubPath (destPath, subPath, false, width, maxMiterExtensionSquared, jointStyle, endStyle, nullptr);
+    }
 }
 
 void PathStrokeType::createStrokedPath (Path& destPath, const Path& sourcePath,
@@ -659,6 +723,15 @@ void PathStrokeType::createStrokedPath (Path& destPath, const Path& sourcePath,
                                      transform, extraAccuracy, nullptr);
 }
 
+void PathStrokeType::createStrokedPolyline (Path& destPath, const Point<float>* points, int numPoints,
+                                            const AffineTransform& transform) const
+{
+    jassert (points != nullptr || numPoints == 0);
+
+    PathStrokeHelpers::createPolylineStroke (thickness, jointStyle, endStyle, destPath,
+                                             points, numPoints, transform);
+}
+
 void PathStrokeType::createDashedStroke (Path& destPath,
                                          const Path& sourcePath,
                                          const float* dashLengths,
@@ -741,4 +814,95 @@ void PathStrokeType::createStrokeWithArrowheads (Path& destPath,
                                      destPath, sourcePath, transform, extraAccuracy, &head);
 }
 
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class PathStrokeTypeTests  : public UnitTest
+{
+public:
+    PathStrokeTypeTests()
+        : UnitTest ("PathStrokeType", UnitTestCategories::graphics)
+    {}
+
+    void runTest() override
+    {
+        auto r = getRandom();
+
+        beginTest ("Polylines are stroked in the same way as paths");
+        {
+            auto points = createWaveform (r, 200);
+
+            // some repeated points, which the stroke has to skip over
+            points.insert (50, points[49]);
+            points.insert (50, points[49]);
+            points.add (points.getLast());
+
+            for (auto joint : { PathStrokeType::mitered, PathStrokeType::curved, PathStrokeType::beveled })
+            {
+                for (auto end : { PathStrokeType::butt, PathStrokeType::square, PathStrokeType::rounded })
+                {
+                    for (auto& transform : { AffineTransform(), AffineTransform::rotation (0.3f).scaled (1.5f, 0.7f).translated (10.0f, 3.0f) })
+                    {
+                        PathStrokeType stroke (2.5f, joint, end);
+                        Path expected, actual;
+                        stroke.createStrokedPath (expected, createPath (points), transform);
+                        stroke.createStrokedPolyline (actual, points.getRawDataPointer(), points.size(), transform);
+
+                        expect (actual == expected);
+                    }
+                }
+            }
+
+            Path stroke;
+            stroke.addRectangle (1.0f, 2.0f, 3.0f, 4.0f);
+            PathStrokeType (2.0f).createStrokedPolyline (stroke, points.getRawDataPointer(), 1);
+            expect (stroke.isEmpty());
+
+            PathStrokeType (0.0f).createStrokedPolyline (stroke, points.getRawDataPointer(), points.size());
+            expect (stroke.isEmpty());
+        }
+
+        beginTest ("Long polylines");
+        {
+            auto points = createWaveform (r, 100000);
+            PathStrokeType strokeType (1.5f);
+            Path expected, actual;
+
+            strokeType.createStrokedPath (expected, createPath (points));
+            strokeType.createStrokedPolyline (actual, points.getRawDataPointer(), points.size());
+
+            expect (actual == expected);
+        }
+    }
+
+private:
+    static Array<Point<float>> createWaveform (Random& r, int numPoints)
+    {
+        Array<Point<float>> points;
+        points.ensureStorageAllocated (numPoints);
+
+        for (int i = 0; i < numPoints; ++i)
+            points.add ({ (float) i * 0.25f, 50.0f + 40.0f * std::sin ((float) i * 0.05f) + r.nextFloat() * 5.0f });
+
+        return points;
+    }
+
+    static Path createPath (const Array<Point<float>>& points)
+    {
+        Path p;
+        p.preallocateSpace (points.size() * 3);
+        p.startNewSubPath (points.getFirst());
+
+        for (int i = 1; i < points.size(); ++i)
+            p.lineTo (points.getReference (i));
+
+        return p;
+    }
+};
+
+static PathStrokeTypeTests pathStrokeTypeTests;
+
+#endif
+
 } // namespace juce
@@ -109,6 +109,25 @@ public:
                             const AffineTransform& transform = AffineTransform(),
                             float extraAccuracy = 1.0f) const;
 
+    /** Applies this stroke type to a line made from a sequence of connected points.
+
+        This produces exactly the same outline as building an open Path from the points and
+        calling createStrokedPath() on it, but it doesn't need to create and flatten the source
+        path, so it's a lot quicker for very long lines, like waveforms with many thousands of
+        points.
+
+        @param destPath         the resultant stroked outline shape will be copied into this path
+        @param points           the points that the line passes through
+        @param numPoints        the number of points in the array. If this is less than 2, the
+                                path will just be cleared
+        @param transform        an optional transform to apply to the points as they are used
+        @see createStrokedPath
+    */
+    void createStrokedPolyline (Path& destPath,
+                                const Point<float>* points,
+                                int numPoints,
+                                const AffineTransform& transform = AffineTransform()) const;
+
 
     //==============================================================================
     /** Applies this stroke type to a path, creating a dashed line.
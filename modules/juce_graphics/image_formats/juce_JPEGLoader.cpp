@@ -324,24 +324,9 @@ Image JPEGImageFormat::decodeImage (InputStream& in)
                         uint8* dest = destData.getLinePointer (y);
 
                         if (hasAlphaChan)
-                        {
-                            for (int i = width; --i >= 0;)
-                            {
-                                ((PixelARGB*) dest)->setARGB (0xff, src[0], src[1], src[2]);
-                                ((PixelARGB*) dest)->premultiply();
-                                dest += destData.pixelStride;
-                                src += 3;
-                            }
-                        }
+                            RenderingHelpers::PixelConversion::convertRGBToARGB ((PixelARGB*) dest, destData.pixelStride, src, 3, width);
                         else
-                        {
-                            for (int i = width; --i >= 0;)
-                            {
-                                ((PixelRGB*) dest)->setARGB (0xff, src[0], src[1], src[2]);
-                                dest += destData.pixelStride;
-                                src += 3;
-                            }
-                        }
+                            RenderingHelpers::PixelConversion::convertRGBToRGB ((PixelRGB*) dest, destData.pixelStride, src, 3, width);
                     }
 
                     if (! hasFailed)
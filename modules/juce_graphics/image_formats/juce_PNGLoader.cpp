@@ -430,24 +430,9 @@ namespace PNGHelpers
             uint8* dest = destData.getLinePointer (y);
 
             if (hasAlphaChan)
-            {
-                for (int i = (int) width; --i >= 0;)
-                {
-                    ((PixelARGB*) dest)->setARGB (src[3], src[0], src[1], src[2]);
-                    ((PixelARGB*) dest)->premultiply();
-                    dest += destData.pixelStride;
-                    src += 4;
-                }
-            }
+                RenderingHelpers::PixelConversion::convertRGBAToARGB ((PixelARGB*) dest, destData.pixelStride, src, width);
             else
-            {
-                for (int i = (int) width; --i >= 0;)
-                {
-                    ((PixelRGB*) dest)->setARGB (0, src[0], src[1], src[2]);
-                    dest += destData.pixelStride;
-                    src += 4;
-                }
-            }
+                RenderingHelpers::PixelConversion::convertRGBToRGB ((PixelRGB*) dest, destData.pixelStride, src, 4, width);
         }
 
         return image;
@@ -0,0 +1,747 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+namespace BlurHelpers
+{
+    // Adds each value multiplied by a weight to a row of totals
+    static void addWeightedValues (float* totals, const uint8* values, int num, float weight) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_PIXEL_BLENDING_SSE2
+        auto w = _mm_set1_ps (weight);
+        auto zero = _mm_setzero_si128();
+
+        for (; i + 16 <= num; i += 16)
+        {
+            auto bytes = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (values + i));
+            auto low = _mm_unpacklo_epi8 (bytes, zero);
+            auto high = _mm_unpackhi_epi8 (bytes, zero);
+
+            const __m128 v[] = { _mm_cvtepi32_ps (_mm_unpacklo_epi16 (low, zero)),
+                                 _mm_cvtepi32_ps (_mm_unpackhi_epi16 (low, zero)),
+                                 _mm_cvtepi32_ps (_mm_unpacklo_epi16 (high, zero)),
+                                 _mm_cvtepi32_ps (_mm_unpackhi_epi16 (high, zero)) };
+
+            for (int j = 0; j < 4; ++j)
+                _mm_storeu_ps (totals + i + j * 4, _mm_add_ps (_mm_loadu_ps (totals + i + j * 4), _mm_mul_ps (v[j], w)));
+        }
+       #elif JUCE_PIXEL_BLENDING_NEON
+        auto w = vdupq_n_f32 (weight);
+
+        for (; i + 16 <= num; i += 16)
+        {
+            auto bytes = vld1q_u8 (values + i);
+            auto low = vmovl_u8 (vget_low_u8 (bytes));
+            auto high = vmovl_u8 (vget_high_u8 (bytes));
+
+            const float32x4_t v[] = { vcvtq_f32_u32 (vmovl_u16 (vget_low_u16 (low))),
+                                      vcvtq_f32_u32 (vmovl_u16 (vget_high_u16 (low))),
+                                      vcvtq_f32_u32 (vmovl_u16 (vget_low_u16 (high))),
+                                      vcvtq_f32_u32 (vmovl_u16 (vget_high_u16 (high))) };
+
+            for (int j = 0; j < 4; ++j)
+                vst1q_f32 (totals + i + j * 4, vaddq_f32 (vld1q_f32 (totals + i + j * 4), vmulq_f32 (v[j], w)));
+        }
+       #endif
+
+        for (; i < num; ++i)
+            totals[i] += weight * (float) values[i];
+    }
+
+    static void addWeightedValues (float* totals, const float* values, int num, float weight) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_PIXEL_BLENDING_SSE2
+        auto w = _mm_set1_ps (weight);
+
+        for (; i + 4 <= num; i += 4)
+            _mm_storeu_ps (totals + i, _mm_add_ps (_mm_loadu_ps (totals + i), _mm_mul_ps (_mm_loadu_ps (values + i), w)));
+       #elif JUCE_PIXEL_BLENDING_NEON
+        auto w = vdupq_n_f32 (weight);
+
+        for (; i + 4 <= num; i += 4)
+            vst1q_f32 (totals + i, vaddq_f32 (vld1q_f32 (totals + i), vmulq_f32 (vld1q_f32 (values + i), w)));
+       #endif
+
+        for (; i < num; ++i)
+            totals[i] += weight * values[i];
+    }
+
+    // Rounds a row of values to the nearest integer and clips them to the range 0 to 255
+    static void storeRoundedValues (uint8* dest, const float* values, int num) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_PIXEL_BLENDING_SSE2
+        for (; i + 8 <= num; i += 8)
+        {
+            auto words = _mm_packs_epi32 (_mm_cvtps_epi32 (_mm_loadu_ps (values + i)),
+                                          _mm_cvtps_epi32 (_mm_loadu_ps (values + i + 4)));
+            _mm_storel_epi64 (reinterpret_cast<__m128i*> (dest + i), _mm_packus_epi16 (words, words));
+        }
+       #elif JUCE_PIXEL_BLENDING_NEON
+        for (; i + 8 <= num; i += 8)
+        {
+            auto half = vdupq_n_f32 (0.5f);
+            auto words = vcombine_s16 (vqmovn_s32 (vcvtq_s32_f32 (vaddq_f32 (vld1q_f32 (values + i), half))),
+                                       vqmovn_s32 (vcvtq_s32_f32 (vaddq_f32 (vld1q_f32 (values + i + 4), half))));
+            vst1_u8 (dest + i, vqmovun_s16 (words));
+        }
+       #endif
+
+        for (; i < num; ++i)
+            dest[i] = (uint8) jlimit (0, 255, roundToInt (values[i]));
+    }
+
+    // Adds one row of values to a row of totals, and subtracts another one
+    static void updateTotals (int* totals, const uint8* valuesToAdd, const uint8* valuesToSubtract, int num) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_PIXEL_BLENDING_SSE2
+        auto zero = _mm_setzero_si128();
+
+        for (; i + 8 <= num; i += 8)
+        {
+            auto added = _mm_unpacklo_epi8 (_mm_loadl_epi64 (reinterpret_cast<const __m128i*> (valuesToAdd + i)), zero);
+            auto subtracted = _mm_unpacklo_epi8 (_mm_loadl_epi64 (reinterpret_cast<const __m128i*> (valuesToSubtract + i)), zero);
+            auto difference = _mm_sub_epi16 (added, subtracted);
+            auto sign = _mm_srai_epi16 (difference, 15);
+
+            auto* t = reinterpret_cast<__m128i*> (totals + i);
+            _mm_storeu_si128 (t,     _mm_add_epi32 (_mm_loadu_si128 (t),     _mm_unpacklo_epi16 (difference, sign)));
+            _mm_storeu_si128 (t + 1, _mm_add_epi32 (_mm_loadu_si128 (t + 1), _mm_unpackhi_epi16 (difference, sign)));
+        }
+       #elif JUCE_PIXEL_BLENDING_NEON
+        for (; i + 8 <= num; i += 8)
+        {
+            auto difference = vreinterpretq_s16_u16 (vsubl_u8 (vld1_u8 (valuesToAdd + i), vld1_u8 (valuesToSubtract + i)));
+            vst1q_s32 (totals + i,     vaddw_s16 (vld1q_s32 (totals + i),     vget_low_s16 (difference)));
+            vst1q_s32 (totals + i + 4, vaddw_s16 (vld1q_s32 (totals + i + 4), vget_high_s16 (difference)));
+        }
+       #endif
+
+        for (; i < num; ++i)
+            totals[i] += (int) valuesToAdd[i] - (int) valuesToSubtract[i];
+    }
+
+    // Writes a row of totals multiplied by a scale factor, rounded to the nearest integer
+    static void storeScaledTotals (uint8* dest, const int* totals, int num, float scale) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_PIXEL_BLENDING_SSE2
+        auto s = _mm_set1_ps (scale);
+
+        for (; i + 8 <= num; i += 8)
+        {
+            auto* t = reinterpret_cast<const __m128i*> (totals + i);
+            auto words = _mm_packs_epi32 (_mm_cvtps_epi32 (_mm_mul_ps (_mm_cvtepi32_ps (_mm_loadu_si128 (t)), s)),
+                                          _mm_cvtps_epi32 (_mm_mul_ps (_mm_cvtepi32_ps (_mm_loadu_si128 (t + 1)), s)));
+            _mm_storel_epi64 (reinterpret_cast<__m128i*> (dest + i), _mm_packus_epi16 (words, words));
+        }
+       #elif JUCE_PIXEL_BLENDING_NEON
+        for (; i + 8 <= num; i += 8)
+        {
+            auto half = vdupq_n_f32 (0.5f);
+            auto words = vcombine_s16 (vqmovn_s32 (vcvtq_s32_f32 (vmlaq_n_f32 (half, vcvtq_f32_s32 (vld1q_s32 (totals + i)), scale))),
+                                       vqmovn_s32 (vcvtq_s32_f32 (vmlaq_n_f32 (half, vcvtq_f32_s32 (vld1q_s32 (totals + i + 4)), scale))));
+            vst1_u8 (dest + i, vqmovun_s16 (words));
+        }
+       #endif
+
+        for (; i < num; ++i)
+            dest[i] = (uint8) roundToInt ((float) totals[i] * scale);
+    }
+
+    //==============================================================================
+    // Small images aren't worth splitting up between threads
+    static void performJobs (const Image::BitmapData& data, size_t numJobs, std::function<void (size_t)> job)
+    {
+        if ((int64) data.width * data.height * data.pixelStride >= 65536)
+        {
+            SoftwareRenderingThreadPool::performJobs (numJobs, std::move (job));
+        }
+        else
+        {
+            for (size_t i = 0; i < numJobs; ++i)
+                job (i);
+        }
+    }
+
+    static void applyHorizontalBoxBlurs (const Image::BitmapData& data, const int* radii, int numRadii)
+    {
+        const int rowsPerJob = 16;
+        auto numChannels = data.pixelStride;
+        auto width = data.width;
+
+        performJobs (data, (size_t) ((data.height + rowsPerJob - 1) / rowsPerJob), [&] (size_t job)
+        {
+            HeapBlock<uint8> source ((size_t) (width * numChannels));
+            auto startRow = (int) job * rowsPerJob;
+
+            for (int y = startRow; y < jmin (data.height, startRow + rowsPerJob); ++y)
+            {
+                auto* line = data.getLinePointer (y);
+
+                for (int pass = 0; pass < numRadii; ++pass)
+                {
+                    auto radius = radii[pass];
+
+                    if (radius <= 0)
+                        continue;
+
+                    auto scale = 1.0f / (float) (radius * 2 + 1);
+                    memcpy (source, line, (size_t) (width * numChannels));
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                    {
+                        auto* src = source.get() + channel;
+                        auto* dest = line + channel;
+                        int total = 0;
+
+                        for (int x = 0; x < jmin (radius, width - 1) + 1; ++x)
+                            total += src[x * numChannels];
+
+                        for (int x = 0; x < width; ++x)
+                        {
+                            dest[x * numChannels] = (uint8) roundToInt ((float) total * scale);
+
+                            if (x + radius + 1 < width)  total += src[(x + radius + 1) * numChannels];
+                            if (x - radius >= 0)         total -= src[(x - radius) * numChannels];
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    static void applyVerticalBoxBlurs (const Image::BitmapData& data, const int* radii, int numRadii)
+    {
+        // The image is split into strips of columns, and each one is copied into a buffer so
+        // that the original values are still available after the rows have been overwritten
+        const int bytesPerJob = 64;
+        auto rowBytes = data.width * data.pixelStride;
+        auto height = data.height;
+
+        performJobs (data, (size_t) ((rowBytes + bytesPerJob - 1) / bytesPerJob), [&] (size_t job)
+        {
+            auto startByte = (int) job * bytesPerJob;
+            auto numBytes = jmin (bytesPerJob, rowBytes - startByte);
+
+            HeapBlock<uint8> source ((size_t) (numBytes * height)), zeros ((size_t) numBytes, true);
+            HeapBlock<int> totals ((size_t) numBytes);
+
+            for (int pass = 0; pass < numRadii; ++pass)
+            {
+                auto radius = radii[pass];
+
+                if (radius <= 0)
+                    continue;
+
+                for (int y = 0; y < height; ++y)
+                    memcpy (source + y * numBytes, data.getLinePointer (y) + startByte, (size_t) numBytes);
+
+                auto getSourceRow = [&] (int y) -> const uint8*  { return isPositiveAndBelow (y, height) ? source + y * numBytes : zeros.get(); };
+                auto scale = 1.0f / (float) (radius * 2 + 1);
+
+                zeromem (totals, (size_t) numBytes * sizeof (int));
+
+                for (int y = 0; y <= jmin (radius, height - 1); ++y)
+                    updateTotals (totals, getSourceRow (y), zeros, numBytes);
+
+                for (int y = 0; y < height; ++y)
+                {
+                    storeScaledTotals (data.getLinePointer (y) + startByte, totals, numBytes, scale);
+                    updateTotals (totals, getSourceRow (y + radius + 1), getSourceRow (y - radius), numBytes);
+                }
+            }
+        });
+    }
+
+    static void applyBoxBlurs (Image& image, Rectangle<int> area, const int* radii, int numRadii)
+    {
+        area = area.getIntersection (image.getBounds());
+
+        if (area.isEmpty() || numRadii <= 0)
+            return;
+
+        const Image::BitmapData data (image, area.getX(), area.getY(), area.getWidth(), area.getHeight(),
+                                      Image::BitmapData::readWrite);
+
+        // When there's more than one pass, the earlier ones spread the pixels out beyond the edges
+        // of the area, and the later passes need to see that, so they're done on a copy with enough
+        // transparent space around it. (The last pass doesn't need this, as anything it spreads
+        // outside the area is thrown away).
+        int padding = 0;
+
+        for (int i = 0; i < numRadii - 1; ++i)
+            padding += jmax (0, radii[i]);
+
+        if (padding == 0)
+        {
+            applyHorizontalBoxBlurs (data, radii, numRadii);
+            applyVerticalBoxBlurs (data, radii, numRadii);
+            return;
+        }
+
+        Image paddedImage (image.getFormat(), area.getWidth() + padding * 2, area.getHeight() + padding * 2,
+                           true, SoftwareImageType());
+
+        const Image::BitmapData paddedData (paddedImage, Image::BitmapData::readWrite);
+        auto numBytes = (size_t) (data.width * data.pixelStride);
+
+        for (int y = 0; y < data.height; ++y)
+            memcpy (paddedData.getPixelPointer (padding, y + padding), data.getLinePointer (y), numBytes);
+
+        applyHorizontalBoxBlurs (paddedData, radii, numRadii);
+        applyVerticalBoxBlurs (paddedData, radii, numRadii);
+
+        for (int y = 0; y < data.height; ++y)
+            memcpy (data.getLinePointer (y), paddedData.getPixelPointer (padding, y + padding), numBytes);
+    }
+}
+
+//==============================================================================
+void ImageBlur::applyBoxBlur (Image& image, Rectangle<int> area, int radius, int numPasses)
+{
+    std::vector<int> radii ((size_t) jmax (0, numPasses), radius);
+    BlurHelpers::applyBoxBlurs (image, area, radii.data(), (int) radii.size());
+}
+
+void ImageBlur::applyFastGaussianBlur (Image& image, Rectangle<int> area, float standardDeviation)
+{
+    if (standardDeviation <= 0.0f)
+        return;
+
+    // This chooses the sizes of three box blurs whose combined variance is as close as possible
+    // to that of the gaussian, using two different sizes so that it can match it more closely.
+    const int numBoxes = 3;
+    auto variance = (double) standardDeviation * standardDeviation;
+    auto smallerWidth = (int) std::floor (std::sqrt (12.0 * variance / numBoxes + 1.0));
+
+    if ((smallerWidth & 1) == 0)
+        --smallerWidth;
+
+    auto numSmaller = roundToInt ((12.0 * variance - numBoxes * smallerWidth * smallerWidth - 4 * numBoxes * smallerWidth - 3 * numBoxes)
+                                    / (-4.0 * smallerWidth - 4.0));
+
+    int radii[numBoxes];
+
+    for (int i = 0; i < numBoxes; ++i)
+        radii[i] = i < numSmaller ? smallerWidth / 2 : smallerWidth / 2 + 1;
+
+    BlurHelpers::applyBoxBlurs (image, area, radii, numBoxes);
+}
+
+void ImageBlur::applyGaussianBlur (Image& image, Rectangle<int> area, float standardDeviation)
+{
+    if (standardDeviation <= 0.0f)
+        return;
+
+    auto radius = (int) std::ceil (standardDeviation * 3.0f);
+    HeapBlock<float> kernel ((size_t) (radius * 2 + 1));
+    float total = 0;
+
+    for (int i = -radius; i <= radius; ++i)
+    {
+        auto value = (float) std::exp (-(i * i) / (2.0 * standardDeviation * standardDeviation));
+        kernel[i + radius] = value;
+        total += value;
+    }
+
+    for (int i = 0; i < radius * 2 + 1; ++i)
+        kernel[i] /= total;
+
+    // A blur of just this area is the same as convolving an image that only contains this area
+    area = area.getIntersection (image.getBounds());
+
+    if (! area.isEmpty())
+    {
+        auto areaImage = image.getClippedImage (area);
+        applySeparableKernel (areaImage, areaImage, areaImage.getBounds(),
+                              kernel, radius * 2 + 1, -radius, kernel, radius * 2 + 1, -radius);
+    }
+}
+
+void ImageBlur::applySeparableKernel (const Image& source, Image& destination, Rectangle<int> area,
+                                      const float* rowKernel, int rowKernelSize, int rowKernelOffset,
+                                      const float* columnKernel, int columnKernelSize, int columnKernelOffset)
+{
+    jassert (source.getBounds() == destination.getBounds() && source.getFormat() == destination.getFormat());
+
+    area = area.getIntersection (destination.getBounds());
+
+    if (area.isEmpty())
+        return;
+
+    // First, each of the source rows that the column kernel needs is convolved with the row kernel
+    const Image::BitmapData srcData (source, Image::BitmapData::readOnly);
+    auto numChannels = srcData.pixelStride;
+    auto rowValues = area.getWidth() * numChannels;
+    auto firstSourceRow = jmax (0, area.getY() + columnKernelOffset);
+    auto lastSourceRow = jmin (srcData.height, area.getBottom() + columnKernelOffset + columnKernelSize - 1);
+    auto numSourceRows = jmax (0, lastSourceRow - firstSourceRow);
+    const int rowsPerJob = 16;
+
+    HeapBlock<float> rowsConvolved ((size_t) (numSourceRows * rowValues));
+
+    BlurHelpers::performJobs (srcData, (size_t) ((numSourceRows + rowsPerJob - 1) / rowsPerJob), [&] (size_t job)
+    {
+        // each row is copied into a buffer with zeros around it, so that the kernel can be
+        // applied without having to check where the edges are
+        auto paddedStartX = area.getX() + rowKernelOffset;
+        auto paddedWidth = area.getWidth() + rowKernelSize - 1;
+        auto validStartX = jmax (0, paddedStartX);
+        auto validEndX = jmin (srcData.width, paddedStartX + paddedWidth);
+        HeapBlock<uint8> padded ((size_t) (paddedWidth * numChannels), true);
+
+        for (int i = 0; i < rowsPerJob; ++i)
+        {
+            auto row = (int) job * rowsPerJob + i;
+
+            if (row >= numSourceRows)
+                break;
+
+            if (validEndX > validStartX)
+                memcpy (padded + (validStartX - paddedStartX) * numChannels,
+                        srcData.getPixelPointer (validStartX, firstSourceRow + row),
+                        (size_t) ((validEndX - validStartX) * numChannels));
+
+            auto* totals = rowsConvolved + row * rowValues;
+            zeromem (totals, (size_t) rowValues * sizeof (float));
+
+            for (int k = 0; k < rowKernelSize; ++k)
+                BlurHelpers::addWeightedValues (totals, padded + k * numChannels, rowValues, rowKernel[k]);
+        }
+    });
+
+    // ..and then those rows are convolved with the column kernel to make the destination rows
+    const Image::BitmapData destData (destination, area.getX(), area.getY(), area.getWidth(), area.getHeight(),
+                                      Image::BitmapData::readWrite);
+
+    BlurHelpers::performJobs (destData, (size_t) ((area.getHeight() + rowsPerJob - 1) / rowsPerJob), [&] (size_t job)
+    {
+        HeapBlock<float> totals ((size_t) rowValues);
+
+        for (int i = 0; i < rowsPerJob; ++i)
+        {
+            auto y = (int) job * rowsPerJob + i;
+
+            if (y >= area.getHeight())
+                break;
+
+            zeromem (totals, (size_t) rowValues * sizeof (float));
+
+            for (int k = 0; k < columnKernelSize; ++k)
+            {
+                auto row = area.getY() + y + columnKernelOffset + k - firstSourceRow;
+
+                if (isPositiveAndBelow (row, numSourceRows))
+                    BlurHelpers::addWeightedValues (totals.get(), rowsConvolved + row * rowValues, rowValues, columnKernel[k]);
+            }
+
+            BlurHelpers::storeRoundedValues (destData.getLinePointer (y), totals, rowValues);
+        }
+    });
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ImageBlurTests  : public UnitTest
+{
+public:
+    ImageBlurTests()
+        : UnitTest ("ImageBlur", UnitTestCategories::graphics)
+    {}
+
+    void runTest() override
+    {
+        auto random = getRandom();
+
+        beginTest ("Box blurs match a reference");
+        {
+            for (auto format : { Image::SingleChannel, Image::RGB, Image::ARGB })
+            {
+                for (auto size : { Rectangle<int> (37, 23), Rectangle<int> (300, 250) })
+                {
+                    for (auto radius : { 0, 1, 3, 40 })
+                    {
+                        for (int numPasses = 1; numPasses <= 3; ++numPasses)
+                        {
+                            auto image = createRandomImage (format, size.getWidth(), size.getHeight(), random);
+                            auto expected = image.createCopy();
+                            auto area = size.reduced (3, 2).translated (1, 0);
+
+                            std::vector<int> radii ((size_t) numPasses, radius);
+                            applyReferenceBoxBlurs (expected, area, radii);
+                            ImageBlur::applyBoxBlur (image, area, radius, numPasses);
+
+                            expectEquals (getMaxDifference (image, expected), 0);
+                        }
+                    }
+                }
+            }
+        }
+
+        beginTest ("Gaussian blurs match a reference");
+        {
+            for (auto format : { Image::SingleChannel, Image::RGB, Image::ARGB })
+            {
+                for (auto standardDeviation : { 0.5f, 1.7f, 6.0f })
+                {
+                    auto image = createRandomImage (format, 260, 280, random);
+                    auto expected = image.createCopy();
+                    Rectangle<int> area (10, 5, 230, 270);
+
+                    applyReferenceGaussianBlur (expected, area, standardDeviation);
+                    ImageBlur::applyGaussianBlur (image, area, standardDeviation);
+
+                    expectLessOrEqual (getMaxDifference (image, expected), 1);
+                }
+            }
+        }
+
+        beginTest ("Fast gaussian blurs are close to gaussian blurs");
+        {
+            for (auto standardDeviation : { 2.5f, 7.0f, 20.0f })
+            {
+                auto image = createRandomImage (Image::ARGB, 200, 150, random);
+
+                // a random image gets blurred to almost nothing, so this adds some larger shapes
+                {
+                    Graphics g (image);
+
+                    for (int i = 0; i < 20; ++i)
+                    {
+                        g.setColour (Colour ((uint32) random.nextInt()));
+                        g.fillEllipse (random.nextFloat() * 200.0f, random.nextFloat() * 150.0f, 50.0f, 40.0f);
+                    }
+                }
+
+                auto gaussian = image.createCopy();
+                ImageBlur::applyGaussianBlur (gaussian, gaussian.getBounds(), standardDeviation);
+                ImageBlur::applyFastGaussianBlur (image, image.getBounds(), standardDeviation);
+
+                expectLessOrEqual (getMaxDifference (image, gaussian), 16);
+            }
+        }
+
+        beginTest ("Convolution kernels");
+        {
+            ImageConvolutionKernel gaussianKernel (9);
+            gaussianKernel.createGaussianBlur (2.5f);
+            gaussianKernel.rescaleAllValues (1.5f);
+
+            ImageConvolutionKernel sharpenKernel (3);
+            sharpenKernel.setKernelValue (1, 1, 5.0f);
+
+            for (auto xy : { Point<int> (1, 0), Point<int> (0, 1), Point<int> (2, 1), Point<int> (1, 2) })
+                sharpenKernel.setKernelValue (xy.x, xy.y, -1.0f);
+
+            for (auto* kernel : { &gaussianKernel, &sharpenKernel })
+            {
+                for (auto format : { Image::SingleChannel, Image::ARGB })
+                {
+                    auto source = createRandomImage (format, 70, 50, random);
+                    auto dest = source.createCopy();
+                    auto expected = source.createCopy();
+                    Rectangle<int> area (5, 3, 50, 40);
+
+                    applyReferenceKernel (expected, source, area, *kernel);
+                    kernel->applyToImage (dest, source, area);
+                    expectLessOrEqual (getMaxDifference (dest, expected), 1);
+
+                    // filtering an image in-place should give the same result
+                    kernel->applyToImage (source, source, area);
+                    expectLessOrEqual (getMaxDifference (source, expected), 1);
+                }
+            }
+        }
+
+        beginTest ("Gaussian blurs match a two-dimensional kernel");
+        {
+            for (auto format : { Image::SingleChannel, Image::ARGB })
+            {
+                auto source = createRandomImage (format, 256, 256, random);
+                auto image = source.createCopy();
+                auto expected = source.createCopy();
+                const auto standardDeviation = 2.0f;
+
+                // the two-dimensional convolution that ImageConvolutionKernel used to do for everything
+                ImageConvolutionKernel kernel ((int) std::ceil (standardDeviation * 3.0f) * 2 + 1);
+                kernel.createGaussianBlur (standardDeviation);
+
+                applyReferenceKernel (expected, source, expected.getBounds(), kernel);
+                ImageBlur::applyGaussianBlur (image, image.getBounds(), standardDeviation);
+
+                expectLessOrEqual (getMaxDifference (image, expected), 1);
+            }
+        }
+    }
+
+private:
+    static Image createRandomImage (Image::PixelFormat format, int width, int height, Random& random)
+    {
+        Image image (format, width, height, false, SoftwareImageType());
+        Image::BitmapData data (image, Image::BitmapData::writeOnly);
+
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width * data.pixelStride; ++x)
+                data.getLinePointer (y)[x] = (uint8) random.nextInt (256);
+
+        if (format == Image::ARGB)
+            for (int y = 0; y < height; ++y)
+                for (int x = 0; x < width; ++x)
+                    reinterpret_cast<PixelARGB*> (data.getPixelPointer (x, y))->premultiply();
+
+        return image;
+    }
+
+    static int getMaxDifference (const Image& a, const Image& b)
+    {
+        Image::BitmapData da (a, Image::BitmapData::readOnly), db (b, Image::BitmapData::readOnly);
+        int maxDifference = 0;
+
+        for (int y = 0; y < da.height; ++y)
+            for (int x = 0; x < da.width * da.pixelStride; ++x)
+                maxDifference = jmax (maxDifference, std::abs ((int) da.getLinePointer (y)[x] - (int) db.getLinePointer (y)[x]));
+
+        return maxDifference;
+    }
+
+    // Applies each box blur in turn along the rows, and then along the columns, in an image
+    // with enough transparent space around the area for none of the pixels to be lost
+    static void applyReferenceBoxBlurs (Image& image, Rectangle<int> area, const std::vector<int>& radii)
+    {
+        auto padding = std::accumulate (radii.begin(), radii.end(), 0);
+        Image padded (image.getFormat(), area.getWidth() + padding * 2, area.getHeight() + padding * 2, true);
+        padded.clear (padded.getBounds());
+
+        auto clipped = image.getClippedImage (area);
+        Image::BitmapData clippedData (clipped, Image::BitmapData::readWrite);
+        Image::BitmapData data (padded, Image::BitmapData::readWrite);
+
+        for (int y = 0; y < clippedData.height; ++y)
+            for (int x = 0; x < clippedData.width * clippedData.pixelStride; ++x)
+                data.getPixelPointer (padding, y + padding)[x] = clippedData.getLinePointer (y)[x];
+
+        auto blurLine = [&] (int length, std::function<uint8& (int, int)> getValue)
+        {
+            for (auto radius : radii)
+            {
+                for (int channel = 0; channel < data.pixelStride; ++channel)
+                {
+                    std::vector<int> original;
+
+                    for (int i = 0; i < length; ++i)
+                        original.push_back (getValue (i, channel));
+
+                    for (int i = 0; i < length; ++i)
+                    {
+                        int total = 0;
+
+                        for (int j = i - radius; j <= i + radius; ++j)
+                            if (isPositiveAndBelow (j, length))
+                                total += original[(size_t) j];
+
+                        getValue (i, channel) = (uint8) roundToInt ((double) total / (radius * 2 + 1));
+                    }
+                }
+            }
+        };
+
+        for (int y = 0; y < data.height; ++y)
+            blurLine (data.width, [&] (int x, int channel) -> uint8& { return data.getPixelPointer (x, y)[channel]; });
+
+        for (int x = 0; x < data.width; ++x)
+            blurLine (data.height, [&] (int y, int channel) -> uint8& { return data.getPixelPointer (x, y)[channel]; });
+
+        for (int y = 0; y < clippedData.height; ++y)
+            for (int x = 0; x < clippedData.width * clippedData.pixelStride; ++x)
+                clippedData.getLinePointer (y)[x] = data.getPixelPointer (padding, y + padding)[x];
+    }
+
+    // A straightforward two-dimensional gaussian blur, which treats the pixels outside the area as transparent
+    static void applyReferenceGaussianBlur (Image& image, Rectangle<int> area, float standardDeviation)
+    {
+        auto radius = (int) std::ceil (standardDeviation * 3.0f);
+        ImageConvolutionKernel kernel (radius * 2 + 1);
+
+        for (int y = 0; y < kernel.getKernelSize(); ++y)
+            for (int x = 0; x < kernel.getKernelSize(); ++x)
+                kernel.setKernelValue (x, y, (float) std::exp (-((x - radius) * (x - radius) + (y - radius) * (y - radius))
+                                                                 / (2.0 * standardDeviation * standardDeviation)));
+
+        kernel.setOverallSum (1.0f);
+
+        auto clipped = image.getClippedImage (area);
+        applyReferenceKernel (clipped, clipped.createCopy(), clipped.getBounds(), kernel);
+    }
+
+    static void applyReferenceKernel (Image& dest, const Image& source, Rectangle<int> area, const ImageConvolutionKernel& kernel)
+    {
+        Image::BitmapData destData (dest, Image::BitmapData::readWrite);
+        Image::BitmapData srcData (source, Image::BitmapData::readOnly);
+        auto size = kernel.getKernelSize();
+
+        for (int y = area.getY(); y < area.getBottom(); ++y)
+        {
+            for (int x = area.getX(); x < area.getRight(); ++x)
+            {
+                for (int channel = 0; channel < srcData.pixelStride; ++channel)
+                {
+                    double total = 0;
+
+                    for (int ky = 0; ky < size; ++ky)
+                    {
+                        for (int kx = 0; kx < size; ++kx)
+                        {
+                            auto sx = x + kx - size / 2, sy = y + ky - size / 2;
+
+                            if (isPositiveAndBelow (sx, srcData.width) && isPositiveAndBelow (sy, srcData.height))
+                                total += kernel.getKernelValue (kx, ky) * srcData.getPixelPointer (sx, sy)[channel];
+                        }
+                    }
+
+                    destData.getPixelPointer (x, y)[channel] = (uint8) jlimit (0, 255, roundToInt (total));
+                }
+            }
+        }
+    }
+};
+
+static ImageBlurTests imageBlurTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Fast blurring functions for images.
+
+    These work on SingleChannel, RGB and ARGB images, blurring each channel separately
+    (which is correct for ARGB images because their pixels are premultiplied). The
+    pixels outside the area being blurred are treated as being transparent, and are
+    left unchanged.
+
+    The blurs are done as a horizontal pass followed by a vertical one, and large
+    images are split up between the same background threads that the
+    LowLevelGraphicsTiledSoftwareRenderer uses.
+
+    @see ImageConvolutionKernel, DropShadow, GlowEffect
+
+    @tags{Graphics}
+*/
+class JUCE_API  ImageBlur
+{
+public:
+    //==============================================================================
+    /** Replaces each pixel with the average of the pixels within a square around it.
+
+        The square is (radius * 2 + 1) pixels wide, and the time this takes doesn't depend
+        on the radius. Repeating the blur a few times gives a smoother result that gets
+        closer to a gaussian blur with each pass.
+    */
+    static void applyBoxBlur (Image& image, Rectangle<int> area, int radius, int numPasses = 1);
+
+    /** Applies a gaussian blur, by convolving the image with a gaussian kernel.
+
+        The kernel extends to three times the standard deviation each side of the pixel,
+        so this takes longer for larger blurs.
+
+        @see applyFastGaussianBlur
+    */
+    static void applyGaussianBlur (Image& image, Rectangle<int> area, float standardDeviation);
+
+    /** Applies a close approximation to a gaussian blur, using three box blurs whose
+        sizes are chosen to give the same overall standard deviation.
+
+        The time this takes doesn't depend on the size of the blur.
+
+        @see applyGaussianBlur
+    */
+    static void applyFastGaussianBlur (Image& image, Rectangle<int> area, float standardDeviation);
+
+private:
+    //==============================================================================
+    friend class ImageConvolutionKernel;
+
+    // Convolves an area of the source image with a horizontal and then a vertical kernel,
+    // writing the result to the same area of the destination, which must be the same size
+    // and format as the source (but can be the same image). The offsets are the positions
+    // of each kernel's first value relative to the pixel being calculated.
+    static void applySeparableKernel (const Image& source, Image& destination, Rectangle<int> area,
+                                      const float* rowKernel, int rowKernelSize, int rowKernelOffset,
+                                      const float* columnKernel, int columnKernelSize, int columnKernelOffset);
+
+    ImageBlur() = delete;
+};
+
+} // namespace juce
@@ -30,25 +30,33 @@ struct ImageCache::Pimpl     : private Timer,
                                private DeletedAtShutdown
 {
     Pimpl() {}
-    ~Pimpl() override { clearSingletonInstance(); }
 
-    JUCE_DECLARE_SINGLETON_SINGLETHREADED_MINIMAL (ImageCache::Pimpl)
-
-    Image getFromHashCode (const int64 hashCode) noexcept
+    ~Pimpl() override
     {
-        const ScopedLock sl (lock);
+        // this waits for any images that are still being decoded, and cancels the ones that haven't started
+        decodingThreads.reset();
 
-        for (auto& item : images)
         {
-            if (item.hashCode == hashCode)
-            {
-                item.lastUseTime = Time::getApproximateMillisecondCounter();
-                return item.image;
-            }
+            // wake up anything that's still waiting for an image that won't be loaded now
+            const ScopedLock sl (lock);
+
+            for (auto& p : pendingLoads)
+                p.second->finished.signal();
+
+            pendingLoads.clear();
         }
 
-        return {};
-     }
+        clearSingletonInstance();
+    }
+
+    // The cache can be used from any thread, so creating it has to be thread-safe too
+    JUCE_DECLARE_SINGLETON (ImageCache::Pimpl, false)
+
+    Image getFromHashCode (const int64 hashCode) noexcept
+    {
+        const ScopedLock sl (lock);
+        return findImage (hashCode);
+    }
 
     void addImageToCache (const Image& image, const int64 hashCode)
     {
@@ -58,32 +66,110 @@ struct ImageCache::Pimpl     : private Timer,
                 startTimer (2000);
 
             const ScopedLock sl (lock);
-            images.add ({ image, hashCode, Time::getApproximateMillisecondCounter() });
+            addImage (image, hashCode);
+        }
+    }
+
+    //==============================================================================
+    Image getOrLoad (const int64 hashCode, std::function<Image()> loadImage)
+    {
+        std::shared_ptr<PendingLoad> pending;
+        bool isAlreadyLoading = false;
+
+        {
+            const ScopedLock sl (lock);
+
+            auto image = findImage (hashCode);
+
+            if (image.isValid())
+                return image;
+
+            auto& pendingLoad = pendingLoads[hashCode];
+            isAlreadyLoading = (pendingLoad != nullptr);
+
+            if (! isAlreadyLoading)
+                pendingLoad = std::make_shared<PendingLoad>();
+
+            pending = pendingLoad;
+        }
+
+        // Another thread is already loading this image, so just wait for it to finish
+        if (isAlreadyLoading)
+        {
+            pending->finished.wait();
+            return pending->image;
+        }
+
+        auto image = loadImage();
+        finishLoading (hashCode, *pending, image);
+        return image;
+    }
+
+    Image loadAsync (const int64 hashCode, std::function<Image()> loadImage,
+                     std::function<void (const Image&)> callback, const Image& placeholder)
+    {
+        const ScopedLock sl (lock);
+
+        auto image = findImage (hashCode);
+
+        if (image.isValid())
+            return image;
+
+        auto& pendingLoad = pendingLoads[hashCode];
+
+        if (pendingLoad == nullptr)
+        {
+            pendingLoad = std::make_shared<PendingLoad>();
+
+            if (decodingThreads == nullptr)
+                decodingThreads.reset (new ThreadPool (jlimit (1, 2, SystemStats::getNumCpus() - 1)));
+
+            auto pending = pendingLoad;
+
+            decodingThreads->addJob ([this, hashCode, pending, loadImage]
+            {
+                finishLoading (hashCode, *pending, loadImage());
+            });
         }
+
+        if (callback != nullptr)
+            pendingLoad->callbacks.push_back (std::move (callback));
+
+        return placeholder;
     }
 
+    //==============================================================================
     void timerCallback() override
     {
         auto now = Time::getApproximateMillisecondCounter();
 
         const ScopedLock sl (lock);
 
-        for (int i = images.size(); --i >= 0;)
+        for (auto i = images.begin(); i != images.end();)
         {
-            auto& item = images.getReference(i);
+            auto& item = i->second;
 
             if (item.image.getReferenceCount() <= 1)
             {
                 if (now > item.lastUseTime + cacheTimeout || now < item.lastUseTime - 1000)
-                    images.remove (i);
+                {
+                    totalBytes -= item.numBytes;
+                    i = images.erase (i);
+                    continue;
+                }
             }
             else
             {
                 item.lastUseTime = now; // multiply-referenced, so this image is still in use.
             }
+
+            ++i;
         }
 
-        if (images.isEmpty())
+        // images that were in use when they were added may have been released since then
+        releaseImagesOverBudget();
+
+        if (images.empty())
             stopTimer();
     }
 
@@ -91,21 +177,152 @@ struct ImageCache::Pimpl     : private Timer,
     {
         const ScopedLock sl (lock);
 
-        for (int i = images.size(); --i >= 0;)
-            if (images.getReference(i).image.getReferenceCount() <= 1)
-                images.remove (i);
+        for (auto i = images.begin(); i != images.end();)
+        {
+            if (i->second.image.getReferenceCount() <= 1)
+            {
+                totalBytes -= i->second.numBytes;
+                i = images.erase (i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    void setMaximumCacheSize (size_t newMaxNumBytes)
+    {
+        const ScopedLock sl (lock);
+        maxNumBytes = newMaxNumBytes;
+        releaseImagesOverBudget();
+    }
+
+    ImageCache::Statistics getStatistics() const
+    {
+        const ScopedLock sl (lock);
+
+        ImageCache::Statistics stats;
+        stats.hits = hits;
+        stats.misses = misses;
+        stats.numImages = (int) images.size();
+        stats.numBytes = totalBytes;
+        return stats;
     }
 
+    //==============================================================================
     struct Item
     {
         Image image;
-        int64 hashCode;
         uint32 lastUseTime;
+        uint64 lastUseOrder;
+        size_t numBytes;
     };
 
-    Array<Item> images;
+    struct PendingLoad
+    {
+        WaitableEvent finished { true };
+        Image image;
+        std::vector<std::function<void (const Image&)>> callbacks;
+    };
+
+    std::map<int64, Item> images;
+    std::map<int64, std::shared_ptr<PendingLoad>> pendingLoads;
+    std::unique_ptr<ThreadPool> decodingThreads;
     CriticalSection lock;
     unsigned int cacheTimeout = 5000;
+    size_t maxNumBytes = 0, totalBytes = 0;
+    uint64 useCounter = 0;
+    int64 hits = 0, misses = 0;
+
+private:
+    Image findImage (const int64 hashCode)
+    {
+        auto found = images.find (hashCode);
+
+        if (found == images.end())
+        {
+            ++misses;
+            return {};
+        }
+
+        ++hits;
+        found->second.lastUseTime = Time::getApproximateMillisecondCounter();
+        found->second.lastUseOrder = ++useCounter;
+        return found->second.image;
+    }
+
+    void addImage (const Image& image, const int64 hashCode)
+    {
+        auto numBytes = getSizeInBytes (image);
+        auto& item = images[hashCode];
+
+        totalBytes = totalBytes - item.numBytes + numBytes;
+        item = { image, Time::getApproximateMillisecondCounter(), ++useCounter, numBytes };
+
+        releaseImagesOverBudget();
+    }
+
+    void finishLoading (const int64 hashCode, PendingLoad& pending, const Image& image)
+    {
+        std::vector<std::function<void (const Image&)>> callbacks;
+
+        {
+            const ScopedLock sl (lock);
+
+            if (image.isValid())
+            {
+                if (! isTimerRunning())
+                    startTimer (2000);
+
+                addImage (image, hashCode);
+            }
+
+            pending.image = image;
+            std::swap (callbacks, pending.callbacks);
+            pendingLoads.erase (hashCode);
+        }
+
+        pending.finished.signal();
+
+        if (! callbacks.empty())
+        {
+            MessageManager::callAsync ([callbacks, image]
+            {
+                for (auto& callback : callbacks)
+                    callback (image);
+            });
+        }
+    }
+
+    void releaseImagesOverBudget()
+    {
+        if (maxNumBytes == 0)
+            return;
+
+        while (totalBytes > maxNumBytes)
+        {
+            auto oldest = images.end();
+
+            for (auto i = images.begin(); i != images.end(); ++i)
+                if (i->second.image.getReferenceCount() <= 1
+                     && (oldest == images.end() || i->second.lastUseOrder < oldest->second.lastUseOrder))
+                    oldest = i;
+
+            // if everything that's left is still being used, there's nothing more that can be released
+            if (oldest == images.end())
+                break;
+
+            totalBytes -= oldest->second.numBytes;
+            images.erase (oldest);
+        }
+    }
+
+    static size_t getSizeInBytes (const Image& image)
+    {
+        auto bytesPerPixel = image.getFormat() == Image::ARGB ? 4 : (image.getFormat() == Image::RGB ? 3 : 1);
+        return (size_t) image.getWidth() * (size_t) image.getHeight() * (size_t) bytesPerPixel;
+    }
 
     JUCE_DECLARE_NON_COPYABLE (Pimpl)
 };
@@ -129,30 +346,28 @@ void ImageCache::addImageToCache (const Image& image, const int64 hashCode)
 
 Image ImageCache::getFromFile (const File& file)
 {
-    auto hashCode = file.hashCode64();
-    auto image = getFromHashCode (hashCode);
+    return Pimpl::getInstance()->getOrLoad (file.hashCode64(), [file] { return ImageFileFormat::loadFrom (file); });
+}
 
-    if (image.isNull())
-    {
-        image = ImageFileFormat::loadFrom (file);
-        addImageToCache (image, hashCode);
-    }
+Image ImageCache::getFromFileAsync (const File& file, std::function<void (const Image&)> callback, const Image& placeholder)
+{
+    return Pimpl::getInstance()->loadAsync (file.hashCode64(), [file] { return ImageFileFormat::loadFrom (file); },
+                                            std::move (callback), placeholder);
+}
 
-    return image;
+Image ImageCache::getFromFileAsync (const File& file, std::function<void (const Image&)> callback)
+{
+    return getFromFileAsync (file, std::move (callback), {});
 }
 
 Image ImageCache::getFromMemory (const void* imageData, const int dataSize)
 {
     auto hashCode = (int64) (pointer_sized_int) imageData;
-    auto image = getFromHashCode (hashCode);
 
-    if (image.isNull())
+    return Pimpl::getInstance()->getOrLoad (hashCode, [imageData, dataSize]
     {
-        image = ImageFileFormat::loadFrom (imageData, (size_t) dataSize);
-        addImageToCache (image, hashCode);
-    }
-
-    return image;
+        return ImageFileFormat::loadFrom (imageData, (size_t) dataSize);
+    });
 }
 
 void ImageCache::setCacheTimeout (const int millisecs)
@@ -161,9 +376,212 @@ void ImageCache::setCacheTimeout (const int millisecs)
     Pimpl::getInstance()->cacheTimeout = (unsigned int) millisecs;
 }
 
+void ImageCache::setMaximumCacheSize (size_t maxNumBytes)
+{
+    Pimpl::getInstance()->setMaximumCacheSize (maxNumBytes);
+}
+
 void ImageCache::releaseUnusedImages()
 {
     Pimpl::getInstance()->releaseUnusedImages();
 }
 
+ImageCache::Statistics ImageCache::getStatistics()
+{
+    if (auto* pimpl = Pimpl::getInstanceWithoutCreating())
+        return pimpl->getStatistics();
+
+    return {};
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ImageCacheTests  : public UnitTest
+{
+public:
+    ImageCacheTests()
+        : UnitTest ("ImageCache", UnitTestCategories::graphics)
+    {}
+
+    void runTest() override
+    {
+        TemporaryFile tempFolder;
+        auto folder = tempFolder.getFile();
+        folder.createDirectory();
+
+        Array<File> files;
+
+        for (int i = 0; i < 8; ++i)
+            files.add (writeTestImage (folder.getChildFile ("image" + String (i) + ".png"), 300 + i, 200));
+
+        ImageCache::releaseUnusedImages();
+
+        beginTest ("Images are shared");
+        {
+            auto before = ImageCache::getStatistics();
+
+            auto image = ImageCache::getFromFile (files[0]);
+            expect (image.isValid());
+            expect (ImageCache::getFromFile (files[0]) == image);
+
+            auto stats = ImageCache::getStatistics();
+            expect (stats.hits == before.hits + 1);
+            expect (stats.misses == before.misses + 1);
+            expectEquals (stats.numImages, before.numImages + 1);
+            expect (stats.numBytes == before.numBytes + (size_t) (image.getWidth() * image.getHeight() * 4));
+
+            image = {};
+            ImageCache::releaseUnusedImages();
+            expectEquals (ImageCache::getStatistics().numImages, before.numImages);
+        }
+
+        beginTest ("Memory budget");
+        {
+            const size_t imageSize = 100 * 100 * 4;
+
+            for (int i = 0; i < 5; ++i)
+                ImageCache::addImageToCache (Image (Image::ARGB, 100, 100, false), 1000 + i);
+
+            auto inUse = ImageCache::getFromHashCode (1000);
+            expect (inUse.isValid());
+
+            // this keeps the image in use, and the most recently-used ones
+            ImageCache::setMaximumCacheSize (imageSize * 3);
+
+            auto stats = ImageCache::getStatistics();
+            expectEquals (stats.numImages, 3);
+            expect (stats.numBytes == imageSize * 3);
+            expect (ImageCache::getFromHashCode (1000) == inUse);
+            expect (ImageCache::getFromHashCode (1001).isNull());
+            expect (ImageCache::getFromHashCode (1002).isNull());
+            expect (ImageCache::getFromHashCode (1003).isValid());
+            expect (ImageCache::getFromHashCode (1004).isValid());
+
+            // adding another image pushes out the least recently used one that isn't in use
+            ImageCache::addImageToCache (Image (Image::ARGB, 100, 100, false), 1005);
+            expect (ImageCache::getFromHashCode (1003).isNull());
+            expect (ImageCache::getFromHashCode (1000).isValid());
+
+            ImageCache::setMaximumCacheSize (0);
+            inUse = {};
+            ImageCache::releaseUnusedImages();
+            expectEquals (ImageCache::getStatistics().numImages, 0);
+        }
+
+        beginTest ("Asynchronous loading");
+        {
+            Image placeholder (Image::RGB, 1, 1, true);
+            Array<Image> loadedImages;
+            int numPlaceholders = 0;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                auto image = ImageCache::getFromFileAsync (files[1], [&loadedImages] (const Image& im) { loadedImages.add (im); },
+                                                           placeholder);
+
+                // (the background thread might have already finished, in which case the image is returned)
+                if (image == placeholder)
+                    ++numPlaceholders;
+                else
+                    expect (i > 0 && image.isValid());
+            }
+
+            expect (numPlaceholders > 0);
+
+            // this waits for the background thread, rather than loading the file again
+            auto image = ImageCache::getFromFile (files[1]);
+            expect (image.isValid());
+            expectEquals (image.getWidth(), 301);
+
+            // once it's been loaded, the cached image is returned straight away
+            expect (ImageCache::getFromFileAsync (files[1], [] (const Image&) {}, placeholder) == image);
+
+           #if JUCE_MODAL_LOOPS_PERMITTED
+            if (MessageManager::getInstance()->isThisTheMessageThread())
+            {
+                for (int i = 0; i < 100 && loadedImages.size() < numPlaceholders; ++i)
+                    MessageManager::getInstance()->runDispatchLoopUntil (10);
+
+                expectEquals (loadedImages.size(), numPlaceholders);
+
+                for (auto& im : loadedImages)
+                    expect (im == image);
+            }
+           #endif
+
+            auto missing = ImageCache::getFromFile (folder.getChildFile ("missing.png"));
+            expect (missing.isNull());
+
+            image = {};
+            loadedImages.clear();
+            ImageCache::releaseUnusedImages();
+        }
+
+        beginTest ("Concurrent loading");
+        {
+            ThreadPool pool (4);
+            Image results[4];
+
+            for (auto& result : results)
+            {
+                auto* r = &result;
+                pool.addJob ([r, &files] { *r = ImageCache::getFromFile (files[2]); });
+            }
+
+            while (pool.getNumJobs() > 0)
+                Thread::sleep (5);
+
+            expect (results[0].isValid());
+
+            for (auto& result : results)
+                expect (result == results[0]);
+
+            for (auto& result : results)
+                result = {};
+
+            ImageCache::releaseUnusedImages();
+        }
+
+        beginTest ("Loading every image in the background");
+        {
+            for (auto& f : files)
+                ImageCache::getFromFileAsync (f, nullptr);
+
+            for (int i = 0; i < files.size(); ++i)
+            {
+                auto image = ImageCache::getFromFile (files[i]);
+                expect (image.isValid());
+                expectEquals (image.getWidth(), 300 + i);
+                expect (ImageCache::getFromFile (files[i]) == image);
+            }
+
+            ImageCache::releaseUnusedImages();
+            expectEquals (ImageCache::getStatistics().numImages, 0);
+        }
+
+        folder.deleteRecursively();
+    }
+
+    static File writeTestImage (const File& file, int width, int height)
+    {
+        Image image (Image::ARGB, width, height, true);
+
+        {
+            Graphics g (image);
+            g.setGradientFill (ColourGradient (Colours::red, 0, 0, Colours::blue.withAlpha (0.5f), (float) width, (float) height, true));
+            g.fillEllipse (image.getBounds().toFloat());
+        }
+
+        FileOutputStream out (file);
+        PNGImageFormat().writeImageToStream (image, out);
+        return file;
+    }
+};
+
+static ImageCacheTests imageCacheTests;
+
+#endif
+
 } // namespace juce
@@ -37,7 +37,12 @@ namespace juce
     Another advantage is that after images are released, they will be kept in
     memory for a few seconds before it is actually deleted, so if you're repeatedly
     loading/deleting the same image, it'll reduce the chances of having to reload it
-    each time.
+    each time. You can also give the cache a memory budget, in which case the
+    least-recently used images that aren't being referenced elsewhere are released
+    as soon as the budget is exceeded.
+
+    Files can also be decoded on a background thread with getFromFileAsync(), and
+    if several threads ask for the same file at once, it'll only be loaded once.
 
     @see Image, ImageFileFormat
 
@@ -63,6 +68,35 @@ public:
     */
     static Image getFromFile (const File& file);
 
+    /** Loads an image from a file on a background thread, (or just returns the image if
+        it's already cached).
+
+        If the cache already contains an image that was loaded from this file, that image
+        is returned and the callback won't be used. Otherwise, this returns the placeholder
+        image straight away, and the file is decoded on a background thread. When that's
+        finished, the image is added to the cache and the callback is called on the message
+        thread with the new image (which will be invalid if the file couldn't be loaded).
+
+        If the same file is requested again before it has finished loading, it won't be
+        loaded a second time - all the callbacks will be given the same image, and calls to
+        getFromFile() for it will wait for the background thread rather than loading it again.
+
+        @param file         the file to try to load
+        @param callback     a function to call on the message thread when the image has loaded
+        @param placeholder  the image to return if the file hasn't already been loaded
+        @see getFromFile
+    */
+    static Image getFromFileAsync (const File& file,
+                                   std::function<void (const Image&)> callback,
+                                   const Image& placeholder);
+
+    /** Loads an image from a file on a background thread, returning an invalid image
+        if it isn't already in the cache.
+        @see getFromFileAsync
+    */
+    static Image getFromFileAsync (const File& file,
+                                   std::function<void (const Image&)> callback);
+
     /** Loads an image from an in-memory image file, (or just returns the image if it's already cached).
 
         If the cache already contains an image that was loaded from this block of memory,
@@ -108,11 +142,36 @@ public:
     */
     static void setCacheTimeout (int millisecs);
 
+    /** Sets the maximum amount of memory that the cache's images should use.
+
+        When the images in the cache add up to more than this, the least-recently used
+        ones that aren't being referenced by any other Image objects are released.
+        Images that are still in use can't be released, so the cache may hold more than
+        this if they're all being used. A size of 0 (the default) means that there's no
+        limit, and images are only released when the cache timeout expires.
+
+        @see setCacheTimeout, getStatistics
+    */
+    static void setMaximumCacheSize (size_t maxNumBytes);
+
     /** Releases any images in the cache that aren't being referenced by active
         Image objects.
     */
     static void releaseUnusedImages();
 
+    //==============================================================================
+    /** Some statistics about how the cache is being used. */
+    struct Statistics
+    {
+        int64 hits = 0;         /**< The number of times an image was found in the cache. */
+        int64 misses = 0;       /**< The number of times an image wasn't found in the cache. */
+        int numImages = 0;      /**< The number of images currently in the cache. */
+        size_t numBytes = 0;    /**< The approximate amount of memory used by the images in the cache. */
+    };
+
+    /** Returns some statistics about the cache's current state. */
+    static Statistics getStatistics();
+
 private:
     //==============================================================================
     struct Pimpl;
@@ -101,6 +101,45 @@ void ImageConvolutionKernel::createGaussianBlur (const float radius)
     setOverallSum (1.0f);
 }
 
+bool ImageConvolutionKernel::getSeparableFactors (float* rowValues, float* columnValues) const
+{
+    int pivotX = 0, pivotY = 0;
+    float largest = 0;
+
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            auto value = std::abs (values[x + y * size]);
+
+            if (value > largest)
+            {
+                largest = value;
+                pivotX = x;
+                pivotY = y;
+            }
+        }
+    }
+
+    if (largest <= 0.0f)
+        return false;
+
+    auto pivot = values[pivotX + pivotY * size];
+
+    for (int i = 0; i < size; ++i)
+    {
+        rowValues[i] = values[i + pivotY * size];
+        columnValues[i] = values[pivotX + i * size] / pivot;
+    }
+
+    for (int y = 0; y < size; ++y)
+        for (int x = 0; x < size; ++x)
+            if (std::abs (values[x + y * size] - rowValues[x] * columnValues[y]) > largest * 1.0e-5f)
+                return false;
+
+    return true;
+}
+
 //==============================================================================
 void ImageConvolutionKernel::applyToImage (Image& destImage,
                                            const Image& sourceImage,
@@ -126,6 +165,23 @@ void ImageConvolutionKernel::applyToImage (Image& destImage,
     if (area.isEmpty())
         return;
 
+    HeapBlock<float> rowValues ((size_t) size), columnValues ((size_t) size);
+
+    if (getSeparableFactors (rowValues, columnValues))
+    {
+        ImageBlur::applySeparableKernel (sourceImage, destImage, area,
+                                         rowValues, size, -(size >> 1),
+                                         columnValues, size, -(size >> 1));
+        return;
+    }
+
+    // The pixels are written as we go along, so filtering an image in-place needs a copy to read from
+    if (sourceImage == destImage)
+    {
+        applyToImage (destImage, sourceImage.createCopy(), area);
+        return;
+    }
+
     auto right = area.getRight();
     auto bottom = area.getBottom();
 
@@ -184,10 +240,10 @@ void ImageConvolutionKernel::applyToImage (Image& destImage,
                     }
                 }
 
-                *dest++ = (uint8) jmin (0xff, roundToInt (c1));
-                *dest++ = (uint8) jmin (0xff, roundToInt (c2));
-                *dest++ = (uint8) jmin (0xff, roundToInt (c3));
-                *dest++ = (uint8) jmin (0xff, roundToInt (c4));
+                *dest++ = (uint8) jlimit (0, 0xff, roundToInt (c1));
+                *dest++ = (uint8) jlimit (0, 0xff, roundToInt (c2));
+                *dest++ = (uint8) jlimit (0, 0xff, roundToInt (c3));
+                *dest++ = (uint8) jlimit (0, 0xff, roundToInt (c4));
             }
         }
     }
@@ -238,9 +294,9 @@ void ImageConvolutionKernel::applyToImage (Image& destImage,
                     }
                 }
 
-                *dest++ = (uint8) roundToInt (c1);
-                *dest++ = (uint8) roundToInt (c2);
-                *dest++ = (uint8) roundToInt (c3);
+                *dest++ = (uint8) jlimit (0, 0xff, roundToInt (c1));
+                *dest++ = (uint8) jlimit (0, 0xff, roundToInt (c2));
+                *dest++ = (uint8) jlimit (0, 0xff, roundToInt (c3));
             }
         }
     }
@@ -279,7 +335,7 @@ void ImageConvolutionKernel::applyToImage (Image& destImage,
                             }
                             else
                             {
-                                src += 3;
+                                ++src;
                             }
 
                             ++sx;
@@ -287,7 +343,7 @@ void ImageConvolutionKernel::applyToImage (Image& destImage,
                     }
                 }
 
-                *dest++ = (uint8) roundToInt (c1);
+                *dest++ = (uint8) jlimit (0, 0xff, roundToInt (c1));
             }
         }
     }
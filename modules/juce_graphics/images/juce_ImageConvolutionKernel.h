@@ -96,6 +96,12 @@ public:
                                 the destination, but if different, it must be exactly the same
                                 size and format.
         @param destinationArea  the region of the image to apply the filter to
+
+        If the kernel is separable (i.e. each value is the product of a row value and a column
+        value, as with a gaussian blur), this will be done with a much faster horizontal
+        pass followed by a vertical one.
+
+        @see ImageBlur
     */
     void applyToImage (Image& destImage,
                        const Image& sourceImage,
@@ -106,6 +112,8 @@ private:
     HeapBlock<float> values;
     const int size;
 
+    bool getSeparableFactors (float* rowValues, float* columnValues) const;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ImageConvolutionKernel)
 };
 
@@ -108,4 +108,230 @@ Image ImageFileFormat::loadFrom (const void* rawData, const size_t numBytes)
     return Image();
 }
 
+Array<Image> ImageFileFormat::loadFromFiles (const Array<File>& files)
+{
+    Array<Image> images;
+    images.resize (files.size());
+
+    SoftwareRenderingThreadPool::performJobs ((size_t) files.size(), [&] (size_t i)
+    {
+        images.getReference ((int) i) = loadFrom (files.getReference ((int) i));
+    });
+
+    return images;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ImageFileFormatTests  : public UnitTest
+{
+public:
+    ImageFileFormatTests()
+        : UnitTest ("ImageFileFormat", UnitTestCategories::graphics)
+    {}
+
+    void runTest() override
+    {
+        auto r = getRandom();
+
+        beginTest ("Pixel conversion");
+        {
+            using namespace RenderingHelpers::PixelConversion;
+
+            for (int width = 1; width < 40; ++width)
+            {
+                HeapBlock<uint8> src ((size_t) width * 4);
+
+                for (int i = 0; i < width * 4; ++i)
+                    src[i] = (uint8) r.nextInt (256);
+
+                // make sure that the special cases of transparent and opaque pixels get tested
+                for (int i = 0; i < width; i += 3)
+                    src[i * 4 + 3] = (uint8) (r.nextBool() ? 0 : 0xff);
+
+                HeapBlock<PixelARGB> argb ((size_t) width), expectedARGB ((size_t) width);
+                HeapBlock<PixelRGB> rgb ((size_t) width), expectedRGB ((size_t) width);
+
+                convertRGBAToARGB (argb, (int) sizeof (PixelARGB), src, width);
+
+                for (int i = 0; i < width; ++i)
+                {
+                    expectedARGB[i].setARGB (src[i * 4 + 3], src[i * 4], src[i * 4 + 1], src[i * 4 + 2]);
+                    expectedARGB[i].premultiply();
+                }
+
+                expect (memcmp (argb, expectedARGB, (size_t) width * sizeof (PixelARGB)) == 0);
+
+                for (int srcStride = 3; srcStride <= 4; ++srcStride)
+                {
+                    convertRGBToARGB (argb, (int) sizeof (PixelARGB), src, srcStride, width);
+                    convertRGBToRGB (rgb, (int) sizeof (PixelRGB), src, srcStride, width);
+
+                    for (int i = 0; i < width; ++i)
+                    {
+                        auto* s = src + i * srcStride;
+                        expectedARGB[i].setARGB (0xff, s[0], s[1], s[2]);
+                        expectedRGB[i].setARGB (0xff, s[0], s[1], s[2]);
+                    }
+
+                    expect (memcmp (argb, expectedARGB, (size_t) width * sizeof (PixelARGB)) == 0);
+                    expect (memcmp (rgb, expectedRGB, (size_t) width * sizeof (PixelRGB)) == 0);
+                }
+            }
+        }
+
+        beginTest ("PNG round trip");
+        {
+            for (auto format : { Image::ARGB, Image::RGB })
+            {
+                auto image = createRandomImage (format, 67, 45, r);
+                PNGImageFormat png;
+                auto decoded = encodeAndDecode (png, image);
+
+                // the PNG holds unpremultiplied colours, so those will have been rounded
+                if (format == Image::ARGB)
+                {
+                    const Image::BitmapData data (image, Image::BitmapData::readWrite);
+
+                    for (int y = 0; y < image.getHeight(); ++y)
+                    {
+                        for (int x = 0; x < image.getWidth(); ++x)
+                        {
+                            auto* p = (PixelARGB*) data.getPixelPointer (x, y);
+                            p->unpremultiply();
+                            p->premultiply();
+                        }
+                    }
+                }
+
+                expect (areIdentical (decoded, image));
+            }
+        }
+
+        beginTest ("JPEG channel order");
+        {
+            const Colour colour (200, 120, 40);
+            Image image (Image::RGB, 32, 32, false);
+            image.clear (image.getBounds(), colour);
+
+            JPEGImageFormat jpeg;
+            jpeg.setQuality (1.0f);
+            auto decoded = encodeAndDecode (jpeg, image);
+
+            expect (decoded.getBounds() == image.getBounds());
+
+            auto c = decoded.getPixelAt (13, 21);
+            expect (std::abs (c.getRed()   - colour.getRed())   <= 4);
+            expect (std::abs (c.getGreen() - colour.getGreen()) <= 4);
+            expect (std::abs (c.getBlue()  - colour.getBlue())  <= 4);
+        }
+
+        TemporaryFile tempFolder;
+        auto folder = tempFolder.getFile();
+        folder.createDirectory();
+
+        beginTest ("Batch loading");
+        {
+            Array<File> files;
+
+            for (int i = 0; i < 6; ++i)
+                files.add (writeImage (folder.getChildFile ("image" + String (i) + (i % 2 == 0 ? ".png" : ".jpg")),
+                                       createRandomImage (i % 3 == 0 ? Image::RGB : Image::ARGB, 50 + i, 40, r)));
+
+            files.add (folder.getChildFile ("missing.png"));
+
+            auto images = ImageFileFormat::loadFromFiles (files);
+            expectEquals (images.size(), files.size());
+
+            for (int i = 0; i < files.size(); ++i)
+                expect (areIdentical (images[i], ImageFileFormat::loadFrom (files[i])));
+
+            expect (images.getLast().isNull());
+            expect (ImageFileFormat::loadFromFiles ({}).isEmpty());
+        }
+
+        beginTest ("Batch loading large images");
+        {
+            Array<File> files;
+
+            for (int i = 0; i < 16; ++i)
+                files.add (writeImage (folder.getChildFile ("large" + String (i) + (i % 2 == 0 ? ".png" : ".jpg")),
+                                       createRandomImage (Image::ARGB, 512, 512, r)));
+
+            auto images = ImageFileFormat::loadFromFiles (files);
+            expectEquals (images.size(), files.size());
+
+            for (int i = 0; i < files.size(); ++i)
+            {
+                expect (images[i].getBounds() == Rectangle<int> (512, 512));
+                expect (areIdentical (images[i], ImageFileFormat::loadFrom (files[i])));
+            }
+        }
+
+        folder.deleteRecursively();
+    }
+
+private:
+    static Image createRandomImage (Image::PixelFormat format, int width, int height, Random& r)
+    {
+        Image image (format, width, height, false);
+        Image::BitmapData data (image, Image::BitmapData::writeOnly);
+
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                // smooth gradients with some noise, so that the images compress like real ones
+                auto alpha = (uint8) jlimit (0, 255, 300 - (x + y) * 2 + r.nextInt (20));
+                data.setPixelColour (x, y, Colour ((uint8) (x * 3), (uint8) (y * 5), (uint8) (r.nextInt (32) + 100), alpha));
+            }
+        }
+
+        return image;
+    }
+
+    static Image encodeAndDecode (ImageFileFormat& format, const Image& image)
+    {
+        MemoryOutputStream out;
+        format.writeImageToStream (image, out);
+
+        MemoryInputStream in (out.getData(), out.getDataSize(), false);
+        return format.decodeImage (in);
+    }
+
+    static File writeImage (const File& file, const Image& image)
+    {
+        FileOutputStream out (file);
+
+        if (auto* format = ImageFileFormat::findImageFormatForFileExtension (file))
+            format->writeImageToStream (image, out);
+
+        return file;
+    }
+
+    static bool areIdentical (const Image& a, const Image& b)
+    {
+        if (a.isNull() || b.isNull())
+            return a.isNull() && b.isNull();
+
+        if (a.getBounds() != b.getBounds() || a.getFormat() != b.getFormat())
+            return false;
+
+        const Image::BitmapData dataA (a, Image::BitmapData::readOnly);
+        const Image::BitmapData dataB (b, Image::BitmapData::readOnly);
+
+        for (int y = 0; y < a.getHeight(); ++y)
+            if (memcmp (dataA.getLinePointer (y), dataB.getLinePointer (y), (size_t) (a.getWidth() * dataA.pixelStride)) != 0)
+                return false;
+
+        return true;
+    }
+};
+
+static ImageFileFormatTests imageFileFormatTests;
+
+#endif
+
 } // namespace juce
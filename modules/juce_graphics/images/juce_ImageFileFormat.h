@@ -137,6 +137,18 @@ public:
     */
     static Image loadFrom (const void* rawData,
                            size_t numBytesOfData);
+
+    /** Tries to load a set of image files, decoding them in parallel.
+
+        The files are decoded on the threads that LowLevelGraphicsTiledSoftwareRenderer
+        uses, as well as the calling thread, and this blocks until they've all been loaded.
+        It's a handy way to get a batch of images ready while an app is starting up.
+
+        @returns        an array containing the image for each file, in the same order as
+                        the files. Any that couldn't be loaded will be invalid images.
+        @see loadFrom
+    */
+    static Array<Image> loadFromFiles (const Array<File>& files);
 };
 
 //==============================================================================
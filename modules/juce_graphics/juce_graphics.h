@@ -86,6 +86,16 @@
  #define JUCE_DISABLE_COREGRAPHICS_FONT_SMOOTHING 0
 #endif
 
+/** Config: JUCE_USE_SIMD_PIXEL_BLENDING
+
+    Enables SSE2, AVX2 or NEON versions of the software renderer's pixel blending loops,
+    depending on which instruction sets the compiler is targeting. The results are identical
+    to the plain C++ versions, so you'd only want to turn this off for debugging purposes.
+*/
+#ifndef JUCE_USE_SIMD_PIXEL_BLENDING
+ #define JUCE_USE_SIMD_PIXEL_BLENDING 1
+#endif
+
 #ifndef JUCE_INCLUDE_PNGLIB_CODE
  #define JUCE_INCLUDE_PNGLIB_CODE 1
 #endif
@@ -129,6 +139,7 @@ namespace juce
 #include "placement/juce_RectanglePlacement.h"
 #include "images/juce_ImageCache.h"
 #include "images/juce_ImageConvolutionKernel.h"
+#include "images/juce_ImageBlur.h"
 #include "images/juce_ImageFileFormat.h"
 #include "fonts/juce_Typeface.h"
 #include "fonts/juce_Font.h"
@@ -142,6 +153,7 @@ namespace juce
 #include "colour/juce_FillType.h"
 #include "native/juce_RenderingHelpers.h"
 #include "contexts/juce_LowLevelGraphicsSoftwareRenderer.h"
+#include "contexts/juce_LowLevelGraphicsTiledSoftwareRenderer.h"
 #include "contexts/juce_LowLevelGraphicsPostScriptRenderer.h"
 #include "effects/juce_ImageEffectFilter.h"
 #include "effects/juce_DropShadowEffect.h"
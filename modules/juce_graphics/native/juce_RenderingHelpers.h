@@ -23,6 +23,25 @@
   ==============================================================================
 */
 
+#if JUCE_USE_SIMD_PIXEL_BLENDING && ! JUCE_BIG_ENDIAN
+ #if JUCE_INTEL && (defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2))
+  #include <emmintrin.h>
+  #define JUCE_PIXEL_BLENDING_SSE2 1
+
+  #if defined (__AVX2__)
+   #include <immintrin.h>
+   #define JUCE_PIXEL_BLENDING_AVX2 1
+  #endif
+ #elif JUCE_ARM && (defined (__ARM_NEON__) || defined (__ARM_NEON))
+  #include <arm_neon.h>
+  #define JUCE_PIXEL_BLENDING_NEON 1
+ #endif
+#endif
+
+#if JUCE_PIXEL_BLENDING_SSE2 || JUCE_PIXEL_BLENDING_NEON
+ #define JUCE_PIXEL_BLENDING_SIMD 1
+#endif
+
 namespace juce
 {
 
@@ -134,9 +153,29 @@ public:
     bool isOnlyTranslated = true, isRotated = false;
 };
 
+//==============================================================================
+/** Returns a lock that must be held while asking a typeface for a glyph's shape from
+    a rendering thread.
+
+    Typefaces load their glyphs lazily, and the platform font engines that they use (e.g.
+    FreeType) can't be used by more than one thread at a time, so when several threads
+    render text in parallel, they have to take turns. Typefaces share a small set of locks,
+    so threads that are drawing with different typefaces will rarely have to wait.
+*/
+inline CriticalSection& getGlyphCreationLock (const Typeface& typeface) noexcept
+{
+    static CriticalSection locks[16];
+    return locks[((pointer_sized_uint) &typeface >> 4) % (pointer_sized_uint) numElementsInArray (locks)];
+}
+
 //==============================================================================
 /** Holds a cache of recently-used glyph objects of some type.
 
+    The glyphs are looked up by their typeface, size, glyph number and (if the glyph
+    type supports it) their sub-pixel position, in a set of hash tables which are each
+    guarded by their own spin-lock. This means that several rendering threads can use
+    the cache at the same time without getting in each other's way very often.
+
     @tags{Graphics}
 */
 template <class CachedGlyphType, class RenderTargetType>
@@ -166,96 +205,182 @@ public:
     //==============================================================================
     void reset()
     {
-        const ScopedLock sl (lock);
-        glyphs.clear();
-        addNewGlyphSlots (120);
-        hits = 0;
-        misses = 0;
+        for (auto& shard : shards)
+        {
+            const SpinLock::ScopedLockType sl (shard.lock);
+            shard.glyphs.clear();
+            shard.capacity = initialCapacityPerShard;
+            shard.hits = shard.misses = 0;
+            shard.recentHits = shard.recentMisses = 0;
+        }
     }
 
     void drawGlyph (RenderTargetType& target, const Font& font, const int glyphNumber, Point<float> pos)
     {
-        if (auto glyph = findOrCreateGlyph (font, glyphNumber))
-        {
-            glyph->lastAccessCount = ++accessCounter;
+        if (auto glyph = findOrCreateGlyph (font, glyphNumber, pos.x))
             glyph->draw (target, pos);
-        }
     }
 
-    ReferenceCountedObjectPtr<CachedGlyphType> findOrCreateGlyph (const Font& font, int glyphNumber)
+    ReferenceCountedObjectPtr<CachedGlyphType> findOrCreateGlyph (const Font& font, int glyphNumber, float x = 0.0f)
     {
-        const ScopedLock sl (lock);
+        auto* typeface = font.getTypeface();
+
+        if (typeface == nullptr)
+            return {};
+
+        GlyphKey key { typeface, font.getHeight(), font.getHorizontalScale(), glyphNumber,
+                       CachedGlyphType::getSubpixelPhase (*typeface, x) };
+
+        auto& shard = shards[key.getHash() % numShards];
 
-        if (auto g = findExistingGlyph (font, glyphNumber))
         {
-            ++hits;
-            return g;
+            const SpinLock::ScopedLockType sl (shard.lock);
+
+            if (auto g = shard.glyphs[key])
+            {
+                ++shard.hits;
+                ++shard.recentHits;
+                g->lastAccessCount = ++shard.accessCounter;
+                return g;
+            }
+
+            ++shard.misses;
+            ++shard.recentMisses;
         }
 
-        ++misses;
-        auto g = getGlyphForReuse();
-        jassert (g != nullptr);
-        g->generate (font, glyphNumber);
-        return g;
+        // The glyph is created without holding the shard's lock, so that other threads can
+        // carry on drawing the glyphs that are already in this part of the cache
+        ReferenceCountedObjectPtr<CachedGlyphType> newGlyph (new CachedGlyphType());
+
+        {
+            const ScopedLock sl (getGlyphCreationLock (*typeface));
+            newGlyph->generate (font, glyphNumber, key.subpixelPhase);
+        }
+
+        const SpinLock::ScopedLockType sl (shard.lock);
+
+        // another thread may have made the same glyph while this one was busy
+        if (auto g = shard.glyphs[key])
+            return g;
+
+        shard.makeSpaceForNewGlyph();
+        newGlyph->lastAccessCount = ++shard.accessCounter;
+        shard.glyphs.set (key, newGlyph);
+        return newGlyph;
     }
 
-private:
-    ReferenceCountedArray<CachedGlyphType> glyphs;
-    Atomic<int> accessCounter, hits, misses;
-    CriticalSection lock;
+    //==============================================================================
+    /** Some statistics about how well the cache is working. */
+    struct Statistics
+    {
+        int64 hits = 0, misses = 0;
+        int numGlyphs = 0;
+    };
 
-    ReferenceCountedObjectPtr<CachedGlyphType> findExistingGlyph (const Font& font, int glyphNumber) const noexcept
+    /** Returns the number of lookups that have been made since the cache was last reset,
+        and the number of glyphs that it currently holds.
+    */
+    Statistics getStatistics() const
     {
-        for (auto g : glyphs)
-            if (g->glyph == glyphNumber && g->font == font)
-                return *g;
+        Statistics stats;
 
-        return {};
+        for (auto& shard : shards)
+        {
+            const SpinLock::ScopedLockType sl (shard.lock);
+            stats.hits += shard.hits;
+            stats.misses += shard.misses;
+            stats.numGlyphs += shard.glyphs.size();
+        }
+
+        return stats;
     }
 
-    ReferenceCountedObjectPtr<CachedGlyphType> getGlyphForReuse()
+private:
+    //==============================================================================
+    struct GlyphKey
     {
-        if (hits.get() + misses.get() > glyphs.size() * 16)
-        {
-            if (misses.get() * 2 > hits.get())
-                addNewGlyphSlots (32);
+        Typeface* typeface;
+        float height, horizontalScale;
+        int glyph, subpixelPhase;
 
-            hits = 0;
-            misses = 0;
+        bool operator== (const GlyphKey& other) const noexcept
+        {
+            return typeface == other.typeface && height == other.height && horizontalScale == other.horizontalScale
+                    && glyph == other.glyph && subpixelPhase == other.subpixelPhase;
         }
 
-        if (auto g = findLeastRecentlyUsedGlyph())
-            return *g;
+        uint32 getHash() const noexcept
+        {
+            auto hash = (uint32) (pointer_sized_uint) typeface;
+
+            for (auto value : { (uint32) glyph, (uint32) subpixelPhase, (uint32) roundToInt (height * 64.0f),
+                                (uint32) roundToInt (horizontalScale * 1024.0f) })
+                hash = hash * 31 + value;
 
-        addNewGlyphSlots (32);
-        return glyphs.getLast();
-    }
+            return hash ^ (hash >> 15);
+        }
+    };
 
-    void addNewGlyphSlots (int num)
+    struct GlyphKeyHash
     {
-        glyphs.ensureStorageAllocated (glyphs.size() + num);
+        int generateHash (const GlyphKey& key, int upperLimit) const noexcept
+        {
+            return (int) (key.getHash() % (uint32) upperLimit);
+        }
+    };
 
-        while (--num >= 0)
-            glyphs.add (new CachedGlyphType());
-    }
+    using GlyphPtr = ReferenceCountedObjectPtr<CachedGlyphType>;
 
-    CachedGlyphType* findLeastRecentlyUsedGlyph() const noexcept
+    //==============================================================================
+    struct Shard
     {
-        CachedGlyphType* oldest = nullptr;
-        auto oldestCounter = std::numeric_limits<int>::max();
-
-        for (auto* g : glyphs)
+        void makeSpaceForNewGlyph()
         {
-            if (g->lastAccessCount <= oldestCounter
-                 && g->getReferenceCount() == 1)
+            // As the cache gets used, each part of it grows if more than a third of
+            // its recent lookups have failed
+            if (recentHits + recentMisses > capacity * 16)
+            {
+                if (recentMisses * 2 > recentHits)
+                    capacity += 8;
+
+                recentHits = recentMisses = 0;
+            }
+
+            if (glyphs.size() < capacity)
+                return;
+
+            // find the least-recently used glyph that isn't currently being drawn..
+            GlyphKey oldestKey {};
+            auto oldestCounter = std::numeric_limits<int>::max();
+            bool found = false;
+
+            for (typename decltype (glyphs)::Iterator i (glyphs); i.next();)
             {
-                oldestCounter = g->lastAccessCount;
-                oldest = g;
+                auto* g = i.getValue().get();
+
+                if (g->lastAccessCount <= oldestCounter && g->getReferenceCount() == 1)
+                {
+                    oldestCounter = g->lastAccessCount;
+                    oldestKey = i.getKey();
+                    found = true;
+                }
             }
+
+            if (found)
+                glyphs.remove (oldestKey);
         }
 
-        return oldest;
-    }
+        mutable SpinLock lock;
+        HashMap<GlyphKey, GlyphPtr, GlyphKeyHash> glyphs;
+        int capacity = 0, accessCounter = 0;
+        int64 hits = 0, misses = 0;
+        int recentHits = 0, recentMisses = 0;
+    };
+
+    static constexpr int numShards = 16;
+    static constexpr int initialCapacityPerShard = 16;
+
+    Shard shards[numShards];
 
     static GlyphCache*& getSingletonPointer() noexcept
     {
@@ -277,6 +402,8 @@ class CachedGlyphEdgeTable  : public ReferenceCountedObject
 public:
     CachedGlyphEdgeTable() = default;
 
+    static int getSubpixelPhase (Typeface&, float) noexcept     { return 0; }
+
     void draw (RendererType& state, Point<float> pos) const
     {
         if (snapToIntegerCoordinate)
@@ -286,7 +413,7 @@ public:
             state.fillEdgeTable (*edgeTable, pos.x, roundToInt (pos.y));
     }
 
-    void generate (const Font& newFont, int glyphNumber)
+    void generate (const Font& newFont, int glyphNumber, int /*subpixelPhase*/)
     {
         font = newFont;
         auto* typeface = newFont.getTypeface();
@@ -308,257 +435,1515 @@ public:
 };
 
 //==============================================================================
-/** Calculates the alpha values and positions for rendering the edges of a
-    non-pixel-aligned rectangle.
+/** A set of single-channel pages which small pre-rendered glyph images are packed into.
+
+    Each page is divided into shelves of glyphs with similar heights. The space on a page
+    is only re-used once all of the glyphs that were allocated on it have been deleted, and
+    the total number of pages is limited, so if the atlas fills up, allocate() will fail
+    and the glyphs will need to be drawn some other way.
 
     @tags{Graphics}
 */
-struct FloatRectangleRasterisingInfo
+class GlyphAtlas
 {
-    FloatRectangleRasterisingInfo (Rectangle<float> area)
-        : left   (roundToInt (256.0f * area.getX())),
-          top    (roundToInt (256.0f * area.getY())),
-          right  (roundToInt (256.0f * area.getRight())),
-          bottom (roundToInt (256.0f * area.getBottom()))
+public:
+    GlyphAtlas() = default;
+
+    enum
     {
-        if ((top >> 8) == (bottom >> 8))
-        {
-            topAlpha = bottom - top;
-            bottomAlpha = 0;
-            totalTop = top >> 8;
-            totalBottom = bottom = top = totalTop + 1;
-        }
-        else
+        pageSize = 512,
+        maxNumPages = 16,
+        maxGlyphSize = 64
+    };
+
+    struct Page  : public ReferenceCountedObject
+    {
+        Page() : pixels ((size_t) (pageSize * pageSize), true) {}
+
+        bool allocate (int width, int height, Point<int>& position)
         {
-            if ((top & 255) == 0)
-            {
-                topAlpha = 0;
-                top = totalTop = (top >> 8);
-            }
-            else
+            auto shelfHeight = (height + 3) & ~3;
+
+            for (auto& shelf : shelves)
             {
-                topAlpha = 255 - (top & 255);
-                totalTop = (top >> 8);
-                top = totalTop + 1;
+                if (shelf.height == shelfHeight && shelf.nextX + width <= pageSize)
+                {
+                    position = { shelf.nextX, shelf.y };
+                    shelf.nextX += width;
+                    return true;
+                }
             }
 
-            bottomAlpha = bottom & 255;
-            bottom >>= 8;
-            totalBottom = bottom + (bottomAlpha != 0 ? 1 : 0);
+            if (nextShelfY + shelfHeight > pageSize)
+                return false;
+
+            shelves.add ({ nextShelfY, shelfHeight, width });
+            position = { 0, nextShelfY };
+            nextShelfY += shelfHeight;
+            return true;
         }
 
-        if ((left >> 8) == (right >> 8))
+        void clear()
         {
-            leftAlpha = right - left;
-            rightAlpha = 0;
-            totalLeft = (left >> 8);
-            totalRight = right = left = totalLeft + 1;
+            if (nextShelfY > 0)
+                zeromem (pixels, (size_t) (pageSize * nextShelfY));
+
+            shelves.clearQuick();
+            nextShelfY = 0;
         }
-        else
+
+        struct Shelf
         {
-            if ((left & 255) == 0)
+            int y, height, nextX;
+        };
+
+        HeapBlock<uint8> pixels;
+        Array<Shelf> shelves;
+        int nextShelfY = 0;
+
+        JUCE_DECLARE_NON_COPYABLE (Page)
+    };
+
+    /** A block of pixels in the atlas, which stays valid for as long as this object exists. */
+    struct Allocation
+    {
+        ReferenceCountedObjectPtr<Page> page;
+        uint8* pixels = nullptr;
+        int lineStride = 0;
+    };
+
+    /** Finds space for an image of the given size, which will be filled with zeros. */
+    Allocation allocate (int width, int height)
+    {
+        Allocation a;
+
+        if (width <= 0 || height <= 0 || width > maxGlyphSize || height > maxGlyphSize)
+            return a;
+
+        const SpinLock::ScopedLockType sl (lock);
+
+        for (int i = 0; i <= pages.size(); ++i)
+        {
+            if (i == pages.size())
             {
-                leftAlpha = 0;
-                left = totalLeft = (left >> 8);
+                if (pages.size() >= maxNumPages)
+                    break;
+
+                pages.add (new Page());
             }
-            else
+
+            auto* page = pages.getObjectPointerUnchecked (i);
+
+            // If nothing else is using a page, it can be emptied and used again
+            if (page->getReferenceCount() == 1)
+                page->clear();
+
+            Point<int> position;
+
+            if (page->allocate (width, height, position))
             {
-                leftAlpha = 255 - (left & 255);
-                totalLeft = (left >> 8);
-                left = totalLeft + 1;
+                a.page = page;
+                a.pixels = page->pixels + position.x + position.y * pageSize;
+                a.lineStride = pageSize;
+                break;
             }
+        }
 
-            rightAlpha = right & 255;
-            right >>= 8;
-            totalRight = right + (rightAlpha != 0 ? 1 : 0);
+        return a;
+    }
+
+    /** Returns the number of bytes that the atlas is currently using. */
+    size_t getNumBytesUsed() const
+    {
+        const SpinLock::ScopedLockType sl (lock);
+        return (size_t) pages.size() * (size_t) (pageSize * pageSize);
+    }
+
+    static GlyphAtlas& getInstance()
+    {
+        static GlyphAtlas atlas;
+        return atlas;
+    }
+
+private:
+    mutable SpinLock lock;
+    ReferenceCountedArray<Page> pages;
+
+    JUCE_DECLARE_NON_COPYABLE (GlyphAtlas)
+};
+
+//==============================================================================
+/** Caches a glyph as an image in the GlyphAtlas, which can be drawn without having to
+    create an edge-table for it.
+
+    Each glyph is rendered at one of four sub-pixel horizontal positions. If the glyph
+    is too big for the atlas, or the renderer can't draw the image with its current clip
+    region, then it's drawn using an edge-table instead.
+
+    @tags{Graphics}
+*/
+template <class RendererType>
+class CachedGlyphBitmap  : public ReferenceCountedObject
+{
+public:
+    CachedGlyphBitmap() = default;
+
+    enum { numSubpixelPhases = 4 };
+
+    static int getSubpixelPhase (Typeface& typeface, float x) noexcept
+    {
+        return typeface.isHinted() ? 0 : (getSubpixelPosition (x) & (numSubpixelPhases - 1));
+    }
+
+    void draw (RendererType& state, Point<float> pos) const
+    {
+        if (snapToIntegerCoordinate)
+            pos.x = std::floor (pos.x + 0.5f);
+
+        auto subpixelX = getSubpixelPosition (pos.x);
+        auto x = subpixelX >> 2;
+        auto y = roundToInt (pos.y);
+
+        if (bitmap.pixels != nullptr
+             && state.fillGlyphBitmap (bitmap.pixels, bitmap.lineStride, bitmapBounds.translated (x, y)))
+            return;
+
+        if (edgeTable != nullptr)
+            state.fillEdgeTable (*edgeTable, (float) subpixelX / (float) numSubpixelPhases, y);
+    }
+
+    void generate (const Font& newFont, int glyphNumber, int subpixelPhase)
+    {
+        font = newFont;
+        auto* typeface = newFont.getTypeface();
+        snapToIntegerCoordinate = typeface->isHinted();
+        glyph = glyphNumber;
+
+        auto fontHeight = font.getHeight();
+        edgeTable.reset (typeface->getEdgeTableForGlyph (glyphNumber,
+                                                         AffineTransform::scale (fontHeight * font.getHorizontalScale(),
+                                                                                 fontHeight), fontHeight));
+
+        if (edgeTable != nullptr)
+        {
+            EdgeTable shifted (*edgeTable);
+            shifted.translate ((float) subpixelPhase / (float) numSubpixelPhases, 0);
+            // (translating the table moves its edges but not its bounds, so this allows for the extra pixel)
+            bitmapBounds = shifted.getMaximumBounds().withTrimmedRight (-1);
+            bitmap = GlyphAtlas::getInstance().allocate (bitmapBounds.getWidth(), bitmapBounds.getHeight());
+
+            if (bitmap.pixels != nullptr)
+            {
+                LevelWriter writer { bitmap.pixels, bitmap.lineStride, bitmapBounds.getPosition(), nullptr };
+                shifted.iterate (writer);
+            }
         }
     }
 
-    template <class Callback>
-    void iterate (Callback& callback) const
+    Font font;
+    std::unique_ptr<EdgeTable> edgeTable;
+    GlyphAtlas::Allocation bitmap;
+    Rectangle<int> bitmapBounds;
+    int glyph = 0, lastAccessCount = 0;
+    bool snapToIntegerCoordinate = false;
+
+private:
+    // The position in quarter-pixels, so the bottom two bits are the sub-pixel phase
+    static int getSubpixelPosition (float x) noexcept
     {
-        if (topAlpha != 0)       callback (totalLeft, totalTop, totalRight - totalLeft, 1, topAlpha);
-        if (bottomAlpha != 0)    callback (totalLeft, bottom,   totalRight - totalLeft, 1, bottomAlpha);
-        if (leftAlpha != 0)      callback (totalLeft, totalTop, 1, totalBottom - totalTop, leftAlpha);
-        if (rightAlpha != 0)     callback (right,     totalTop, 1, totalBottom - totalTop, rightAlpha);
+        return (int) std::floor (x * (float) numSubpixelPhases + 0.5f);
+    }
 
-        callback (left, top, right - left, bottom - top, 255);
+    struct LevelWriter
+    {
+        uint8* pixels;
+        int lineStride;
+        Point<int> origin;
+        uint8* line;
+
+        void setEdgeTableYPos (int y) noexcept                         { line = pixels + (y - origin.y) * lineStride - origin.x; }
+        void handleEdgeTablePixel (int x, int alphaLevel) noexcept     { line[x] = (uint8) alphaLevel; }
+        void handleEdgeTablePixelFull (int x) noexcept                 { line[x] = 255; }
+        void handleEdgeTableLine (int x, int width, int alphaLevel) noexcept   { memset (line + x, alphaLevel, (size_t) width); }
+        void handleEdgeTableLineFull (int x, int width) noexcept       { memset (line + x, 255, (size_t) width); }
+    };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CachedGlyphBitmap)
+};
+
+//==============================================================================
+/** Holds a cache of recently-drawn stroked paths and path edge-tables.
+
+    Things like meters and plots tend to draw exactly the same paths each time they're
+    repainted, so rather than stroking and rasterising them over and over again, the results
+    are kept here. They're looked up by a 64-bit hash of the path's contents combined with
+    the stroke settings or transform that were used, and each entry keeps a copy of the
+    path and settings so that a hash collision can't return the wrong result.
+
+    A path only gets cached the second time that it's seen, so that paths which change on
+    every repaint don't push the others out, and the least-recently used entries are dropped
+    when the cache gets bigger than its size limit. A renderer that draws the same operation
+    more than once, e.g. once for each tile, should wrap each one in a ScopedOperation so
+    that those repeated lookups don't count as the path being seen again.
+
+    @tags{Graphics}
+*/
+class PathCache  : private DeletedAtShutdown
+{
+public:
+    PathCache()
+    {
+        reset();
     }
 
-    inline bool isOnePixelWide() const noexcept            { return right - left == 1 && leftAlpha + rightAlpha == 0; }
+    ~PathCache() override
+    {
+        getSingletonPointer() = nullptr;
+    }
 
-    inline int getTopLeftCornerAlpha() const noexcept      { return (topAlpha * leftAlpha) >> 8; }
-    inline int getTopRightCornerAlpha() const noexcept     { return (topAlpha * rightAlpha) >> 8; }
-    inline int getBottomLeftCornerAlpha() const noexcept   { return (bottomAlpha * leftAlpha) >> 8; }
-    inline int getBottomRightCornerAlpha() const noexcept  { return (bottomAlpha * rightAlpha) >> 8; }
+    /** Returns the shared cache, creating it if necessary.
+        This can be called from any thread, as images can be drawn on any thread.
+    */
+    static PathCache& getInstance()
+    {
+        auto& instance = getSingletonPointer();
+
+        if (auto* c = instance.load (std::memory_order_acquire))
+            return *c;
+
+        static SpinLock creationLock;
+        const SpinLock::ScopedLockType sl (creationLock);
+
+        if (instance.load() == nullptr)
+            instance = new PathCache();
+
+        return *instance.load();
+    }
+
+    //==============================================================================
+    /** An entry in the cache, which holds either a stroked path or an edge table. */
+    struct CachedPath  : public ReferenceCountedObject
+    {
+        Path path;
+        std::unique_ptr<EdgeTable> edgeTable;
+        size_t numBytes = 0;
+        int lastAccessCount = 0;
+
+        // the things that this entry was created from
+        Path sourcePath;
+        std::array<float, 11> parameters {};
+    };
+
+    using CachedPathPtr = ReferenceCountedObjectPtr<CachedPath>;
+
+    //==============================================================================
+    /** While one of these exists, any lookups made on the current thread are treated as
+        part of the given drawing operation.
+
+        A path that misses the cache more than once during the same operation is only
+        counted as having been seen once, so a renderer that draws each operation in
+        several pieces doesn't cause paths that change on every repaint to be cached.
+        Use createOperationID() to get a new ID for each operation.
+    */
+    struct ScopedOperation
+    {
+        explicit ScopedOperation (uint32 operationID) noexcept  : previousID (getCurrentOperationID())
+        {
+            getCurrentOperationID() = operationID;
+        }
+
+        ~ScopedOperation() noexcept
+        {
+            getCurrentOperationID() = previousID;
+        }
+
+    private:
+        uint32 previousID;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedOperation)
+    };
+
+    /** Returns a new ID to use with ScopedOperation. */
+    static uint32 createOperationID() noexcept
+    {
+        static std::atomic<uint32> lastID { 0 };
+
+        for (;;)
+            if (auto newID = ++lastID)
+                return newID;
+    }
+
+    //==============================================================================
+    /** Strokes a path, re-using the result from a previous call if possible. */
+    void createStrokedPath (Path& destPath, const Path& sourcePath, const PathStrokeType& strokeType,
+                            const AffineTransform& transform, float extraAccuracy)
+    {
+        KeyBuilder key (sourcePath);
+
+        if (key.numElements >= minElementsToCache)
+        {
+            key.addParameters ({ (float) strokeKey, strokeType.getStrokeThickness(), (float) strokeType.getJointStyle(),
+                                 (float) strokeType.getEndStyle(), extraAccuracy, transform.mat00, transform.mat01, transform.mat02,
+                                 transform.mat10, transform.mat11, transform.mat12 });
+
+            bool shouldCache = false;
+
+            if (auto cached = find (key, sourcePath, shouldCache))
+            {
+                destPath = cached->path;
+                return;
+            }
+
+            strokeType.createStrokedPath (destPath, sourcePath, transform, extraAccuracy);
+
+            if (shouldCache)
+            {
+                CachedPathPtr newEntry (new CachedPath());
+                newEntry->path = destPath;
+                newEntry->numBytes = sizeof (CachedPath) + (size_t) KeyBuilder (destPath).numCoords * sizeof (float);
+                add (key, sourcePath, newEntry);
+            }
+
+            return;
+        }
+
+        strokeType.createStrokedPath (destPath, sourcePath, transform, extraAccuracy);
+    }
+
+    /** Looks for an edge table of a path, and creates one if this is the second time that
+        the path has been asked for.
+
+        The tables are kept without their whole-pixel translation, so that a path that's just
+        been moved around can still use the same table. If this returns an entry, its table
+        needs to be translated by the offset that's returned.
+    */
+    CachedPathPtr findOrCreateEdgeTable (const Path& path, const AffineTransform& transform,
+                                         EdgeTable::PathRasteriser rasteriser, Point<int>& offset)
+    {
+        KeyBuilder key (path);
+
+        if (key.numElements < minElementsToCache)
+            return {};
+
+        offset = { (int) std::floor (transform.getTranslationX()), (int) std::floor (transform.getTranslationY()) };
+        auto untranslated = transform.translated ((float) -offset.x, (float) -offset.y);
+
+        key.addParameters ({ (float) edgeTableKey, (float) (int) rasteriser, untranslated.mat00, untranslated.mat01, untranslated.mat02,
+                             untranslated.mat10, untranslated.mat11, untranslated.mat12 });
+
+        bool shouldCache = false;
+
+        if (auto cached = find (key, path, shouldCache))
+            return cached;
+
+        if (! shouldCache)
+            return {};
+
+        auto bounds = path.getBoundsTransformed (untranslated).getSmallestIntegerContainer().expanded (1);
+
+        // huge tables would use up the whole cache and take longer to copy than to re-create
+        if ((int64) bounds.getWidth() * bounds.getHeight() > maxEdgeTableArea)
+            return {};
+
+        CachedPathPtr newEntry (new CachedPath());
+        newEntry->edgeTable.reset (new EdgeTable (bounds, path, untranslated, rasteriser));
+        newEntry->edgeTable->optimiseTable();
+        newEntry->numBytes = sizeof (CachedPath) + newEntry->edgeTable->getMemoryUsage();
+        add (key, path, newEntry);
+        return newEntry;
+    }
+
+    //==============================================================================
+    /** Removes everything from the cache, and resets its statistics. */
+    void reset()
+    {
+        const SpinLock::ScopedLockType sl (lock);
+        entries.clear();
+        totalBytes = 0;
+        hits = misses = 0;
+
+        for (auto& m : recentMisses)
+            m = {};
+    }
+
+    /** Sets the number of bytes of memory that the cache is allowed to use. */
+    void setMaximumSize (size_t newMaxNumBytes)
+    {
+        const SpinLock::ScopedLockType sl (lock);
+        maxNumBytes = newMaxNumBytes;
+        removeOldEntries();
+    }
+
+    /** Some statistics about how well the cache is working. */
+    struct Statistics
+    {
+        int64 hits = 0, misses = 0;
+        int numEntries = 0;
+        size_t numBytes = 0;
+    };
+
+    /** Returns the number of lookups that have been made since the cache was last reset,
+        and the number of entries that it currently holds.
+    */
+    Statistics getStatistics() const
+    {
+        const SpinLock::ScopedLockType sl (lock);
+
+        Statistics stats;
+        stats.hits = hits;
+        stats.misses = misses;
+        stats.numEntries = entries.size();
+        stats.numBytes = totalBytes;
+        return stats;
+    }
+
+private:
+    //==============================================================================
+    enum { strokeKey = 1, edgeTableKey = 2 };
+
+    // Builds up a 64-bit FNV-style hash of a path's contents and any other values that
+    // affect the result, keeping those values so that they can be checked on a hit
+    struct KeyBuilder
+    {
+        KeyBuilder (const Path& p) noexcept
+        {
+            add (p.isUsingNonZeroWinding() ? 1.0f : 0.0f);
+
+            for (Path::Iterator i (p); i.next();)
+            {
+                ++numElements;
+                add ((float) i.elementType);
+
+                switch (i.elementType)
+                {
+                    case Path::Iterator::startNewSubPath:
+                    case Path::Iterator::lineTo:       add ({ i.x1, i.y1 }); numCoords += 3; break;
+                    case Path::Iterator::quadraticTo:  add ({ i.x1, i.y1, i.x2, i.y2 }); numCoords += 5; break;
+                    case Path::Iterator::cubicTo:      add ({ i.x1, i.y1, i.x2, i.y2, i.x3, i.y3 }); numCoords += 7; break;
+                    case Path::Iterator::closePath:    ++numCoords; break;
+                    default:                           jassertfalse; break;
+                }
+            }
+        }
+
+        void add (float value) noexcept
+        {
+            uint32 bits;
+            memcpy (&bits, &value, sizeof (bits));
+            hash = (hash ^ bits) * (uint64) 0x100000001b3ULL;
+        }
+
+        void add (std::initializer_list<float> values) noexcept
+        {
+            for (auto v : values)
+                add (v);
+        }
+
+        void addParameters (std::initializer_list<float> values) noexcept
+        {
+            jassert (numParameters + values.size() <= parameters.size());
+
+            for (auto v : values)
+            {
+                parameters[numParameters++] = v;
+                add (v);
+            }
+        }
+
+        uint64 hash = (uint64) 0xcbf29ce484222325ULL;
+        int numElements = 0, numCoords = 0;
+        decltype (CachedPath::parameters) parameters {};
+        size_t numParameters = 0;
+    };
+
+    struct RecentMiss
+    {
+        uint64 hash = 0;
+        uint32 operationID = 0;
+    };
+
+    //==============================================================================
+    CachedPathPtr find (const KeyBuilder& key, const Path& sourcePath, bool& shouldCache)
+    {
+        const SpinLock::ScopedLockType sl (lock);
+
+        if (auto cached = entries[key.hash])
+        {
+            // a different path or set of parameters with the same hash is just a miss,
+            // and it can't be cached because its slot is already taken
+            if (cached->parameters == key.parameters && cached->sourcePath == sourcePath)
+            {
+                ++hits;
+                cached->lastAccessCount = ++accessCounter;
+                return cached;
+            }
+
+            ++misses;
+            return {};
+        }
+
+        ++misses;
+        auto operationID = getCurrentOperationID();
+
+        for (auto& m : recentMisses)
+        {
+            if (m.hash == key.hash)
+            {
+                // another piece of the same operation doesn't count as seeing the path again
+                if (operationID == 0 || m.operationID != operationID)
+                    shouldCache = true;
+
+                return {};
+            }
+        }
+
+        recentMisses[nextRecentMiss] = { key.hash, operationID };
+        nextRecentMiss = (nextRecentMiss + 1) % numElementsInArray (recentMisses);
+        return {};
+    }
+
+    void add (const KeyBuilder& key, const Path& sourcePath, CachedPathPtr newEntry)
+    {
+        newEntry->sourcePath = sourcePath;
+        newEntry->parameters = key.parameters;
+        newEntry->numBytes += (size_t) key.numCoords * sizeof (float);
+
+        const SpinLock::ScopedLockType sl (lock);
+
+        // another thread may have added the same thing while this one was busy,
+        // and anything that would fill most of the cache isn't worth keeping
+        if (entries.contains (key.hash) || newEntry->numBytes > maxNumBytes / 4)
+            return;
+
+        newEntry->lastAccessCount = ++accessCounter;
+        entries.set (key.hash, newEntry);
+        totalBytes += newEntry->numBytes;
+        removeOldEntries();
+    }
+
+    void removeOldEntries()
+    {
+        while (totalBytes > maxNumBytes)
+        {
+            // find the least-recently used entry that isn't currently being drawn..
+            uint64 oldestKey = 0;
+            CachedPath* oldest = nullptr;
+
+            for (HashMap<uint64, CachedPathPtr>::Iterator i (entries); i.next();)
+            {
+                auto* c = i.getValue().get();
+
+                if (c->getReferenceCount() == 1 && (oldest == nullptr || c->lastAccessCount < oldest->lastAccessCount))
+                {
+                    oldest = c;
+                    oldestKey = i.getKey();
+                }
+            }
+
+            if (oldest == nullptr)
+                break;
+
+            totalBytes -= oldest->numBytes;
+            entries.remove (oldestKey);
+        }
+    }
+
+    //==============================================================================
+    static constexpr int minElementsToCache = 32;
+    static constexpr int64 maxEdgeTableArea = 4096 * 4096;
+
+    mutable SpinLock lock;
+    HashMap<uint64, CachedPathPtr> entries;
+    RecentMiss recentMisses[64];
+    int nextRecentMiss = 0, accessCounter = 0;
+    size_t totalBytes = 0, maxNumBytes = 16 * 1024 * 1024;
+    int64 hits = 0, misses = 0;
+
+    static std::atomic<PathCache*>& getSingletonPointer() noexcept
+    {
+        static std::atomic<PathCache*> c { nullptr };
+        return c;
+    }
+
+    static uint32& getCurrentOperationID() noexcept
+    {
+        static thread_local uint32 operationID = 0;
+        return operationID;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PathCache)
+};
+
+//==============================================================================
+/** Calculates the alpha values and positions for rendering the edges of a
+    non-pixel-aligned rectangle.
+
+    @tags{Graphics}
+*/
+struct FloatRectangleRasterisingInfo
+{
+    FloatRectangleRasterisingInfo (Rectangle<float> area)
+        : left   (roundToInt (256.0f * area.getX())),
+          top    (roundToInt (256.0f * area.getY())),
+          right  (roundToInt (256.0f * area.getRight())),
+          bottom (roundToInt (256.0f * area.getBottom()))
+    {
+        if ((top >> 8) == (bottom >> 8))
+        {
+            topAlpha = bottom - top;
+            bottomAlpha = 0;
+            totalTop = top >> 8;
+            totalBottom = bottom = top = totalTop + 1;
+        }
+        else
+        {
+            if ((top & 255) == 0)
+            {
+                topAlpha = 0;
+                top = totalTop = (top >> 8);
+            }
+            else
+            {
+                topAlpha = 255 - (top & 255);
+                totalTop = (top >> 8);
+                top = totalTop + 1;
+            }
+
+            bottomAlpha = bottom & 255;
+            bottom >>= 8;
+            totalBottom = bottom + (bottomAlpha != 0 ? 1 : 0);
+        }
+
+        if ((left >> 8) == (right >> 8))
+        {
+            leftAlpha = right - left;
+            rightAlpha = 0;
+            totalLeft = (left >> 8);
+            totalRight = right = left = totalLeft + 1;
+        }
+        else
+        {
+            if ((left & 255) == 0)
+            {
+                leftAlpha = 0;
+                left = totalLeft = (left >> 8);
+            }
+            else
+            {
+                leftAlpha = 255 - (left & 255);
+                totalLeft = (left >> 8);
+                left = totalLeft + 1;
+            }
+
+            rightAlpha = right & 255;
+            right >>= 8;
+            totalRight = right + (rightAlpha != 0 ? 1 : 0);
+        }
+    }
+
+    template <class Callback>
+    void iterate (Callback& callback) const
+    {
+        if (topAlpha != 0)       callback (totalLeft, totalTop, totalRight - totalLeft, 1, topAlpha);
+        if (bottomAlpha != 0)    callback (totalLeft, bottom,   totalRight - totalLeft, 1, bottomAlpha);
+        if (leftAlpha != 0)      callback (totalLeft, totalTop, 1, totalBottom - totalTop, leftAlpha);
+        if (rightAlpha != 0)     callback (right,     totalTop, 1, totalBottom - totalTop, rightAlpha);
+
+        callback (left, top, right - left, bottom - top, 255);
+    }
+
+    inline bool isOnePixelWide() const noexcept            { return right - left == 1 && leftAlpha + rightAlpha == 0; }
+
+    inline int getTopLeftCornerAlpha() const noexcept      { return (topAlpha * leftAlpha) >> 8; }
+    inline int getTopRightCornerAlpha() const noexcept     { return (topAlpha * rightAlpha) >> 8; }
+    inline int getBottomLeftCornerAlpha() const noexcept   { return (bottomAlpha * leftAlpha) >> 8; }
+    inline int getBottomRightCornerAlpha() const noexcept  { return (bottomAlpha * rightAlpha) >> 8; }
+
+    //==============================================================================
+    int left, top, right, bottom;  // bounds of the solid central area, excluding anti-aliased edges
+    int totalTop, totalLeft, totalBottom, totalRight; // bounds of the total area, including edges
+    int topAlpha, leftAlpha, bottomAlpha, rightAlpha; // alpha of each anti-aliased edge
+};
+
+//==============================================================================
+/** Contains classes for calculating the colour of pixels within various types of gradient. */
+namespace GradientPixelIterators
+{
+    /** Iterates the colour of pixels in a linear gradient */
+    struct Linear
+    {
+        Linear (const ColourGradient& gradient, const AffineTransform& transform,
+                const PixelARGB* colours, int numColours)
+            : lookupTable (colours),
+              numEntries (numColours)
+        {
+            jassert (numColours >= 0);
+            auto p1 = gradient.point1;
+            auto p2 = gradient.point2;
+
+            if (! transform.isIdentity())
+            {
+                auto p3 = Line<float> (p2, p1).getPointAlongLine (0.0f, 100.0f);
+
+                p1.applyTransform (transform);
+                p2.applyTransform (transform);
+                p3.applyTransform (transform);
+
+                p2 = Line<float> (p2, p3).findNearestPointTo (p1);
+            }
+
+            vertical   = std::abs (p1.x - p2.x) < 0.001f;
+            horizontal = std::abs (p1.y - p2.y) < 0.001f;
+
+            if (vertical)
+            {
+                scale = roundToInt ((numEntries << (int) numScaleBits) / (double) (p2.y - p1.y));
+                start = roundToInt (p1.y * (float) scale);
+            }
+            else if (horizontal)
+            {
+                scale = roundToInt ((numEntries << (int) numScaleBits) / (double) (p2.x - p1.x));
+                start = roundToInt (p1.x * (float) scale);
+            }
+            else
+            {
+                grad = (p2.getY() - p1.y) / (double) (p1.x - p2.x);
+                yTerm = p1.getY() - p1.x / grad;
+                scale = roundToInt ((numEntries << (int) numScaleBits) / (yTerm * grad - (p2.y * grad - p2.x)));
+                grad *= scale;
+            }
+        }
+
+        forcedinline void setY (int y) noexcept
+        {
+            if (vertical)
+                linePix = lookupTable[jlimit (0, numEntries, (y * scale - start) >> (int) numScaleBits)];
+            else if (! horizontal)
+                start = roundToInt ((y - yTerm) * grad);
+        }
+
+        inline PixelARGB getPixel (int x) const noexcept
+        {
+            return vertical ? linePix
+                            : lookupTable[jlimit (0, numEntries, (x * scale - start) >> (int) numScaleBits)];
+        }
+
+        const PixelARGB* const lookupTable;
+        const int numEntries;
+        PixelARGB linePix;
+        int start, scale;
+        double grad, yTerm;
+        bool vertical, horizontal;
+        enum { numScaleBits = 12 };
+
+        JUCE_DECLARE_NON_COPYABLE (Linear)
+    };
+
+    //==============================================================================
+    /** Iterates the colour of pixels in a circular radial gradient */
+    struct Radial
+    {
+        Radial (const ColourGradient& gradient, const AffineTransform&,
+                const PixelARGB* colours, int numColours)
+            : lookupTable (colours),
+              numEntries (numColours),
+              gx1 (gradient.point1.x),
+              gy1 (gradient.point1.y)
+        {
+            jassert (numColours >= 0);
+            auto diff = gradient.point1 - gradient.point2;
+            maxDist = diff.x * diff.x + diff.y * diff.y;
+            invScale = numEntries / std::sqrt (maxDist);
+            jassert (roundToInt (std::sqrt (maxDist) * invScale) <= numEntries);
+        }
+
+        forcedinline void setY (int y) noexcept
+        {
+            dy = y - gy1;
+            dy *= dy;
+        }
+
+        inline PixelARGB getPixel (int px) const noexcept
+        {
+            auto x = px - gx1;
+            x *= x;
+            x += dy;
+
+            return lookupTable[x >= maxDist ? numEntries : roundToInt (std::sqrt (x) * invScale)];
+        }
+
+        const PixelARGB* const lookupTable;
+        const int numEntries;
+        const double gx1, gy1;
+        double maxDist, invScale, dy;
+
+        JUCE_DECLARE_NON_COPYABLE (Radial)
+    };
+
+    //==============================================================================
+    /** Iterates the colour of pixels in a skewed radial gradient */
+    struct TransformedRadial   : public Radial
+    {
+        TransformedRadial (const ColourGradient& gradient, const AffineTransform& transform,
+                           const PixelARGB* colours, int numColours)
+            : Radial (gradient, transform, colours, numColours),
+              inverseTransform (transform.inverted())
+        {
+            tM10 = inverseTransform.mat10;
+            tM00 = inverseTransform.mat00;
+        }
+
+        forcedinline void setY (int y) noexcept
+        {
+            auto floatY = (float) y;
+            lineYM01 = inverseTransform.mat01 * floatY + inverseTransform.mat02 - gx1;
+            lineYM11 = inverseTransform.mat11 * floatY + inverseTransform.mat12 - gy1;
+        }
+
+        inline PixelARGB getPixel (int px) const noexcept
+        {
+            double x = px;
+            auto y = tM10 * x + lineYM11;
+            x = tM00 * x + lineYM01;
+            x *= x;
+            x += y * y;
+
+            if (x >= maxDist)
+                return lookupTable[numEntries];
+
+            return lookupTable[jmin (numEntries, roundToInt (std::sqrt (x) * invScale))];
+        }
+
+    private:
+        double tM10, tM00, lineYM01, lineYM11;
+        const AffineTransform inverseTransform;
+
+        JUCE_DECLARE_NON_COPYABLE (TransformedRadial)
+    };
+}
+
+#define JUCE_PERFORM_PIXEL_OP_LOOP(op) \
+{ \
+    const int destStride = destData.pixelStride;  \
+    do { dest->op; dest = addBytesToPointer (dest, destStride); } while (--width > 0); \
+}
+
+//==============================================================================
+/** Contains the loops that blend runs of pixels, with SIMD versions of the common cases.
+
+    Each SIMD version produces exactly the same results as the pixel classes' blend()
+    methods, so they can be used interchangeably.
+*/
+namespace SpanBlending
+{
+   #if JUCE_PIXEL_BLENDING_SSE2
+    // Blends 4 premultiplied ARGB pixels, whose components have been unpacked to
+    // 16-bit lanes, onto 4 destination pixels
+    forcedinline __m128i blend4 (__m128i dest, __m128i srcLo, __m128i srcHi) noexcept
+    {
+        auto zero = _mm_setzero_si128();
+        auto k256 = _mm_set1_epi16 (256);
+
+        auto invAlphaLo = _mm_sub_epi16 (k256, _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (srcLo, 0xff), 0xff));
+        auto invAlphaHi = _mm_sub_epi16 (k256, _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (srcHi, 0xff), 0xff));
+
+        auto destLo = _mm_srli_epi16 (_mm_mullo_epi16 (_mm_unpacklo_epi8 (dest, zero), invAlphaLo), 8);
+        auto destHi = _mm_srli_epi16 (_mm_mullo_epi16 (_mm_unpackhi_epi8 (dest, zero), invAlphaHi), 8);
+
+        return _mm_packus_epi16 (_mm_add_epi16 (srcLo, destLo), _mm_add_epi16 (srcHi, destHi));
+    }
+
+    // Blends bytes with a constant multiplier, adding a pattern of source values
+    forcedinline __m128i blendBytes16 (__m128i dest, __m128i srcLo, __m128i srcHi, __m128i invAlpha) noexcept
+    {
+        auto zero = _mm_setzero_si128();
+        auto destLo = _mm_srli_epi16 (_mm_mullo_epi16 (_mm_unpacklo_epi8 (dest, zero), invAlpha), 8);
+        auto destHi = _mm_srli_epi16 (_mm_mullo_epi16 (_mm_unpackhi_epi8 (dest, zero), invAlpha), 8);
+
+        return _mm_packus_epi16 (_mm_add_epi16 (srcLo, destLo), _mm_add_epi16 (srcHi, destHi));
+    }
+   #endif
+
+   #if JUCE_PIXEL_BLENDING_AVX2
+    forcedinline __m256i blend8 (__m256i dest, __m256i srcLo, __m256i srcHi) noexcept
+    {
+        auto zero = _mm256_setzero_si256();
+        auto k256 = _mm256_set1_epi16 (256);
+
+        auto invAlphaLo = _mm256_sub_epi16 (k256, _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (srcLo, 0xff), 0xff));
+        auto invAlphaHi = _mm256_sub_epi16 (k256, _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (srcHi, 0xff), 0xff));
+
+        auto destLo = _mm256_srli_epi16 (_mm256_mullo_epi16 (_mm256_unpacklo_epi8 (dest, zero), invAlphaLo), 8);
+        auto destHi = _mm256_srli_epi16 (_mm256_mullo_epi16 (_mm256_unpackhi_epi8 (dest, zero), invAlphaHi), 8);
+
+        return _mm256_packus_epi16 (_mm256_add_epi16 (srcLo, destLo), _mm256_add_epi16 (srcHi, destHi));
+    }
+   #endif
+
+   #if JUCE_PIXEL_BLENDING_NEON
+    forcedinline uint8x8_t blendChannel8 (uint8x8_t dest, uint16x8_t src, uint16x8_t invAlpha) noexcept
+    {
+        return vqmovn_u16 (vaddq_u16 (src, vshrq_n_u16 (vmulq_u16 (vmovl_u8 (dest), invAlpha), 8)));
+    }
+   #endif
+
+    // Blends a contiguous run of ARGB pixels, returning the number of pixels that were done
+    inline int blendARGBSpan (PixelARGB* dest, const PixelARGB* src, int width, uint32 extraAlpha) noexcept
+    {
+        ignoreUnused (dest, src, extraAlpha);
+        int done = 0;
+
+       #if JUCE_PIXEL_BLENDING_AVX2
+        {
+            auto zero = _mm256_setzero_si256();
+            auto alpha = _mm256_set1_epi16 ((short) extraAlpha);
+
+            for (; done + 8 <= width; done += 8)
+            {
+                auto s = _mm256_loadu_si256 ((const __m256i*) (src + done));
+                auto srcLo = _mm256_unpacklo_epi8 (s, zero);
+                auto srcHi = _mm256_unpackhi_epi8 (s, zero);
+
+                if (extraAlpha < 0x100)
+                {
+                    srcLo = _mm256_srli_epi16 (_mm256_mullo_epi16 (srcLo, alpha), 8);
+                    srcHi = _mm256_srli_epi16 (_mm256_mullo_epi16 (srcHi, alpha), 8);
+                }
+
+                auto d = (__m256i*) (dest + done);
+                _mm256_storeu_si256 (d, blend8 (_mm256_loadu_si256 (d), srcLo, srcHi));
+            }
+        }
+       #endif
+
+       #if JUCE_PIXEL_BLENDING_SSE2
+        {
+            auto zero = _mm_setzero_si128();
+            auto alpha = _mm_set1_epi16 ((short) extraAlpha);
+
+            for (; done + 4 <= width; done += 4)
+            {
+                auto s = _mm_loadu_si128 ((const __m128i*) (src + done));
+                auto srcLo = _mm_unpacklo_epi8 (s, zero);
+                auto srcHi = _mm_unpackhi_epi8 (s, zero);
+
+                if (extraAlpha < 0x100)
+                {
+                    srcLo = _mm_srli_epi16 (_mm_mullo_epi16 (srcLo, alpha), 8);
+                    srcHi = _mm_srli_epi16 (_mm_mullo_epi16 (srcHi, alpha), 8);
+                }
+
+                auto d = (__m128i*) (dest + done);
+                _mm_storeu_si128 (d, blend4 (_mm_loadu_si128 (d), srcLo, srcHi));
+            }
+        }
+       #elif JUCE_PIXEL_BLENDING_NEON
+        {
+            auto alpha = vdupq_n_u16 ((uint16) extraAlpha);
+            auto k256 = vdupq_n_u16 (256);
+
+            for (; done + 8 <= width; done += 8)
+            {
+                auto s = vld4_u8 ((const uint8*) (src + done));
+                auto d = vld4_u8 ((uint8*) (dest + done));
+                uint16x8_t channels[4];
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    channels[i] = vmovl_u8 (s.val[i]);
+
+                    if (extraAlpha < 0x100)
+                        channels[i] = vshrq_n_u16 (vmulq_u16 (channels[i], alpha), 8);
+                }
+
+                auto invAlpha = vsubq_u16 (k256, channels[PixelARGB::indexA]);
+
+                for (int i = 0; i < 4; ++i)
+                    d.val[i] = blendChannel8 (d.val[i], channels[i], invAlpha);
+
+                vst4_u8 ((uint8*) (dest + done), d);
+            }
+        }
+       #endif
+
+        return done;
+    }
+
+    // Blends a contiguous run of pixels with a constant colour, returning the number of bytes that were done.
+    // The pattern holds the colour's components laid out as they'd appear in the destination, and the
+    // same multiplier is used for every byte.
+    inline int blendBytesWithPattern (uint8* dest, int numBytes, const uint8* pattern, int numPatternVectors, uint32 invAlpha) noexcept
+    {
+        ignoreUnused (dest, pattern, numPatternVectors, invAlpha);
+        int done = 0;
+
+       #if JUCE_PIXEL_BLENDING_SSE2
+        auto zero = _mm_setzero_si128();
+        auto inv = _mm_set1_epi16 ((short) invAlpha);
+        __m128i srcLo[3], srcHi[3];
+
+        for (int i = 0; i < numPatternVectors; ++i)
+        {
+            auto s = _mm_loadu_si128 ((const __m128i*) (pattern + 16 * i));
+            srcLo[i] = _mm_unpacklo_epi8 (s, zero);
+            srcHi[i] = _mm_unpackhi_epi8 (s, zero);
+        }
+
+        for (auto chunkSize = 16 * numPatternVectors; done + chunkSize <= numBytes;)
+        {
+            for (int i = 0; i < numPatternVectors; ++i)
+            {
+                auto d = (__m128i*) (dest + done);
+                _mm_storeu_si128 (d, blendBytes16 (_mm_loadu_si128 (d), srcLo[i], srcHi[i], inv));
+                done += 16;
+            }
+        }
+       #elif JUCE_PIXEL_BLENDING_NEON
+        auto inv = vdupq_n_u16 ((uint16) invAlpha);
+        uint16x8_t srcLo[3], srcHi[3];
+
+        for (int i = 0; i < numPatternVectors; ++i)
+        {
+            auto s = vld1q_u8 (pattern + 16 * i);
+            srcLo[i] = vmovl_u8 (vget_low_u8 (s));
+            srcHi[i] = vmovl_u8 (vget_high_u8 (s));
+        }
+
+        for (auto chunkSize = 16 * numPatternVectors; done + chunkSize <= numBytes;)
+        {
+            for (int i = 0; i < numPatternVectors; ++i)
+            {
+                auto d = vld1q_u8 (dest + done);
+                vst1q_u8 (dest + done, vcombine_u8 (blendChannel8 (vget_low_u8 (d),  srcLo[i], inv),
+                                                    blendChannel8 (vget_high_u8 (d), srcHi[i], inv)));
+                done += 16;
+            }
+        }
+       #endif
+
+        return done;
+    }
+
+    //==============================================================================
+    /** Blends a run of source pixels onto a run of destination pixels. */
+    template <class DestPixelType, class SrcPixelType>
+    forcedinline void blendPixels (DestPixelType* dest, int destStride, const SrcPixelType* src, int srcStride, int width) noexcept
+    {
+        do
+        {
+            dest->blend (*src);
+            dest = addBytesToPointer (dest, destStride);
+            src  = addBytesToPointer (src, srcStride);
+        } while (--width > 0);
+    }
+
+    /** Blends a run of source pixels onto a run of destination pixels, applying an extra
+        multiplier to the source's opacity.
+    */
+    template <class DestPixelType, class SrcPixelType>
+    forcedinline void blendPixels (DestPixelType* dest, int destStride, const SrcPixelType* src, int srcStride, int width, uint32 extraAlpha) noexcept
+    {
+        do
+        {
+            dest->blend (*src, extraAlpha);
+            dest = addBytesToPointer (dest, destStride);
+            src  = addBytesToPointer (src, srcStride);
+        } while (--width > 0);
+    }
+
+    inline void blendPixels (PixelARGB* dest, int destStride, const PixelARGB* src, int srcStride, int width, uint32 extraAlpha) noexcept
+    {
+       #if JUCE_PIXEL_BLENDING_SIMD
+        if (destStride == (int) sizeof (PixelARGB) && srcStride == (int) sizeof (PixelARGB))
+        {
+            auto done = blendARGBSpan (dest, src, width, extraAlpha);
+
+            if (done == width)
+                return;
+
+            dest += done;
+            src += done;
+            width -= done;
+        }
+       #endif
+
+        do
+        {
+            dest->blend (*src, extraAlpha);
+            dest = addBytesToPointer (dest, destStride);
+            src  = addBytesToPointer (src, srcStride);
+        } while (--width > 0);
+    }
+
+    inline void blendPixels (PixelARGB* dest, int destStride, const PixelARGB* src, int srcStride, int width) noexcept
+    {
+       #if JUCE_PIXEL_BLENDING_SIMD
+        if (destStride == (int) sizeof (PixelARGB) && srcStride == (int) sizeof (PixelARGB))
+        {
+            // an extra alpha of 256 leaves the source unchanged
+            auto done = blendARGBSpan (dest, src, width, 0x100);
+
+            if (done == width)
+                return;
+
+            dest += done;
+            src += done;
+            width -= done;
+        }
+       #endif
+
+        do
+        {
+            dest->blend (*src);
+            dest = addBytesToPointer (dest, destStride);
+            src  = addBytesToPointer (src, srcStride);
+        } while (--width > 0);
+    }
+
+    //==============================================================================
+    /** Blends a solid colour onto a run of pixels. */
+    template <class PixelType>
+    forcedinline void blendColour (PixelType* dest, int destStride, PixelARGB colour, int width) noexcept
+    {
+        do
+        {
+            dest->blend (colour);
+            dest = addBytesToPointer (dest, destStride);
+        } while (--width > 0);
+    }
+
+    template <class PixelType, size_t numPatternPixels>
+    inline void blendColourUsingPattern (PixelType* dest, int destStride, PixelARGB colour, int width) noexcept
+    {
+       #if JUCE_PIXEL_BLENDING_SIMD
+        if (destStride == (int) sizeof (PixelType))
+        {
+            // The pattern is a whole number of 16-byte vectors, and a whole number of pixels
+            PixelType pattern[numPatternPixels];
+
+            for (auto& p : pattern)
+                p.set (colour);
+
+            auto numBytesDone = blendBytesWithPattern ((uint8*) dest, width * (int) sizeof (PixelType), (const uint8*) pattern,
+                                                       (int) (numPatternPixels * sizeof (PixelType) / 16), 0x100u - colour.getAlpha());
+            auto numDone = numBytesDone / (int) sizeof (PixelType);
+
+            if (numDone == width)
+                return;
+
+            dest += numDone;
+            width -= numDone;
+        }
+       #endif
+
+        do
+        {
+            dest->blend (colour);
+            dest = addBytesToPointer (dest, destStride);
+        } while (--width > 0);
+    }
+
+    inline void blendColour (PixelARGB* dest, int destStride, PixelARGB colour, int width) noexcept
+    {
+        blendColourUsingPattern<PixelARGB, 4> (dest, destStride, colour, width);
+    }
+
+    inline void blendColour (PixelRGB* dest, int destStride, PixelARGB colour, int width) noexcept
+    {
+        blendColourUsingPattern<PixelRGB, 16> (dest, destStride, colour, width);
+    }
+
+    inline void blendColour (PixelAlpha* dest, int destStride, PixelARGB colour, int width) noexcept
+    {
+        blendColourUsingPattern<PixelAlpha, 16> (dest, destStride, colour, width);
+    }
+}
+
+//==============================================================================
+/** Contains the loops that the image decoders use to turn rows of decoded RGB or RGBA
+    bytes into pixels, with SIMD versions of the common cases.
+
+    Each SIMD version produces exactly the same results as calling setARGB() and then
+    premultiply() on each pixel, so they can be used interchangeably.
+*/
+namespace PixelConversion
+{
+   #if JUCE_PIXEL_BLENDING_SSE2
+    // Returns which of the R, G, B, A source lanes ends up in the given lane of a PixelARGB
+    constexpr int getSourceLane (int lane) noexcept
+    {
+        return lane == PixelARGB::indexR ? 0 : (lane == PixelARGB::indexG ? 1 : (lane == PixelARGB::indexB ? 2 : 3));
+    }
+
+    enum { argbShuffle = getSourceLane (0) | (getSourceLane (1) << 2) | (getSourceLane (2) << 4) | (getSourceLane (3) << 6) };
+
+    forcedinline __m128i getAlphaLaneMultipliers() noexcept
+    {
+        return _mm_setr_epi16 (PixelARGB::indexA == 0 ? 256 : 0, PixelARGB::indexA == 1 ? 256 : 0,
+                               PixelARGB::indexA == 2 ? 256 : 0, PixelARGB::indexA == 3 ? 256 : 0,
+                               PixelARGB::indexA == 0 ? 256 : 0, PixelARGB::indexA == 1 ? 256 : 0,
+                               PixelARGB::indexA == 2 ? 256 : 0, PixelARGB::indexA == 3 ? 256 : 0);
+    }
+
+    // Swizzles and premultiplies 2 RGBA pixels that have been unpacked to 16-bit lanes. A multiplier
+    // of 256 leaves a component unchanged, so that's used for opaque pixels and for the alpha itself.
+    forcedinline __m128i premultiply2 (__m128i rgba, __m128i alphaLaneMultipliers) noexcept
+    {
+        auto alpha = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (rgba, 0xff), 0xff);
+        auto multiplier = _mm_max_epi16 (_mm_sub_epi16 (alpha, _mm_cmpeq_epi16 (alpha, _mm_set1_epi16 (0xff))),
+                                         alphaLaneMultipliers);
+        auto argb = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (rgba, argbShuffle), argbShuffle);
+
+        return _mm_srli_epi16 (_mm_add_epi16 (_mm_mullo_epi16 (argb, multiplier), _mm_set1_epi16 (0x7f)), 8);
+    }
+   #endif
+
+   #if JUCE_PIXEL_BLENDING_NEON
+    forcedinline uint8x8_t premultiplyChannel8 (uint8x8_t channel, uint16x8_t multiplier) noexcept
+    {
+        return vshrn_n_u16 (vaddq_u16 (vmulq_u16 (vmovl_u8 (channel), multiplier), vdupq_n_u16 (0x7f)), 8);
+    }
 
-    //==============================================================================
-    int left, top, right, bottom;  // bounds of the solid central area, excluding anti-aliased edges
-    int totalTop, totalLeft, totalBottom, totalRight; // bounds of the total area, including edges
-    int topAlpha, leftAlpha, bottomAlpha, rightAlpha; // alpha of each anti-aliased edge
-};
+    // Loads 8 pixels' worth of R, G and B bytes, from source pixels that are either 3 or 4 bytes wide
+    forcedinline uint8x8x3_t loadRGB8 (const uint8* src, int srcStride) noexcept
+    {
+        if (srcStride == 3)
+            return vld3_u8 (src);
 
-//==============================================================================
-/** Contains classes for calculating the colour of pixels within various types of gradient. */
-namespace GradientPixelIterators
-{
-    /** Iterates the colour of pixels in a linear gradient */
-    struct Linear
+        auto rgbx = vld4_u8 (src);
+        return { { rgbx.val[0], rgbx.val[1], rgbx.val[2] } };
+    }
+   #endif
+
+    // Converts a contiguous run of straight-alpha RGBA bytes to premultiplied ARGB, returning
+    // the number of pixels that were done. If ignoreAlpha is true, the pixels are made opaque.
+    inline int convertRGBASpan (PixelARGB* dest, const uint8* src, int width, bool ignoreAlpha) noexcept
     {
-        Linear (const ColourGradient& gradient, const AffineTransform& transform,
-                const PixelARGB* colours, int numColours)
-            : lookupTable (colours),
-              numEntries (numColours)
-        {
-            jassert (numColours >= 0);
-            auto p1 = gradient.point1;
-            auto p2 = gradient.point2;
+        ignoreUnused (dest, src, ignoreAlpha);
+        int done = 0;
 
-            if (! transform.isIdentity())
-            {
-                auto p3 = Line<float> (p2, p1).getPointAlongLine (0.0f, 100.0f);
+       #if JUCE_PIXEL_BLENDING_SSE2
+        auto zero = _mm_setzero_si128();
+        auto alphaLaneMultipliers = getAlphaLaneMultipliers();
+        auto opaque = _mm_set1_epi32 (ignoreAlpha ? (int) 0xff000000 : 0);
 
-                p1.applyTransform (transform);
-                p2.applyTransform (transform);
-                p3.applyTransform (transform);
+        for (; done + 4 <= width; done += 4)
+        {
+            auto s = _mm_or_si128 (_mm_loadu_si128 ((const __m128i*) (src + done * 4)), opaque);
 
-                p2 = Line<float> (p2, p3).findNearestPointTo (p1);
-            }
+            _mm_storeu_si128 ((__m128i*) (dest + done),
+                              _mm_packus_epi16 (premultiply2 (_mm_unpacklo_epi8 (s, zero), alphaLaneMultipliers),
+                                                premultiply2 (_mm_unpackhi_epi8 (s, zero), alphaLaneMultipliers)));
+        }
+       #elif JUCE_PIXEL_BLENDING_NEON
+        auto k255 = vdup_n_u8 (0xff);
 
-            vertical   = std::abs (p1.x - p2.x) < 0.001f;
-            horizontal = std::abs (p1.y - p2.y) < 0.001f;
+        for (; done + 8 <= width; done += 8)
+        {
+            auto s = vld4_u8 (src + done * 4);
+            uint8x8x4_t d;
 
-            if (vertical)
-            {
-                scale = roundToInt ((numEntries << (int) numScaleBits) / (double) (p2.y - p1.y));
-                start = roundToInt (p1.y * (float) scale);
-            }
-            else if (horizontal)
+            if (ignoreAlpha)
             {
-                scale = roundToInt ((numEntries << (int) numScaleBits) / (double) (p2.x - p1.x));
-                start = roundToInt (p1.x * (float) scale);
+                d.val[PixelARGB::indexR] = s.val[0];
+                d.val[PixelARGB::indexG] = s.val[1];
+                d.val[PixelARGB::indexB] = s.val[2];
+                d.val[PixelARGB::indexA] = k255;
             }
             else
             {
-                grad = (p2.getY() - p1.y) / (double) (p1.x - p2.x);
-                yTerm = p1.getY() - p1.x / grad;
-                scale = roundToInt ((numEntries << (int) numScaleBits) / (yTerm * grad - (p2.y * grad - p2.x)));
-                grad *= scale;
+                auto alpha = s.val[3];
+                auto multiplier = vaddw_u8 (vmovl_u8 (alpha), vshr_n_u8 (vceq_u8 (alpha, k255), 7));
+
+                d.val[PixelARGB::indexR] = premultiplyChannel8 (s.val[0], multiplier);
+                d.val[PixelARGB::indexG] = premultiplyChannel8 (s.val[1], multiplier);
+                d.val[PixelARGB::indexB] = premultiplyChannel8 (s.val[2], multiplier);
+                d.val[PixelARGB::indexA] = alpha;
             }
-        }
 
-        forcedinline void setY (int y) noexcept
-        {
-            if (vertical)
-                linePix = lookupTable[jlimit (0, numEntries, (y * scale - start) >> (int) numScaleBits)];
-            else if (! horizontal)
-                start = roundToInt ((y - yTerm) * grad);
+            vst4_u8 ((uint8*) (dest + done), d);
         }
+       #endif
 
-        inline PixelARGB getPixel (int x) const noexcept
+        return done;
+    }
+
+   #if JUCE_PIXEL_BLENDING_NEON
+    // Converts a contiguous run of RGB pixels that are either 3 or 4 bytes wide, returning
+    // the number of pixels that were done. There's no SSE2 version, because without a byte
+    // shuffle instruction, re-ordering 3-byte pixels costs more than the scalar loop.
+    inline int convertRGBSpan (PixelRGB* dest, const uint8* src, int srcStride, int width) noexcept
+    {
+        int done = 0;
+
+        for (; done + 8 <= width; done += 8)
         {
-            return vertical ? linePix
-                            : lookupTable[jlimit (0, numEntries, (x * scale - start) >> (int) numScaleBits)];
-        }
+            auto s = loadRGB8 (src + done * srcStride, srcStride);
+            uint8x8x3_t d;
 
-        const PixelARGB* const lookupTable;
-        const int numEntries;
-        PixelARGB linePix;
-        int start, scale;
-        double grad, yTerm;
-        bool vertical, horizontal;
-        enum { numScaleBits = 12 };
+            d.val[PixelRGB::indexR] = s.val[0];
+            d.val[PixelRGB::indexG] = s.val[1];
+            d.val[PixelRGB::indexB] = s.val[2];
 
-        JUCE_DECLARE_NON_COPYABLE (Linear)
-    };
+            vst3_u8 ((uint8*) (dest + done), d);
+        }
+
+        return done;
+    }
+   #endif
 
     //==============================================================================
-    /** Iterates the colour of pixels in a circular radial gradient */
-    struct Radial
+    /** Converts a row of straight-alpha RGBA bytes, as decoded from a PNG, to premultiplied ARGB pixels. */
+    inline void convertRGBAToARGB (PixelARGB* dest, int destStride, const uint8* src, int width) noexcept
     {
-        Radial (const ColourGradient& gradient, const AffineTransform&,
-                const PixelARGB* colours, int numColours)
-            : lookupTable (colours),
-              numEntries (numColours),
-              gx1 (gradient.point1.x),
-              gy1 (gradient.point1.y)
+       #if JUCE_PIXEL_BLENDING_SIMD
+        if (destStride == (int) sizeof (PixelARGB))
         {
-            jassert (numColours >= 0);
-            auto diff = gradient.point1 - gradient.point2;
-            maxDist = diff.x * diff.x + diff.y * diff.y;
-            invScale = numEntries / std::sqrt (maxDist);
-            jassert (roundToInt (std::sqrt (maxDist) * invScale) <= numEntries);
+            auto done = convertRGBASpan (dest, src, width, false);
+            dest += done;
+            src += done * 4;
+            width -= done;
         }
+       #endif
 
-        forcedinline void setY (int y) noexcept
+        for (; width > 0; --width)
         {
-            dy = y - gy1;
-            dy *= dy;
+            dest->setARGB (src[3], src[0], src[1], src[2]);
+            dest->premultiply();
+            dest = addBytesToPointer (dest, destStride);
+            src += 4;
         }
+    }
 
-        inline PixelARGB getPixel (int px) const noexcept
-        {
-            auto x = px - gx1;
-            x *= x;
-            x += dy;
+    /** Converts a row of RGB pixels, which are either 3 or 4 bytes wide, to opaque ARGB pixels. */
+    inline void convertRGBToARGB (PixelARGB* dest, int destStride, const uint8* src, int srcStride, int width) noexcept
+    {
+        jassert (srcStride == 3 || srcStride == 4);
 
-            return lookupTable[x >= maxDist ? numEntries : roundToInt (std::sqrt (x) * invScale)];
+       #if JUCE_PIXEL_BLENDING_SSE2
+        if (destStride == (int) sizeof (PixelARGB) && srcStride == 4)
+        {
+            auto done = convertRGBASpan (dest, src, width, true);
+            dest += done;
+            src += done * 4;
+            width -= done;
         }
+       #elif JUCE_PIXEL_BLENDING_NEON
+        if (destStride == (int) sizeof (PixelARGB))
+        {
+            auto k255 = vdup_n_u8 (0xff);
+            int done = 0;
 
-        const PixelARGB* const lookupTable;
-        const int numEntries;
-        const double gx1, gy1;
-        double maxDist, invScale, dy;
+            for (; done + 8 <= width; done += 8)
+            {
+                auto s = loadRGB8 (src + done * srcStride, srcStride);
+                uint8x8x4_t d;
 
-        JUCE_DECLARE_NON_COPYABLE (Radial)
-    };
+                d.val[PixelARGB::indexR] = s.val[0];
+                d.val[PixelARGB::indexG] = s.val[1];
+                d.val[PixelARGB::indexB] = s.val[2];
+                d.val[PixelARGB::indexA] = k255;
 
-    //==============================================================================
-    /** Iterates the colour of pixels in a skewed radial gradient */
-    struct TransformedRadial   : public Radial
+                vst4_u8 ((uint8*) (dest + done), d);
+            }
+
+            dest += done;
+            src += done * srcStride;
+            width -= done;
+        }
+       #endif
+
+        for (; width > 0; --width)
+        {
+            dest->setARGB (0xff, src[0], src[1], src[2]);
+            dest = addBytesToPointer (dest, destStride);
+            src += srcStride;
+        }
+    }
+
+    /** Converts a row of RGB pixels, which are either 3 or 4 bytes wide, to RGB pixels. */
+    inline void convertRGBToRGB (PixelRGB* dest, int destStride, const uint8* src, int srcStride, int width) noexcept
     {
-        TransformedRadial (const ColourGradient& gradient, const AffineTransform& transform,
-                           const PixelARGB* colours, int numColours)
-            : Radial (gradient, transform, colours, numColours),
-              inverseTransform (transform.inverted())
+        jassert (srcStride == 3 || srcStride == 4);
+
+       #if JUCE_PIXEL_BLENDING_NEON
+        if (destStride == (int) sizeof (PixelRGB))
         {
-            tM10 = inverseTransform.mat10;
-            tM00 = inverseTransform.mat00;
+            auto done = convertRGBSpan (dest, src, srcStride, width);
+            dest += done;
+            src += done * srcStride;
+            width -= done;
         }
+       #endif
 
-        forcedinline void setY (int y) noexcept
+        for (; width > 0; --width)
         {
-            auto floatY = (float) y;
-            lineYM01 = inverseTransform.mat01 * floatY + inverseTransform.mat02 - gx1;
-            lineYM11 = inverseTransform.mat11 * floatY + inverseTransform.mat12 - gy1;
+            dest->setARGB (0xff, src[0], src[1], src[2]);
+            dest = addBytesToPointer (dest, destStride);
+            src += srcStride;
         }
+    }
+}
 
-        inline PixelARGB getPixel (int px) const noexcept
+//==============================================================================
+/** Contains the loops that reduce runs of sample values down to their range, for drawing
+    waveforms, with SIMD versions of the common cases.
+*/
+namespace SampleRanges
+{
+    /** Returns the lowest and highest of a set of values. */
+    inline Range<float> findMinAndMax (const float* values, int num) noexcept
+    {
+        jassert (num > 0);
+        auto lowest = values[0], highest = values[0];
+        int done = 0;
+
+       #if JUCE_PIXEL_BLENDING_SSE2
+        if (num >= 8)
         {
-            double x = px;
-            auto y = tM10 * x + lineYM11;
-            x = tM00 * x + lineYM01;
-            x *= x;
-            x += y * y;
+            auto mn = _mm_loadu_ps (values);
+            auto mx = mn;
 
-            if (x >= maxDist)
-                return lookupTable[numEntries];
+            for (done = 4; done + 4 <= num; done += 4)
+            {
+                auto v = _mm_loadu_ps (values + done);
+                mn = _mm_min_ps (mn, v);
+                mx = _mm_max_ps (mx, v);
+            }
 
-            return lookupTable[jmin (numEntries, roundToInt (std::sqrt (x) * invScale))];
+            mn = _mm_min_ps (mn, _mm_shuffle_ps (mn, mn, _MM_SHUFFLE (1, 0, 3, 2)));
+            mx = _mm_max_ps (mx, _mm_shuffle_ps (mx, mx, _MM_SHUFFLE (1, 0, 3, 2)));
+            lowest  = _mm_cvtss_f32 (_mm_min_ss (mn, _mm_shuffle_ps (mn, mn, _MM_SHUFFLE (2, 3, 0, 1))));
+            highest = _mm_cvtss_f32 (_mm_max_ss (mx, _mm_shuffle_ps (mx, mx, _MM_SHUFFLE (2, 3, 0, 1))));
         }
+       #elif JUCE_PIXEL_BLENDING_NEON
+        if (num >= 8)
+        {
+            auto mn = vld1q_f32 (values);
+            auto mx = mn;
 
-    private:
-        double tM10, tM00, lineYM01, lineYM11;
-        const AffineTransform inverseTransform;
+            for (done = 4; done + 4 <= num; done += 4)
+            {
+                auto v = vld1q_f32 (values + done);
+                mn = vminq_f32 (mn, v);
+                mx = vmaxq_f32 (mx, v);
+            }
 
-        JUCE_DECLARE_NON_COPYABLE (TransformedRadial)
-    };
-}
+            auto mn2 = vpmin_f32 (vget_low_f32 (mn), vget_high_f32 (mn));
+            auto mx2 = vpmax_f32 (vget_low_f32 (mx), vget_high_f32 (mx));
+            lowest  = vget_lane_f32 (vpmin_f32 (mn2, mn2), 0);
+            highest = vget_lane_f32 (vpmax_f32 (mx2, mx2), 0);
+        }
+       #endif
 
-#define JUCE_PERFORM_PIXEL_OP_LOOP(op) \
-{ \
-    const int destStride = destData.pixelStride;  \
-    do { dest->op; dest = addBytesToPointer (dest, destStride); } while (--width > 0); \
+        for (; done < num; ++done)
+        {
+            lowest  = jmin (lowest,  values[done]);
+            highest = jmax (highest, values[done]);
+        }
+
+        return { lowest, highest };
+    }
 }
 
 //==============================================================================
@@ -667,7 +2052,7 @@ namespace EdgeTableFillers
 
         inline void blendLine (PixelType* dest, PixelARGB colour, int width) const noexcept
         {
-            JUCE_PERFORM_PIXEL_OP_LOOP (blend (colour))
+            SpanBlending::blendColour (dest, destData.pixelStride, colour, width);
         }
 
         forcedinline void replaceLine (PixelRGB* dest, PixelARGB colour, int width) const noexcept
@@ -724,18 +2109,12 @@ namespace EdgeTableFillers
 
         void handleEdgeTableLine (int x, int width, int alphaLevel) const noexcept
         {
-            auto* dest = getPixel (x);
-
-            if (alphaLevel < 0xff)
-                JUCE_PERFORM_PIXEL_OP_LOOP (blend (GradientType::getPixel (x++), (uint32) alphaLevel))
-            else
-                JUCE_PERFORM_PIXEL_OP_LOOP (blend (GradientType::getPixel (x++)))
+            blendLine (x, width, alphaLevel < 0xff ? (uint32) alphaLevel : 0x100u);
         }
 
         void handleEdgeTableLineFull (int x, int width) const noexcept
         {
-            auto* dest = getPixel (x);
-            JUCE_PERFORM_PIXEL_OP_LOOP (blend (GradientType::getPixel (x++)))
+            blendLine (x, width, 0x100u);
         }
 
         void handleEdgeTableRectangle (int x, int y, int width, int height, int alphaLevel) noexcept
@@ -765,6 +2144,29 @@ namespace EdgeTableFillers
             return addBytesToPointer (linePixels, x * destData.pixelStride);
         }
 
+        // The colours are generated a chunk at a time, so that they can be blended as a run
+        void blendLine (int x, int width, uint32 alphaLevel) const noexcept
+        {
+            auto* dest = getPixel (x);
+            PixelARGB colours[32];
+
+            while (width > 0)
+            {
+                auto num = jmin (width, (int) numElementsInArray (colours));
+
+                for (int i = 0; i < num; ++i)
+                    colours[i] = GradientType::getPixel (x++);
+
+                if (alphaLevel < 0x100)
+                    SpanBlending::blendPixels (dest, destData.pixelStride, colours, (int) sizeof (PixelARGB), num, alphaLevel);
+                else
+                    SpanBlending::blendPixels (dest, destData.pixelStride, colours, (int) sizeof (PixelARGB), num);
+
+                dest = addBytesToPointer (dest, num * destData.pixelStride);
+                width -= num;
+            }
+        }
+
         JUCE_DECLARE_NON_COPYABLE (Gradient)
     };
 
@@ -816,17 +2218,14 @@ namespace EdgeTableFillers
 
             if (repeatPattern)
             {
-                if (alphaLevel < 0xfe)
-                    JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (x++ % srcData.width), (uint32) alphaLevel))
-                else
-                    JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (x++ % srcData.width)))
+                blendRepeatingLine (dest, x, width, alphaLevel < 0xfe ? (uint32) alphaLevel : 0x100u);
             }
             else
             {
                 jassert (x >= 0 && x + width <= srcData.width);
 
                 if (alphaLevel < 0xfe)
-                    JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (x++), (uint32) alphaLevel))
+                    SpanBlending::blendPixels (dest, destData.pixelStride, getSrcPixel (x), srcData.pixelStride, width, (uint32) alphaLevel);
                 else
                     copyRow (dest, getSrcPixel (x), width);
             }
@@ -839,17 +2238,14 @@ namespace EdgeTableFillers
 
             if (repeatPattern)
             {
-                if (extraAlpha < 0xfe)
-                    JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (x++ % srcData.width), (uint32) extraAlpha))
-                else
-                    JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (x++ % srcData.width)))
+                blendRepeatingLine (dest, x, width, extraAlpha < 0xfe ? (uint32) extraAlpha : 0x100u);
             }
             else
             {
                 jassert (x >= 0 && x + width <= srcData.width);
 
                 if (extraAlpha < 0xfe)
-                    JUCE_PERFORM_PIXEL_OP_LOOP (blend (*getSrcPixel (x++), (uint32) extraAlpha))
+                    SpanBlending::blendPixels (dest, destData.pixelStride, getSrcPixel (x), srcData.pixelStride, width, (uint32) extraAlpha);
                 else
                     copyRow (dest, getSrcPixel (x), width);
             }
@@ -915,12 +2311,26 @@ namespace EdgeTableFillers
             }
             else
             {
-                do
-                {
-                    dest->blend (*src);
-                    dest = addBytesToPointer (dest, destStride);
-                    src  = addBytesToPointer (src, srcStride);
-                } while (--width > 0);
+                SpanBlending::blendPixels (dest, destStride, src, srcStride, width);
+            }
+        }
+
+        // Blends the line in runs that don't cross the right-hand edge of the source image
+        void blendRepeatingLine (DestPixelType* dest, int x, int width, uint32 alphaLevel) const noexcept
+        {
+            while (width > 0)
+            {
+                auto srcX = x % srcData.width;
+                auto num = jmin (width, srcData.width - srcX);
+
+                if (alphaLevel < 0x100)
+                    SpanBlending::blendPixels (dest, destData.pixelStride, getSrcPixel (srcX), srcData.pixelStride, num, alphaLevel);
+                else
+                    SpanBlending::blendPixels (dest, destData.pixelStride, getSrcPixel (srcX), srcData.pixelStride, num);
+
+                dest = addBytesToPointer (dest, num * destData.pixelStride);
+                x += num;
+                width -= num;
             }
         }
 
@@ -985,9 +2395,9 @@ namespace EdgeTableFillers
             alphaLevel >>= 8;
 
             if (alphaLevel < 0xfe)
-                JUCE_PERFORM_PIXEL_OP_LOOP (blend (*span++, (uint32) alphaLevel))
+                SpanBlending::blendPixels (dest, destData.pixelStride, span, (int) sizeof (SrcPixelType), width, (uint32) alphaLevel);
             else
-                JUCE_PERFORM_PIXEL_OP_LOOP (blend (*span++))
+                SpanBlending::blendPixels (dest, destData.pixelStride, span, (int) sizeof (SrcPixelType), width);
         }
 
         forcedinline void handleEdgeTableLineFull (int x, int width) noexcept
@@ -1627,7 +3037,12 @@ struct ClipRegions
         EdgeTableRegion (Rectangle<float> r)            : edgeTable (r) {}
         EdgeTableRegion (const RectangleList<int>& r)   : edgeTable (r) {}
         EdgeTableRegion (const RectangleList<float>& r) : edgeTable (r) {}
-        EdgeTableRegion (Rectangle<int> bounds, const Path& p, const AffineTransform& t) : edgeTable (bounds, p, t) {}
+        EdgeTableRegion (Rectangle<int> bounds, const Path& p, const AffineTransform& t,
+                         EdgeTable::PathRasteriser r = EdgeTable::PathRasteriser::subScanline)
+            : edgeTable (bounds, p, t, r) {}
+
+        EdgeTableRegion (Rectangle<int> bounds, int x, const Range<float>* spans, int numSpans)
+            : edgeTable (bounds, x, spans, numSpans) {}
 
         EdgeTableRegion (const EdgeTableRegion& other)  : Base(), edgeTable (other.edgeTable) {}
         EdgeTableRegion& operator= (const EdgeTableRegion&) = delete;
@@ -2049,20 +3464,23 @@ public:
 
     SavedStateBase (Rectangle<int> initialClip)
         : clip (new RectangleListRegionType (initialClip)),
-          interpolationQuality (Graphics::mediumResamplingQuality), transparencyLayerAlpha (1.0f)
+          interpolationQuality (Graphics::mediumResamplingQuality), transparencyLayerAlpha (1.0f),
+          pathRasteriser (EdgeTable::PathRasteriser::subScanline)
     {
     }
 
     SavedStateBase (const RectangleList<int>& clipList, Point<int> origin)
         : clip (new RectangleListRegionType (clipList)), transform (origin),
-          interpolationQuality (Graphics::mediumResamplingQuality), transparencyLayerAlpha (1.0f)
+          interpolationQuality (Graphics::mediumResamplingQuality), transparencyLayerAlpha (1.0f),
+          pathRasteriser (EdgeTable::PathRasteriser::subScanline)
     {
     }
 
     SavedStateBase (const SavedStateBase& other)
         : clip (other.clip), transform (other.transform), fillType (other.fillType),
           interpolationQuality (other.interpolationQuality),
-          transparencyLayerAlpha (other.transparencyLayerAlpha)
+          transparencyLayerAlpha (other.transparencyLayerAlpha),
+          pathRasteriser (other.pathRasteriser)
     {
     }
 
@@ -2328,10 +3746,51 @@ public:
             auto clipRect = clip->getClipBounds();
 
             if (path.getBoundsTransformed (trans).getSmallestIntegerContainer().intersects (clipRect))
-                fillShape (*new EdgeTableRegionType (clipRect, path, trans), false);
+            {
+                Point<int> offset;
+
+                if (auto cached = PathCache::getInstance().findOrCreateEdgeTable (path, trans, pathRasteriser, offset))
+                {
+                    auto* edgeTableClip = new EdgeTableRegionType (*cached->edgeTable);
+                    edgeTableClip->edgeTable.clipToRectangle (clipRect - offset);
+                    edgeTableClip->edgeTable.translate ((float) offset.x, offset.y);
+                    fillShape (*edgeTableClip, false);
+                }
+                else
+                {
+                    fillShape (*new EdgeTableRegionType (clipRect, path, trans, pathRasteriser), false);
+                }
+            }
         }
     }
 
+    bool fillVerticalSpans (Rectangle<float> area, const Range<float>* spans, int numSpans)
+    {
+        if (clip == nullptr)
+            return true;
+
+        // the spans can only be drawn as columns of pixels if they aren't rotated or skewed
+        if (transform.isRotated)
+            return false;
+
+        auto t = transform.getTransform();
+        auto deviceArea = area.transformedBy (t);
+
+        // ..and if each one covers a single column
+        if (std::abs (deviceArea.getWidth() - (float) numSpans) >= 1.0f)
+            return false;
+
+        HeapBlock<Range<float>> deviceSpans ((size_t) numSpans);
+
+        for (int i = 0; i < numSpans; ++i)
+            deviceSpans[i] = { spans[i].getStart() * t.mat11 + t.mat12,
+                               spans[i].getEnd()   * t.mat11 + t.mat12 };
+
+        fillShape (*new EdgeTableRegionType (clip->getClipBounds(), roundToInt (deviceArea.getX()),
+                                             deviceSpans, numSpans), false);
+        return true;
+    }
+
     void fillEdgeTable (const EdgeTable& edgeTable, float x, int y)
     {
         if (clip != nullptr)
@@ -2474,6 +3933,7 @@ public:
     FillType fillType;
     Graphics::ResamplingQuality interpolationQuality;
     float transparencyLayerAlpha;
+    EdgeTable::PathRasteriser pathRasteriser;
 };
 
 //==============================================================================
@@ -2524,7 +3984,7 @@ public:
         }
     }
 
-    using GlyphCacheType = GlyphCache<CachedGlyphEdgeTable<SoftwareRendererSavedState>, SoftwareRendererSavedState>;
+    using GlyphCacheType = GlyphCache<CachedGlyphBitmap<SoftwareRendererSavedState>, SoftwareRendererSavedState>;
 
     static void clearGlyphCache()
     {
@@ -2567,7 +4027,13 @@ public:
                 auto t = transform.getTransformWith (AffineTransform::scale (fontHeight * font.getHorizontalScale(), fontHeight)
                                                                      .followedBy (trans));
 
-                std::unique_ptr<EdgeTable> et (font.getTypeface()->getEdgeTableForGlyph (glyphNumber, t, fontHeight));
+                auto* typeface = font.getTypeface();
+                std::unique_ptr<EdgeTable> et;
+
+                {
+                    const ScopedLock sl (getGlyphCreationLock (*typeface));
+                    et.reset (typeface->getEdgeTableForGlyph (glyphNumber, t, fontHeight));
+                }
 
                 if (et != nullptr)
                     fillShape (*new EdgeTableRegionType (*et), false);
@@ -2577,6 +4043,29 @@ public:
 
     Rectangle<int> getMaximumBounds() const     { return image.getBounds(); }
 
+    // Fills an area with the current colour, using a single-channel image of alpha levels as a
+    // mask. This only handles solid colours and rectangular clip regions, so returns false if it
+    // couldn't draw it and the caller needs to fill an edge-table instead.
+    bool fillGlyphBitmap (const uint8* levels, int lineStride, Rectangle<int> area)
+    {
+        auto* rectangleClip = dynamic_cast<RectangleListRegionType*> (clip.get());
+
+        if (rectangleClip == nullptr || ! fillType.isColour())
+            return false;
+
+        if (rectangleClip->clip.intersectsRectangle (area))
+        {
+            // this matches the brightening in fillEdgeTable()
+            auto brightness = fillType.colour.getBrightness() - 0.5f;
+            auto levelMultiplier = brightness > 0.0f ? (int) ((1.0f + 1.6f * brightness) * 256.0f) : 256;
+
+            GlyphBitmapIterator iter { levels, lineStride, area, rectangleClip->clip, levelMultiplier };
+            fillWithSolidColour (iter, fillType.colour.getPixelARGB(), false);
+        }
+
+        return true;
+    }
+
     //==============================================================================
     template <typename IteratorType>
     void renderImageTransformed (IteratorType& iter, const Image& src, int alpha, const AffineTransform& trans, Graphics::ResamplingQuality quality, bool tiledFill) const
@@ -2633,6 +4122,59 @@ public:
     Font font;
 
 private:
+    struct GlyphBitmapIterator
+    {
+        const uint8* levels;
+        int lineStride;
+        Rectangle<int> area;
+        const RectangleList<int>& clip;
+        int levelMultiplier;
+
+        template <class Renderer>
+        void iterate (Renderer& r) const noexcept
+        {
+            for (auto& clipRect : clip)
+            {
+                auto rect = clipRect.getIntersection (area);
+
+                if (rect.isEmpty())
+                    continue;
+
+                for (int y = rect.getY(); y < rect.getBottom(); ++y)
+                {
+                    auto* line = levels + (y - area.getY()) * lineStride - area.getX();
+                    r.setEdgeTableYPos (y);
+
+                    for (int x = rect.getX(); x < rect.getRight();)
+                    {
+                        auto level = (int) line[x];
+
+                        if (levelMultiplier != 256)
+                            level = jmin (255, (level * levelMultiplier) >> 8);
+
+                        if (level >= 255)
+                        {
+                            // runs of solid pixels are drawn in one go..
+                            auto runStart = x;
+
+                            while (++x < rect.getRight() && line[x] == line[runStart])
+                            {}
+
+                            r.handleEdgeTableLineFull (runStart, x - runStart);
+                        }
+                        else
+                        {
+                            if (level > 0)
+                                r.handleEdgeTablePixel (x, level);
+
+                            ++x;
+                        }
+                    }
+                }
+            }
+        }
+    };
+
     SoftwareRendererSavedState& operator= (const SoftwareRendererSavedState&) = delete;
 };
 
@@ -2717,10 +4259,18 @@ public:
     void setFill (const FillType& fillType) override                             { stack->setFillType (fillType); }
     void setOpacity (float newOpacity) override                                  { stack->fillType.setOpacity (newOpacity); }
     void setInterpolationQuality (Graphics::ResamplingQuality quality) override  { stack->interpolationQuality = quality; }
+    void setPathRasteriser (EdgeTable::PathRasteriser rasteriser) override       { stack->pathRasteriser = rasteriser; }
     void fillRect (const Rectangle<int>& r, bool replace) override               { stack->fillRect (r, replace); }
     void fillRect (const Rectangle<float>& r) override                           { stack->fillRect (r); }
     void fillRectList (const RectangleList<float>& list) override                { stack->fillRectList (list); }
     void fillPath (const Path& path, const AffineTransform& t) override          { stack->fillPath (path, t); }
+
+    void fillVerticalSpans (Rectangle<float> area, const Range<float>* spans, int numSpans) override
+    {
+        if (! stack->fillVerticalSpans (area, spans, numSpans))
+            LowLevelGraphicsContext::fillVerticalSpans (area, spans, numSpans);
+    }
+
     void drawImage (const Image& im, const AffineTransform& t) override          { stack->drawImage (im, t); }
     void drawGlyph (int glyphNumber, const AffineTransform& t) override          { stack->drawGlyph (glyphNumber, t); }
     void drawLine (const Line<float>& line) override                             { stack->drawLine (line); }
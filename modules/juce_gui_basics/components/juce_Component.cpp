@@ -447,6 +447,37 @@ struct Component::ComponentHelpers
         return wasClipped;
     }
 
+    static Rectangle<int> getAreaNotObscuredBySiblings (const Component& comp, Rectangle<int> areaInParent)
+    {
+        auto& siblings = comp.parentComponent->childComponentList;
+        RectangleList<int> visibleArea (areaInParent);
+
+        for (int i = siblings.indexOf (const_cast<Component*> (&comp)) + 1; i < siblings.size(); ++i)
+        {
+            auto& sibling = *siblings.getUnchecked (i);
+
+            if (sibling.isVisible() && sibling.isOpaque() && sibling.componentTransparency == 0
+                 && ! sibling.isTransformed() && sibling.boundsRelativeToParent.intersects (areaInParent))
+            {
+                visibleArea.subtract (sibling.boundsRelativeToParent);
+
+                if (visibleArea.isEmpty())
+                    return {};
+            }
+        }
+
+        return visibleArea.getBounds();
+    }
+
+    static ComponentPaintProfiler* getActivePaintProfiler() noexcept
+    {
+        if (auto* profiler = ComponentPaintProfiler::getInstanceWithoutCreating())
+            if (profiler->isEnabled())
+                return profiler;
+
+        return nullptr;
+    }
+
     static Rectangle<int> getParentOrMainMonitorBounds (const Component& comp)
     {
         if (auto* p = comp.getParentComponent())
@@ -1872,6 +1903,10 @@ void Component::internalRepaintUnchecked (Rectangle<int> area, bool isEntireComp
         if (area.isEmpty())
             return;
 
+        if (flags.hasHeavyweightPeerFlag || parentComponent == nullptr)
+            if (auto* profiler = ComponentHelpers::getActivePaintProfiler())
+                profiler->repaintRequested (*this, area);
+
         if (flags.hasHeavyweightPeerFlag)
         {
             if (auto* peer = getPeer())
@@ -1887,7 +1922,14 @@ void Component::internalRepaintUnchecked (Rectangle<int> area, bool isEntireComp
         else
         {
             if (parentComponent != nullptr)
-                parentComponent->internalRepaint (ComponentHelpers::convertToParentSpace (*this, area));
+            {
+                // any part of the area that's behind an opaque sibling can't be seen, so
+                // only the rest of it needs to be repainted
+                auto visibleArea = ComponentHelpers::getAreaNotObscuredBySiblings (*this, ComponentHelpers::convertToParentSpace (*this, area));
+
+                if (! visibleArea.isEmpty())
+                    parentComponent->internalRepaint (visibleArea);
+            }
         }
     }
 }
@@ -1919,6 +1961,8 @@ void Component::paintWithinParentContext (Graphics& g)
 void Component::paintComponentAndChildren (Graphics& g)
 {
     auto clipBounds = g.getClipBounds();
+    auto* profiler = ComponentHelpers::getActivePaintProfiler();
+    auto paintStartTicks = profiler != nullptr ? Time::getHighResolutionTicks() : 0;
 
     if (flags.dontClipGraphicsFlag)
     {
@@ -1932,6 +1976,8 @@ void Component::paintComponentAndChildren (Graphics& g)
             paint (g);
     }
 
+    auto paintTicks = profiler != nullptr ? Time::getHighResolutionTicks() - paintStartTicks : 0;
+
     for (int i = 0; i < childComponentList.size(); ++i)
     {
         auto& child = *childComponentList.getUnchecked (i);
@@ -1978,7 +2024,17 @@ void Component::paintComponentAndChildren (Graphics& g)
     }
 
     Graphics::ScopedSaveState ss (g);
-    paintOverChildren (g);
+
+    if (profiler != nullptr)
+    {
+        auto overChildrenStartTicks = Time::getHighResolutionTicks();
+        paintOverChildren (g);
+        profiler->componentPainted (*this, clipBounds, paintTicks + Time::getHighResolutionTicks() - overChildrenStartTicks);
+    }
+    else
+    {
+        paintOverChildren (g);
+    }
 }
 
 void Component::paintEntireComponent (Graphics& g, bool ignoreAlphaLevel)
@@ -0,0 +1,508 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+ComponentPaintProfiler::ComponentPaintProfiler() {}
+
+ComponentPaintProfiler::~ComponentPaintProfiler()
+{
+    clearSingletonInstance();
+}
+
+JUCE_IMPLEMENT_SINGLETON (ComponentPaintProfiler)
+
+//==============================================================================
+void ComponentPaintProfiler::setEnabled (bool shouldBeEnabled)
+{
+    if (enabled != shouldBeEnabled)
+    {
+        enabled = shouldBeEnabled;
+        pendingRepaints.clear();
+
+        if (! enabled)
+            setOverlayVisible (false);
+    }
+}
+
+void ComponentPaintProfiler::setOverlayVisible (bool shouldBeVisible)
+{
+    if (shouldBeVisible)
+        setEnabled (true);
+
+    if (overlayVisible != shouldBeVisible)
+    {
+        overlayVisible = shouldBeVisible;
+        repaintAllWindows();
+    }
+}
+
+void ComponentPaintProfiler::reset()
+{
+    components.clear();
+    pendingRepaints.clear();
+    frames.clear();
+    lastFrameComponent = nullptr;
+    lastInvalidRegion.clear();
+    lastPaintedAreas.clear();
+    lastPaintTimes.clear();
+}
+
+void ComponentPaintProfiler::repaintAllWindows()
+{
+    for (int i = ComponentPeer::getNumPeers(); --i >= 0;)
+        ComponentPeer::getPeer (i)->getComponent().repaint();
+}
+
+//==============================================================================
+Array<ComponentPaintProfiler::ComponentStatistics> ComponentPaintProfiler::getComponentStatistics() const
+{
+    Array<ComponentStatistics> result;
+    result.ensureStorageAllocated ((int) components.size());
+
+    for (auto& c : components)
+        result.add (c.second.stats);
+
+    std::sort (result.begin(), result.end(), [] (const ComponentStatistics& a, const ComponentStatistics& b)
+    {
+        return a.totalPaintTimeMs > b.totalPaintTimeMs;
+    });
+
+    return result;
+}
+
+Array<ComponentPaintProfiler::FrameStatistics> ComponentPaintProfiler::getFrameStatistics() const
+{
+    return frames;
+}
+
+void ComponentPaintProfiler::setMaxNumFramesToKeep (int maxNumFramesToKeep)
+{
+    maxNumFrames = jmax (1, maxNumFramesToKeep);
+
+    if (frames.size() > maxNumFrames)
+        frames.removeRange (0, frames.size() - maxNumFrames);
+}
+
+//==============================================================================
+var ComponentPaintProfiler::toVar() const
+{
+    Array<var> componentList, frameList;
+
+    for (auto& c : getComponentStatistics())
+    {
+        DynamicObject::Ptr obj (new DynamicObject());
+        obj->setProperty ("description",        c.description);
+        obj->setProperty ("numPaints",          c.numPaints);
+        obj->setProperty ("totalPaintTimeMs",   c.totalPaintTimeMs);
+        obj->setProperty ("maxPaintTimeMs",     c.maxPaintTimeMs);
+        obj->setProperty ("averagePaintTimeMs", c.getAveragePaintTimeMs());
+        obj->setProperty ("paintedArea",        c.paintedArea);
+        componentList.add (var (obj.get()));
+    }
+
+    for (auto& f : frames)
+    {
+        DynamicObject::Ptr obj (new DynamicObject());
+        obj->setProperty ("time",                 f.time);
+        obj->setProperty ("paintTimeMs",          f.paintTimeMs);
+        obj->setProperty ("numRepaintRequests",   f.numRepaintRequests);
+        obj->setProperty ("numInvalidRectangles", f.numInvalidRectangles);
+        obj->setProperty ("invalidArea",          f.invalidArea);
+        obj->setProperty ("numComponentsPainted", f.numComponentsPainted);
+        obj->setProperty ("paintedArea",          f.paintedArea);
+        obj->setProperty ("overdraw",             f.getOverdraw());
+        frameList.add (var (obj.get()));
+    }
+
+    DynamicObject::Ptr result (new DynamicObject());
+    result->setProperty ("components", componentList);
+    result->setProperty ("frames", frameList);
+    return var (result.get());
+}
+
+String ComponentPaintProfiler::toJSON() const
+{
+    return JSON::toString (toVar());
+}
+
+//==============================================================================
+void ComponentPaintProfiler::beginFrame (Component& componentBeingPainted)
+{
+    removeDeletedComponents();
+    auto pending = pendingRepaints.find (&componentBeingPainted);
+
+    if (pending == pendingRepaints.end())
+    {
+        beginFrame (componentBeingPainted, RectangleList<int> (componentBeingPainted.getLocalBounds()));
+        return;
+    }
+
+    auto repaints = std::move (pending->second);
+    pendingRepaints.erase (pending);
+
+    beginFrame (componentBeingPainted, repaints.region);
+
+    if (frameDepth == 1)
+        currentFrame.numRepaintRequests = repaints.numRequests;
+}
+
+void ComponentPaintProfiler::beginFrame (Component& componentBeingPainted, const RectangleList<int>& invalidRegion)
+{
+    if (! enabled || ++frameDepth > 1)
+        return;
+
+    currentFrameComponent = &componentBeingPainted;
+    currentFrame = {};
+    currentFrame.time = Time::getMillisecondCounterHiRes();
+    currentFrame.numInvalidRectangles = invalidRegion.getNumRectangles();
+
+    for (auto& r : invalidRegion)
+        currentFrame.invalidArea += (int64) r.getWidth() * r.getHeight();
+
+    lastInvalidRegion = invalidRegion;
+    lastPaintedAreas.clearQuick();
+    lastPaintTimes.clearQuick();
+    currentFrameStartTicks = Time::getHighResolutionTicks();
+}
+
+void ComponentPaintProfiler::endFrame()
+{
+    if (frameDepth == 0 || --frameDepth > 0)
+        return;
+
+    currentFrame.paintTimeMs = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - currentFrameStartTicks) * 1000.0;
+
+    if (frames.size() >= maxNumFrames)
+        frames.removeRange (0, frames.size() - maxNumFrames + 1);
+
+    frames.add (currentFrame);
+    lastFrameComponent = currentFrameComponent;
+    currentFrameComponent = nullptr;
+}
+
+void ComponentPaintProfiler::repaintRequested (Component& c, Rectangle<int> area)
+{
+    auto& pending = pendingRepaints[&c];
+
+    // (a null pointer here means either that this is a new entry, or that the component
+    // which used to be at this address has been deleted)
+    if (pending.component == nullptr)
+    {
+        pending = {};
+        pending.component = &c;
+    }
+
+    pending.region.add (area);
+    ++pending.numRequests;
+}
+
+void ComponentPaintProfiler::removeDeletedComponents()
+{
+    for (auto i = pendingRepaints.begin(); i != pendingRepaints.end();)
+    {
+        if (i->second.component == nullptr)
+            i = pendingRepaints.erase (i);
+        else
+            ++i;
+    }
+}
+
+void ComponentPaintProfiler::componentPainted (Component& c, Rectangle<int> area, int64 paintTicks)
+{
+    if (currentFrameComponent == nullptr)
+        return;
+
+    auto& entry = components[&c];
+
+    // (a null pointer here means either that this is a new entry, or that the component
+    // which used to be at this address has been deleted)
+    if (entry.component == nullptr)
+    {
+        entry.component = &c;
+        entry.stats = {};
+        entry.stats.description = getDescription (c);
+    }
+
+    auto paintTimeMs = Time::highResolutionTicksToSeconds (paintTicks) * 1000.0;
+    auto areaInFrame = &c == currentFrameComponent ? area : currentFrameComponent->getLocalArea (&c, area);
+    auto pixels = (int64) areaInFrame.getWidth() * areaInFrame.getHeight();
+
+    auto& stats = entry.stats;
+    ++stats.numPaints;
+    stats.totalPaintTimeMs += paintTimeMs;
+    stats.maxPaintTimeMs = jmax (stats.maxPaintTimeMs, paintTimeMs);
+    stats.paintedArea += pixels;
+
+    ++currentFrame.numComponentsPainted;
+    currentFrame.paintedArea += pixels;
+
+    lastPaintedAreas.add (areaInFrame);
+    lastPaintTimes.add ({ stats.description, paintTimeMs });
+}
+
+String ComponentPaintProfiler::getDescription (const Component& c)
+{
+    auto name = c.getName();
+
+    if (name.isEmpty())
+        name = c.getComponentID().isNotEmpty() ? "#" + c.getComponentID() : String ("Unnamed component");
+
+    auto* topLevel = c.getTopLevelComponent();
+    auto bounds = topLevel == &c ? c.getLocalBounds() : topLevel->getLocalArea (&c, c.getLocalBounds());
+
+    return name + " [" + bounds.toString() + "]";
+}
+
+//==============================================================================
+void ComponentPaintProfiler::drawOverlay (Graphics& g, Component& componentBeingPainted) const
+{
+    if (lastFrameComponent != &componentBeingPainted || frames.isEmpty())
+        return;
+
+    Graphics::ScopedSaveState ss (g);
+
+    // each painted area is shaded lightly, so the parts that get drawn over
+    // several times in a frame end up darker than the rest
+    g.setColour (Colours::red.withAlpha (0.12f));
+
+    for (auto& area : lastPaintedAreas)
+        g.fillRect (area);
+
+    g.setColour (Colours::yellow.withAlpha (0.6f));
+
+    for (auto& area : lastInvalidRegion)
+        g.drawRect (area);
+
+    auto& frame = frames.getReference (frames.size() - 1);
+
+    StringArray lines;
+    lines.add (String (frame.paintTimeMs, 2) + " ms, " + String (frame.numRepaintRequests) + " repaints, "
+                 + String (frame.numInvalidRectangles) + " rects");
+    lines.add ("Invalid area " + String (frame.invalidArea) + ", overdraw " + String (frame.getOverdraw(), 2) + "x");
+
+    auto slowest = lastPaintTimes;
+    std::sort (slowest.begin(), slowest.end(), [] (const std::pair<String, double>& a,
+                                                   const std::pair<String, double>& b)
+    {
+        return a.second > b.second;
+    });
+
+    for (int i = 0; i < jmin (5, slowest.size()); ++i)
+        lines.add (String (slowest.getReference (i).second, 2) + " ms  " + slowest.getReference (i).first);
+
+    const Font font (12.0f);
+    const int lineHeight = 15;
+    int width = 0;
+
+    for (auto& line : lines)
+        width = jmax (width, font.getStringWidth (line));
+
+    Rectangle<int> panel (lastInvalidRegion.getBounds().getTopLeft(), { width + 8, lines.size() * lineHeight + 6 });
+
+    g.setColour (Colours::black.withAlpha (0.7f));
+    g.fillRect (panel);
+    g.setColour (Colours::white);
+    g.setFont (font);
+
+    auto textArea = panel.reduced (4, 3);
+
+    for (auto& line : lines)
+        g.drawText (line, textArea.removeFromTop (lineHeight), Justification::centredLeft, false);
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ComponentPaintProfilerTests  : public UnitTest
+{
+public:
+    ComponentPaintProfilerTests()
+        : UnitTest ("ComponentPaintProfiler", UnitTestCategories::gui)
+    {}
+
+    void runTest() override
+    {
+        auto& profiler = *ComponentPaintProfiler::getInstance();
+        auto wasEnabled = profiler.isEnabled();
+
+        profiler.setEnabled (true);
+        profiler.reset();
+
+        beginTest ("Paint times and areas");
+        {
+            TestComponent root ("root", false), front ("front", true), slow ("slow", false);
+            root.setBounds (0, 0, 200, 100);
+            root.addAndMakeVisible (slow);
+            root.addAndMakeVisible (front);
+            slow.setBounds (10, 10, 50, 50);
+            front.setBounds (100, 0, 100, 100);
+            slow.sleepTimeMs = 5;
+
+            paintFrame (profiler, root);
+
+            auto frame = profiler.getFrameStatistics().getLast();
+            expectEquals (frame.numComponentsPainted, 3);
+            expectEquals (frame.invalidArea, (int64) 20000);
+            expectEquals (frame.paintedArea, (int64) (20000 + 2500 + 10000));
+            expect (frame.getOverdraw() > 1.5);
+            expect (frame.paintTimeMs >= 5.0);
+
+            auto stats = profiler.getComponentStatistics();
+            expectEquals (stats.size(), 3);
+            expect (stats.getFirst().description.startsWith ("slow"));
+            expect (stats.getFirst().totalPaintTimeMs >= 5.0);
+
+            for (auto& s : stats)
+                expectEquals (s.numPaints, 1);
+        }
+
+        beginTest ("Repaints are collected into the invalid region");
+        {
+            TestComponent root ("root", false), child ("child", false);
+            root.setBounds (0, 0, 200, 100);
+            root.addAndMakeVisible (child);
+            child.setBounds (20, 30, 40, 20);
+
+            paintFrame (profiler, root);
+
+            child.repaint();
+            child.repaint (0, 0, 10, 10);
+            root.repaint (150, 10, 20, 20);
+            paintFrame (profiler, root);
+
+            auto frame = profiler.getFrameStatistics().getLast();
+            expectEquals (frame.numRepaintRequests, 3);
+            expectEquals (frame.numInvalidRectangles, 2);
+            expectEquals (frame.invalidArea, (int64) (800 + 400));
+        }
+
+        beginTest ("Repaints from deleted components are forgotten");
+        {
+            for (int i = 0; i < 10; ++i)
+            {
+                std::unique_ptr<TestComponent> deleted (new TestComponent ("deleted", false));
+                deleted->setBounds (0, 0, 200, 100);
+                deleted->repaint (0, 0, 10, 10);
+                deleted.reset();
+
+                // a new component may well be given the same address as the old one
+                std::unique_ptr<TestComponent> root (new TestComponent ("root", false));
+                root->setBounds (0, 0, 200, 100);
+                paintFrame (profiler, *root);
+
+                auto frame = profiler.getFrameStatistics().getLast();
+                expectEquals (frame.numRepaintRequests, 0);
+                expectEquals (frame.invalidArea, (int64) 20000);
+            }
+        }
+
+        beginTest ("Repaints hidden by opaque siblings are skipped");
+        {
+            TestComponent root ("root", false), back ("back", false), front ("front", true);
+            root.setBounds (0, 0, 200, 100);
+            root.addAndMakeVisible (back);
+            root.addAndMakeVisible (front);
+            back.setBounds (10, 10, 50, 50);
+            front.setBounds (0, 0, 100, 100);
+
+            paintFrame (profiler, root);
+
+            back.repaint();
+            paintFrame (profiler, root);
+            expectEquals (profiler.getFrameStatistics().getLast().numRepaintRequests, 0);
+
+            // when only part of it is hidden, only the rest is repainted
+            front.setBounds (0, 0, 40, 100);
+            paintFrame (profiler, root);
+
+            back.repaint();
+            paintFrame (profiler, root);
+            expectEquals (profiler.getFrameStatistics().getLast().invalidArea, (int64) (20 * 50));
+
+            // and transparent or hidden components don't hide anything
+            front.setOpaque (false);
+            paintFrame (profiler, root);
+
+            back.repaint();
+            paintFrame (profiler, root);
+            expectEquals (profiler.getFrameStatistics().getLast().invalidArea, (int64) (50 * 50));
+        }
+
+        beginTest ("JSON");
+        {
+            profiler.setMaxNumFramesToKeep (4);
+            expectEquals (profiler.getFrameStatistics().size(), 4);
+
+            auto parsed = JSON::parse (profiler.toJSON());
+            expect (parsed["components"].size() >= 3);
+            expectEquals (parsed["frames"].size(), 4);
+            expectEquals ((int) parsed["frames"][3]["invalidArea"], (int) profiler.getFrameStatistics().getLast().invalidArea);
+
+            profiler.setMaxNumFramesToKeep (256);
+        }
+
+        profiler.reset();
+        profiler.setEnabled (wasEnabled);
+    }
+
+private:
+    struct TestComponent  : public Component
+    {
+        TestComponent (const String& name, bool opaque)  : Component (name)
+        {
+            setOpaque (opaque);
+            setVisible (true);
+        }
+
+        void paint (Graphics& g) override
+        {
+            if (sleepTimeMs > 0)
+                Thread::sleep (sleepTimeMs);
+
+            g.fillAll (isOpaque() ? Colours::blue : Colours::red.withAlpha (0.5f));
+        }
+
+        int sleepTimeMs = 0;
+    };
+
+    static void paintFrame (ComponentPaintProfiler& profiler, Component& root)
+    {
+        Image image (Image::ARGB, root.getWidth(), root.getHeight(), true);
+        Graphics g (image);
+
+        profiler.beginFrame (root);
+        root.paintEntireComponent (g, true);
+        profiler.endFrame();
+    }
+};
+
+static ComponentPaintProfilerTests componentPaintProfilerTests;
+
+#endif
+
+} // namespace juce
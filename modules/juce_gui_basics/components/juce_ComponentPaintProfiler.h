@@ -0,0 +1,212 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2020 - Raw Material Software Limited
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 6 End-User License
+   Agreement and JUCE Privacy Policy (both effective as of the 16th June 2020).
+
+   End User License Agreement: www.juce.com/juce-6-licence
+   Privacy Policy: www.juce.com/juce-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Measures how long each component takes to paint, and how much of each window
+    gets invalidated and redrawn, to help track down slow or wasteful repaints.
+
+    The profiler does nothing until you call setEnabled (true). Once enabled, each
+    frame that a ComponentPeer paints is recorded, along with the time spent in each
+    component's paint() and paintOverChildren() methods and the area that each of
+    them was asked to draw.
+
+    Adding up the painted areas and comparing them with the window's invalid region
+    gives you the overdraw for a frame, i.e. how many times each invalid pixel was
+    drawn on average. The overlay that setOverlayVisible() turns on shades each area
+    that was painted, so the regions that are being drawn over and over again show
+    up as darker patches, and lists the components that are taking the most time.
+
+    The statistics can be exported with toJSON() for viewing in other tools.
+
+    All the methods of this class must be called on the message thread.
+
+    @tags{GUI}
+*/
+class JUCE_API  ComponentPaintProfiler  : private DeletedAtShutdown
+{
+public:
+    //==============================================================================
+   #ifndef DOXYGEN
+    JUCE_DECLARE_SINGLETON_SINGLETHREADED_MINIMAL (ComponentPaintProfiler)
+   #endif
+
+    //==============================================================================
+    /** Starts or stops collecting statistics. */
+    void setEnabled (bool shouldBeEnabled);
+
+    /** Returns true if statistics are being collected. */
+    bool isEnabled() const noexcept                     { return enabled; }
+
+    /** Shows or hides an overlay on each window with the most recent frame's statistics.
+        This will also enable the profiler if it isn't already running.
+    */
+    void setOverlayVisible (bool shouldBeVisible);
+
+    /** Returns true if the overlay is being drawn. */
+    bool isOverlayVisible() const noexcept              { return overlayVisible; }
+
+    /** Clears all the statistics that have been collected so far. */
+    void reset();
+
+    //==============================================================================
+    /** The totals that have been collected for one component. */
+    struct ComponentStatistics
+    {
+        /** The component's name or ID, if it has one, followed by its bounds within its window. */
+        String description;
+
+        /** The number of times that the component's paint methods have been called. */
+        int numPaints = 0;
+
+        /** The total and longest times spent in the component's own paint methods.
+            These don't include the time spent painting its children.
+        */
+        double totalPaintTimeMs = 0, maxPaintTimeMs = 0;
+
+        /** The total number of pixels that the component has been asked to paint. */
+        int64 paintedArea = 0;
+
+        /** Returns the average time taken by each paint call. */
+        double getAveragePaintTimeMs() const noexcept   { return numPaints > 0 ? totalPaintTimeMs / numPaints : 0.0; }
+    };
+
+    /** Returns the statistics for each component that has been painted, with the
+        most expensive ones first.
+    */
+    Array<ComponentStatistics> getComponentStatistics() const;
+
+    //==============================================================================
+    /** The statistics for one frame that was painted. */
+    struct FrameStatistics
+    {
+        /** The time at which the frame was painted, from Time::getMillisecondCounterHiRes(). */
+        double time = 0;
+
+        /** The time taken to paint the whole frame. */
+        double paintTimeMs = 0;
+
+        /** The number of repaint requests that were merged into this frame. */
+        int numRepaintRequests = 0;
+
+        /** The number of rectangles in the frame's invalid region, and the total number of
+            pixels that they cover.
+        */
+        int numInvalidRectangles = 0;
+        int64 invalidArea = 0;
+
+        /** The number of component paint calls made, and the total area that they were asked
+            to paint. When components overlap, the painted area can be larger than the
+            invalid area.
+        */
+        int numComponentsPainted = 0;
+        int64 paintedArea = 0;
+
+        /** Returns the number of times that each invalid pixel was painted, on average. */
+        double getOverdraw() const noexcept             { return invalidArea > 0 ? (double) paintedArea / (double) invalidArea : 0.0; }
+    };
+
+    /** Returns the statistics for the most recent frames, oldest first. */
+    Array<FrameStatistics> getFrameStatistics() const;
+
+    /** Sets the number of frames for which statistics are kept. The default is 256. */
+    void setMaxNumFramesToKeep (int maxNumFrames);
+
+    //==============================================================================
+    /** Returns all the statistics as a var, which can be turned into JSON. */
+    var toVar() const;
+
+    /** Returns all the statistics as a JSON string. */
+    String toJSON() const;
+
+    //==============================================================================
+    /** Marks the start of a frame in which a component and its children are painted.
+
+        ComponentPeer calls this for you, so you'd only need to call it if you paint a
+        component hierarchy yourself, e.g. into an OpenGL texture. Any repaints that the
+        component has requested since its last frame are counted as the frame's invalid
+        region, unless you pass in the region explicitly.
+    */
+    void beginFrame (Component& componentBeingPainted);
+
+    /** Marks the start of a frame, giving the region that needs to be painted. */
+    void beginFrame (Component& componentBeingPainted, const RectangleList<int>& invalidRegion);
+
+    /** Marks the end of a frame that was started with beginFrame(). */
+    void endFrame();
+
+    /** Draws the statistics overlay for the most recent frame over a component.
+        ComponentPeer calls this for you when the overlay is visible.
+    */
+    void drawOverlay (Graphics&, Component& componentBeingPainted) const;
+
+private:
+    //==============================================================================
+    ComponentPaintProfiler();
+    ~ComponentPaintProfiler() override;
+
+    struct ComponentEntry
+    {
+        Component::SafePointer<Component> component;
+        ComponentStatistics stats;
+    };
+
+    struct PendingRepaints
+    {
+        Component::SafePointer<Component> component;
+        RectangleList<int> region;
+        int numRequests = 0;
+    };
+
+    std::map<const Component*, ComponentEntry> components;
+    std::map<const Component*, PendingRepaints> pendingRepaints;
+    Array<FrameStatistics> frames;
+    int maxNumFrames = 256;
+
+    Component* currentFrameComponent = nullptr;
+    Component::SafePointer<Component> lastFrameComponent;
+    FrameStatistics currentFrame;
+    int64 currentFrameStartTicks = 0;
+    int frameDepth = 0;
+    RectangleList<int> lastInvalidRegion;
+    Array<Rectangle<int>> lastPaintedAreas;
+    Array<std::pair<String, double>> lastPaintTimes;
+    bool enabled = false, overlayVisible = false;
+
+    friend class Component;
+    void repaintRequested (Component&, Rectangle<int> area);
+    void componentPainted (Component&, Rectangle<int> area, int64 paintTicks);
+    void removeDeletedComponents();
+
+    static String getDescription (const Component&);
+    static void repaintAllWindows();
+
+    JUCE_DECLARE_NON_COPYABLE (ComponentPaintProfiler)
+};
+
+} // namespace juce
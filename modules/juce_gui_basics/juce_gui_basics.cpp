@@ -108,6 +108,7 @@ namespace juce
 #include "desktop/juce_Displays.cpp"
 #include "desktop/juce_Desktop.cpp"
 #include "components/juce_ModalComponentManager.cpp"
+#include "components/juce_ComponentPaintProfiler.cpp"
 #include "mouse/juce_ComponentDragger.cpp"
 #include "mouse/juce_DragAndDropContainer.cpp"
 #include "mouse/juce_MouseCursor.cpp"
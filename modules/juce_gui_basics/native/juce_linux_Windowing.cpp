@@ -377,6 +377,8 @@ private:
                 return;
             }
 
+            coalesceRegionsNeedingRepaint();
+
             auto originalRepaintRegion = regionsNeedingRepaint;
             regionsNeedingRepaint.clear();
             auto totalArea = originalRepaintRegion.getBounds();
@@ -417,7 +419,27 @@ private:
         }
 
     private:
-        enum { repaintTimerPeriod = 1000 / 100 };
+        enum { repaintTimerPeriod = 1000 / 100, maxRectanglesToPaintSeparately = 16 };
+
+        // Each rectangle in the region has to be clipped against and blitted separately, so
+        // when lots of small ones are scattered over most of their bounding box, it's
+        // quicker to just paint the whole box.
+        void coalesceRegionsNeedingRepaint()
+        {
+            regionsNeedingRepaint.consolidate();
+
+            if (regionsNeedingRepaint.getNumRectangles() > maxRectanglesToPaintSeparately)
+            {
+                auto bounds = regionsNeedingRepaint.getBounds();
+                int64 area = 0;
+
+                for (auto& r : regionsNeedingRepaint)
+                    area += (int64) r.getWidth() * r.getHeight();
+
+                if (area * 2 >= (int64) bounds.getWidth() * bounds.getHeight())
+                    regionsNeedingRepaint = bounds;
+            }
+        }
 
         LinuxComponentPeer& peer;
         const bool isSemiTransparentWindow;
@@ -127,12 +127,25 @@ void ComponentPeer::handlePaint (LowLevelGraphicsContext& contextToPaintTo)
     }
   #endif
 
+    auto* profiler = ComponentPaintProfiler::getInstanceWithoutCreating();
+
+    if (profiler != nullptr && profiler->isEnabled())
+        profiler->beginFrame (component);
+
     JUCE_TRY
     {
         component.paintEntireComponent (g, true);
     }
     JUCE_CATCH_EXCEPTION
 
+    if (profiler != nullptr)
+    {
+        profiler->endFrame();
+
+        if (profiler->isOverlayVisible())
+            profiler->drawOverlay (g, component);
+    }
+
   #if JUCE_ENABLE_REPAINT_DEBUGGING
    #ifdef JUCE_IS_REPAINT_DEBUGGING_ACTIVE
     if (JUCE_IS_REPAINT_DEBUGGING_ACTIVE)
@@ -34,6 +34,14 @@
 
 #include "juce_osc.h"
 
+#include <unordered_map>
+
+#if JUCE_LINUX
+ #include <sys/socket.h>
+ #include <netinet/in.h>
+ #include <netdb.h>
+#endif
+
 #include "osc/juce_OSCTypes.cpp"
 #include "osc/juce_OSCTimeTag.cpp"
 #include "osc/juce_OSCArgument.cpp"
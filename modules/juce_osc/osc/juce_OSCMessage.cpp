@@ -36,7 +36,7 @@ void OSCMessage::setAddressPattern (const OSCAddressPattern& ap) noexcept
     addressPattern = ap;
 }
 
-OSCAddressPattern OSCMessage::getAddressPattern() const noexcept
+const OSCAddressPattern& OSCMessage::getAddressPattern() const noexcept
 {
     return addressPattern;
 }
@@ -84,7 +84,7 @@ const OSCArgument* OSCMessage::end() const noexcept
 
 void OSCMessage::clear()
 {
-    arguments.clear();
+    arguments.clearQuick();
 }
 
 //==============================================================================
@@ -93,7 +93,7 @@ void OSCMessage::addFloat32 (float value)           { arguments.add (OSCArgument
 void OSCMessage::addString (const String& value)    { arguments.add (OSCArgument (value)); }
 void OSCMessage::addBlob (MemoryBlock blob)         { arguments.add (OSCArgument (std::move (blob))); }
 void OSCMessage::addColour (OSCColour colour)       { arguments.add (OSCArgument (colour)); }
-void OSCMessage::addArgument (OSCArgument arg)      { arguments.add (arg); }
+void OSCMessage::addArgument (OSCArgument arg)      { arguments.add (std::move (arg)); }
 
 
 //==============================================================================
@@ -80,7 +80,7 @@ public:
     void setAddressPattern (const OSCAddressPattern& ap) noexcept;
 
     /** Returns the address pattern of the OSCMessage. */
-    OSCAddressPattern getAddressPattern() const noexcept;
+    const OSCAddressPattern& getAddressPattern() const noexcept;
 
     /** Returns the number of OSCArgument objects that belong to this OSCMessage. */
     int size() const noexcept;
@@ -115,7 +115,10 @@ public:
     */
     const OSCArgument* end() const noexcept;
 
-    /** Removes all arguments from the OSCMessage. */
+    /** Removes all arguments from the OSCMessage.
+        The storage that they used is kept, so that adding new arguments afterwards
+        won't need to allocate any memory.
+    */
     void clear();
 
     //==============================================================================
@@ -26,6 +26,58 @@
 namespace juce
 {
 
+//==============================================================================
+/** Keeps a re-usable OSCMessage for each of the addresses that have been received
+    recently, so that parsing a message to one of them doesn't need to tokenise its
+    address pattern or allocate storage for its arguments.
+*/
+class OSCMessageCache
+{
+public:
+    OSCMessageCache() = default;
+
+    /** Returns the cached message for an address pattern, creating it if needed.
+        @throw OSCFormatError if the address pattern isn't valid.
+    */
+    OSCMessage& getMessage (const char* address, size_t length)
+    {
+        auto& slot = slots[getHash (address, length) & (numSlots - 1)];
+
+        if (slot.message == nullptr
+             || slot.address.getSize() != length
+             || memcmp (slot.address.getData(), address, length) != 0)
+        {
+            std::unique_ptr<OSCMessage> newMessage (new OSCMessage (OSCAddressPattern (String::fromUTF8 (address, (int) length))));
+            slot.address.replaceWith (address, length);
+            slot.message = std::move (newMessage);
+        }
+
+        return *slot.message;
+    }
+
+private:
+    struct Slot
+    {
+        MemoryBlock address;
+        std::unique_ptr<OSCMessage> message;
+    };
+
+    static constexpr size_t numSlots = 256;
+    std::array<Slot, numSlots> slots;
+
+    static size_t getHash (const char* text, size_t length) noexcept
+    {
+        uint32 hash = 2166136261u;
+
+        for (size_t i = 0; i < length; ++i)
+            hash = (hash ^ (uint8) text[i]) * 16777619u;
+
+        return (size_t) hash;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (OSCMessageCache)
+};
+
 namespace
 {
     //==============================================================================
@@ -93,15 +145,11 @@ namespace
         {
             checkBytesAvailable (4, "OSC input stream exhausted while reading string");
 
-            auto posBegin = (size_t) getPosition();
-            auto s = input.readString();
-            auto posEnd = (size_t) getPosition();
+            auto length = findNullTerminator ("OSC input stream exhausted before finding null terminator of string");
+            auto s = String::fromUTF8 (getCurrentData(), (int) length);
 
-            if (static_cast<const char*> (getData()) [posEnd - 1] != '\0')
-                throw OSCFormatError ("OSC input stream exhausted before finding null terminator of string");
-
-            size_t bytesRead = posEnd - posBegin;
-            readPaddingZeros (bytesRead);
+            input.skipNextBytes ((int64) length + 1);
+            readPaddingZeros (length + 1);
 
             return s;
         }
@@ -206,6 +254,59 @@ namespace
             return msg;
         }
 
+        /** Reads a message into one of the re-usable messages in a cache, which means that
+            nothing needs to be allocated unless the message has string or blob arguments,
+            or its address pattern hasn't been seen recently.
+
+            The message that is returned will be overwritten by the next message that's read
+            from the cache with the same address pattern.
+        */
+        const OSCMessage& readMessage (OSCMessageCache& cache)
+        {
+            checkBytesAvailable (4, "OSC input stream exhausted while reading string");
+
+            auto addressLength = findNullTerminator ("OSC input stream exhausted before finding null terminator of string");
+            auto& message = cache.getMessage (getCurrentData(), addressLength);
+
+            input.skipNextBytes ((int64) addressLength + 1);
+            readPaddingZeros (addressLength + 1);
+
+            checkBytesAvailable (4, "OSC input stream exhausted while reading type tag string");
+
+            if (input.readByte() != ',')
+                throw OSCFormatError ("OSC input stream format error: expected type tag string");
+
+            auto numTypes = findNullTerminator ("OSC input stream exhausted while reading type tag string");
+            auto* types = getCurrentData();
+
+            for (size_t i = 0; i < numTypes; ++i)
+                if (! OSCTypes::isSupportedType (types[i]))
+                    throw OSCFormatError ("OSC input stream format error: encountered unsupported type tag");
+
+            input.skipNextBytes ((int64) numTypes + 1);
+            readPaddingZeros (numTypes + 2);
+
+            message.clear();
+
+            for (size_t i = 0; i < numTypes; ++i)
+                message.addArgument (readArgument (types[i]));
+
+            return message;
+        }
+
+        const OSCMessage& readMessageWithKnownSize (size_t size, OSCMessageCache& cache)
+        {
+            checkBytesAvailable ((int64) size, "OSC input stream exhausted while reading bundle element content");
+
+            auto begin = (size_t) getPosition();
+            auto& message = readMessage (cache);
+
+            if (getPosition() - begin != size)
+                throw OSCFormatError ("OSC input stream format error: wrong element content size encountered while reading");
+
+            return message;
+        }
+
         //==============================================================================
         OSCBundle readBundle (size_t maxBytesToRead = std::numeric_limits<size_t>::max())
         {
@@ -264,6 +365,22 @@ namespace
     private:
         MemoryInputStream input;
 
+        //==============================================================================
+        const char* getCurrentData()
+        {
+            return static_cast<const char*> (getData()) + input.getPosition();
+        }
+
+        size_t findNullTerminator (const char* errorMessage)
+        {
+            auto numBytesRemaining = (size_t) input.getNumBytesRemaining();
+
+            if (auto* end = static_cast<const char*> (std::memchr (getCurrentData(), 0, numBytesRemaining)))
+                return (size_t) (end - getCurrentData());
+
+            throw OSCFormatError (errorMessage);
+        }
+
         //==============================================================================
         void readPaddingZeros (size_t bytesRead)
         {
@@ -380,12 +497,12 @@ struct OSCReceiver::Pimpl   : private Thread,
     void addListener (ListenerWithOSCAddress<MessageLoopCallback>* listenerToAdd,
                       OSCAddress addressToMatch)
     {
-        addListenerWithAddress (listenerToAdd, addressToMatch, listenersWithAddress);
+        listenersWithAddress.add (listenerToAdd, addressToMatch);
     }
 
     void addListener (ListenerWithOSCAddress<RealtimeCallback>* listenerToAdd, OSCAddress addressToMatch)
     {
-        addListenerWithAddress (listenerToAdd, addressToMatch, realtimeListenersWithAddress);
+        realtimeListenersWithAddress.add (listenerToAdd, addressToMatch);
     }
 
     void removeListener (OSCReceiver::Listener<MessageLoopCallback>* listenerToRemove)
@@ -400,21 +517,22 @@ struct OSCReceiver::Pimpl   : private Thread,
 
     void removeListener (ListenerWithOSCAddress<MessageLoopCallback>* listenerToRemove)
     {
-        removeListenerWithAddress (listenerToRemove, listenersWithAddress);
+        listenersWithAddress.remove (listenerToRemove);
     }
 
     void removeListener (ListenerWithOSCAddress<RealtimeCallback>* listenerToRemove)
     {
-        removeListenerWithAddress (listenerToRemove, realtimeListenersWithAddress);
+        realtimeListenersWithAddress.remove (listenerToRemove);
     }
 
     //==============================================================================
     struct CallbackMessage   : public Message
     {
-        CallbackMessage (OSCBundle::Element oscElement)  : content (oscElement) {}
+        CallbackMessage() = default;
 
-        // the payload of the message. Can be either an OSCMessage or an OSCBundle.
-        OSCBundle::Element content;
+        // the payloads of all the packets that arrived in one batch. Each one
+        // can be either an OSCMessage or an OSCBundle.
+        Array<OSCBundle::Element> contents;
     };
 
     //==============================================================================
@@ -424,19 +542,28 @@ struct OSCReceiver::Pimpl   : private Thread,
 
         try
         {
-            auto content = inStream.readElementWithKnownSize (dataSize);
-
             // realtime listeners should receive the OSC content first - and immediately
-            // on this thread:
-            callRealtimeListeners (content);
+            // on this thread. Messages are read into a re-usable object from the cache,
+            // so that a message to a familiar address doesn't need to allocate anything.
+            if (*data == '/')
+            {
+                auto& message = inStream.readMessageWithKnownSize (dataSize, messageCache);
+
+                callRealtimeListeners (message);
+                realtimeListenersWithAddress.call (message);
 
-            if (content.isMessage())
-                callRealtimeListenersWithAddress (content.getMessage());
+                if (hasMessageLoopListeners())
+                    pendingContents.add (OSCBundle::Element (message));
+            }
+            else
+            {
+                auto content = inStream.readElementWithKnownSize (dataSize);
 
-            // now post the message that will trigger the handleMessage callback
-            // dealing with the non-realtime listeners.
-            if (listeners.size() > 0 || listenersWithAddress.size() > 0)
-                postMessage (new CallbackMessage (content));
+                callRealtimeListeners (content.getBundle());
+
+                if (hasMessageLoopListeners())
+                    pendingContents.add (content);
+            }
         }
         catch (const OSCFormatError&)
         {
@@ -453,11 +580,125 @@ struct OSCReceiver::Pimpl   : private Thread,
 
 private:
     //==============================================================================
-    void run() override
+    // A map of the OSC addresses that listeners are interested in. The addresses are
+    // indexed by name, so a message without any wildcards in its address pattern can
+    // find its listeners with a single lookup, rather than having to test its pattern
+    // against every address that's been registered.
+    //
+    // Listeners can be added and removed on any thread while messages are being
+    // dispatched, so all access goes through a lock. The callbacks are made after
+    // the lock has been released, from a copy of the listeners that matched, so a
+    // listener can add or remove listeners from inside its callback. If anything
+    // has been removed since the copy was taken, each listener is checked again
+    // before it's called.
+    template <typename ListenerType>
+    struct AddressedListeners
     {
-        int bufferSize = 65535;
-        HeapBlock<char> oscBuffer (bufferSize);
+        void add (ListenerType* listenerToAdd, const OSCAddress& address)
+        {
+            const ScopedLock sl (lock);
+
+            for (auto& i : entries)
+                if (address == i.first && listenerToAdd == i.second)
+                    return;
+
+            entries.add (std::make_pair (address, listenerToAdd));
+            index[address.toString()].add (listenerToAdd);
+        }
+
+        void remove (ListenerType* listenerToRemove)
+        {
+            const ScopedLock sl (lock);
+
+            for (int i = 0; i < entries.size(); ++i)
+            {
+                auto& entry = entries.getReference (i);
 
+                if (listenerToRemove == entry.second)
+                {
+                    auto found = index.find (entry.first.toString());
+
+                    if (found != index.end())
+                    {
+                        found->second.removeFirstMatchingValue (listenerToRemove);
+
+                        if (found->second.isEmpty())
+                            index.erase (found);
+                    }
+
+                    // aarrgh... can't simply call entries.remove (i) because this
+                    // requires a default c'tor to be present for OSCAddress...
+                    // luckily, we don't care about methods preserving element order:
+                    entries.swap (i, entries.size() - 1);
+                    entries.removeLast();
+                    ++numRemovals;
+                    break;
+                }
+            }
+        }
+
+        void call (const OSCMessage& message) const
+        {
+            Array<ListenerType*> matching;
+            uint32 removalsBeforeCall;
+
+            {
+                const ScopedLock sl (lock);
+                auto& pattern = message.getAddressPattern();
+                removalsBeforeCall = numRemovals;
+
+                if (! pattern.containsWildcards())
+                {
+                    auto found = index.find (pattern.toString());
+
+                    if (found != index.end())
+                        matching = found->second;
+                }
+                else
+                {
+                    for (auto& entry : entries)
+                        if (pattern.matches (entry.first))
+                            matching.add (entry.second);
+                }
+            }
+
+            for (auto* l : matching)
+                if (numRemovals == removalsBeforeCall || contains (l))
+                    l->oscMessageReceived (message);
+        }
+
+        bool contains (ListenerType* listener) const
+        {
+            const ScopedLock sl (lock);
+
+            for (auto& entry : entries)
+                if (entry.second == listener)
+                    return true;
+
+            return false;
+        }
+
+        int size() const noexcept
+        {
+            const ScopedLock sl (lock);
+            return entries.size();
+        }
+
+    private:
+        struct StringHash
+        {
+            size_t operator() (const String& s) const noexcept    { return s.hash(); }
+        };
+
+        CriticalSection lock;
+        Array<std::pair<OSCAddress, ListenerType*>> entries;
+        std::unordered_map<String, Array<ListenerType*>, StringHash> index;
+        std::atomic<uint32> numRemovals { 0 };
+    };
+
+    //==============================================================================
+    void run() override
+    {
         while (! threadShouldExit())
         {
             jassert (socket != nullptr);
@@ -469,119 +710,126 @@ private:
             if (ready == 0)
                 continue;
 
-            auto bytesRead = (size_t) socket->read (oscBuffer.getData(), bufferSize, false);
+            readPendingPackets();
 
-            if (bytesRead >= 4)
-                handleBuffer (oscBuffer.getData(), bytesRead);
+            // all the content from this batch of packets gets delivered to the
+            // message thread together
+            if (! pendingContents.isEmpty())
+            {
+                auto* message = new CallbackMessage();
+                message->contents.swapWith (pendingContents);
+                postMessage (message);
+            }
         }
     }
 
-    //==============================================================================
-    template <typename ListenerType>
-    void addListenerWithAddress (ListenerType* listenerToAdd,
-                                 OSCAddress address,
-                                 Array<std::pair<OSCAddress, ListenerType*>>& array)
+    // Reads as many of the packets that are waiting on the socket as will fit in the
+    // buffers (up to maxPacketsPerBatch), so that a burst of traffic can be handled
+    // with far fewer system calls.
+    void readPendingPackets()
     {
-        for (auto& i : array)
-            if (address == i.first && listenerToAdd == i.second)
-                return;
+        if (packetBuffers == nullptr)
+            packetBuffers.allocate ((size_t) (maxPacketsPerBatch * maxPacketSize), false);
 
-        array.add (std::make_pair (address, listenerToAdd));
-    }
+       #if JUCE_LINUX
+        mmsghdr headers[maxPacketsPerBatch];
+        iovec vectors[maxPacketsPerBatch];
+        zeromem (headers, sizeof (headers));
 
-    //==============================================================================
-    template <typename ListenerType>
-    void removeListenerWithAddress (ListenerType* listenerToRemove,
-                                    Array<std::pair<OSCAddress, ListenerType*>>& array)
-    {
-        for (int i = 0; i < array.size(); ++i)
+        for (int i = 0; i < maxPacketsPerBatch; ++i)
         {
-            if (listenerToRemove == array.getReference (i).second)
-            {
-                // aarrgh... can't simply call array.remove (i) because this
-                // requires a default c'tor to be present for OSCAddress...
-                // luckily, we don't care about methods preserving element order:
-                array.swap (i, array.size() - 1);
-                array.removeLast();
-                break;
-            }
+            vectors[i].iov_base = packetBuffers + i * maxPacketSize;
+            vectors[i].iov_len  = (size_t) maxPacketSize;
+            headers[i].msg_hdr.msg_iov = vectors + i;
+            headers[i].msg_hdr.msg_iovlen = 1;
         }
-    }
 
-    //==============================================================================
-    void handleMessage (const Message& msg) override
-    {
-        if (auto* callbackMessage = dynamic_cast<const CallbackMessage*> (&msg))
+        auto numPackets = recvmmsg (socket->getRawSocketHandle(), headers, (unsigned int) maxPacketsPerBatch,
+                                    MSG_DONTWAIT, nullptr);
+
+        for (int i = 0; i < numPackets; ++i)
+            if (headers[i].msg_len >= 4 && (headers[i].msg_hdr.msg_flags & MSG_TRUNC) == 0)
+                handleBuffer (packetBuffers + i * maxPacketSize, (size_t) headers[i].msg_len);
+       #else
+        for (int i = 0; i < maxPacketsPerBatch; ++i)
         {
-            auto& content = callbackMessage->content;
+            if (i > 0 && socket->waitUntilReady (true, 0) <= 0)
+                break;
 
-            callListeners (content);
+            auto* buffer = packetBuffers + i * maxPacketSize;
+            auto bytesRead = socket->read (buffer, maxPacketSize, false);
 
-            if (content.isMessage())
-                callListenersWithAddress (content.getMessage());
+            if (bytesRead < 0)
+                break;
+
+            if (bytesRead >= 4)
+                handleBuffer (buffer, (size_t) bytesRead);
         }
+       #endif
     }
 
     //==============================================================================
-    void callListeners (const OSCBundle::Element& content)
+    void handleMessage (const Message& msg) override
     {
-        using OSCListener = OSCReceiver::Listener<OSCReceiver::MessageLoopCallback>;
-
-        if (content.isMessage())
-        {
-            auto&& message = content.getMessage();
-            listeners.call ([&] (OSCListener& l) { l.oscMessageReceived (message); });
-        }
-        else if (content.isBundle())
+        if (auto* callbackMessage = dynamic_cast<const CallbackMessage*> (&msg))
         {
-            auto&& bundle = content.getBundle();
-            listeners.call ([&] (OSCListener& l) { l.oscBundleReceived (bundle); });
+            for (auto& content : callbackMessage->contents)
+            {
+                if (content.isMessage())
+                {
+                    auto& message = content.getMessage();
+                    callListeners (message);
+                    listenersWithAddress.call (message);
+                }
+                else if (content.isBundle())
+                {
+                    callListeners (content.getBundle());
+                }
+            }
         }
     }
 
-    void callRealtimeListeners (const OSCBundle::Element& content)
+    bool hasMessageLoopListeners() const noexcept
     {
-        using OSCListener = OSCReceiver::Listener<OSCReceiver::RealtimeCallback>;
-
-        if (content.isMessage())
-        {
-            auto&& message = content.getMessage();
-            realtimeListeners.call ([&] (OSCListener& l) { l.oscMessageReceived (message); });
-        }
-        else if (content.isBundle())
-        {
-            auto&& bundle = content.getBundle();
-            realtimeListeners.call ([&] (OSCListener& l) { l.oscBundleReceived (bundle); });
-        }
+        return listeners.size() > 0 || listenersWithAddress.size() > 0;
     }
 
     //==============================================================================
-    void callListenersWithAddress (const OSCMessage& message)
+    template <typename Content>
+    void callListeners (const Content& content)
     {
-        for (auto& entry : listenersWithAddress)
-            if (auto* listener = entry.second)
-                if (message.getAddressPattern().matches (entry.first))
-                    listener->oscMessageReceived (message);
+        using OSCListener = OSCReceiver::Listener<OSCReceiver::MessageLoopCallback>;
+        listeners.call ([&] (OSCListener& l) { deliver (l, content); });
     }
 
-    void callRealtimeListenersWithAddress (const OSCMessage& message)
+    template <typename Content>
+    void callRealtimeListeners (const Content& content)
     {
-        for (auto& entry : realtimeListenersWithAddress)
-            if (auto* listener = entry.second)
-                if (message.getAddressPattern().matches (entry.first))
-                    listener->oscMessageReceived (message);
+        using OSCListener = OSCReceiver::Listener<OSCReceiver::RealtimeCallback>;
+        realtimeListeners.call ([&] (OSCListener& l) { deliver (l, content); });
     }
 
+    template <typename ListenerType>
+    static void deliver (ListenerType& l, const OSCMessage& message)    { l.oscMessageReceived (message); }
+
+    template <typename ListenerType>
+    static void deliver (ListenerType& l, const OSCBundle& bundle)      { l.oscBundleReceived (bundle); }
+
     //==============================================================================
     ListenerList<OSCReceiver::Listener<OSCReceiver::MessageLoopCallback>> listeners;
     ListenerList<OSCReceiver::Listener<OSCReceiver::RealtimeCallback>>    realtimeListeners;
 
-    Array<std::pair<OSCAddress, OSCReceiver::ListenerWithOSCAddress<OSCReceiver::MessageLoopCallback>*>> listenersWithAddress;
-    Array<std::pair<OSCAddress, OSCReceiver::ListenerWithOSCAddress<OSCReceiver::RealtimeCallback>*>>    realtimeListenersWithAddress;
+    AddressedListeners<OSCReceiver::ListenerWithOSCAddress<OSCReceiver::MessageLoopCallback>> listenersWithAddress;
+    AddressedListeners<OSCReceiver::ListenerWithOSCAddress<OSCReceiver::RealtimeCallback>>    realtimeListenersWithAddress;
 
     OptionalScopedPointer<DatagramSocket> socket;
     OSCReceiver::FormatErrorHandler formatErrorHandler { nullptr };
 
+    enum { maxPacketsPerBatch = 32, maxPacketSize = 65535 };
+    HeapBlock<char> packetBuffers;
+    OSCMessageCache messageCache;
+    Array<OSCBundle::Element> pendingContents;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Pimpl)
 };
 
@@ -1189,6 +1437,268 @@ public:
 
 static OSCInputStreamTests OSCInputStreamUnitTests;
 
+//==============================================================================
+class OSCReceiverTests  : public UnitTest
+{
+public:
+    OSCReceiverTests()
+        : UnitTest ("OSCReceiver class", UnitTestCategories::osc)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("reading OSC messages into a cache");
+        {
+            OSCMessageCache cache;
+            auto first = encodeMessage ("/test/fader1", 42);
+            auto second = encodeMessage ("/test/fader1", 43);
+
+            OSCInputStream inStream1 (first.getData(), first.getSize());
+            auto& message1 = inStream1.readMessageWithKnownSize (first.getSize(), cache);
+
+            expectEquals (message1.getAddressPattern().toString(), String ("/test/fader1"));
+            expectEquals (message1.size(), 2);
+            expectEquals (message1[0].getInt32(), 42);
+            expectEquals (message1[1].getFloat32(), 0.5f);
+
+            OSCInputStream inStream2 (second.getData(), second.getSize());
+            auto& message2 = inStream2.readMessageWithKnownSize (second.getSize(), cache);
+
+            expect (&message1 == &message2);
+            expectEquals (message2.size(), 2);
+            expectEquals (message2[0].getInt32(), 43);
+
+            auto invalid = encodeMessage ("/test/fader1", 1);
+            static_cast<char*> (invalid.getData())[1] = ' ';
+
+            OSCInputStream inStream3 (invalid.getData(), invalid.getSize());
+            expectThrowsType (inStream3.readMessageWithKnownSize (invalid.getSize(), cache), OSCFormatError)
+
+            OSCInputStream inStream4 (first.getData(), first.getSize() - 4);
+            expectThrowsType (inStream4.readMessageWithKnownSize (first.getSize() - 4, cache), OSCFormatError)
+        }
+
+        DatagramSocket receiveSocket (false);
+        expect (receiveSocket.bindToPort (0));
+        auto port = receiveSocket.getBoundPort();
+
+        OSCReceiver receiver;
+        expect (receiver.connectToSocket (receiveSocket));
+
+        OSCSender sender;
+        expect (sender.connect ("127.0.0.1", port));
+
+        beginTest ("dispatching messages to listeners with addresses");
+        {
+            CountingListener faderA, faderB, everything;
+            receiver.addListener (&faderA, "/fader/a");
+            receiver.addListener (&faderB, "/fader/b");
+            receiver.addListener (&everything, "/fader/a");
+            receiver.addListener (&everything, "/fader/b");
+
+            expect (sender.send ("/fader/a", 1));
+            expect (UnitTestHelpers::waitUntil ([&] { return faderA.count == 1 && everything.count == 1; }));
+            expectEquals (faderB.count.load(), 0);
+
+            expect (sender.send ("/fader/?", 2));
+            expect (UnitTestHelpers::waitUntil ([&] { return faderA.count == 2 && faderB.count == 1 && everything.count == 3; }));
+
+            receiver.removeListener (&faderA);
+            expect (sender.send ("/fader/a", 3));
+            expect (UnitTestHelpers::waitUntil ([&] { return everything.count == 4; }));
+            expectEquals (faderA.count.load(), 2);
+            expectEquals (everything.lastValue.load(), 3);
+
+            receiver.removeListener (&faderB);
+            receiver.removeListener (&everything);
+            receiver.removeListener (&everything);
+        }
+
+        beginTest ("receiving bursts of messages");
+        {
+            SequenceListener listener;
+            receiver.addListener (&listener);
+
+            const int numMessages = 5000;
+            listener.reset();
+
+            for (int i = 0; i < numMessages; ++i)
+            {
+                sender.send ("/sequence", i);
+
+                // don't let the sender get too far ahead, or the socket's buffer might overflow
+                if ((i % 64) == 63)
+                    expect (UnitTestHelpers::waitUntil ([&] { return listener.count > i - 64; }));
+            }
+
+            expect (UnitTestHelpers::waitUntil ([&] { return listener.count == numMessages; }));
+            expectEquals (listener.numErrors.load(), 0);
+
+            receiver.removeListener (&listener);
+        }
+
+        beginTest ("adding and removing listeners while receiving");
+        {
+            CountingListener stable;
+            OwnedArray<CountingListener> churning;
+
+            for (int i = 0; i < 16; ++i)
+                churning.add (new CountingListener());
+
+            receiver.addListener (&stable, "/churn/stable");
+
+            const int numMessages = 2000;
+
+            for (int i = 0; i < numMessages; ++i)
+            {
+                if ((i & 1) == 0)
+                    sender.send ("/churn/stable", i);
+                else
+                    sender.send ((i & 2) == 0 ? "/churn/?" : "/churn/" + String (i % 16), i);
+
+                // the receiver's thread is dispatching these while we change its listeners
+                auto* l = churning[i % 16];
+                receiver.addListener (l, "/churn/" + String (i % 16));
+                receiver.addListener (l, "/churn/stable");
+                receiver.removeListener (l);
+                receiver.removeListener (l);
+
+                if ((i % 64) == 63)
+                    expect (UnitTestHelpers::waitUntil ([&] { return stable.count >= (i - 64) / 2; }));
+            }
+
+            expect (UnitTestHelpers::waitUntil ([&] { return stable.count == numMessages / 2; }));
+            receiver.removeListener (&stable);
+        }
+
+        beginTest ("listeners removing listeners from their callbacks");
+        {
+            struct RemovingListener  : public CountingListener
+            {
+                RemovingListener (OSCReceiver& r, CountingListener& other)  : receiver (r), toRemove (other) {}
+
+                void oscMessageReceived (const OSCMessage& message) override
+                {
+                    CountingListener::oscMessageReceived (message);
+                    receiver.removeListener (&toRemove);
+                    receiver.removeListener (this);
+                }
+
+                OSCReceiver& receiver;
+                CountingListener& toRemove;
+            };
+
+            CountingListener removed, done;
+            RemovingListener remover (receiver, removed);
+
+            receiver.addListener (&remover, "/remove");
+            receiver.addListener (&removed, "/remove");
+            receiver.addListener (&done, "/done");
+
+            expect (sender.send ("/remove", 1));
+            expect (sender.send ("/remove", 2));
+            expect (sender.send ("/done", 3));
+            expect (UnitTestHelpers::waitUntil ([&] { return done.count == 1; }));
+
+            expectEquals (remover.count.load(), 1);
+            expectEquals (removed.count.load(), 0);
+
+            receiver.removeListener (&done);
+        }
+
+        beginTest ("dispatching to many listeners with addresses");
+        {
+            OwnedArray<CountingListener> channelListeners;
+
+            for (int i = 0; i < 512; ++i)
+                receiver.addListener (channelListeners.add (new CountingListener()), "/universe1/channel" + String (i));
+
+            const int numSent = 10 * 512;
+
+            for (int i = 0; i < numSent; ++i)
+            {
+                auto channel = (i * 7) % 512;
+                sender.send ("/universe1/channel" + String (channel), i);
+
+                if ((i % 64) == 63)
+                    UnitTestHelpers::waitUntil ([&] { return getTotalCount (channelListeners) > i - 64; });
+            }
+
+            expect (UnitTestHelpers::waitUntil ([&] { return getTotalCount (channelListeners) == numSent; }));
+
+            // every channel gets the same number of messages
+            expect (std::all_of (channelListeners.begin(), channelListeners.end(),
+                                 [] (CountingListener* l) { return l->count == 10; }));
+
+            for (auto* l : channelListeners)
+                receiver.removeListener (l);
+        }
+
+        receiver.disconnect();
+    }
+
+private:
+    struct CountingListener  : public OSCReceiver::ListenerWithOSCAddress<OSCReceiver::RealtimeCallback>
+    {
+        void oscMessageReceived (const OSCMessage& message) override
+        {
+            if (message.size() > 0 && message[0].isInt32())
+                lastValue = message[0].getInt32();
+
+            ++count;
+        }
+
+        std::atomic<int> count { 0 }, lastValue { -1 };
+    };
+
+    struct SequenceListener  : public OSCReceiver::Listener<OSCReceiver::RealtimeCallback>
+    {
+        void reset()    { count = 0; numErrors = 0; }
+
+        void oscMessageReceived (const OSCMessage& message) override
+        {
+            if (message.size() != 1 || message[0].getInt32() != count)
+                ++numErrors;
+
+            ++count;
+        }
+
+        std::atomic<int> count { 0 }, numErrors { 0 };
+    };
+
+    static int getTotalCount (const OwnedArray<CountingListener>& listeners)
+    {
+        int total = 0;
+
+        for (auto* l : listeners)
+            total += l->count;
+
+        return total;
+    }
+
+    static MemoryBlock encodeMessage (const String& address, int32 value)
+    {
+        MemoryOutputStream out;
+
+        auto writeString = [&out] (const String& s)
+        {
+            out.write (s.toRawUTF8(), s.getNumBytesAsUTF8() + 1);
+
+            while ((out.getDataSize() & 3) != 0)
+                out.writeByte (0);
+        };
+
+        writeString (address);
+        writeString (",if");
+        out.writeIntBigEndian (value);
+        out.writeFloatBigEndian (0.5f);
+
+        return out.getMemoryBlock();
+    }
+};
+
+static OSCReceiverTests OSCReceiverUnitTests;
+
 #endif
 
 } // namespace juce
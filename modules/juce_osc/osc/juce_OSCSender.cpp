@@ -26,193 +26,209 @@
 namespace juce
 {
 
-namespace
-{
-    //==============================================================================
-    /** Writes OSC data to an internal memory buffer, which grows as required.
+//==============================================================================
+/** Writes OSC data to an internal memory buffer, which grows as required.
 
-        The data that was written into the stream can then be accessed later as
-        a contiguous block of memory.
+    The data that was written into the stream can then be accessed later as
+    a contiguous block of memory.
 
-        This class implements the Open Sound Control 1.0 Specification for
-        the format in which the OSC data will be written into the buffer.
-    */
-    struct OSCOutputStream
-    {
-        OSCOutputStream() noexcept {}
+    This class implements the Open Sound Control 1.0 Specification for
+    the format in which the OSC data will be written into the buffer.
+*/
+struct OSCOutputStream
+{
+    OSCOutputStream() noexcept {}
 
-        /** Returns a pointer to the data that has been written to the stream. */
-        const void* getData() const noexcept    { return output.getData(); }
+    /** Returns a pointer to the data that has been written to the stream. */
+    const void* getData() const noexcept    { return output.getData(); }
 
-        /** Returns the number of bytes of data that have been written to the stream. */
-        size_t getDataSize() const noexcept     { return output.getDataSize(); }
+    /** Returns the number of bytes of data that have been written to the stream. */
+    size_t getDataSize() const noexcept     { return output.getDataSize(); }
 
-        //==============================================================================
-        bool writeInt32 (int32 value)
-        {
-            return output.writeIntBigEndian (value);
-        }
+    /** Discards the data that has been written, but keeps the memory so it can be re-used. */
+    void reset() noexcept                   { output.reset(); }
 
-        bool writeUint64 (uint64 value)
-        {
-            return output.writeInt64BigEndian (int64 (value));
-        }
+    /** Appends some raw data, which must already be in OSC format. */
+    bool writeRaw (const void* data, size_t numBytes)
+    {
+        return output.write (data, numBytes);
+    }
 
-        bool writeFloat32 (float value)
-        {
-            return output.writeFloatBigEndian (value);
-        }
+    //==============================================================================
+    bool writeInt32 (int32 value)
+    {
+        return output.writeIntBigEndian (value);
+    }
 
-        bool writeString (const String& value)
-        {
-            if (! output.writeString (value))
-                return false;
+    bool writeUint64 (uint64 value)
+    {
+        return output.writeInt64BigEndian (int64 (value));
+    }
 
-            const size_t numPaddingZeros = ~value.getNumBytesAsUTF8() & 3;
+    bool writeFloat32 (float value)
+    {
+        return output.writeFloatBigEndian (value);
+    }
 
-            return output.writeRepeatedByte ('\0', numPaddingZeros);
-        }
+    bool writeString (const String& value)
+    {
+        if (! output.writeString (value))
+            return false;
 
-        bool writeBlob (const MemoryBlock& blob)
-        {
-            if (! (output.writeIntBigEndian ((int) blob.getSize())
-                    && output.write (blob.getData(), blob.getSize())))
-                return false;
+        const size_t numPaddingZeros = ~value.getNumBytesAsUTF8() & 3;
 
-            const size_t numPaddingZeros = ~(blob.getSize() - 1) & 3;
+        return output.writeRepeatedByte ('\0', numPaddingZeros);
+    }
 
-            return output.writeRepeatedByte (0, numPaddingZeros);
-        }
+    bool writeBlob (const MemoryBlock& blob)
+    {
+        if (! (output.writeIntBigEndian ((int) blob.getSize())
+                && output.write (blob.getData(), blob.getSize())))
+            return false;
 
-        bool writeColour (OSCColour colour)
-        {
-            return output.writeIntBigEndian ((int32) colour.toInt32());
-        }
+        const size_t numPaddingZeros = ~(blob.getSize() - 1) & 3;
 
-        bool writeTimeTag (OSCTimeTag timeTag)
-        {
-            return output.writeInt64BigEndian (int64 (timeTag.getRawTimeTag()));
-        }
+        return output.writeRepeatedByte (0, numPaddingZeros);
+    }
 
-        bool writeAddress (const OSCAddress& address)
-        {
-            return writeString (address.toString());
-        }
+    bool writeColour (OSCColour colour)
+    {
+        return output.writeIntBigEndian ((int32) colour.toInt32());
+    }
 
-        bool writeAddressPattern (const OSCAddressPattern& ap)
-        {
-            return writeString (ap.toString());
-        }
+    bool writeTimeTag (OSCTimeTag timeTag)
+    {
+        return output.writeInt64BigEndian (int64 (timeTag.getRawTimeTag()));
+    }
 
-        bool writeTypeTagString (const OSCTypeList& typeList)
-        {
-            output.writeByte (',');
+    bool writeAddress (const OSCAddress& address)
+    {
+        return writeString (address.toString());
+    }
 
-            if (typeList.size() > 0)
-                output.write (typeList.begin(), (size_t) typeList.size());
+    bool writeAddressPattern (const OSCAddressPattern& ap)
+    {
+        return writeString (ap.toString());
+    }
 
-            output.writeByte ('\0');
+    bool writeTypeTagString (const OSCTypeList& typeList)
+    {
+        output.writeByte (',');
 
-            size_t bytesWritten = (size_t) typeList.size() + 1;
-            size_t numPaddingZeros = ~bytesWritten & 0x03;
+        if (typeList.size() > 0)
+            output.write (typeList.begin(), (size_t) typeList.size());
 
-            return output.writeRepeatedByte ('\0', numPaddingZeros);
-        }
+        output.writeByte ('\0');
 
-        bool writeArgument (const OSCArgument& arg)
-        {
-            switch (arg.getType())
-            {
-                case OSCTypes::int32:       return writeInt32 (arg.getInt32());
-                case OSCTypes::float32:     return writeFloat32 (arg.getFloat32());
-                case OSCTypes::string:      return writeString (arg.getString());
-                case OSCTypes::blob:        return writeBlob (arg.getBlob());
-                case OSCTypes::colour:      return writeColour (arg.getColour());
+        size_t bytesWritten = (size_t) typeList.size() + 1;
+        size_t numPaddingZeros = ~bytesWritten & 0x03;
 
-                default:
-                    // In this very unlikely case you supplied an invalid OSCType!
-                    jassertfalse;
-                    return false;
-            }
-        }
+        return output.writeRepeatedByte ('\0', numPaddingZeros);
+    }
 
-        //==============================================================================
-        bool writeMessage (const OSCMessage& msg)
+    bool writeArgument (const OSCArgument& arg)
+    {
+        switch (arg.getType())
         {
-            if (! writeAddressPattern (msg.getAddressPattern()))
+            case OSCTypes::int32:       return writeInt32 (arg.getInt32());
+            case OSCTypes::float32:     return writeFloat32 (arg.getFloat32());
+            case OSCTypes::string:      return writeString (arg.getString());
+            case OSCTypes::blob:        return writeBlob (arg.getBlob());
+            case OSCTypes::colour:      return writeColour (arg.getColour());
+
+            default:
+                // In this very unlikely case you supplied an invalid OSCType!
+                jassertfalse;
                 return false;
+        }
+    }
 
-            OSCTypeList typeList;
-
-            for (auto& arg : msg)
-                typeList.add (arg.getType());
+    //==============================================================================
+    bool writeMessage (const OSCMessage& msg)
+    {
+        if (! writeAddressPattern (msg.getAddressPattern()))
+            return false;
 
-            if (! writeTypeTagString (typeList))
-                return false;
+        // this is the same as calling writeTypeTagString(), but avoids building a list
+        output.writeByte (',');
 
-            for (auto& arg : msg)
-                if (! writeArgument (arg))
-                    return false;
+        for (auto& arg : msg)
+            output.writeByte (arg.getType());
 
-            return true;
-        }
+        output.writeByte ('\0');
 
-        bool writeBundle (const OSCBundle& bundle)
-        {
-            if (! writeString ("#bundle"))
-                return false;
+        if (! output.writeRepeatedByte ('\0', ~((size_t) msg.size() + 1) & 0x03))
+            return false;
 
-            if (! writeTimeTag (bundle.getTimeTag()))
+        for (auto& arg : msg)
+            if (! writeArgument (arg))
                 return false;
 
-            for (auto& element : bundle)
-                if (! writeBundleElement (element))
-                    return false;
+        return true;
+    }
 
-            return true;
-        }
+    bool writeBundle (const OSCBundle& bundle)
+    {
+        if (! writeString ("#bundle"))
+            return false;
 
-        //==============================================================================
-        bool writeBundleElement (const OSCBundle::Element& element)
-        {
-            const int64 startPos = output.getPosition();
+        if (! writeTimeTag (bundle.getTimeTag()))
+            return false;
 
-            if (! writeInt32 (0))   // writing dummy value for element size
+        for (auto& element : bundle)
+            if (! writeBundleElement (element))
                 return false;
 
-            if (element.isBundle())
-            {
-                if (! writeBundle (element.getBundle()))
-                    return false;
-            }
-            else
-            {
-                if (! writeMessage (element.getMessage()))
-                    return false;
-            }
+        return true;
+    }
+
+    //==============================================================================
+    bool writeBundleElement (const OSCBundle::Element& element)
+    {
+        const int64 startPos = output.getPosition();
 
-            const int64 endPos = output.getPosition();
-            const int64 elementSize = endPos - (startPos + 4);
+        if (! writeInt32 (0))   // writing dummy value for element size
+            return false;
 
-            return output.setPosition (startPos)
-                     && writeInt32 ((int32) elementSize)
-                     && output.setPosition (endPos);
+        if (element.isBundle())
+        {
+            if (! writeBundle (element.getBundle()))
+                return false;
+        }
+        else
+        {
+            if (! writeMessage (element.getMessage()))
+                return false;
         }
 
-    private:
-        MemoryOutputStream output;
+        const int64 endPos = output.getPosition();
+        const int64 elementSize = endPos - (startPos + 4);
 
-        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OSCOutputStream)
-    };
+        return output.setPosition (startPos)
+                 && writeInt32 ((int32) elementSize)
+                 && output.setPosition (endPos);
+    }
+
+private:
+    MemoryOutputStream output;
 
-} // namespace
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OSCOutputStream)
+};
 
 
 //==============================================================================
-struct OSCSender::Pimpl
+struct OSCSender::Pimpl  : private Thread
 {
-    Pimpl() noexcept  {}
-    ~Pimpl() noexcept { disconnect(); }
+    Pimpl()  : Thread ("OSC bundling")
+    {
+        resetStatistics();
+    }
+
+    ~Pimpl() override
+    {
+        stopBundling();
+        disconnect();
+    }
 
     //==============================================================================
     bool connect (const String& newTargetHost, int newTargetPort)
@@ -220,6 +236,8 @@ struct OSCSender::Pimpl
         if (! disconnect())
             return false;
 
+        const ScopedLock sl (lock);
+
         socket.setOwned (new DatagramSocket (true));
         targetHostName = newTargetHost;
         targetPortNumber = newTargetPort;
@@ -236,6 +254,8 @@ struct OSCSender::Pimpl
         if (! disconnect())
             return false;
 
+        const ScopedLock sl (lock);
+
         socket.setNonOwned (&newSocket);
         targetHostName = newTargetHost;
         targetPortNumber = newTargetPort;
@@ -244,6 +264,11 @@ struct OSCSender::Pimpl
 
     bool disconnect()
     {
+        const ScopedLock sl (lock);
+
+        if (socket != nullptr)
+            flushQueue();
+
         socket.reset();
         return true;
     }
@@ -251,34 +276,367 @@ struct OSCSender::Pimpl
     //==============================================================================
     bool send (const OSCMessage& message, const String& hostName, int portNumber)
     {
-        OSCOutputStream outStream;
+        const ScopedLock sl (lock);
+
+        flushQueue();
+        outStream.reset();
 
         return outStream.writeMessage (message)
-            && sendOutputStream (outStream, hostName, portNumber);
+            && sendOutputStream (outStream, hostName, portNumber, 1);
     }
 
     bool send (const OSCBundle& bundle, const String& hostName, int portNumber)
     {
-        OSCOutputStream outStream;
+        const ScopedLock sl (lock);
+
+        flushQueue();
+        outStream.reset();
 
         return outStream.writeBundle (bundle)
-            && sendOutputStream (outStream, hostName, portNumber);
+            && sendOutputStream (outStream, hostName, portNumber, 0);
+    }
+
+    bool send (const OSCMessage& message)
+    {
+        const ScopedLock sl (lock);
+
+        if (bundlingInterval > 0 && socket != nullptr)
+            return queueMessage (message);
+
+        return send (message, targetHostName, targetPortNumber);
     }
 
-    bool send (const OSCMessage& message)   { return send (message, targetHostName, targetPortNumber); }
-    bool send (const OSCBundle& bundle)     { return send (bundle,  targetHostName, targetPortNumber); }
+    bool send (const OSCBundle& bundle)     { return send (bundle, targetHostName, targetPortNumber); }
+
+    //==============================================================================
+    void startBundling (int intervalMilliseconds, int maxSize, bool onlyLatestValues)
+    {
+        jassert (intervalMilliseconds > 0);
+        jassert (maxSize > bundleHeaderSize);
+
+        {
+            const ScopedLock sl (lock);
+            flushQueue();
+
+            bundlingInterval = jmax (1, intervalMilliseconds);
+            maxPacketSize = jmax (bundleHeaderSize + 8, maxSize);
+            onlySendLatestValues = onlyLatestValues;
+        }
+
+        startThread();
+    }
+
+    void stopBundling()
+    {
+        stopThread (4000);
+
+        const ScopedLock sl (lock);
+
+        if (socket != nullptr)
+            flushQueue();
+
+        bundlingInterval = 0;
+    }
+
+    bool flush()
+    {
+        const ScopedLock sl (lock);
+        return flushQueue();
+    }
+
+    //==============================================================================
+    OSCSender::Statistics getStatistics() const
+    {
+        OSCSender::Statistics stats;
+        stats.numMessagesSent     = numMessagesSent;
+        stats.numMessagesReplaced = numMessagesReplaced;
+        stats.numPacketsSent      = numPacketsSent;
+        stats.numBytesSent        = numBytesSent;
+        stats.numFailures         = numFailures;
+
+        auto seconds = (Time::getMillisecondCounterHiRes() - statisticsStartTime) / 1000.0;
+
+        if (seconds > 0)
+        {
+            stats.messagesPerSecond = (double) stats.numMessagesSent / seconds;
+            stats.packetsPerSecond  = (double) stats.numPacketsSent / seconds;
+        }
+
+        return stats;
+    }
+
+    void resetStatistics()
+    {
+        numMessagesSent = 0;
+        numMessagesReplaced = 0;
+        numPacketsSent = 0;
+        numBytesSent = 0;
+        numFailures = 0;
+        statisticsStartTime = Time::getMillisecondCounterHiRes();
+    }
 
 private:
     //==============================================================================
-    bool sendOutputStream (OSCOutputStream& outStream, const String& hostName, int portNumber)
+    struct Packet
+    {
+        Range<int> range;
+        int numMessages;
+    };
+
+    struct StringHash
+    {
+        size_t operator() (const String& s) const noexcept    { return s.hash(); }
+    };
+
+    // "#bundle" plus a time tag
+    enum { bundleHeaderSize = 16 };
+
+    //==============================================================================
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            int interval;
+
+            {
+                const ScopedLock sl (lock);
+                interval = bundlingInterval;
+            }
+
+            wait (interval);
+
+            const ScopedLock sl (lock);
+
+            if (socket != nullptr)
+                flushQueue();
+        }
+    }
+
+    bool queueMessage (const OSCMessage& message)
+    {
+        auto start = (int) queue.getDataSize();
+
+        if (! queue.writeMessage (message))
+            return false;
+
+        if (onlySendLatestValues)
+        {
+            auto address = message.getAddressPattern().toString();
+            auto found = latestMessageIndex.find (address);
+
+            if (found != latestMessageIndex.end())
+            {
+                // an empty range marks a message that no longer needs to be sent
+                queuedMessages.getReference (found->second) = {};
+                found->second = queuedMessages.size();
+                ++numMessagesReplaced;
+            }
+            else
+            {
+                latestMessageIndex[address] = queuedMessages.size();
+            }
+        }
+
+        queuedMessages.add ({ start, (int) queue.getDataSize() });
+        return true;
+    }
+
+    // Packs the queued messages into as few bundles as will fit into the maximum packet
+    // size, and sends them all in one go. A packet that would only contain one message
+    // is sent as a plain message rather than a bundle.
+    bool flushQueue()
+    {
+        if (queuedMessages.isEmpty())
+            return true;
+
+        packetData.reset();
+        packets.clearQuick();
+
+        auto* queuedData = static_cast<const char*> (queue.getData());
+        Packet packet { {}, 0 };
+
+        auto finishPacket = [&]
+        {
+            if (packet.numMessages == 1)
+                packet.range.setStart (packet.range.getStart() + bundleHeaderSize + 4);
+
+            if (packet.numMessages > 0)
+                packets.add (packet);
+
+            packet.numMessages = 0;
+        };
+
+        for (auto& message : queuedMessages)
+        {
+            if (message.isEmpty())
+                continue;
+
+            auto packetSize = (int) packetData.getDataSize() - packet.range.getStart();
+
+            if (packet.numMessages > 0 && packetSize + 4 + message.getLength() > maxPacketSize)
+                finishPacket();
+
+            if (packet.numMessages == 0)
+            {
+                packet.range.setStart ((int) packetData.getDataSize());
+                packetData.writeString ("#bundle");
+                packetData.writeTimeTag (OSCTimeTag::immediately);
+            }
+
+            packetData.writeInt32 (message.getLength());
+            packetData.writeRaw (queuedData + message.getStart(), (size_t) message.getLength());
+            packet.range.setEnd ((int) packetData.getDataSize());
+            ++packet.numMessages;
+        }
+
+        finishPacket();
+
+        queue.reset();
+        queuedMessages.clearQuick();
+        latestMessageIndex.clear();
+
+        return sendPackets();
+    }
+
+    bool sendPackets()
+    {
+        if (socket == nullptr)
+        {
+            // if you hit this, you tried to send some OSC data without being
+            // connected to a port! You should call OSCSender::connect() first.
+            jassertfalse;
+            return false;
+        }
+
+        auto* data = static_cast<const char*> (packetData.getData());
+        bool allSent = true;
+
+       #if JUCE_LINUX
+        if (packets.size() > 1 && resolveTargetAddress())
+        {
+            const int maxPacketsPerCall = 64;
+            mmsghdr headers[maxPacketsPerCall];
+            iovec vectors[maxPacketsPerCall];
+
+            for (int index = 0; index < packets.size();)
+            {
+                auto numToSend = jmin (maxPacketsPerCall, packets.size() - index);
+                zeromem (headers, sizeof (headers));
+
+                for (int i = 0; i < numToSend; ++i)
+                {
+                    auto range = packets.getReference (index + i).range;
+                    vectors[i].iov_base = const_cast<char*> (data + range.getStart());
+                    vectors[i].iov_len  = (size_t) range.getLength();
+                    headers[i].msg_hdr.msg_name = &targetAddress;
+                    headers[i].msg_hdr.msg_namelen = (socklen_t) sizeof (targetAddress);
+                    headers[i].msg_hdr.msg_iov = vectors + i;
+                    headers[i].msg_hdr.msg_iovlen = 1;
+                }
+
+                auto numSent = sendmmsg (socket->getRawSocketHandle(), headers, (unsigned int) numToSend, 0);
+
+                if (numSent <= 0)
+                {
+                    if (numSent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)
+                         && socket->waitUntilReady (false, 100) > 0)
+                        continue;
+
+                    // give up on this packet, but try to send the rest
+                    allSent = false;
+                    ++numFailures;
+                    ++index;
+                    continue;
+                }
+
+                for (int i = 0; i < numSent; ++i)
+                    recordPacketSent (packets.getReference (index + i));
+
+                index += numSent;
+            }
+
+            return allSent;
+        }
+       #endif
+
+        for (auto& packet : packets)
+        {
+            auto size = packet.range.getLength();
+
+            if (socket->write (targetHostName, targetPortNumber, data + packet.range.getStart(), size) == size)
+            {
+                recordPacketSent (packet);
+            }
+            else
+            {
+                ++numFailures;
+                allSent = false;
+            }
+        }
+
+        return allSent;
+    }
+
+   #if JUCE_LINUX
+    bool resolveTargetAddress()
+    {
+        if (resolvedHostName == targetHostName && resolvedPortNumber == targetPortNumber)
+            return true;
+
+        addrinfo hints;
+        zerostruct (hints);
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+
+        addrinfo* info = nullptr;
+
+        if (getaddrinfo (targetHostName.toRawUTF8(), String (targetPortNumber).toRawUTF8(), &hints, &info) != 0
+             || info == nullptr)
+            return false;
+
+        auto isValid = info->ai_addrlen == sizeof (targetAddress);
+
+        if (isValid)
+        {
+            memcpy (&targetAddress, info->ai_addr, sizeof (targetAddress));
+            resolvedHostName = targetHostName;
+            resolvedPortNumber = targetPortNumber;
+        }
+
+        freeaddrinfo (info);
+        return isValid;
+    }
+
+    sockaddr_in targetAddress;
+    String resolvedHostName;
+    int resolvedPortNumber = -1;
+   #endif
+
+    void recordPacketSent (const Packet& packet)
+    {
+        ++numPacketsSent;
+        numMessagesSent += packet.numMessages;
+        numBytesSent += packet.range.getLength();
+    }
+
+    //==============================================================================
+    bool sendOutputStream (OSCOutputStream& stream, const String& hostName, int portNumber, int numMessages)
     {
         if (socket != nullptr)
         {
-            const int streamSize = (int) outStream.getDataSize();
+            const int streamSize = (int) stream.getDataSize();
 
             const int bytesWritten = socket->write (hostName, portNumber,
-                                                    outStream.getData(), streamSize);
-            return bytesWritten == streamSize;
+                                                    stream.getData(), streamSize);
+
+            if (bytesWritten != streamSize)
+            {
+                ++numFailures;
+                return false;
+            }
+
+            recordPacketSent ({ { 0, streamSize }, numMessages });
+            return true;
         }
 
         // if you hit this, you tried to send some OSC data without being
@@ -289,10 +647,22 @@ private:
     }
 
     //==============================================================================
+    CriticalSection lock;
     OptionalScopedPointer<DatagramSocket> socket;
     String targetHostName;
     int targetPortNumber = 0;
 
+    OSCOutputStream outStream, queue, packetData;
+    Array<Range<int>> queuedMessages;
+    Array<Packet> packets;
+    std::unordered_map<String, int, StringHash> latestMessageIndex;
+
+    int bundlingInterval = 0, maxPacketSize = OSCSender::defaultMaxPacketSize;
+    bool onlySendLatestValues = false;
+
+    std::atomic<int64> numMessagesSent, numMessagesReplaced, numPacketsSent, numBytesSent, numFailures;
+    double statisticsStartTime = 0;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Pimpl)
 };
 
@@ -331,6 +701,18 @@ bool OSCSender::send (const OSCBundle& bundle)      { return pimpl->send (bundle
 bool OSCSender::sendToIPAddress (const String& host, int port, const OSCMessage& message) { return pimpl->send (message, host, port); }
 bool OSCSender::sendToIPAddress (const String& host, int port, const OSCBundle& bundle)   { return pimpl->send (bundle,  host, port); }
 
+//==============================================================================
+void OSCSender::startBundling (int intervalMilliseconds, int maxPacketSize, bool onlySendLatestValues)
+{
+    pimpl->startBundling (intervalMilliseconds, maxPacketSize, onlySendLatestValues);
+}
+
+void OSCSender::stopBundling()                          { pimpl->stopBundling(); }
+bool OSCSender::flush()                                 { return pimpl->flush(); }
+
+OSCSender::Statistics OSCSender::getStatistics() const  { return pimpl->getStatistics(); }
+void OSCSender::resetStatistics()                       { pimpl->resetStatistics(); }
+
 
 //==============================================================================
 //==============================================================================
@@ -871,6 +1253,143 @@ public:
 
 static OSCRoundTripTests OSCRoundTripUnitTests;
 
+//==============================================================================
+class OSCSenderTests  : public UnitTest
+{
+public:
+    OSCSenderTests()
+        : UnitTest ("OSCSender class", UnitTestCategories::osc)
+    {}
+
+    void runTest() override
+    {
+        DatagramSocket receiveSocket (false);
+        OSCReceiver receiver;
+        ReceivedMessages received;
+        OSCSender sender;
+
+        beginTest ("Bundling");
+        {
+            expect (receiveSocket.bindToPort (0));
+            expect (receiver.connectToSocket (receiveSocket));
+            receiver.addListener (&received);
+            expect (sender.connect ("127.0.0.1", receiveSocket.getBoundPort()));
+
+            const int numMessages = 200;
+            sender.startBundling (60000);
+
+            for (int i = 0; i < numMessages; ++i)
+                expect (sender.send ("/param/" + String (i), i));
+
+            Thread::sleep (20);
+            expectEquals (received.getNumMessages(), 0);
+
+            expect (sender.flush());
+            expect (UnitTestHelpers::waitUntil ([&] { return received.getNumMessages() == numMessages; }));
+
+            auto values = received.getValues();
+
+            for (int i = 0; i < numMessages; ++i)
+                expectEquals (values[i], i);
+
+            auto stats = sender.getStatistics();
+            expectEquals (stats.numMessagesSent, (int64) numMessages);
+            expectEquals (stats.numFailures, (int64) 0);
+            expect (stats.numPacketsSent > 1 && stats.numPacketsSent < 10);
+            expect (stats.numBytesSent <= stats.numPacketsSent * OSCSender::defaultMaxPacketSize);
+            expectEquals ((int64) received.getNumBundles(), stats.numPacketsSent);
+
+            // bundles and messages that are sent directly must come after anything in the queue
+            received.clear();
+            expect (sender.send ("/param/0", 1));
+            expect (sender.send (OSCBundle()));
+            expect (UnitTestHelpers::waitUntil ([&] { return received.getNumMessages() == 1 && received.getNumBundles() == 1; }));
+            expectEquals (received.getValues()[0], 1);
+
+            sender.stopBundling();
+        }
+
+        beginTest ("Bundling at regular intervals");
+        {
+            received.clear();
+            sender.startBundling (5, 256);
+
+            for (int i = 0; i < 100; ++i)
+                expect (sender.send ("/param", i));
+
+            expect (UnitTestHelpers::waitUntil ([&] { return received.getNumMessages() == 100; }));
+            expect (received.getNumBundles() > 1);
+            sender.stopBundling();
+        }
+
+        beginTest ("Only sending the latest values");
+        {
+            received.clear();
+            sender.resetStatistics();
+            sender.startBundling (60000, OSCSender::defaultMaxPacketSize, true);
+
+            for (int i = 0; i < 100; ++i)
+                expect (sender.send ("/fader", i));
+
+            expect (sender.send ("/other", -1));
+            expect (sender.flush());
+            expect (UnitTestHelpers::waitUntil ([&] { return received.getNumMessages() == 2; }));
+
+            Thread::sleep (20);
+            auto values = received.getValues();
+            expectEquals (values.size(), 2);
+            expectEquals (values[0], 99);
+            expectEquals (values[1], -1);
+
+            auto stats = sender.getStatistics();
+            expectEquals (stats.numMessagesReplaced, (int64) 99);
+            expectEquals (stats.numMessagesSent, (int64) 2);
+            expectEquals (stats.numPacketsSent, (int64) 1);
+
+            sender.stopBundling();
+        }
+
+        receiver.disconnect();
+    }
+
+private:
+    struct ReceivedMessages  : public OSCReceiver::Listener<OSCReceiver::RealtimeCallback>
+    {
+        void oscMessageReceived (const OSCMessage& message) override
+        {
+            const ScopedLock sl (lock);
+            addMessage (message);
+        }
+
+        void oscBundleReceived (const OSCBundle& bundle) override
+        {
+            const ScopedLock sl (lock);
+            ++numBundles;
+
+            for (auto& element : bundle)
+                if (element.isMessage())
+                    addMessage (element.getMessage());
+        }
+
+        void clear()                        { const ScopedLock sl (lock); values.clear(); numBundles = 0; }
+        int getNumMessages() const          { const ScopedLock sl (lock); return values.size(); }
+        int getNumBundles() const           { const ScopedLock sl (lock); return numBundles; }
+        Array<int> getValues() const        { const ScopedLock sl (lock); return values; }
+
+    private:
+        void addMessage (const OSCMessage& message)
+        {
+            values.add (message.size() > 0 && message[0].isInt32() ? message[0].getInt32() : 0);
+        }
+
+        CriticalSection lock;
+        Array<int> values;
+        int numBundles = 0;
+    };
+};
+
+static OSCSenderTests OSCSenderUnitTests;
+
 #endif
 
 } // namespace juce
@@ -137,6 +137,69 @@ public:
     bool sendToIPAddress (const String& targetIPAddress, int targetPortNumber,
                           const OSCAddressPattern& address, Args&&... args);
 
+    //==============================================================================
+    /** The default for the largest packet that bundling will create. This is the
+        biggest UDP payload that fits into a standard 1500-byte Ethernet frame, so
+        the packets won't need to be fragmented.
+    */
+    static constexpr int defaultMaxPacketSize = 1472;
+
+    /** Switches the sender into a mode where messages are collected and sent in bundles.
+
+        Once this has been called, messages that are passed to send() are added to a queue
+        rather than being sent straight away. Every intervalMilliseconds, a background thread
+        packs all the queued messages into as few OSC bundles as possible, each of which is
+        no bigger than maxPacketSize bytes, and sends them all together. When you're sending
+        thousands of parameter changes per second, this uses far fewer system calls than
+        sending each message in its own packet.
+
+        If onlySendLatestValues is true, a message that's sent to the same address as one
+        that's still waiting in the queue will replace it, so that each address gets sent at
+        most once per interval.
+
+        Bundles, and messages sent with sendToIPAddress(), are still sent immediately, after
+        any queued messages have been sent.
+
+        @see stopBundling, flush
+    */
+    void startBundling (int intervalMilliseconds,
+                        int maxPacketSize = defaultMaxPacketSize,
+                        bool onlySendLatestValues = false);
+
+    /** Sends any queued messages and goes back to sending each message immediately.
+        @see startBundling
+    */
+    void stopBundling();
+
+    /** If bundling is enabled, this immediately sends any messages that are in the queue.
+        @returns true if everything was sent successfully.
+        @see startBundling
+    */
+    bool flush();
+
+    //==============================================================================
+    /** Holds some statistics about the data that an OSCSender has sent.
+        @see getStatistics
+    */
+    struct Statistics
+    {
+        int64 numMessagesSent = 0;      /**< The number of messages that have been sent (not counting those inside bundles that you passed to send()). */
+        int64 numMessagesReplaced = 0;  /**< The number of queued messages that were dropped because a newer one was sent to the same address. */
+        int64 numPacketsSent = 0;       /**< The number of UDP packets that have been sent. */
+        int64 numBytesSent = 0;         /**< The total size of all the packets that have been sent. */
+        int64 numFailures = 0;          /**< The number of packets that the socket failed to send. */
+        double messagesPerSecond = 0;   /**< The average number of messages sent per second since the statistics were reset. */
+        double packetsPerSecond = 0;    /**< The average number of packets sent per second since the statistics were reset. */
+    };
+
+    /** Returns some statistics about the data that has been sent since the sender was
+        created, or since resetStatistics() was last called.
+    */
+    Statistics getStatistics() const;
+
+    /** Resets the counters returned by getStatistics(). */
+    void resetStatistics();
+
 private:
     //==============================================================================
     struct Pimpl;